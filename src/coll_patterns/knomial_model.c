@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "coll_patterns/knomial_model.h"
+
+double ucc_kn_model_time(const ucc_kn_model_t *model,
+                         ucc_kn_pattern_t pattern, ucc_rank_t size,
+                         ucc_kn_radix_t radix, size_t msgsize)
+{
+    double     bw = model->bw;
+    ucc_rank_t n_full, n_extra, full_pow_size, peers;
+    int        pow_radix_sup, i;
+    double     t, seg;
+
+    if (model->nnodes > 1 && model->ppn > 1) {
+        bw /= model->ppn;
+    }
+    CALC_POW_RADIX_SUP(size, radix, pow_radix_sup, full_pow_size);
+    n_full  = size / full_pow_size;
+    n_extra = size - n_full * full_pow_size;
+    t       = 0;
+    seg     = msgsize;
+    for (i = 0; i < pow_radix_sup; i++) {
+        peers = radix - 1;
+        if (i == pow_radix_sup - 1 && full_pow_size != size) {
+            peers = n_full - 1;
+        }
+        if (peers == 0) {
+            continue;
+        }
+        if (pattern == UCC_KN_PATTERN_SCATTER ||
+            pattern == UCC_KN_PATTERN_SRA) {
+            seg /= (peers + 1);
+        }
+        t += model->latency + peers * (model->overhead + seg / bw);
+    }
+    if (n_extra > 0 && pattern != UCC_KN_PATTERN_TREE) {
+        t += 2 * (model->latency + model->overhead + msgsize / bw);
+    }
+    if (pattern == UCC_KN_PATTERN_SRA) {
+        t *= 2;
+    }
+    return t;
+}
+
+ucc_kn_radix_t ucc_kn_model_radix(const ucc_kn_model_t *model,
+                                  ucc_kn_pattern_t pattern,
+                                  ucc_rank_t size, size_t msgsize)
+{
+    double         t, best_t;
+    ucc_kn_radix_t r, best, max_radix;
+
+    if (size <= 2) {
+        return size;
+    }
+    max_radix = ucc_min(size, UCC_KN_RADIX_AUTO_MAX);
+    best      = 2;
+    best_t    = ucc_kn_model_time(model, pattern, size, 2, msgsize);
+    for (r = 3; r <= max_radix; r++) {
+        t = ucc_kn_model_time(model, pattern, size, r, msgsize);
+        if (t < best_t) {
+            best_t = t;
+            best   = r;
+        }
+    }
+    return best;
+}
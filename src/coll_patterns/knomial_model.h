@@ -0,0 +1,53 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_KNOMIAL_MODEL_H_
+#define UCC_KNOMIAL_MODEL_H_
+
+#include "utils/ucc_math.h"
+#include "coll_patterns/recursive_knomial.h"
+
+/* Upper bound of the automatically selected knomial radix */
+#define UCC_KN_RADIX_AUTO_MAX 32
+
+/* Communication pattern of a knomial algorithm, defines how the message
+   size is split across the steps in the radix cost model */
+typedef enum ucc_kn_pattern {
+    UCC_KN_PATTERN_EXCHANGE, /*< full message every step: allreduce
+                                knomial, barrier */
+    UCC_KN_PATTERN_TREE,     /*< full message, no extra ranks: bcast,
+                                reduce */
+    UCC_KN_PATTERN_SCATTER,  /*< message shrinks by radix every step:
+                                reduce_scatter, allgather */
+    UCC_KN_PATTERN_SRA       /*< reduce_scatter followed by allgather */
+} ucc_kn_pattern_t;
+
+/* Parameters of the knomial cost model */
+typedef struct ucc_kn_model {
+    double     latency;  /*< link latency paid once per step, sec */
+    double     overhead; /*< cost of posting a message, sec */
+    double     bw;       /*< link bandwidth, bytes per sec */
+    ucc_rank_t nnodes;
+    ucc_rank_t ppn;      /*< ranks of a node share the link bandwidth when
+                             the team spans several nodes */
+} ucc_kn_model_t;
+
+/* Time of the knomial pattern with the given radix. Every step costs the
+   link latency plus the overhead and transfer time of each message sent
+   in it. The last step of a non full tree talks to less peers, extra ranks
+   add one exchange with their proxy before and after the main loop. */
+double ucc_kn_model_time(const ucc_kn_model_t *model,
+                         ucc_kn_pattern_t pattern, ucc_rank_t size,
+                         ucc_kn_radix_t radix, size_t msgsize);
+
+/* Radix in [2, min(size, UCC_KN_RADIX_AUTO_MAX)] minimizing the cost
+   model, the smallest one of equal cost. Teams of up to 2 ranks use radix
+   equal to the team size. */
+ucc_kn_radix_t ucc_kn_model_radix(const ucc_kn_model_t *model,
+                                  ucc_kn_pattern_t pattern,
+                                  ucc_rank_t size, size_t msgsize);
+
+#endif
@@ -36,6 +36,21 @@ enum {
         _full_pow_size = (fs != _size) ? fs / _radix : fs;                     \
     } while (0)
 
+/**
+ *  Loop peers and SRA segment indices of a rank for every iteration of the
+ *  pattern. Built once per (size, rank, radix) so that progress functions
+ *  do table lookups instead of recomputing them on every step.
+ */
+typedef struct ucc_knomial_table {
+    ucc_kn_radix_t  radix;
+    uint8_t         pow_radix_sup;
+    ucc_rank_t     *peers;      /**< [iteration * (radix - 1) + loop_step - 1],
+                                     UCC_KN_PEER_NULL if there is no peer */
+    ucc_rank_t     *seg_index;  /**< [iteration * radix + loop_step], segment
+                                     of the rank itself at loop_step 0 */
+    ucc_kn_radix_t *step_radix; /**< [iteration] */
+} ucc_knomial_table_t;
+
 typedef struct ucc_knomial_pattern {
     ucc_kn_radix_t radix;
     uint8_t        iteration;
@@ -43,6 +58,7 @@ typedef struct ucc_knomial_pattern {
     uint8_t        node_type;
     ucc_rank_t     radix_pow;
     ucc_rank_t     n_extra; /**< number of "extra" ranks to be served by "proxies" */
+    const ucc_knomial_table_t *tbl; /**< precomputed peers or NULL */
 } ucc_knomial_pattern_t;
 
 /**
@@ -69,6 +85,7 @@ static inline void ucc_knomial_pattern_init_impl(ucc_rank_t             size,
                                                        : full_pow_size)
                             : 1;
     p->node_type     = KN_NODE_BASE;
+    p->tbl           = NULL;
     if (rank < p->n_extra * 2) {
         p->node_type = (rank % 2) ? KN_NODE_EXTRA : KN_NODE_PROXY;
     }
@@ -89,6 +106,19 @@ static inline void ucc_knomial_pattern_init(ucc_rank_t size, ucc_rank_t rank,
     ucc_knomial_pattern_init_impl(size, rank, radix, p, 0);
 }
 
+/**
+ *  Makes the pattern use the precomputed table. The table must be built for
+ *  the same size, rank and radix as the pattern.
+ */
+static inline void
+ucc_knomial_pattern_set_table(ucc_knomial_pattern_t     *p,
+                              const ucc_knomial_table_t *tbl)
+{
+    ucc_assert(!tbl || (tbl->radix == p->radix &&
+                        tbl->pow_radix_sup == p->pow_radix_sup));
+    p->tbl = tbl;
+}
+
 static inline ucc_rank_t ucc_knomial_pattern_get_proxy(ucc_knomial_pattern_t *p,
                                                        ucc_rank_t rank)
 {
@@ -128,6 +158,9 @@ static inline ucc_rank_t ucc_knomial_pattern_get_loop_peer(ucc_knomial_pattern_t
                p->node_type == KN_NODE_PROXY);
     ucc_assert(loop_step >= 1 && loop_step < p->radix);
     ucc_assert((rank >= p->n_extra * 2) || ((rank % 2) == 0));
+    if (p->tbl) {
+        return p->tbl->peers[p->iteration * (p->radix - 1) + loop_step - 1];
+    }
     ucc_rank_t loop_rank = ucc_knomial_pattern_loop_rank(p, rank);
     ucc_rank_t step_size = p->radix_pow * p->radix;
     ucc_rank_t peer      = (loop_rank + loop_step * p->radix_pow) % step_size +
@@ -16,6 +16,9 @@ static inline ucc_rank_t ucc_sra_kn_compute_step_radix(ucc_rank_t rank,
     ucc_rank_t step_radix = 0;
     ucc_rank_t k, peer;
 
+    if (p->tbl) {
+        return p->tbl->step_radix[p->iteration];
+    }
     for (k = 1; k < p->radix; k++) {
         peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, k);
         if (peer == UCC_KN_PEER_NULL)
@@ -42,6 +45,18 @@ static inline ucc_rank_t ucc_sra_kn_compute_seg_index(ucc_rank_t peer,
     return peer_index;
 }
 
+/* segment index of the peer of loop_step (loop_step 0 is the rank itself)
+   at the current iteration, taken from the table if the pattern has one */
+static inline ucc_rank_t ucc_sra_kn_get_seg_index(ucc_knomial_pattern_t *p,
+                                                  ucc_rank_t             peer,
+                                                  ucc_kn_radix_t loop_step)
+{
+    if (p->tbl) {
+        return p->tbl->seg_index[p->iteration * p->radix + loop_step];
+    }
+    return ucc_sra_kn_compute_seg_index(peer, p->radix_pow, p);
+}
+
 // segment size
 static inline size_t ucc_sra_kn_compute_seg_size(size_t         block_count,
                                                  ucc_kn_radix_t radix,
@@ -68,7 +83,8 @@ static inline size_t ucc_sra_kn_compute_block_count(size_t     count,
     ucc_rank_t i, my_si, my_seg_len;
 
     for (i = 0; i < p->iteration; i++) {
-        my_si       = ucc_sra_kn_compute_seg_index(rank, k_pow, p);
+        my_si       = p->tbl ? p->tbl->seg_index[i * p->radix] :
+                               ucc_sra_kn_compute_seg_index(rank, k_pow, p);
         my_seg_len  = ucc_sra_kn_compute_seg_size(block_count, p->radix, my_si);
         block_count = my_seg_len;
         k_pow *= p->radix;
@@ -77,15 +93,17 @@ static inline size_t ucc_sra_kn_compute_block_count(size_t     count,
 }
 
 static inline void
-ucc_sra_kn_get_offset_and_seglen(size_t count, size_t dt_size, ucc_rank_t rank,
-                                 ucc_rank_t size, ucc_kn_radix_t radix,
-                                 ptrdiff_t *offset, int *seglen)
+ucc_sra_kn_get_offset_and_seglen_tbl(size_t count, size_t dt_size,
+                                     ucc_rank_t rank, ucc_rank_t size,
+                                     ucc_kn_radix_t             radix,
+                                     const ucc_knomial_table_t *tbl,
+                                     ptrdiff_t *offset, int *seglen)
 {
     ptrdiff_t             _offset     = 0;
     size_t                block_count = count;
     ucc_rank_t            step_radix  = 0;
     ucc_rank_t            my_seg_len  = 0;
-    ucc_rank_t            k, r, peer, my_si;
+    ucc_rank_t            my_si;
     size_t                my_seg_offset;
     ucc_knomial_pattern_t p;
     ucc_knomial_pattern_init(size, rank, radix, &p);
@@ -97,16 +115,10 @@ ucc_sra_kn_get_offset_and_seglen(size_t count, size_t dt_size, ucc_rank_t rank,
             *seglen = count;
         return;
     }
+    ucc_knomial_pattern_set_table(&p, tbl);
     while (!ucc_knomial_pattern_loop_done(&p)) {
-        r = 0;
-        for (k = 1; k < p.radix; k++) {
-            peer = ucc_knomial_pattern_get_loop_peer(&p, rank, size, k);
-            if (peer == UCC_KN_PEER_NULL)
-                continue;
-            r++;
-        }
-        step_radix = r + 1;
-        my_si      = ucc_sra_kn_compute_seg_index(rank, p.radix_pow, &p);
+        step_radix = ucc_sra_kn_compute_step_radix(rank, size, &p);
+        my_si      = ucc_sra_kn_get_seg_index(&p, rank, 0);
         my_seg_offset =
             ucc_sra_kn_compute_seg_offset(block_count, step_radix, my_si);
         _offset += my_seg_offset * dt_size;
@@ -126,6 +138,15 @@ ucc_sra_kn_get_offset_and_seglen(size_t count, size_t dt_size, ucc_rank_t rank,
         *seglen = my_seg_len;
 }
 
+static inline void
+ucc_sra_kn_get_offset_and_seglen(size_t count, size_t dt_size, ucc_rank_t rank,
+                                 ucc_rank_t size, ucc_kn_radix_t radix,
+                                 ptrdiff_t *offset, int *seglen)
+{
+    ucc_sra_kn_get_offset_and_seglen_tbl(count, dt_size, rank, size, radix,
+                                         NULL, offset, seglen);
+}
+
 static inline ptrdiff_t ucc_sra_kn_get_offset(size_t count, size_t dt_size,
                                               ucc_rank_t rank, ucc_rank_t size,
                                               ucc_kn_radix_t radix)
@@ -136,4 +157,66 @@ static inline ptrdiff_t ucc_sra_kn_get_offset(size_t count, size_t dt_size,
     return offset;
 }
 
+/* offset of the rank result using the table of the (advanced) pattern p */
+static inline ptrdiff_t ucc_sra_kn_pattern_get_offset(size_t count,
+                                                      size_t dt_size,
+                                                      ucc_rank_t rank,
+                                                      ucc_rank_t size,
+                                                      ucc_knomial_pattern_t *p)
+{
+    ptrdiff_t offset;
+    ucc_sra_kn_get_offset_and_seglen_tbl(count, dt_size, rank, size, p->radix,
+                                         p->tbl, &offset, NULL);
+    return offset;
+}
+
+
+/* Size of the table of the pattern: header followed by the peers, segment
+   indices and step radices of all the iterations */
+static inline size_t ucc_knomial_table_size(const ucc_knomial_pattern_t *p)
+{
+    return sizeof(ucc_knomial_table_t) +
+           p->pow_radix_sup * ((2 * p->radix - 1) * sizeof(ucc_rank_t) +
+                               sizeof(ucc_kn_radix_t));
+}
+
+/* Fills the table of the rank from the pattern initialized for the same
+   size, rank and radix, the pattern is iterated to the end of the loop.
+   tbl must hold ucc_knomial_table_size bytes. */
+static inline void ucc_sra_kn_table_init(ucc_knomial_table_t   *tbl,
+                                         ucc_rank_t             size,
+                                         ucc_rank_t             rank,
+                                         ucc_knomial_pattern_t *p)
+{
+    ucc_kn_radix_t radix = p->radix;
+    ucc_rank_t     peer;
+    ucc_kn_radix_t k, step_radix;
+
+    ucc_assert(p->node_type != KN_NODE_EXTRA && p->iteration == 0);
+    tbl->radix         = radix;
+    tbl->pow_radix_sup = p->pow_radix_sup;
+    tbl->peers         = PTR_OFFSET(tbl, sizeof(*tbl));
+    tbl->seg_index     = tbl->peers + p->pow_radix_sup * (radix - 1);
+    tbl->step_radix    =
+        (ucc_kn_radix_t *)(tbl->seg_index + p->pow_radix_sup * radix);
+    while (!ucc_knomial_pattern_loop_done(p)) {
+        step_radix = 1;
+        tbl->seg_index[p->iteration * radix] =
+            ucc_sra_kn_compute_seg_index(rank, p->radix_pow, p);
+        for (k = 1; k < radix; k++) {
+            peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, k);
+            tbl->peers[p->iteration * (radix - 1) + k - 1] = peer;
+            tbl->seg_index[p->iteration * radix + k]       =
+                (peer == UCC_KN_PEER_NULL)
+                    ? 0
+                    : ucc_sra_kn_compute_seg_index(peer, p->radix_pow, p);
+            if (peer != UCC_KN_PEER_NULL) {
+                step_radix++;
+            }
+        }
+        tbl->step_radix[p->iteration] = step_radix;
+        ucc_knomial_pattern_next_iteration(p);
+    }
+}
+
 #endif
@@ -15,6 +15,16 @@ static ucc_config_field_t ucc_cl_basic_lib_config_table[] = {
     {"", "", NULL, ucc_offsetof(ucc_cl_basic_lib_config_t, super),
      UCC_CONFIG_TYPE_TABLE(ucc_cl_lib_config_table)},
 
+    {"ADAPTIVE_SAMPLES", "0",
+     "Number of calls every candidate algorithm is timed for by adaptive "
+     "selection. Candidates are the algorithms of all TLs supporting a "
+     "collective, memory type and message size bucket. After exploration "
+     "the ranks agree on the fastest one which is used for the rest of the "
+     "team lifetime. 0 - disables adaptive selection, the algorithm is "
+     "selected by scores",
+     ucc_offsetof(ucc_cl_basic_lib_config_t, adaptive_samples),
+     UCC_CONFIG_TYPE_UINT},
+
     {NULL}
 };
 
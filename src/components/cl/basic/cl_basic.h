@@ -21,8 +21,16 @@ typedef struct ucc_cl_basic_iface {
 /* Extern iface should follow the pattern: ucc_cl_<cl_name> */
 extern ucc_cl_basic_iface_t ucc_cl_basic;
 
+/* Max number of algorithms compared by adaptive selection for a
+   single collective, memory type and message size bucket */
+#define UCC_CL_BASIC_ADAPT_MAX_CANDS 8
+
+/* Message size buckets of adaptive selection: 0 and powers of 2 */
+#define UCC_CL_BASIC_ADAPT_N_BUCKETS 65
+
 typedef struct ucc_cl_basic_lib_config {
     ucc_cl_lib_config_t super;
+    unsigned            adaptive_samples;
 } ucc_cl_basic_lib_config_t;
 
 typedef struct ucc_cl_basic_context_config {
@@ -31,6 +39,7 @@ typedef struct ucc_cl_basic_context_config {
 
 typedef struct ucc_cl_basic_lib {
     ucc_cl_lib_t super;
+    unsigned     adaptive_samples;
 } ucc_cl_basic_lib_t;
 UCC_CLASS_DECLARE(ucc_cl_basic_lib_t, const ucc_base_lib_params_t *,
                   const ucc_base_config_t *);
@@ -43,17 +52,65 @@ typedef struct ucc_cl_basic_context {
 UCC_CLASS_DECLARE(ucc_cl_basic_context_t, const ucc_base_context_params_t *,
                   const ucc_base_config_t *);
 
+typedef struct ucc_cl_basic_adapt_cand {
+    ucc_base_coll_init_fn_t init;
+    ucc_base_team_t        *team;
+    double                  time;      /*< sum of completion times */
+    uint32_t                n_samples;
+} ucc_cl_basic_adapt_cand_t;
+
+typedef enum ucc_cl_basic_adapt_state {
+    UCC_CL_BASIC_ADAPT_NEW,
+    UCC_CL_BASIC_ADAPT_EXPLORE,
+    UCC_CL_BASIC_ADAPT_AGREE,
+    UCC_CL_BASIC_ADAPT_LOCKED
+} ucc_cl_basic_adapt_state_t;
+
+typedef struct ucc_cl_basic_adapt_bucket {
+    ucc_cl_basic_adapt_state_t    state;
+    uint32_t                      n_calls;
+    uint32_t                      n_cands;
+    ucc_cl_basic_adapt_cand_t     cands[UCC_CL_BASIC_ADAPT_MAX_CANDS];
+    double                        local[UCC_CL_BASIC_ADAPT_MAX_CANDS];
+    double                        global[UCC_CL_BASIC_ADAPT_MAX_CANDS];
+    struct ucc_service_coll_req  *sreq;
+    int                           winner;
+} ucc_cl_basic_adapt_bucket_t;
+
 typedef struct ucc_cl_basic_team {
-    ucc_cl_team_t            super;
-    ucc_team_multiple_req_t *team_create_req;
-    ucc_tl_team_t          **tl_teams;
-    unsigned                 n_tl_teams;
-    ucc_score_map_t         *score_map;
+    ucc_cl_team_t                super;
+    ucc_team_multiple_req_t     *team_create_req;
+    ucc_tl_team_t              **tl_teams;
+    unsigned                     n_tl_teams;
+    ucc_score_map_t             *score_map;
+    /* adaptive selection only: score maps of single TLs and the
+       selection state per coll type, memory type and msg size bucket */
+    ucc_score_map_t            **tl_score_maps;
+    ucc_cl_basic_adapt_bucket_t *adapt[UCC_COLL_TYPE_NUM]
+                                      [UCC_MEMORY_TYPE_LAST];
 } ucc_cl_basic_team_t;
 UCC_CLASS_DECLARE(ucc_cl_basic_team_t, ucc_base_context_t *,
                   const ucc_base_team_params_t *);
 
+ucc_status_t ucc_cl_basic_adaptive_init(ucc_cl_basic_team_t *team);
+
+/* Returns UCC_INPROGRESS while agreements of the team are in flight */
+ucc_status_t ucc_cl_basic_adaptive_cleanup(ucc_cl_basic_team_t *team);
+
+/* Selects the algorithm at runtime: for every coll type, memory type and
+   msg size bucket the candidates are timed in turn for the first calls,
+   the ranks agree on the fastest one which is used afterwards. "init" and
+   "bteam" are the static choice of the score map. */
+ucc_status_t ucc_cl_basic_adaptive_coll_init(ucc_cl_basic_team_t     *team,
+                                             ucc_base_coll_args_t    *args,
+                                             ucc_base_coll_init_fn_t  init,
+                                             ucc_base_team_t         *bteam,
+                                             ucc_coll_task_t        **task);
+
 #define UCC_CL_BASIC_TEAM_CTX(_team)                                           \
     (ucc_derived_of((_team)->super.super.context, ucc_cl_basic_context_t))
 
+#define UCC_CL_BASIC_TEAM_LIB(_team)                                           \
+    (ucc_derived_of((_team)->super.super.context->lib, ucc_cl_basic_lib_t))
+
 #endif
@@ -0,0 +1,387 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "cl_basic.h"
+#include "core/ucc_team.h"
+#include "core/ucc_service_coll.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_time.h"
+#include "utils/ucc_coll_utils.h"
+#include "components/mc/base/ucc_mc_base.h"
+#include <float.h>
+
+/* Explored call: the candidate task wrapped into a schedule, so that its
+   completion time is recorded */
+typedef struct ucc_cl_basic_adapt_task {
+    ucc_schedule_t             super;
+    ucc_cl_basic_adapt_cand_t *cand;
+    double                     start;
+} ucc_cl_basic_adapt_task_t;
+
+ucc_status_t ucc_cl_basic_adaptive_init(ucc_cl_basic_team_t *team)
+{
+    ucc_base_lib_t   *lib = team->super.super.context->lib;
+    ucc_coll_score_t *score;
+    ucc_status_t      status;
+    int               i;
+
+    team->tl_score_maps = ucc_calloc(team->n_tl_teams,
+                                     sizeof(ucc_score_map_t *),
+                                     "cl_basic_tl_score_maps");
+    if (!team->tl_score_maps) {
+        cl_error(lib, "failed to allocate %zd bytes for tl score maps",
+                 team->n_tl_teams * sizeof(ucc_score_map_t *));
+        return UCC_ERR_NO_MEMORY;
+    }
+    for (i = 0; i < team->n_tl_teams; i++) {
+        status = UCC_TL_TEAM_IFACE(team->tl_teams[i])
+                     ->team.get_scores(&team->tl_teams[i]->super, &score);
+        if (UCC_OK != status) {
+            cl_error(lib, "failed to get tl %s scores",
+                     UCC_TL_TEAM_IFACE(team->tl_teams[i])->super.name);
+            goto err;
+        }
+        status = ucc_coll_score_build_map(score, &team->tl_score_maps[i]);
+        if (UCC_OK != status) {
+            cl_error(lib, "failed to build score map");
+            ucc_coll_score_free(score);
+            goto err;
+        }
+    }
+    return UCC_OK;
+err:
+    ucc_cl_basic_adaptive_cleanup(team);
+    return status;
+}
+
+ucc_status_t ucc_cl_basic_adaptive_cleanup(ucc_cl_basic_team_t *team)
+{
+    ucc_cl_basic_adapt_bucket_t *b;
+    int                          i, j, k, n_pending;
+
+    /* agreements posted on all ranks complete during team destroy */
+    n_pending = 0;
+    for (i = 0; i < UCC_COLL_TYPE_NUM; i++) {
+        for (j = 0; j < UCC_MEMORY_TYPE_LAST; j++) {
+            for (k = 0; team->adapt[i][j] && k < UCC_CL_BASIC_ADAPT_N_BUCKETS;
+                 k++) {
+                b = &team->adapt[i][j][k];
+                if (!b->sreq) {
+                    continue;
+                }
+                if (n_pending == 0) {
+                    ucc_context_progress(team->super.super.team->contexts[0]);
+                }
+                if (UCC_INPROGRESS == ucc_service_coll_test(b->sreq)) {
+                    n_pending++;
+                    continue;
+                }
+                ucc_service_coll_finalize(b->sreq);
+                b->sreq = NULL;
+            }
+        }
+    }
+    if (n_pending) {
+        return UCC_INPROGRESS;
+    }
+    for (i = 0; i < UCC_COLL_TYPE_NUM; i++) {
+        for (j = 0; j < UCC_MEMORY_TYPE_LAST; j++) {
+            ucc_free(team->adapt[i][j]);
+            team->adapt[i][j] = NULL;
+        }
+    }
+    for (i = 0; team->tl_score_maps && i < team->n_tl_teams; i++) {
+        if (team->tl_score_maps[i]) {
+            ucc_coll_score_free_map(team->tl_score_maps[i]);
+        }
+    }
+    ucc_free(team->tl_score_maps);
+    team->tl_score_maps = NULL;
+    return UCC_OK;
+}
+
+static void ucc_cl_basic_adapt_add_cand(ucc_cl_basic_adapt_bucket_t *b,
+                                        ucc_base_coll_init_fn_t      init,
+                                        ucc_base_team_t             *bteam)
+{
+    uint32_t i;
+
+    for (i = 0; i < b->n_cands; i++) {
+        if (b->cands[i].init == init && b->cands[i].team == bteam) {
+            return;
+        }
+    }
+    if (b->n_cands < UCC_CL_BASIC_ADAPT_MAX_CANDS) {
+        b->cands[b->n_cands].init = init;
+        b->cands[b->n_cands].team = bteam;
+        b->n_cands++;
+    }
+}
+
+/* Candidates are the ranges of every TL covering the args and all the
+   algorithms of those TLs. The static choice goes first: it is used for
+   the calls made while the ranks agree. The list only depends on the team
+   and args, so it is the same on all ranks. */
+static void ucc_cl_basic_adapt_get_cands(ucc_cl_basic_team_t         *team,
+                                         ucc_base_coll_args_t        *args,
+                                         ucc_cl_basic_adapt_bucket_t *b,
+                                         ucc_base_coll_init_fn_t      init,
+                                         ucc_base_team_t             *bteam)
+{
+    ucc_coll_type_t           ct = args->args.coll_type;
+    ucc_memory_type_t         mt = ucc_coll_args_mem_type(args);
+    ucc_tl_iface_t           *iface;
+    ucc_base_coll_alg_info_t *alg;
+    ucc_base_coll_init_fn_t   tl_init;
+    ucc_base_team_t          *tl_team;
+    int                       i;
+
+    ucc_cl_basic_adapt_add_cand(b, init, bteam);
+    for (i = 0; i < team->n_tl_teams; i++) {
+        if (UCC_OK != ucc_coll_score_map_lookup(team->tl_score_maps[i], args,
+                                                &tl_init, &tl_team)) {
+            continue;
+        }
+        ucc_cl_basic_adapt_add_cand(b, tl_init, tl_team);
+        iface = UCC_TL_TEAM_IFACE(team->tl_teams[i]);
+        if (!iface->alg_id_to_init || !iface->alg_info[ucc_ilog2(ct)]) {
+            continue;
+        }
+        for (alg = iface->alg_info[ucc_ilog2(ct)]; alg->name; alg++) {
+            if (UCC_OK == iface->alg_id_to_init(alg->id, NULL, ct, mt,
+                                                &tl_init)) {
+                ucc_cl_basic_adapt_add_cand(b, tl_init, tl_team);
+            }
+        }
+    }
+}
+
+static ucc_status_t ucc_cl_basic_adapt_task_post(ucc_coll_task_t *task)
+{
+    ucc_cl_basic_adapt_task_t *t =
+        ucc_derived_of(task, ucc_cl_basic_adapt_task_t);
+
+    t->start = ucc_get_time();
+    return ucc_schedule_start(&t->super);
+}
+
+static ucc_status_t
+ucc_cl_basic_adapt_task_done(ucc_coll_task_t *parent, /* NOLINT */
+                             ucc_coll_task_t *task)
+{
+    ucc_cl_basic_adapt_task_t *t =
+        ucc_derived_of(task, ucc_cl_basic_adapt_task_t);
+
+    t->cand->time += ucc_get_time() - t->start;
+    t->cand->n_samples++;
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_cl_basic_adapt_task_finalize(ucc_coll_task_t *task)
+{
+    ucc_cl_basic_adapt_task_t *t =
+        ucc_derived_of(task, ucc_cl_basic_adapt_task_t);
+    ucc_status_t               status;
+
+    status = ucc_schedule_finalize(task);
+    ucc_schedule_cleanup(&t->super);
+    ucc_free(t);
+    return status;
+}
+
+static ucc_status_t
+ucc_cl_basic_adapt_explore(ucc_cl_basic_team_t       *team,
+                           ucc_base_coll_args_t      *args,
+                           ucc_cl_basic_adapt_cand_t *cand,
+                           ucc_coll_task_t          **task)
+{
+    ucc_cl_basic_adapt_task_t *t;
+    ucc_coll_task_t           *cand_task;
+    ucc_status_t               status;
+
+    status = cand->init(args, cand->team, &cand_task);
+    if (UCC_OK != status) {
+        return status;
+    }
+    t = ucc_calloc(1, sizeof(*t), "cl_basic_adapt_task");
+    if (!t) {
+        cl_error(team->super.super.context->lib,
+                 "failed to allocate %zd bytes for adaptive task", sizeof(*t));
+        cand_task->finalize(cand_task);
+        return UCC_ERR_NO_MEMORY;
+    }
+    ucc_schedule_init(&t->super, &args->args, &team->super.super);
+    t->super.super.post     = ucc_cl_basic_adapt_task_post;
+    t->super.super.finalize = ucc_cl_basic_adapt_task_finalize;
+    t->cand                 = cand;
+
+    /* subscribed before the schedule, the time is recorded before the
+       completion of the schedule is reported to the user */
+    status = ucc_event_manager_subscribe(&cand_task->em, UCC_EVENT_COMPLETED,
+                                         &t->super.super,
+                                         ucc_cl_basic_adapt_task_done);
+    if (UCC_OK != status) {
+        goto err;
+    }
+    status = ucc_schedule_add_task(&t->super, cand_task);
+    if (UCC_OK != status) {
+        goto err;
+    }
+    status = ucc_event_manager_subscribe(&t->super.super.em,
+                                         UCC_EVENT_SCHEDULE_STARTED, cand_task,
+                                         ucc_task_start_handler);
+    if (UCC_OK != status) {
+        ucc_cl_basic_adapt_task_finalize(&t->super.super);
+        return status;
+    }
+    *task = &t->super.super;
+    return UCC_OK;
+err:
+    cand_task->finalize(cand_task);
+    ucc_schedule_cleanup(&t->super);
+    ucc_free(t);
+    return status;
+}
+
+/* Every rank contributes its mean completion time of the candidates, the
+   slowest rank defines the time of a collective */
+static ucc_status_t
+ucc_cl_basic_adapt_agree_post(ucc_cl_basic_team_t         *team,
+                              ucc_cl_basic_adapt_bucket_t *b)
+{
+    ucc_team_t        *core_team = team->super.super.team;
+    ucc_team_subset_t  subset    = {.map.type   = UCC_EP_MAP_FULL,
+                                    .map.ep_num = core_team->size,
+                                    .myrank     = core_team->rank};
+    uint32_t           i;
+
+    for (i = 0; i < b->n_cands; i++) {
+        b->local[i] = b->cands[i].n_samples ?
+                      b->cands[i].time / b->cands[i].n_samples : DBL_MAX;
+    }
+    return ucc_service_allreduce(core_team, b->local, b->global,
+                                 UCC_DT_FLOAT64, b->n_cands, UCC_OP_MAX,
+                                 subset, &b->sreq);
+}
+
+static ucc_status_t
+ucc_cl_basic_adapt_agree_wait(ucc_cl_basic_team_t         *team,
+                              ucc_cl_basic_adapt_bucket_t *b)
+{
+    ucc_context_t *ctx = team->super.super.team->contexts[0];
+    ucc_status_t   status;
+    uint32_t       i;
+
+    while (UCC_INPROGRESS == (status = ucc_service_coll_test(b->sreq))) {
+        ucc_context_progress(ctx);
+    }
+    ucc_service_coll_finalize(b->sreq);
+    b->sreq = NULL;
+    if (UCC_OK != status) {
+        return status;
+    }
+    b->winner = 0;
+    for (i = 1; i < b->n_cands; i++) {
+        if (b->global[i] < b->global[b->winner]) {
+            b->winner = i;
+        }
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_cl_basic_adaptive_coll_init(ucc_cl_basic_team_t     *team,
+                                             ucc_base_coll_args_t    *args,
+                                             ucc_base_coll_init_fn_t  init,
+                                             ucc_base_team_t         *bteam,
+                                             ucc_coll_task_t        **task)
+{
+    ucc_base_lib_t              *lib     = team->super.super.context->lib;
+    unsigned                     ct      = ucc_ilog2(args->args.coll_type);
+    ucc_memory_type_t            mt      = ucc_coll_args_mem_type(args);
+    size_t                       msgsize = ucc_coll_args_msgsize(args);
+    uint32_t                     n_explore;
+    ucc_cl_basic_adapt_bucket_t *b;
+    ucc_cl_basic_adapt_cand_t   *cand;
+    ucc_status_t                 status;
+
+    if (mt == UCC_MEMORY_TYPE_NOT_APPLY) {
+        mt = UCC_MEMORY_TYPE_HOST;
+    }
+    if (msgsize == UCC_MSG_SIZE_INVALID || msgsize == UCC_MSG_SIZE_ASSYMETRIC) {
+        msgsize = 0;
+    }
+    if (!team->adapt[ct][mt]) {
+        team->adapt[ct][mt] = ucc_calloc(UCC_CL_BASIC_ADAPT_N_BUCKETS,
+                                         sizeof(ucc_cl_basic_adapt_bucket_t),
+                                         "cl_basic_adapt_buckets");
+        if (!team->adapt[ct][mt]) {
+            cl_error(lib, "failed to allocate %zd bytes for adaptive buckets",
+                     UCC_CL_BASIC_ADAPT_N_BUCKETS *
+                     sizeof(ucc_cl_basic_adapt_bucket_t));
+            return UCC_ERR_NO_MEMORY;
+        }
+    }
+    b = &team->adapt[ct][mt][msgsize ? ucc_ilog2(msgsize) + 1 : 0];
+    /* the decision only depends on the number of calls of the bucket,
+       so all ranks run the same candidate */
+    n_explore = b->n_cands * UCC_CL_BASIC_TEAM_LIB(team)->adaptive_samples;
+    switch (b->state) {
+    case UCC_CL_BASIC_ADAPT_NEW:
+        ucc_cl_basic_adapt_get_cands(team, args, b, init, bteam);
+        n_explore = b->n_cands * UCC_CL_BASIC_TEAM_LIB(team)->adaptive_samples;
+        b->state  = (b->n_cands > 1) ? UCC_CL_BASIC_ADAPT_EXPLORE
+                                     : UCC_CL_BASIC_ADAPT_LOCKED;
+        if (b->state == UCC_CL_BASIC_ADAPT_LOCKED) {
+            break;
+        }
+        /* fall through */
+    case UCC_CL_BASIC_ADAPT_EXPLORE:
+        if (b->n_calls < n_explore) {
+            cand   = &b->cands[b->n_calls++ % b->n_cands];
+            status = ucc_cl_basic_adapt_explore(team, args, cand, task);
+            if (UCC_ERR_NOT_SUPPORTED == status) {
+                /* candidate does not support the args, it is never timed
+                   and loses the agreement */
+                return init(args, bteam, task);
+            }
+            return status;
+        }
+        status = ucc_cl_basic_adapt_agree_post(team, b);
+        if (UCC_OK != status) {
+            cl_warn(lib, "failed to post adaptive selection agreement");
+            b->state = UCC_CL_BASIC_ADAPT_LOCKED;
+            break;
+        }
+        b->state = UCC_CL_BASIC_ADAPT_AGREE;
+        /* fall through */
+    case UCC_CL_BASIC_ADAPT_AGREE:
+        /* the static choice is used while the agreement is in flight, the
+           result is waited for after as many calls as were explored */
+        if (b->n_calls++ < 2 * n_explore) {
+            return init(args, bteam, task);
+        }
+        if (UCC_OK != ucc_cl_basic_adapt_agree_wait(team, b)) {
+            cl_warn(lib, "adaptive selection agreement failed");
+        } else {
+            cl_debug(lib, "adaptive selection: %s %s msgsize %zd: "
+                     "candidate %d of %u, %.2f us",
+                     ucc_coll_type_str(args->args.coll_type),
+                     ucc_memory_type_names[mt], msgsize, b->winner,
+                     b->n_cands, b->global[b->winner] * 1e6);
+        }
+        b->state = UCC_CL_BASIC_ADAPT_LOCKED;
+        break;
+    case UCC_CL_BASIC_ADAPT_LOCKED:
+        break;
+    }
+    cand   = &b->cands[b->winner];
+    status = cand->init(args, cand->team, task);
+    if (UCC_ERR_NOT_SUPPORTED == status && cand->init != init) {
+        /* args of the bucket the winner does not support */
+        return init(args, bteam, task);
+    }
+    return status;
+}
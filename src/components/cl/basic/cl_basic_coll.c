@@ -24,5 +24,12 @@ ucc_status_t ucc_cl_basic_coll_init(ucc_base_coll_args_t *coll_args,
     } else if (UCC_OK != status) {
         return status;
     }
+    /* timing of a partitioned collective includes the production of its
+       partitions, it is not a sample for the adaptive selection */
+    if (cl_team->tl_score_maps &&
+        !UCC_IS_PARTITIONED(coll_args->args)) {
+        return ucc_cl_basic_adaptive_coll_init(cl_team, coll_args, init,
+                                               bteam, task);
+    }
     return init(coll_args, bteam, task);
 }
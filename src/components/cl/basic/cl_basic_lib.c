@@ -14,9 +14,11 @@
 UCC_CLASS_INIT_FUNC(ucc_cl_basic_lib_t, const ucc_base_lib_params_t *params,
                     const ucc_base_config_t *config)
 {
-    const ucc_cl_lib_config_t *cl_config =
-        ucc_derived_of(config, ucc_cl_lib_config_t);
-    UCC_CLASS_CALL_SUPER_INIT(ucc_cl_lib_t, &ucc_cl_basic.super, cl_config);
+    const ucc_cl_basic_lib_config_t *cl_config =
+        ucc_derived_of(config, ucc_cl_basic_lib_config_t);
+    UCC_CLASS_CALL_SUPER_INIT(ucc_cl_lib_t, &ucc_cl_basic.super,
+                              &cl_config->super);
+    self->adaptive_samples = cl_config->adaptive_samples;
     cl_info(&self->super, "initialized lib object: %p", self);
     return UCC_OK;
 }
@@ -53,6 +55,7 @@ ucc_status_t ucc_cl_basic_get_lib_attr(const ucc_base_lib_t *lib,
                                        ucc_base_lib_attr_t  *base_attr)
 {
     ucc_cl_lib_attr_t *attr   = ucc_derived_of(base_attr, ucc_cl_lib_attr_t);
+    ucc_cl_basic_lib_t *basic_lib = ucc_derived_of(lib, ucc_cl_basic_lib_t);
     ucc_cl_lib_t *     cl_lib = ucc_derived_of(lib, ucc_cl_lib_t);
     ucc_config_names_array_t *tls = &cl_lib->tls;
     ucc_tl_iface_t *          tl_iface;
@@ -90,5 +93,9 @@ ucc_status_t ucc_cl_basic_get_lib_attr(const ucc_base_lib_t *lib,
             }
         }
     }
+    if (basic_lib->adaptive_samples > 0) {
+        /* ranks agree on the selected algorithms with service allreduce */
+        attr->super.flags |= UCC_BASE_LIB_FLAG_SERVICE_TEAM_REQUIRED;
+    }
     return UCC_OK;
 }
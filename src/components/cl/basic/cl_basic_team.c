@@ -24,9 +24,11 @@ UCC_CLASS_INIT_FUNC(ucc_cl_basic_team_t, ucc_base_context_t *cl_context,
         status = UCC_ERR_NO_MEMORY;
         goto err;
     }
-    self->n_tl_teams = 0;
-    status           = ucc_team_multiple_req_alloc(&self->team_create_req,
-                                                   ctx->n_tl_ctxs);
+    memset(self->adapt, 0, sizeof(self->adapt));
+    self->tl_score_maps = NULL;
+    self->n_tl_teams    = 0;
+    status              = ucc_team_multiple_req_alloc(&self->team_create_req,
+                                                      ctx->n_tl_ctxs);
     if (UCC_OK != status) {
         cl_error(cl_context->lib, "failed to allocate team req multiple");
         goto err;
@@ -68,6 +70,10 @@ ucc_status_t ucc_cl_basic_team_destroy(ucc_base_team_t *cl_team)
     ucc_status_t            status  = UCC_OK;
     int                     i;
 
+    status = ucc_cl_basic_adaptive_cleanup(team);
+    if (UCC_OK != status) {
+        return status;
+    }
     if (NULL == team->team_create_req) {
         status = ucc_team_multiple_req_alloc(&team->team_create_req,
                                              team->n_tl_teams);
@@ -154,6 +160,10 @@ ucc_status_t ucc_cl_basic_team_create_test(ucc_base_team_t *cl_team)
         status = ucc_coll_score_build_map(score, &team->score_map);
         if (UCC_OK != status) {
             cl_error(ctx->super.super.lib, "failed to build score map");
+            return status;
+        }
+        if (UCC_CL_BASIC_TEAM_LIB(team)->adaptive_samples > 0) {
+            status = ucc_cl_basic_adaptive_init(team);
         }
     }
     return status;
@@ -71,7 +71,8 @@ typedef struct ucc_mem_attr {
  * UCC memory component attributes field mask
  */
 typedef enum ucc_mc_attr_field {
-    UCC_MC_ATTR_FIELD_THREAD_MODE = UCC_BIT(0)
+    UCC_MC_ATTR_FIELD_THREAD_MODE = UCC_BIT(0),
+    UCC_MC_ATTR_FIELD_MPOOL_STATS = UCC_BIT(1)
 }  ucc_mc_attr_field_t;
 
 typedef struct ucc_mc_attr {
@@ -81,6 +82,10 @@ typedef struct ucc_mc_attr {
      */
     uint64_t          field_mask;
     ucc_thread_mode_t thread_mode;
+    uint64_t          mpool_hits;   /*< allocations served by the mpool */
+    uint64_t          mpool_misses; /*< mpool chunk allocations and
+                                        allocations served by the system
+                                        allocator */
 } ucc_mc_attr_t;
 
 /**
@@ -111,6 +116,33 @@ typedef struct ucc_mc_ops {
     ucc_status_t (*memcpy)(void *dst, const void *src, size_t len,
                            ucc_memory_type_t dst_mem,
                            ucc_memory_type_t src_mem);
+    /* optional, wire format conversion of fp32 data */
+    ucc_status_t (*compress)(void *dst, const void *src, float *err,
+                             size_t count, ucc_datatype_t dst_dt);
+    ucc_status_t (*reduce_multi_decompress)(const void *src1, const void *src2,
+                                            void *dst, size_t n_vectors,
+                                            size_t count, size_t stride,
+                                            ucc_datatype_t src2_dt);
+    /* optional, sparse vectors given as sorted (index, value) pairs */
+    ucc_status_t (*reduce_sparse)(const uint64_t *idx1, const void *val1,
+                                  size_t n1, const uint64_t *idx2,
+                                  const void *val2, size_t n2,
+                                  uint64_t *dst_idx, void *dst_val,
+                                  size_t *dst_n, ucc_datatype_t dt);
+    ucc_status_t (*sparse_to_dense)(void *dense, const uint64_t *idx,
+                                    const void *val, size_t n,
+                                    ucc_datatype_t dt);
+    ucc_status_t (*dense_to_sparse)(uint64_t *idx, void *val, size_t *n,
+                                    size_t max_n, const void *dense,
+                                    size_t count, ucc_datatype_t dt);
+    /* optional, range of the packed representation of user defined
+       datatype elements */
+    ucc_status_t (*pack)(void *dst, const void *src,
+                         const ucc_dt_userdefined_t *dt, size_t offset,
+                         size_t len);
+    ucc_status_t (*unpack)(void *dst, const void *src,
+                           const ucc_dt_userdefined_t *dt, size_t offset,
+                           size_t len);
  } ucc_mc_ops_t;
 
 typedef struct ucc_ee_ops {
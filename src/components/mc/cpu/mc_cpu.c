@@ -7,29 +7,113 @@
 #include "mc_cpu.h"
 #include "reduce/mc_cpu_reduce.h"
 #include "utils/ucc_malloc.h"
+#include "utils/ucc_proc_info.h"
+#include "utils/ucc_math.h"
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 static ucc_config_field_t ucc_mc_cpu_config_table[] = {
     {"", "", NULL, ucc_offsetof(ucc_mc_cpu_config_t, super),
      UCC_CONFIG_TYPE_TABLE(ucc_mc_config_table)},
 
-    {"MPOOL_ELEM_SIZE", "1Mb", "The size of each element in mc cpu mpool",
+    {"MPOOL_ELEM_SIZE", "1Mb",
+     "The size of the largest element in mc cpu mpool, larger buffers are "
+     "allocated with ucc_malloc",
      ucc_offsetof(ucc_mc_cpu_config_t, mpool_elem_size),
      UCC_CONFIG_TYPE_MEMUNITS},
 
-    {"MPOOL_MAX_ELEMS", "8", "The max amount of elements in mc cpu mpool",
+    {"MPOOL_MIN_ELEM_SIZE", "4Kb",
+     "The size of the smallest element in mc cpu mpool. Elements are "
+     "grouped in power of 2 size classes between MPOOL_MIN_ELEM_SIZE and "
+     "MPOOL_ELEM_SIZE",
+     ucc_offsetof(ucc_mc_cpu_config_t, mpool_min_elem_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"MPOOL_MAX_ELEMS", "8",
+     "The max amount of elements in each size class of mc cpu mpool, "
+     "0 - disable mpool",
      ucc_offsetof(ucc_mc_cpu_config_t, mpool_max_elems), UCC_CONFIG_TYPE_UINT},
 
+    {"MPOOL_HUGEPAGES", "y",
+     "Try to back mc cpu mpool elements of 2MB and larger with huge pages",
+     ucc_offsetof(ucc_mc_cpu_config_t, mpool_hugepages),
+     UCC_CONFIG_TYPE_BOOL},
+
+    {"MPOOL_TCACHE_SIZE", "4",
+     "Number of elements of each size class cached per thread in "
+     "UCC_THREAD_MULTIPLE mode, 0 - disable per thread caches",
+     ucc_offsetof(ucc_mc_cpu_config_t, mpool_tcache_size),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"MEMCPY_NT_THRESH", "4Mb",
+     "Host to host copies of this size and larger use non-temporal stores "
+     "that bypass the cache, inf - always use regular memcpy",
+     ucc_offsetof(ucc_mc_cpu_config_t, memcpy_nt_thresh),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"MEMCPY_MT_THRESH", "64Mb",
+     "Host to host copies of this size and larger are split between "
+     "MEMCPY_MT_THREADS threads",
+     ucc_offsetof(ucc_mc_cpu_config_t, memcpy_mt_thresh),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"MEMCPY_MT_THREADS", "1",
+     "Number of threads used for large host to host copies, the helper "
+     "threads are started at mc init, 1 - disable multithreaded copy",
+     ucc_offsetof(ucc_mc_cpu_config_t, memcpy_mt_threads),
+     UCC_CONFIG_TYPE_UINT},
+
     {NULL}
 
 };
 
+#define UCC_MC_CPU_HUGEPAGE_2M    (2ul * 1024 * 1024)
+#define UCC_MC_CPU_HUGEPAGE_1G    (1024ul * 1024 * 1024)
+#define UCC_MC_CPU_CHUNK_HDR_SIZE UCC_CACHE_LINE_SIZE
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+/* Per thread cache of mpool elements, used in UCC_THREAD_MULTIPLE mode to
+   avoid taking the mpool lock on every alloc/free. The cache is dropped if
+   the mpool was re-created since it was filled, and returned to the mpool
+   by the tcache key destructor when the thread exits. */
+typedef struct ucc_mc_cpu_tcache {
+    uint32_t                generation;
+    uint32_t                count[UCC_MC_CPU_MAX_CLASSES];
+    ucc_mc_buffer_header_t *elems[UCC_MC_CPU_MAX_CLASSES]
+                                 [UCC_MC_CPU_TCACHE_MAX_SIZE];
+} ucc_mc_cpu_tcache_t;
+
+static __thread ucc_mc_cpu_tcache_t ucc_mc_cpu_tcache;
+
 static ucc_status_t ucc_mc_cpu_init(const ucc_mc_params_t *mc_params)
 {
+    const char *memcpy_nt_name;
+
     ucc_strncpy_safe(ucc_mc_cpu.super.config->log_component.name,
                      ucc_mc_cpu.super.super.name,
                      sizeof(ucc_mc_cpu.super.config->log_component.name));
     ucc_mc_cpu.thread_mode = mc_params->thread_mode;
+    ucc_mc_cpu.memcpy_nt   = ucc_mc_cpu_memcpy_nt_select(&memcpy_nt_name);
+    mc_debug(&ucc_mc_cpu.super, "using %s non-temporal memcpy for copies "
+             "larger than %zd", memcpy_nt_name, MC_CPU_CONFIG->memcpy_nt_thresh);
+    ucc_mc_cpu.memcpy_pool = NULL;
+    if (MC_CPU_CONFIG->memcpy_mt_threads > 1 &&
+        UCC_OK != ucc_mc_cpu_memcpy_pool_create(
+                      MC_CPU_CONFIG->memcpy_mt_threads, ucc_mc_cpu.memcpy_nt,
+                      &ucc_mc_cpu.memcpy_pool)) {
+        mc_warn(&ucc_mc_cpu.super, "failed to start memcpy threads, "
+                "multithreaded copy is disabled");
+    }
     // lock assures single mpool initiation when multiple threads concurrently execute
     // different collective operations thus concurrently entering init function.
     ucc_spinlock_init(&ucc_mc_cpu.mpool_init_spinlock, 0);
@@ -38,9 +122,19 @@ static ucc_status_t ucc_mc_cpu_init(const ucc_mc_params_t *mc_params)
 
 static ucc_status_t ucc_mc_cpu_get_attr(ucc_mc_attr_t *mc_attr)
 {
+    int i;
+
     if (mc_attr->field_mask & UCC_MC_ATTR_FIELD_THREAD_MODE) {
         mc_attr->thread_mode = ucc_mc_cpu.thread_mode;
     }
+    if (mc_attr->field_mask & UCC_MC_ATTR_FIELD_MPOOL_STATS) {
+        mc_attr->mpool_hits   = 0;
+        mc_attr->mpool_misses = ucc_mc_cpu.n_large_allocs;
+        for (i = 0; i < ucc_mc_cpu.n_classes; i++) {
+            mc_attr->mpool_hits   += ucc_mc_cpu.classes[i].n_allocs;
+            mc_attr->mpool_misses += ucc_mc_cpu.classes[i].n_misses;
+        }
+    }
     return UCC_OK;
 }
 
@@ -63,46 +157,152 @@ static ucc_status_t ucc_mc_cpu_mem_alloc(ucc_mc_buffer_header_t **h_ptr,
     return UCC_OK;
 }
 
+static inline int ucc_mc_cpu_size_class(size_t size)
+{
+    unsigned log;
+
+    if (size <= UCC_BIT(ucc_mc_cpu.min_class_log)) {
+        return 0;
+    }
+    log = ucc_ilog2(size - 1) + 1;
+    return log - ucc_mc_cpu.min_class_log;
+}
+
+static inline ucc_mc_cpu_tcache_t *ucc_mc_cpu_get_tcache()
+{
+    ucc_mc_cpu_tcache_t *tc = &ucc_mc_cpu_tcache;
+
+    if (ucc_unlikely(tc->generation != ucc_mc_cpu.generation)) {
+        /* mpool was re-created, cached elements are gone */
+        memset(tc->count, 0, sizeof(tc->count));
+        tc->generation = ucc_mc_cpu.generation;
+        pthread_setspecific(ucc_mc_cpu.tcache_key, tc);
+    }
+    return tc;
+}
+
+/* Called on thread exit, returns the elements cached by the thread */
+static void ucc_mc_cpu_tcache_drain(void *arg)
+{
+    ucc_mc_cpu_tcache_t *tc = (ucc_mc_cpu_tcache_t *)arg;
+    int                  i;
+
+    if (tc->generation != ucc_mc_cpu.generation) {
+        return;
+    }
+    for (i = 0; i < ucc_mc_cpu.n_classes; i++) {
+        while (tc->count[i] > 0) {
+            ucc_mpool_put(tc->elems[i][--tc->count[i]]);
+        }
+    }
+}
+
 static ucc_status_t ucc_mc_cpu_mem_pool_alloc(ucc_mc_buffer_header_t **h_ptr,
                                               size_t                   size)
 {
-    ucc_mc_buffer_header_t *h = NULL;
-    if (size <= MC_CPU_CONFIG->mpool_elem_size) {
-        h = (ucc_mc_buffer_header_t *)ucc_mpool_get(&ucc_mc_cpu.mpool);
+    int                       cls = ucc_mc_cpu_size_class(size);
+    ucc_mc_buffer_header_t   *h   = NULL;
+    ucc_mc_cpu_mpool_class_t *mc_class;
+    ucc_mc_cpu_tcache_t      *tc;
+
+    if (ucc_unlikely(cls >= ucc_mc_cpu.n_classes)) {
+        // Slow path
+        ucc_mc_cpu.n_large_allocs++;
+        return ucc_mc_cpu_mem_alloc(h_ptr, size);
+    }
+    mc_class = &ucc_mc_cpu.classes[cls];
+    if (MC_CPU_CONFIG->mpool_tcache_size &&
+        ucc_mc_cpu.thread_mode == UCC_THREAD_MULTIPLE) {
+        tc = ucc_mc_cpu_get_tcache();
+        if (tc->count[cls] > 0) {
+            h = tc->elems[cls][--tc->count[cls]];
+        }
+    }
+    if (!h) {
+        h = (ucc_mc_buffer_header_t *)ucc_mpool_get(&mc_class->super);
     }
     if (!h) {
         // Slow path
+        mc_class->n_misses++;
         return ucc_mc_cpu_mem_alloc(h_ptr, size);
     }
-    mc_trace(&ucc_mc_cpu.super, "allocated %ld bytes from cpu mpool", size);
+    mc_class->n_allocs++;
+    mc_trace(&ucc_mc_cpu.super, "allocated %ld bytes from cpu mpool class %zd",
+             size, mc_class->elem_size);
     *h_ptr = h;
     return UCC_OK;
 }
 
-static ucc_status_t ucc_mc_cpu_chunk_alloc(ucc_mpool_t *mp, //NOLINT
+/* Chunks are mapped directly: with huge pages if enabled and the chunk is
+   large enough, otherwise with regular pages advising THP. The chunk
+   length is kept in the chunk header for release. */
+static ucc_status_t ucc_mc_cpu_chunk_alloc(ucc_mpool_t *mp,
                                            size_t *size_p,
                                            void **chunk_p)
 {
-    *chunk_p = ucc_malloc(*size_p, "mc cpu");
-    if (!*chunk_p) {
-        mc_error(&ucc_mc_cpu.super, "failed to allocate %zd bytes", *size_p);
-        return UCC_ERR_NO_MEMORY;
+    ucc_mc_cpu_mpool_class_t *mc_class =
+        ucc_derived_of(mp, ucc_mc_cpu_mpool_class_t);
+    size_t length = *size_p + UCC_MC_CPU_CHUNK_HDR_SIZE;
+    void  *ptr    = MAP_FAILED;
+    size_t hp_size;
+    int    hp_flag;
+
+    if (MC_CPU_CONFIG->mpool_hugepages && length >= UCC_MC_CPU_HUGEPAGE_2M) {
+        if (length >= UCC_MC_CPU_HUGEPAGE_1G) {
+            hp_size = UCC_MC_CPU_HUGEPAGE_1G;
+            hp_flag = MAP_HUGE_1GB;
+        } else {
+            hp_size = UCC_MC_CPU_HUGEPAGE_2M;
+            hp_flag = MAP_HUGE_2MB;
+        }
+        ptr = mmap(NULL, ucc_align_up(length, hp_size), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | hp_flag, -1, 0);
+        if (ptr != MAP_FAILED) {
+            length = ucc_align_up(length, hp_size);
+        }
+    }
+    if (ptr == MAP_FAILED) {
+        length = ucc_align_up(length, sysconf(_SC_PAGESIZE));
+        ptr    = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            mc_error(&ucc_mc_cpu.super, "failed to allocate %zd bytes",
+                     length);
+            return UCC_ERR_NO_MEMORY;
+        }
+#ifdef MADV_HUGEPAGE
+        if (MC_CPU_CONFIG->mpool_hugepages &&
+            length >= UCC_MC_CPU_HUGEPAGE_2M) {
+            madvise(ptr, length, MADV_HUGEPAGE);
+        }
+#endif
     }
+    /* place mpool buffers on the numa node of the process */
+    ucc_numa_bind_local(ptr, length);
+    mc_class->n_misses++;
+    *(size_t *)ptr = length;
+    *chunk_p       = PTR_OFFSET(ptr, UCC_MC_CPU_CHUNK_HDR_SIZE);
+    *size_p        = length - UCC_MC_CPU_CHUNK_HDR_SIZE;
     return UCC_OK;
 }
 
-static void ucc_mc_cpu_chunk_init(ucc_mpool_t *mp, //NOLINT
+static void ucc_mc_cpu_chunk_init(ucc_mpool_t *mp,
                                   void *obj, void *chunk) //NOLINT
 {
-    ucc_mc_buffer_header_t *h = (ucc_mc_buffer_header_t *)obj;
-    h->from_pool              = 1;
-    h->addr                   = PTR_OFFSET(h, sizeof(ucc_mc_buffer_header_t));
-    h->mt                     = UCC_MEMORY_TYPE_HOST;
+    ucc_mc_cpu_mpool_elem_t *elem = (ucc_mc_cpu_mpool_elem_t *)obj;
+
+    elem->super.from_pool = 1;
+    elem->super.addr      = PTR_OFFSET(elem, sizeof(ucc_mc_cpu_mpool_elem_t));
+    elem->super.mt        = UCC_MEMORY_TYPE_HOST;
+    elem->cls             = ucc_derived_of(mp, ucc_mc_cpu_mpool_class_t) -
+                            ucc_mc_cpu.classes;
 }
 
 static void ucc_mc_cpu_chunk_release(ucc_mpool_t *mp, void *chunk) //NOLINT
 {
-    ucc_free(chunk);
+    void *ptr = PTR_OFFSET(chunk, -UCC_MC_CPU_CHUNK_HDR_SIZE);
+
+    munmap(ptr, *(size_t *)ptr);
 }
 
 static ucc_mpool_ops_t ucc_mc_ops = {.chunk_alloc   = ucc_mc_cpu_chunk_alloc,
@@ -118,13 +318,95 @@ static ucc_status_t ucc_mc_cpu_mem_free(ucc_mc_buffer_header_t *h_ptr)
 
 static ucc_status_t ucc_mc_cpu_mem_pool_free(ucc_mc_buffer_header_t *h_ptr)
 {
+    ucc_mc_cpu_tcache_t *tc;
+    int                  cls;
+
     if (!h_ptr->from_pool) {
         return ucc_mc_cpu_mem_free(h_ptr);
     }
+    if (MC_CPU_CONFIG->mpool_tcache_size &&
+        ucc_mc_cpu.thread_mode == UCC_THREAD_MULTIPLE) {
+        tc  = ucc_mc_cpu_get_tcache();
+        cls = ucc_derived_of(h_ptr, ucc_mc_cpu_mpool_elem_t)->cls;
+        if (tc->count[cls] < MC_CPU_CONFIG->mpool_tcache_size) {
+            tc->elems[cls][tc->count[cls]++] = h_ptr;
+            return UCC_OK;
+        }
+    }
     ucc_mpool_put(h_ptr);
     return UCC_OK;
 }
 
+static void ucc_mc_cpu_mpool_cleanup()
+{
+    ucc_mc_cpu_mpool_class_t *mc_class;
+    int                       i;
+
+    for (i = 0; i < ucc_mc_cpu.n_classes; i++) {
+        mc_class = &ucc_mc_cpu.classes[i];
+        mc_debug(&ucc_mc_cpu.super, "mpool class %zd: hits %lu, misses %lu",
+                 mc_class->elem_size, mc_class->n_allocs, mc_class->n_misses);
+        /* elements may still be held by thread caches */
+        ucc_mpool_cleanup(&mc_class->super, 0);
+    }
+    mc_debug(&ucc_mc_cpu.super, "allocations above mpool size: %lu",
+             ucc_mc_cpu.n_large_allocs);
+    ucc_mc_cpu.n_classes = 0;
+    pthread_key_delete(ucc_mc_cpu.tcache_key);
+}
+
+static ucc_status_t ucc_mc_cpu_mpool_init()
+{
+    size_t       min_size = ucc_max(MC_CPU_CONFIG->mpool_min_elem_size,
+                                    UCC_CACHE_LINE_SIZE);
+    size_t       max_size = MC_CPU_CONFIG->mpool_elem_size;
+    unsigned     elems_per_chunk;
+    size_t       elem_size;
+    ucc_status_t status;
+    int          i;
+
+    if (pthread_key_create(&ucc_mc_cpu.tcache_key, ucc_mc_cpu_tcache_drain)) {
+        mc_error(&ucc_mc_cpu.super, "failed to create mpool tcache key");
+        return UCC_ERR_NO_RESOURCE;
+    }
+    ucc_mc_cpu.min_class_log  = ucc_ilog2(min_size - 1) + 1;
+    ucc_mc_cpu.n_classes      = 0;
+    ucc_mc_cpu.n_large_allocs = 0;
+    ucc_mc_cpu.generation++;
+    for (i = 0; i < UCC_MC_CPU_MAX_CLASSES; i++) {
+        elem_size = UCC_BIT(ucc_mc_cpu.min_class_log + i);
+        if (elem_size > ucc_max(max_size, min_size)) {
+            break;
+        }
+        elems_per_chunk = ucc_max(UCC_MC_CPU_HUGEPAGE_2M / elem_size, 1);
+        elems_per_chunk = ucc_min(elems_per_chunk,
+                                  MC_CPU_CONFIG->mpool_max_elems);
+        ucc_mc_cpu.classes[i].elem_size = elem_size;
+        ucc_mc_cpu.classes[i].n_allocs  = 0;
+        ucc_mc_cpu.classes[i].n_misses  = 0;
+        status = ucc_mpool_init(
+            &ucc_mc_cpu.classes[i].super, 0,
+            sizeof(ucc_mc_cpu_mpool_elem_t) + elem_size, 0,
+            UCC_CACHE_LINE_SIZE, elems_per_chunk,
+            MC_CPU_CONFIG->mpool_max_elems, &ucc_mc_ops,
+            ucc_mc_cpu.thread_mode, "mc cpu mpool buffers");
+        if (ucc_unlikely(status != UCC_OK)) {
+            ucc_mc_cpu_mpool_cleanup();
+            return status;
+        }
+        ucc_mc_cpu.n_classes++;
+    }
+    if (MC_CPU_CONFIG->mpool_tcache_size > UCC_MC_CPU_TCACHE_MAX_SIZE) {
+        mc_warn(&ucc_mc_cpu.super, "mpool tcache size is limited by %d",
+                UCC_MC_CPU_TCACHE_MAX_SIZE);
+        MC_CPU_CONFIG->mpool_tcache_size = UCC_MC_CPU_TCACHE_MAX_SIZE;
+    }
+    mc_debug(&ucc_mc_cpu.super, "mpool size classes: %d, min %zd, max %zd",
+             ucc_mc_cpu.n_classes, ucc_mc_cpu.classes[0].elem_size,
+             ucc_mc_cpu.classes[ucc_mc_cpu.n_classes - 1].elem_size);
+    return UCC_OK;
+}
+
 static ucc_status_t
 ucc_mc_cpu_mem_pool_alloc_with_init(ucc_mc_buffer_header_t **h_ptr, size_t size)
 {
@@ -140,11 +422,7 @@ ucc_mc_cpu_mem_pool_alloc_with_init(ucc_mc_buffer_header_t **h_ptr, size_t size)
     }
 
     if (!ucc_mc_cpu.mpool_init_flag) {
-        ucc_status_t status = ucc_mpool_init(
-            &ucc_mc_cpu.mpool, 0,
-            sizeof(ucc_mc_buffer_header_t) + MC_CPU_CONFIG->mpool_elem_size, 0,
-            UCC_CACHE_LINE_SIZE, 1, MC_CPU_CONFIG->mpool_max_elems, &ucc_mc_ops,
-            ucc_mc_cpu.thread_mode, "mc cpu mpool buffers");
+        ucc_status_t status = ucc_mc_cpu_mpool_init();
         if (ucc_unlikely(status != UCC_OK)) {
             ucc_spin_unlock(&ucc_mc_cpu.mpool_init_spinlock);
             return status;
@@ -195,6 +473,13 @@ static ucc_status_t ucc_mc_cpu_reduce_multi(const void *src1, const void *src2,
         ucc_assert(8 == sizeof(double));
         return ucc_mc_cpu_reduce_multi_double(src1, src2, dst, n_vectors,
                                               count, stride, op);
+    case UCC_DT_FLOAT32_INT32:
+    case UCC_DT_FLOAT64_INT32:
+    case UCC_DT_INT16_INT32:
+    case UCC_DT_INT32_INT32:
+    case UCC_DT_INT64_INT32:
+        return ucc_mc_cpu_reduce_multi_loc(src1, src2, dst, n_vectors, count,
+                                           stride, dt, op);
     default:
         mc_error(&ucc_mc_cpu.super, "unsupported reduction type (%d)", dt);
         return UCC_ERR_NOT_SUPPORTED;
@@ -213,9 +498,20 @@ static ucc_status_t ucc_mc_cpu_memcpy(void *dst, const void *src, size_t len,
                                       ucc_memory_type_t dst_mem, //NOLINT
                                       ucc_memory_type_t src_mem) //NOLINT
 {
+    ucc_mc_cpu_config_t *cfg = MC_CPU_CONFIG;
+
     ucc_assert((dst_mem == UCC_MEMORY_TYPE_HOST) &&
                (src_mem == UCC_MEMORY_TYPE_HOST));
-    memcpy(dst, src, len);
+    if (len < cfg->memcpy_nt_thresh) {
+        memcpy(dst, src, len);
+    } else if (len < cfg->memcpy_mt_thresh || !ucc_mc_cpu.memcpy_pool) {
+        /* large copies are typically not read again before the next
+           collective step, streaming stores keep them from evicting the
+           working set of the reduction kernels */
+        ucc_mc_cpu.memcpy_nt(dst, src, len);
+    } else {
+        ucc_mc_cpu_memcpy_mt(ucc_mc_cpu.memcpy_pool, dst, src, len);
+    }
     return UCC_OK;
 }
 
@@ -270,10 +566,14 @@ ucc_status_t ucc_ee_cpu_event_test(void *event) //NOLINT
 static ucc_status_t ucc_mc_cpu_finalize()
 {
     if (ucc_mc_cpu.mpool_init_flag) {
-        ucc_mpool_cleanup(&ucc_mc_cpu.mpool, 1);
+        ucc_mc_cpu_mpool_cleanup();
         ucc_mc_cpu.mpool_init_flag     = 0;
         ucc_mc_cpu.super.ops.mem_alloc = ucc_mc_cpu_mem_pool_alloc_with_init;
     }
+    if (ucc_mc_cpu.memcpy_pool) {
+        ucc_mc_cpu_memcpy_pool_destroy(ucc_mc_cpu.memcpy_pool);
+        ucc_mc_cpu.memcpy_pool = NULL;
+    }
     ucc_spinlock_destroy(&ucc_mc_cpu.mpool_init_spinlock);
     return UCC_OK;
 }
@@ -292,6 +592,13 @@ ucc_mc_cpu_t ucc_mc_cpu = {
     .super.ops.reduce       = ucc_mc_cpu_reduce,
     .super.ops.reduce_multi = ucc_mc_cpu_reduce_multi,
     .super.ops.memcpy       = ucc_mc_cpu_memcpy,
+    .super.ops.compress     = ucc_mc_cpu_compress,
+    .super.ops.reduce_multi_decompress = ucc_mc_cpu_reduce_multi_decompress,
+    .super.ops.reduce_sparse   = ucc_mc_cpu_reduce_sparse,
+    .super.ops.sparse_to_dense = ucc_mc_cpu_sparse_to_dense,
+    .super.ops.dense_to_sparse = ucc_mc_cpu_dense_to_sparse,
+    .super.ops.pack            = ucc_mc_cpu_pack,
+    .super.ops.unpack          = ucc_mc_cpu_unpack,
     .super.config_table =
         {
             .name   = "CPU memory component",
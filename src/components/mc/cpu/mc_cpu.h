@@ -9,19 +9,61 @@
 
 #include "components/mc/base/ucc_mc_base.h"
 #include "components/mc/ucc_mc_log.h"
+#include "memcpy/mc_cpu_memcpy.h"
+#include <pthread.h>
+
+/* Size classes of mc cpu mpool are powers of 2 in range
+   [mpool_min_elem_size, mpool_elem_size] */
+#define UCC_MC_CPU_MAX_CLASSES     32
+/* Max number of buffers per size class cached by a thread */
+#define UCC_MC_CPU_TCACHE_MAX_SIZE 8
 
 typedef struct ucc_mc_cpu_config {
     ucc_mc_config_t super;
     size_t          mpool_elem_size;
+    size_t          mpool_min_elem_size;
     int             mpool_max_elems;
+    int             mpool_hugepages;
+    unsigned        mpool_tcache_size;
+    size_t          memcpy_nt_thresh;
+    size_t          memcpy_mt_thresh;
+    unsigned        memcpy_mt_threads;
 } ucc_mc_cpu_config_t;
 
+/* Element of mc cpu mpool, the buffer follows the element */
+typedef struct ucc_mc_cpu_mpool_elem {
+    ucc_mc_buffer_header_t super;
+    int                    cls; /*< size class of the element */
+} ucc_mc_cpu_mpool_elem_t;
+
+/* Counters are not synchronized, in UCC_THREAD_MULTIPLE mode they are
+   approximate */
+typedef struct ucc_mc_cpu_mpool_class {
+    ucc_mpool_t super;
+    size_t      elem_size;
+    uint64_t    n_allocs; /*< requests served by the class */
+    uint64_t    n_misses; /*< chunk allocations and requests that
+                              fell back to ucc_malloc */
+} ucc_mc_cpu_mpool_class_t;
+
 typedef struct ucc_mc_cpu {
-    ucc_mc_base_t     super;
-    ucc_mpool_t       mpool;
-    int               mpool_init_flag;
-    ucc_spinlock_t    mpool_init_spinlock;
-    ucc_thread_mode_t thread_mode;
+    ucc_mc_base_t             super;
+    ucc_mc_cpu_mpool_class_t  classes[UCC_MC_CPU_MAX_CLASSES];
+    int                       n_classes;
+    unsigned                  min_class_log;
+    uint64_t                  n_large_allocs; /*< allocations above the
+                                                  largest size class */
+    uint32_t                  generation; /*< incremented on mpool init,
+                                               invalidates thread caches */
+    pthread_key_t             tcache_key; /*< drains thread caches on
+                                               thread exit */
+    int                       mpool_init_flag;
+    ucc_spinlock_t            mpool_init_spinlock;
+    ucc_thread_mode_t         thread_mode;
+    ucc_mc_cpu_memcpy_fn_t    memcpy_nt; /*< streaming store copy kernel
+                                             selected for the host cpu */
+    ucc_mc_cpu_memcpy_pool_t *memcpy_pool; /*< helper threads of large
+                                               copies, NULL if disabled */
 } ucc_mc_cpu_t;
 
 extern ucc_mc_cpu_t ucc_mc_cpu;
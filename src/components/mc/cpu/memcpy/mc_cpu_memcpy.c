@@ -0,0 +1,249 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "memcpy/mc_cpu_memcpy.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_malloc.h"
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+/* Copies the unaligned head with regular stores so that the body can be
+   written with aligned streaming stores, returns the number of bytes
+   copied */
+static inline size_t ucc_mc_cpu_memcpy_head(void *dst, const void *src,
+                                            size_t len, size_t align)
+{
+    size_t head = (align - ((uintptr_t)dst & (align - 1))) & (align - 1);
+
+    head = ucc_min(head, len);
+    memcpy(dst, src, head);
+    return head;
+}
+
+static void ucc_mc_cpu_memcpy_nt_sse2(void *dst, const void *src, size_t len)
+{
+    size_t      head = ucc_mc_cpu_memcpy_head(dst, src, len, 16);
+    char       *d    = (char *)dst + head;
+    const char *s    = (const char *)src + head;
+    __m128i     x0, x1, x2, x3;
+
+    len -= head;
+    for (; len >= 64; len -= 64, d += 64, s += 64) {
+        x0 = _mm_loadu_si128((const __m128i *)(s + 0));
+        x1 = _mm_loadu_si128((const __m128i *)(s + 16));
+        x2 = _mm_loadu_si128((const __m128i *)(s + 32));
+        x3 = _mm_loadu_si128((const __m128i *)(s + 48));
+        _mm_stream_si128((__m128i *)(d + 0), x0);
+        _mm_stream_si128((__m128i *)(d + 16), x1);
+        _mm_stream_si128((__m128i *)(d + 32), x2);
+        _mm_stream_si128((__m128i *)(d + 48), x3);
+    }
+    /* streaming stores are weakly ordered, make them visible before the
+       copy is reported complete */
+    _mm_sfence();
+    memcpy(d, s, len);
+}
+
+__attribute__((target("avx")))
+static void ucc_mc_cpu_memcpy_nt_avx(void *dst, const void *src, size_t len)
+{
+    size_t      head = ucc_mc_cpu_memcpy_head(dst, src, len, 32);
+    char       *d    = (char *)dst + head;
+    const char *s    = (const char *)src + head;
+    __m256i     y0, y1, y2, y3;
+
+    len -= head;
+    for (; len >= 128; len -= 128, d += 128, s += 128) {
+        y0 = _mm256_loadu_si256((const __m256i *)(s + 0));
+        y1 = _mm256_loadu_si256((const __m256i *)(s + 32));
+        y2 = _mm256_loadu_si256((const __m256i *)(s + 64));
+        y3 = _mm256_loadu_si256((const __m256i *)(s + 96));
+        _mm256_stream_si256((__m256i *)(d + 0), y0);
+        _mm256_stream_si256((__m256i *)(d + 32), y1);
+        _mm256_stream_si256((__m256i *)(d + 64), y2);
+        _mm256_stream_si256((__m256i *)(d + 96), y3);
+    }
+    _mm_sfence();
+    _mm256_zeroupper();
+    memcpy(d, s, len);
+}
+#else
+static void ucc_mc_cpu_memcpy_std(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+}
+#endif
+
+ucc_mc_cpu_memcpy_fn_t ucc_mc_cpu_memcpy_nt_select(const char **name)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        *name = "avx";
+        return ucc_mc_cpu_memcpy_nt_avx;
+    }
+    /* sse2 is part of x86_64 baseline */
+    *name = "sse2";
+    return ucc_mc_cpu_memcpy_nt_sse2;
+#else
+    *name = "memcpy";
+    return ucc_mc_cpu_memcpy_std;
+#endif
+}
+
+typedef struct ucc_mc_cpu_memcpy_part {
+    void       *dst;
+    const void *src;
+    size_t      len;
+} ucc_mc_cpu_memcpy_part_t;
+
+#define UCC_MC_CPU_MEMCPY_MAX_THREADS 64
+
+typedef struct ucc_mc_cpu_memcpy_worker {
+    pthread_t                 thread;
+    ucc_mc_cpu_memcpy_pool_t *pool;
+    unsigned                  idx; /*< part copied by the worker */
+} ucc_mc_cpu_memcpy_worker_t;
+
+/* Helper threads wait on the start condition for a new job id, copy their
+   part and the last one to finish signals the done condition. Only one
+   copy is in flight at a time, the issuer holds the pool lock. */
+struct ucc_mc_cpu_memcpy_pool {
+    pthread_mutex_t            lock;
+    pthread_mutex_t            mutex; /*< protects the job state below */
+    pthread_cond_t             start;
+    pthread_cond_t             done;
+    uint64_t                   job_id;
+    unsigned                   n_pending;
+    int                        stop;
+    ucc_mc_cpu_memcpy_fn_t     copy;
+    ucc_mc_cpu_memcpy_part_t   parts[UCC_MC_CPU_MEMCPY_MAX_THREADS];
+    unsigned                   n_workers;
+    ucc_mc_cpu_memcpy_worker_t workers[UCC_MC_CPU_MEMCPY_MAX_THREADS - 1];
+};
+
+static void *ucc_mc_cpu_memcpy_worker(void *arg)
+{
+    ucc_mc_cpu_memcpy_worker_t *worker = arg;
+    ucc_mc_cpu_memcpy_pool_t   *pool   = worker->pool;
+    uint64_t                    job_id = 0;
+    ucc_mc_cpu_memcpy_part_t    part;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->stop && pool->job_id == job_id) {
+            pthread_cond_wait(&pool->start, &pool->mutex);
+        }
+        if (pool->stop) {
+            break;
+        }
+        job_id = pool->job_id;
+        part   = pool->parts[worker->idx];
+        pthread_mutex_unlock(&pool->mutex);
+        if (part.len) {
+            pool->copy(part.dst, part.src, part.len);
+        }
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->n_pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+ucc_status_t ucc_mc_cpu_memcpy_pool_create(unsigned                   n_threads,
+                                           ucc_mc_cpu_memcpy_fn_t     copy,
+                                           ucc_mc_cpu_memcpy_pool_t **pool_p)
+{
+    ucc_mc_cpu_memcpy_pool_t   *pool;
+    ucc_mc_cpu_memcpy_worker_t *worker;
+
+    pool = ucc_calloc(1, sizeof(*pool), "mc_cpu_memcpy_pool");
+    if (!pool) {
+        return UCC_ERR_NO_MEMORY;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->copy = copy;
+    n_threads  = ucc_min(n_threads, UCC_MC_CPU_MEMCPY_MAX_THREADS);
+    while (pool->n_workers < n_threads - 1) {
+        worker       = &pool->workers[pool->n_workers];
+        worker->pool = pool;
+        worker->idx  = pool->n_workers + 1;
+        if (pthread_create(&worker->thread, NULL, ucc_mc_cpu_memcpy_worker,
+                           worker)) {
+            break;
+        }
+        pool->n_workers++;
+    }
+    if (pool->n_workers == 0) {
+        ucc_mc_cpu_memcpy_pool_destroy(pool);
+        return UCC_ERR_NO_RESOURCE;
+    }
+    *pool_p = pool;
+    return UCC_OK;
+}
+
+void ucc_mc_cpu_memcpy_pool_destroy(ucc_mc_cpu_memcpy_pool_t *pool)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+    for (i = 0; i < pool->n_workers; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->lock);
+    ucc_free(pool);
+}
+
+void ucc_mc_cpu_memcpy_mt(ucc_mc_cpu_memcpy_pool_t *pool, void *dst,
+                          const void *src, size_t len)
+{
+    unsigned n_parts = pool->n_workers + 1;
+    size_t   part_len, offset;
+    unsigned i;
+
+    if (pthread_mutex_trylock(&pool->lock)) {
+        /* helpers are busy with a copy of another thread */
+        pool->copy(dst, src, len);
+        return;
+    }
+    part_len = ucc_align_up(ucc_div_round_up(len, n_parts),
+                            UCC_CACHE_LINE_SIZE);
+    for (i = 0, offset = 0; i < n_parts; i++, offset += part_len) {
+        pool->parts[i].dst = PTR_OFFSET(dst, offset);
+        pool->parts[i].src = PTR_OFFSET(src, offset);
+        pool->parts[i].len = (offset < len) ? ucc_min(part_len, len - offset)
+                                            : 0;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    pool->job_id++;
+    pool->n_pending = pool->n_workers;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    pool->copy(pool->parts[0].dst, pool->parts[0].src, pool->parts[0].len);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->n_pending) {
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->lock);
+}
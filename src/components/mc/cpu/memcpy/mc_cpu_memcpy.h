@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_MC_CPU_MEMCPY_H_
+#define UCC_MC_CPU_MEMCPY_H_
+
+#include "utils/ucc_compiler_def.h"
+#include "ucc/api/ucc.h"
+#include <stddef.h>
+
+typedef void (*ucc_mc_cpu_memcpy_fn_t)(void *dst, const void *src,
+                                       size_t len);
+
+/* Returns the best non-temporal copy kernel supported by the cpu the
+   process runs on, falls back to plain memcpy if streaming stores are not
+   available */
+ucc_mc_cpu_memcpy_fn_t ucc_mc_cpu_memcpy_nt_select(const char **name);
+
+/* Persistent helper threads for large copies, created at mc init */
+typedef struct ucc_mc_cpu_memcpy_pool ucc_mc_cpu_memcpy_pool_t;
+
+/* Starts n_threads - 1 helper threads copying with the given kernel, the
+   pool may have fewer helpers if some of them can't be started */
+ucc_status_t ucc_mc_cpu_memcpy_pool_create(unsigned                   n_threads,
+                                           ucc_mc_cpu_memcpy_fn_t     copy,
+                                           ucc_mc_cpu_memcpy_pool_t **pool);
+
+void ucc_mc_cpu_memcpy_pool_destroy(ucc_mc_cpu_memcpy_pool_t *pool);
+
+/* Splits the copy in parts of cache line aligned size between the calling
+   thread and the helpers of the pool. If the helpers are busy with a copy
+   of another thread the whole copy is done by the calling thread. */
+void ucc_mc_cpu_memcpy_mt(ucc_mc_cpu_memcpy_pool_t *pool, void *dst,
+                          const void *src, size_t len);
+
+/* Copies a range of the packed representation of user defined datatype
+   elements to (pack) or from (unpack) contiguous buffer */
+ucc_status_t ucc_mc_cpu_pack(void *dst, const void *src,
+                             const ucc_dt_userdefined_t *dt, size_t offset,
+                             size_t len);
+
+ucc_status_t ucc_mc_cpu_unpack(void *dst, const void *src,
+                               const ucc_dt_userdefined_t *dt, size_t offset,
+                               size_t len);
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "memcpy/mc_cpu_memcpy.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include <string.h>
+
+/* Walks bytes [offset, offset + len) of the packed representation of the
+   elements starting at elems and copies every contiguous piece from or to
+   packed. Callers pass fragments of a message in increasing offsets, so
+   only the first element of a fragment needs the block lookup. */
+static inline void ucc_mc_cpu_dt_copy(void *packed, void *elems,
+                                      const ucc_dt_userdefined_t *dt,
+                                      size_t offset, size_t len, int pack)
+{
+    size_t   esize = ucc_dt_userdefined_size(dt);
+    size_t   elem, pos, n;
+    uint64_t b;
+    void    *e;
+
+    if (ucc_unlikely(esize == 0)) {
+        return;
+    }
+    if (dt->n_blocks == 1 && dt->blocks[0].length == dt->extent) {
+        /* contiguous elements */
+        e = PTR_OFFSET(elems, dt->blocks[0].offset + offset);
+        if (pack) {
+            memcpy(packed, e, len);
+        } else {
+            memcpy(e, packed, len);
+        }
+        return;
+    }
+    elem = offset / esize;
+    pos  = offset % esize;
+    for (b = 0; pos >= dt->blocks[b].length; b++) {
+        pos -= dt->blocks[b].length;
+    }
+    while (len > 0) {
+        e = PTR_OFFSET(elems, elem * dt->extent + dt->blocks[b].offset + pos);
+        n = ucc_min(dt->blocks[b].length - pos, len);
+        if (pack) {
+            memcpy(packed, e, n);
+        } else {
+            memcpy(e, packed, n);
+        }
+        packed = PTR_OFFSET(packed, n);
+        len   -= n;
+        pos    = 0;
+        if (++b == dt->n_blocks) {
+            b = 0;
+            elem++;
+        }
+    }
+}
+
+ucc_status_t ucc_mc_cpu_pack(void *dst, const void *src,
+                             const ucc_dt_userdefined_t *dt, size_t offset,
+                             size_t len)
+{
+    ucc_mc_cpu_dt_copy(dst, (void *)src, dt, offset, len, 1);
+    return UCC_OK;
+}
+
+ucc_status_t ucc_mc_cpu_unpack(void *dst, const void *src,
+                               const ucc_dt_userdefined_t *dt, size_t offset,
+                               size_t len)
+{
+    ucc_mc_cpu_dt_copy((void *)src, dst, dt, offset, len, 0);
+    return UCC_OK;
+}
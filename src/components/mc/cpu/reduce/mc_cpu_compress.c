@@ -0,0 +1,235 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+#include "mc_cpu.h"
+#include "reduce/mc_cpu_reduce.h"
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* Conversion between fp32 and the 16 bit wire formats used by lossy
+   allreduce compression. Both directions round to nearest even, values
+   which do not fit fp16 saturate to infinity, NaNs stay NaNs. */
+
+static inline uint32_t ucc_mc_cpu_f32_bits(float f)
+{
+    uint32_t u;
+
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float ucc_mc_cpu_bits_f32(uint32_t u)
+{
+    float f;
+
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static inline uint16_t ucc_mc_cpu_f32_to_bf16(float f)
+{
+    uint32_t u = ucc_mc_cpu_f32_bits(f);
+
+    if ((u & 0x7fffffff) > 0x7f800000) {
+        /* keep NaN quiet, truncation could turn it into infinity */
+        return (uint16_t)((u >> 16) | 0x40);
+    }
+    return (uint16_t)((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+}
+
+static inline float ucc_mc_cpu_bf16_to_f32(uint16_t h)
+{
+    return ucc_mc_cpu_bits_f32((uint32_t)h << 16);
+}
+
+static inline uint16_t ucc_mc_cpu_f32_to_fp16(float f)
+{
+    uint32_t u    = ucc_mc_cpu_f32_bits(f);
+    uint32_t sign = (u >> 16) & 0x8000;
+    uint32_t o;
+
+    u &= 0x7fffffff;
+    if (u >= (143u << 23)) {
+        /* >= 2^16: Inf or NaN */
+        o = (u > 0x7f800000) ? 0x7e00 : 0x7c00;
+    } else if (u < (113u << 23)) {
+        /* fp16 subnormal or zero: let the fpu do the rounding by adding
+           0.5, whose ulp equals the smallest fp16 subnormal */
+        o = ucc_mc_cpu_f32_bits(ucc_mc_cpu_bits_f32(u) + 0.5f) -
+            0x3f000000;
+    } else {
+        /* rebias exponent and round mantissa to 10 bits, carry into the
+           exponent produces Inf for values above fp16 max */
+        o = (u + 0xc8000fff + ((u >> 13) & 1)) >> 13;
+    }
+    return (uint16_t)(o | sign);
+}
+
+static inline float ucc_mc_cpu_fp16_to_f32(uint16_t h)
+{
+    uint32_t u   = ((uint32_t)h & 0x7fff) << 13;
+    uint32_t exp = u & (0x7c00 << 13);
+
+    u += (127 - 15) << 23;
+    if (exp == (0x7c00 << 13)) {
+        /* Inf/NaN */
+        u += (128 - 16) << 23;
+    } else if (exp == 0) {
+        /* zero/subnormal: renormalize */
+        u = ucc_mc_cpu_f32_bits(ucc_mc_cpu_bits_f32(u + (1 << 23)) -
+                                ucc_mc_cpu_bits_f32(113u << 23));
+    }
+    return ucc_mc_cpu_bits_f32(u | (((uint32_t)h & 0x8000) << 16));
+}
+
+#define COMPRESS_LOOP(_to, _from, _dst, _src, _err, _start, _count)            \
+    do {                                                                       \
+        size_t _i;                                                             \
+        float  _v;                                                             \
+        if (_err) {                                                            \
+            for (_i = _start; _i < _count; _i++) {                             \
+                _v       = _src[_i] + _err[_i];                                \
+                _dst[_i] = _to(_v);                                            \
+                _err[_i] = _v - _from(_dst[_i]);                               \
+            }                                                                  \
+        } else {                                                               \
+            for (_i = _start; _i < _count; _i++) {                             \
+                _dst[_i] = _to(_src[_i]);                                      \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+/* Walks dst once, all src2 vectors are accumulated per element so that
+   dst may alias src1 */
+#define DECOMPRESS_LOOP(_from, _dst, _src1, _src2, _n, _sc, _start, _count)    \
+    do {                                                                       \
+        size_t _i, _j;                                                         \
+        float  _acc;                                                           \
+        for (_i = _start; _i < _count; _i++) {                                 \
+            _acc = _src1 ? _src1[_i] : 0.0f;                                   \
+            for (_j = 0; _j < _n; _j++) {                                      \
+                _acc += _from(_src2[_j * _sc + _i]);                           \
+            }                                                                  \
+            _dst[_i] = _acc;                                                   \
+        }                                                                      \
+    } while (0)
+
+#if defined(__x86_64__)
+__attribute__((target("avx,f16c")))
+static size_t ucc_mc_cpu_compress_fp16_f16c(uint16_t *dst, const float *src,
+                                             float *err, size_t count)
+{
+    size_t  i;
+    __m256  v;
+    __m128i h;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        v = _mm256_loadu_ps(src + i);
+        if (err) {
+            v = _mm256_add_ps(v, _mm256_loadu_ps(err + i));
+        }
+        h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(dst + i), h);
+        if (err) {
+            _mm256_storeu_ps(err + i, _mm256_sub_ps(v, _mm256_cvtph_ps(h)));
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx,f16c")))
+static size_t ucc_mc_cpu_decompress_fp16_f16c(float *dst, const float *src1,
+                                               const uint16_t *src2,
+                                               size_t n_vectors, size_t sc,
+                                               size_t count)
+{
+    size_t i, j;
+    __m256 acc;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        acc = src1 ? _mm256_loadu_ps(src1 + i) : _mm256_setzero_ps();
+        for (j = 0; j < n_vectors; j++) {
+            acc = _mm256_add_ps(acc, _mm256_cvtph_ps(_mm_loadu_si128(
+                                         (const __m128i *)(src2 + j * sc + i))));
+        }
+        _mm256_storeu_ps(dst + i, acc);
+    }
+    return i;
+}
+
+static inline int ucc_mc_cpu_have_f16c(void)
+{
+    return __builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx");
+}
+#endif
+
+ucc_status_t ucc_mc_cpu_compress(void *dst, const void *src, float *err,
+                                 size_t count, ucc_datatype_t dst_dt)
+{
+    const float *s     = (const float *)src;
+    uint16_t    *d     = (uint16_t *)dst;
+    size_t       start = 0;
+
+    switch (dst_dt) {
+    case UCC_DT_BFLOAT16:
+        COMPRESS_LOOP(ucc_mc_cpu_f32_to_bf16, ucc_mc_cpu_bf16_to_f32, d, s,
+                      err, start, count);
+        break;
+    case UCC_DT_FLOAT16:
+#if defined(__x86_64__)
+        if (ucc_mc_cpu_have_f16c()) {
+            start = ucc_mc_cpu_compress_fp16_f16c(d, s, err, count);
+        }
+#endif
+        COMPRESS_LOOP(ucc_mc_cpu_f32_to_fp16, ucc_mc_cpu_fp16_to_f32, d, s,
+                      err, start, count);
+        break;
+    default:
+        mc_error(&ucc_mc_cpu.super, "unsupported compression dtype %s",
+                 ucc_datatype_str(dst_dt));
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_mc_cpu_reduce_multi_decompress(const void *src1,
+                                                const void *src2, void *dst,
+                                                size_t n_vectors, size_t count,
+                                                size_t stride,
+                                                ucc_datatype_t src2_dt)
+{
+    const float    *s1    = (const float *)src1;
+    const uint16_t *s2    = (const uint16_t *)src2;
+    float          *d     = (float *)dst;
+    size_t          sc    = stride / sizeof(uint16_t);
+    size_t          start = 0;
+
+    ucc_assert((stride % sizeof(uint16_t)) == 0);
+    switch (src2_dt) {
+    case UCC_DT_BFLOAT16:
+        DECOMPRESS_LOOP(ucc_mc_cpu_bf16_to_f32, d, s1, s2, n_vectors, sc,
+                        start, count);
+        break;
+    case UCC_DT_FLOAT16:
+#if defined(__x86_64__)
+        if (ucc_mc_cpu_have_f16c()) {
+            start = ucc_mc_cpu_decompress_fp16_f16c(d, s1, s2, n_vectors, sc,
+                                                    count);
+        }
+#endif
+        DECOMPRESS_LOOP(ucc_mc_cpu_fp16_to_f32, d, s1, s2, n_vectors, sc,
+                        start, count);
+        break;
+    default:
+        mc_error(&ucc_mc_cpu.super, "unsupported compression dtype %s",
+                 ucc_datatype_str(src2_dt));
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return UCC_OK;
+}
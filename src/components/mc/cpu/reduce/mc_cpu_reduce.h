@@ -176,4 +176,36 @@ REDUCE_FN_DECLARE(uint32);
 REDUCE_FN_DECLARE(uint64);
 REDUCE_FN_DECLARE(float);
 REDUCE_FN_DECLARE(double);
+
+/* MAXLOC/MINLOC reductions of value-index pair datatypes */
+ucc_status_t ucc_mc_cpu_reduce_multi_loc(const void *src1, const void *src2,
+                                         void *dst, size_t n_vectors,
+                                         size_t count, size_t stride,
+                                         ucc_datatype_t dt,
+                                         ucc_reduction_op_t op);
+
+/* fp32 <-> fp16/bf16 wire format conversion */
+ucc_status_t ucc_mc_cpu_compress(void *dst, const void *src, float *err,
+                                 size_t count, ucc_datatype_t dst_dt);
+
+ucc_status_t ucc_mc_cpu_reduce_multi_decompress(const void *src1,
+                                                const void *src2, void *dst,
+                                                size_t n_vectors, size_t count,
+                                                size_t stride,
+                                                ucc_datatype_t src2_dt);
+
+/* sum of sparse (index, value) vectors */
+ucc_status_t ucc_mc_cpu_reduce_sparse(const uint64_t *idx1, const void *val1,
+                                      size_t n1, const uint64_t *idx2,
+                                      const void *val2, size_t n2,
+                                      uint64_t *dst_idx, void *dst_val,
+                                      size_t *dst_n, ucc_datatype_t dt);
+
+ucc_status_t ucc_mc_cpu_sparse_to_dense(void *dense, const uint64_t *idx,
+                                        const void *val, size_t n,
+                                        ucc_datatype_t dt);
+
+ucc_status_t ucc_mc_cpu_dense_to_sparse(uint64_t *idx, void *val, size_t *n,
+                                        size_t max_n, const void *dense,
+                                        size_t count, ucc_datatype_t dt);
 #endif
@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+#include "mc_cpu.h"
+#include "reduce/mc_cpu_reduce.h"
+
+/* MAXLOC/MINLOC select the pair with the larger/smaller value, on equal
+   values the pair with the smaller index wins. */
+#define DO_OP_MAXLOC_SEL(_a, _b)                                               \
+    (((_b).v > (_a).v) | (((_b).v == (_a).v) & ((_b).i < (_a).i)))
+#define DO_OP_MINLOC_SEL(_a, _b)                                               \
+    (((_b).v < (_a).v) | (((_b).v == (_a).v) & ((_b).i < (_a).i)))
+
+#define DO_DT_REDUCE_LOC_WITH_OP(_type, s1, s2, d, size, count, stride, _SEL)  \
+    do {                                                                       \
+        size_t       stride_count = stride / sizeof(_type);                    \
+        const _type *src          = s1;                                        \
+        const _type *s;                                                        \
+        _type        a, b;                                                     \
+        size_t       i, j;                                                     \
+        int          sel;                                                      \
+        for (j = 0; j < size; j++) {                                           \
+            s = &s2[j * stride_count];                                         \
+            for (i = 0; i < count; i++) {                                      \
+                a      = src[i];                                               \
+                b      = s[i];                                                 \
+                sel    = _SEL(a, b);                                           \
+                d[i].v = sel ? b.v : a.v;                                      \
+                d[i].i = sel ? b.i : a.i;                                      \
+            }                                                                  \
+            src = d;                                                           \
+        }                                                                      \
+    } while (0)
+
+#define REDUCE_LOC_FN_DEFINE(_name, _vtype)                                    \
+    typedef struct {                                                           \
+        _vtype  v;                                                             \
+        int32_t i;                                                             \
+    } ucc_mc_cpu_##_name##_t;                                                  \
+                                                                               \
+    static ucc_status_t ucc_mc_cpu_reduce_multi_##_name(                       \
+        const void *src1, const void *src2, void *dst, size_t n_vectors,       \
+        size_t count, size_t stride, ucc_reduction_op_t op)                    \
+    {                                                                          \
+        const ucc_mc_cpu_##_name##_t *s1 = src1;                               \
+        const ucc_mc_cpu_##_name##_t *s2 = src2;                               \
+        ucc_mc_cpu_##_name##_t       *d  = dst;                                \
+                                                                               \
+        ucc_assert((stride % sizeof(ucc_mc_cpu_##_name##_t)) == 0);            \
+        switch (op) {                                                          \
+        case UCC_OP_MAXLOC:                                                    \
+            DO_DT_REDUCE_LOC_WITH_OP(ucc_mc_cpu_##_name##_t, s1, s2, d,        \
+                                     n_vectors, count, stride,                 \
+                                     DO_OP_MAXLOC_SEL);                        \
+            break;                                                             \
+        case UCC_OP_MINLOC:                                                    \
+            DO_DT_REDUCE_LOC_WITH_OP(ucc_mc_cpu_##_name##_t, s1, s2, d,        \
+                                     n_vectors, count, stride,                 \
+                                     DO_OP_MINLOC_SEL);                        \
+            break;                                                             \
+        default:                                                               \
+            mc_error(&ucc_mc_cpu.super,                                        \
+                     "value-index dtype does not support "                     \
+                     "requested reduce op: %d",                                \
+                     op);                                                      \
+            return UCC_ERR_NOT_SUPPORTED;                                      \
+        }                                                                      \
+        return UCC_OK;                                                         \
+    }
+
+REDUCE_LOC_FN_DEFINE(float_int, float)
+REDUCE_LOC_FN_DEFINE(double_int, double)
+REDUCE_LOC_FN_DEFINE(short_int, int16_t)
+REDUCE_LOC_FN_DEFINE(2int, int32_t)
+REDUCE_LOC_FN_DEFINE(long_int, int64_t)
+
+ucc_status_t ucc_mc_cpu_reduce_multi_loc(const void *src1, const void *src2,
+                                         void *dst, size_t n_vectors,
+                                         size_t count, size_t stride,
+                                         ucc_datatype_t dt,
+                                         ucc_reduction_op_t op)
+{
+    switch (dt) {
+    case UCC_DT_FLOAT32_INT32:
+        return ucc_mc_cpu_reduce_multi_float_int(src1, src2, dst, n_vectors,
+                                                 count, stride, op);
+    case UCC_DT_FLOAT64_INT32:
+        return ucc_mc_cpu_reduce_multi_double_int(src1, src2, dst, n_vectors,
+                                                  count, stride, op);
+    case UCC_DT_INT16_INT32:
+        return ucc_mc_cpu_reduce_multi_short_int(src1, src2, dst, n_vectors,
+                                                 count, stride, op);
+    case UCC_DT_INT32_INT32:
+        return ucc_mc_cpu_reduce_multi_2int(src1, src2, dst, n_vectors, count,
+                                            stride, op);
+    case UCC_DT_INT64_INT32:
+        return ucc_mc_cpu_reduce_multi_long_int(src1, src2, dst, n_vectors,
+                                                count, stride, op);
+    default:
+        mc_error(&ucc_mc_cpu.super, "unsupported value-index type (%d)", dt);
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+#include "mc_cpu.h"
+#include "reduce/mc_cpu_reduce.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Merge of two sorted index lists. The loop body has no data dependent
+   branches: both cursors advance by comparison results and values of the
+   list which doesn't own the current index are masked out, so the compiler
+   emits conditional moves/blends instead of mispredicted jumps. */
+#define SPARSE_MERGE(_type, _i1, _v1, _n1, _i2, _v2, _n2, _di, _dv, _dn)       \
+    do {                                                                       \
+        const _type *_a = (const _type *)(_v1);                                \
+        const _type *_b = (const _type *)(_v2);                                \
+        _type       *_d = (_type *)(_dv);                                      \
+        size_t       _p = 0, _q = 0, _n = 0;                                   \
+        uint64_t     _x, _y;                                                   \
+        int          _le, _ge;                                                 \
+        while (_p < _n1 && _q < _n2) {                                         \
+            _x      = _i1[_p];                                                 \
+            _y      = _i2[_q];                                                 \
+            _le     = _x <= _y;                                                \
+            _ge     = _x >= _y;                                                \
+            _di[_n] = _le ? _x : _y;                                           \
+            _d[_n]  = (_le ? _a[_p] : (_type)0) + (_ge ? _b[_q] : (_type)0);   \
+            _p += _le;                                                         \
+            _q += _ge;                                                         \
+            _n++;                                                              \
+        }                                                                      \
+        memcpy(_di + _n, _i1 + _p, (_n1 - _p) * sizeof(uint64_t));             \
+        memcpy(_d + _n, _a + _p, (_n1 - _p) * sizeof(_type));                  \
+        _n += _n1 - _p;                                                        \
+        memcpy(_di + _n, _i2 + _q, (_n2 - _q) * sizeof(uint64_t));             \
+        memcpy(_d + _n, _b + _q, (_n2 - _q) * sizeof(_type));                  \
+        *(_dn) = _n + _n2 - _q;                                                \
+    } while (0)
+
+#define SPARSE_TO_DENSE(_type, _dense, _idx, _val, _n)                         \
+    do {                                                                       \
+        _type       *_d = (_type *)(_dense);                                   \
+        const _type *_v = (const _type *)(_val);                               \
+        size_t       _i;                                                       \
+        for (_i = 0; _i < _n; _i++) {                                          \
+            _d[_idx[_i]] += _v[_i];                                            \
+        }                                                                      \
+    } while (0)
+
+/* Stream compaction: every element is stored unconditionally at the current
+   output position, which only advances for nonzeros. Once the output is
+   full the remainder is only scanned for an overflow. */
+#define DENSE_TO_SPARSE(_type, _idx, _val, _n, _max_n, _dense, _count)         \
+    do {                                                                       \
+        const _type *_d = (const _type *)(_dense);                             \
+        _type       *_v = (_type *)(_val);                                     \
+        size_t       _i, _k = 0;                                               \
+        for (_i = 0; _i < _count && _k < _max_n; _i++) {                       \
+            _idx[_k] = _i;                                                     \
+            _v[_k]   = _d[_i];                                                 \
+            _k += (_d[_i] != 0);                                               \
+        }                                                                      \
+        *(_n) = _k;                                                            \
+        for (; _i < _count; _i++) {                                            \
+            if (_d[_i] != 0) {                                                 \
+                return UCC_ERR_NO_RESOURCE;                                    \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+#define SPARSE_DT_SWITCH(_dt, _macro, ...)                                     \
+    do {                                                                       \
+        switch (_dt) {                                                         \
+        case UCC_DT_INT32:                                                     \
+            _macro(int32_t, __VA_ARGS__);                                      \
+            break;                                                             \
+        case UCC_DT_UINT32:                                                    \
+            _macro(uint32_t, __VA_ARGS__);                                     \
+            break;                                                             \
+        case UCC_DT_INT64:                                                     \
+            _macro(int64_t, __VA_ARGS__);                                      \
+            break;                                                             \
+        case UCC_DT_UINT64:                                                    \
+            _macro(uint64_t, __VA_ARGS__);                                     \
+            break;                                                             \
+        case UCC_DT_FLOAT32:                                                   \
+            _macro(float, __VA_ARGS__);                                        \
+            break;                                                             \
+        case UCC_DT_FLOAT64:                                                   \
+            _macro(double, __VA_ARGS__);                                       \
+            break;                                                             \
+        default:                                                               \
+            mc_error(&ucc_mc_cpu.super, "unsupported sparse dtype %s",         \
+                     ucc_datatype_str(_dt));                                   \
+            return UCC_ERR_NOT_SUPPORTED;                                      \
+        }                                                                      \
+    } while (0)
+
+ucc_status_t ucc_mc_cpu_reduce_sparse(const uint64_t *idx1, const void *val1,
+                                      size_t n1, const uint64_t *idx2,
+                                      const void *val2, size_t n2,
+                                      uint64_t *dst_idx, void *dst_val,
+                                      size_t *dst_n, ucc_datatype_t dt)
+{
+    SPARSE_DT_SWITCH(dt, SPARSE_MERGE, idx1, val1, n1, idx2, val2, n2,
+                     dst_idx, dst_val, dst_n);
+    return UCC_OK;
+}
+
+ucc_status_t ucc_mc_cpu_sparse_to_dense(void *dense, const uint64_t *idx,
+                                        const void *val, size_t n,
+                                        ucc_datatype_t dt)
+{
+    SPARSE_DT_SWITCH(dt, SPARSE_TO_DENSE, dense, idx, val, n);
+    return UCC_OK;
+}
+
+ucc_status_t ucc_mc_cpu_dense_to_sparse(uint64_t *idx, void *val, size_t *n,
+                                        size_t max_n, const void *dense,
+                                        size_t count, ucc_datatype_t dt)
+{
+    SPARSE_DT_SWITCH(dt, DENSE_TO_SPARSE, idx, val, n, max_n, dense, count);
+    return UCC_OK;
+}
@@ -14,21 +14,27 @@
 #define ncclDataTypeUnsupported (ncclNumTypes + 1)
 
 ncclDataType_t ucc_to_nccl_dtype[] = {
-    [UCC_DT_INT8]        = (ncclDataType_t)ncclInt8,
-    [UCC_DT_INT16]       = (ncclDataType_t)ncclDataTypeUnsupported,
-    [UCC_DT_INT32]       = (ncclDataType_t)ncclInt32,
-    [UCC_DT_INT64]       = (ncclDataType_t)ncclInt64,
-    [UCC_DT_INT128]      = (ncclDataType_t)ncclDataTypeUnsupported,
-    [UCC_DT_UINT8]       = (ncclDataType_t)ncclUint8,
-    [UCC_DT_UINT16]      = (ncclDataType_t)ncclDataTypeUnsupported,
-    [UCC_DT_UINT32]      = (ncclDataType_t)ncclUint32,
-    [UCC_DT_UINT64]      = (ncclDataType_t)ncclUint64,
-    [UCC_DT_UINT128]     = (ncclDataType_t)ncclDataTypeUnsupported,
-    [UCC_DT_FLOAT16]     = (ncclDataType_t)ncclFloat16,
-    [UCC_DT_FLOAT32]     = (ncclDataType_t)ncclFloat32,
-    [UCC_DT_FLOAT64]     = (ncclDataType_t)ncclFloat64,
-    [UCC_DT_USERDEFINED] = (ncclDataType_t)ncclDataTypeUnsupported,
-    [UCC_DT_OPAQUE]      = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_INT8]          = (ncclDataType_t)ncclInt8,
+    [UCC_DT_INT16]         = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_INT32]         = (ncclDataType_t)ncclInt32,
+    [UCC_DT_INT64]         = (ncclDataType_t)ncclInt64,
+    [UCC_DT_INT128]        = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_UINT8]         = (ncclDataType_t)ncclUint8,
+    [UCC_DT_UINT16]        = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_UINT32]        = (ncclDataType_t)ncclUint32,
+    [UCC_DT_UINT64]        = (ncclDataType_t)ncclUint64,
+    [UCC_DT_UINT128]       = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_FLOAT16]       = (ncclDataType_t)ncclFloat16,
+    [UCC_DT_FLOAT32]       = (ncclDataType_t)ncclFloat32,
+    [UCC_DT_FLOAT64]       = (ncclDataType_t)ncclFloat64,
+    [UCC_DT_BFLOAT16]      = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_FLOAT32_INT32] = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_FLOAT64_INT32] = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_INT16_INT32]   = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_INT32_INT32]   = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_INT64_INT32]   = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_USERDEFINED]   = (ncclDataType_t)ncclDataTypeUnsupported,
+    [UCC_DT_OPAQUE]        = (ncclDataType_t)ncclDataTypeUnsupported,
 };
 
 ncclRedOp_t ucc_to_nccl_reduce_op[] = {
@@ -127,6 +127,7 @@ static ucc_status_t ucc_tl_nccl_coll_finalize(ucc_coll_task_t *coll_task)
     if (task->completed) {
         ucc_mc_ee_destroy_event(task->completed, UCC_EE_CUDA_STREAM);
     }
+    ucc_event_manager_cleanup(&task->super.em);
     ucc_mpool_put(task);
     return status;
 }
@@ -225,6 +226,7 @@ free_event:
         cudaEventDestroy(task->completed);
     }
 free_task:
+    ucc_event_manager_cleanup(&task->super.em);
     ucc_mpool_put(task);
     return status;
 }
@@ -66,6 +66,12 @@ typedef struct ucc_tl_iface {
     ucc_base_coll_iface_t          coll;
     ucc_tl_service_coll_t          scoll;
     ucc_base_coll_alg_info_t *     alg_info[UCC_COLL_TYPE_NUM];
+    /* Maps alg_info id to the init fn, optional. Used by CLs that
+       select between the algorithms of a TL at runtime. */
+    ucc_status_t (*alg_id_to_init)(int alg_id, const char *alg_id_str,
+                                   ucc_coll_type_t          coll_type,
+                                   ucc_memory_type_t        mem_type,
+                                   ucc_base_coll_init_fn_t *init);
 } ucc_tl_iface_t;
 
 typedef struct ucc_tl_lib {
@@ -36,6 +36,7 @@ ucc_status_t ucc_tl_ucp_allgather_knomial_progress(ucc_coll_task_t *coll_task)
     ucc_rank_t             size       = team->size;
     ucc_rank_t             rank       = team->rank;
     void                  *sbuf;
+    ucc_status_t           status;
     ptrdiff_t              peer_seg_offset, local_seg_offset;
     ucc_rank_t             peer, step_radix, peer_seg_index, local_seg_index;
     ucc_kn_radix_t         loop_step;
@@ -54,12 +55,12 @@ UCC_KN_PHASE_EXTRA:
             SAVE_STATE(UCC_KN_PHASE_EXTRA);
             return task->super.super.status;
         }
-        goto out;
+        goto complete;
     }
     while (!ucc_knomial_pattern_loop_done_backward(p)) {
         step_radix       = ucc_sra_kn_compute_step_radix(rank, size, p);
         block_count      = ucc_sra_kn_compute_block_count(count, rank, p);
-        local_seg_index  = ucc_sra_kn_compute_seg_index(rank, p->radix_pow, p);
+        local_seg_index  = ucc_sra_kn_get_seg_index(p, rank, 0);
         local_seg_count  = ucc_sra_kn_compute_seg_size(block_count, step_radix,
                                                       local_seg_index);
         local_seg_offset = ucc_sra_kn_compute_seg_offset(
@@ -82,8 +83,7 @@ UCC_KN_PHASE_EXTRA:
             peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, loop_step);
             if (peer == UCC_KN_PEER_NULL)
                 continue;
-            peer_seg_index =
-                ucc_sra_kn_compute_seg_index(peer, p->radix_pow, p);
+            peer_seg_index = ucc_sra_kn_get_seg_index(p, peer, loop_step);
             peer_seg_count = ucc_sra_kn_compute_seg_size(
                 block_count, step_radix, peer_seg_index);
             peer_seg_offset = ucc_sra_kn_compute_seg_offset(
@@ -108,7 +108,7 @@ UCC_KN_PHASE_EXTRA:
                                          mem_type, peer, team, task),
                       task, out);
     } else {
-        goto out;
+        goto complete;
     }
 UCC_KN_PHASE_PROXY:
     if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
@@ -116,6 +116,17 @@ UCC_KN_PHASE_PROXY:
         return task->super.super.status;
     }
 
+complete:
+    if (task->allgather_kn.decompress_dst) {
+        status = ucc_mc_reduce_multi_decompress(
+            NULL, args->dst.info.buffer, task->allgather_kn.decompress_dst, 1,
+            count, 0, dt, mem_type);
+        if (UCC_OK != status) {
+            tl_error(UCC_TASK_LIB(task), "failed to decompress data");
+            task->super.super.status = status;
+            return status;
+        }
+    }
 out:
     task->super.super.status = UCC_OK;
     UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_kn_done", 0);
@@ -140,9 +151,10 @@ ucc_status_t ucc_tl_ucp_allgather_knomial_start(ucc_coll_task_t *coll_task)
     ucc_assert(args->src.info.mem_type == args->dst.info.mem_type);
 
     ucc_knomial_pattern_init_backward(size, rank, radix, &task->allgather_kn.p);
-    offset = ucc_sra_kn_get_offset(args->dst.info.count,
-                                   ucc_dt_size(args->dst.info.datatype), rank,
-                                   size, radix);
+    ucc_tl_ucp_kn_pattern_set_table(team, size, rank, &task->allgather_kn.p);
+    offset = ucc_sra_kn_pattern_get_offset(args->dst.info.count,
+                                           ucc_dt_size(args->dst.info.datatype),
+                                           rank, size, &task->allgather_kn.p);
     if (!UCC_IS_INPLACE(*args)) {
         status = ucc_mc_memcpy(
             PTR_OFFSET(args->dst.info.buffer, offset), args->src.info.buffer,
@@ -174,6 +186,7 @@ ucc_status_t ucc_tl_ucp_allgather_knomial_init_r(
     task->super.post     = ucc_tl_ucp_allgather_knomial_start;
     task->super.progress = ucc_tl_ucp_allgather_knomial_progress;
     ucc_knomial_pattern_init_backward(size, rank, radix, &task->allgather_kn.p);
+    task->allgather_kn.decompress_dst = NULL;
 
     *task_h              = &task->super;
     return UCC_OK;
@@ -187,6 +200,9 @@ ucc_status_t ucc_tl_ucp_allgather_knomial_init(ucc_base_coll_args_t *coll_args,
     ucc_rank_t         size    = tl_team->size;
     ucc_kn_radix_t     radix;
 
-    radix = ucc_min(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.allgather_kn_radix, size);
+    radix = ucc_tl_ucp_kn_radix(tl_team, tl_team->cfg.allgather_kn_radix,
+                                UCC_KN_PATTERN_SCATTER, size,
+                                coll_args->args.dst.info.count *
+                                ucc_dt_size(coll_args->args.dst.info.datatype));
     return ucc_tl_ucp_allgather_knomial_init_r(coll_args, team, task_h, radix);
 }
@@ -39,6 +39,11 @@ ucc_status_t ucc_tl_ucp_allreduce_knomial_init(ucc_base_coll_args_t *coll_args,
     ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
     ucc_tl_ucp_task_t *task;
     ucc_status_t       status;
+
+    if (UCC_IS_PARTITIONED(coll_args->args)) {
+        /* partitions are fragments of the pipelined SRA schedule */
+        return ucc_tl_ucp_allreduce_sra_knomial_init(coll_args, team, task_h);
+    }
     ALLREDUCE_TASK_CHECK(coll_args->args, tl_team);
     task                 = ucc_tl_ucp_init_task(coll_args, team);
     *task_h              = &task->super;
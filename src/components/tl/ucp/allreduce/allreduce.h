@@ -8,6 +8,7 @@
 #define ALLREDUCE_H_
 #include "../tl_ucp.h"
 #include "../tl_ucp_coll.h"
+#include "core/ucc_mc.h"
 
 enum {
     UCC_TL_UCP_ALLREDUCE_ALG_KNOMIAL,
@@ -24,9 +25,13 @@ ucc_status_t ucc_tl_ucp_allreduce_init(ucc_tl_ucp_task_t *task);
 
 #define CHECK_USERDEFINED_OP(_args, _team)                                     \
     do {                                                                       \
-        if (_args.mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) {         \
+        if ((_args.mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) &&       \
+            (UCC_OK != ucc_dt_reduce_userdefined_check(                        \
+                           &_args, _args.dst.info.datatype,                    \
+                           _args.dst.info.mem_type))) {                        \
             tl_error(UCC_TL_TEAM_LIB(_team),                                   \
-                     "userdefined reductions are not supported yet");          \
+                     "userdefined reductions are supported only for host "     \
+                     "memory and predefined datatypes");                       \
             status = UCC_ERR_NOT_SUPPORTED;                                    \
             goto out;                                                          \
         }                                                                      \
@@ -174,10 +174,9 @@ ucc_status_t ucc_tl_ucp_allreduce_knomial_start(ucc_coll_task_t *coll_task)
     task->allreduce_kn.phase = UCC_KN_PHASE_INIT;
     ucc_assert(coll_task->args.src.info.mem_type ==
                coll_task->args.dst.info.mem_type);
-    ucc_knomial_pattern_init(size, rank,
-                             ucc_min(UCC_TL_UCP_TEAM_LIB(team)->
-                                     cfg.allreduce_kn_radix, size),
+    ucc_knomial_pattern_init(size, rank, task->allreduce_kn.radix,
                              &task->allreduce_kn.p);
+    ucc_tl_ucp_kn_pattern_set_table(team, size, rank, &task->allreduce_kn.p);
     ucc_tl_ucp_task_reset(task);
     task->super.super.status = UCC_INPROGRESS;
     status = ucc_tl_ucp_allreduce_knomial_progress(&task->super);
@@ -194,33 +193,34 @@ ucc_status_t ucc_tl_ucp_allreduce_knomial_init_common(ucc_tl_ucp_task_t *task)
     ucc_datatype_t     dt        = task->super.args.dst.info.datatype;
     size_t             data_size = count * ucc_dt_size(dt);
     ucc_rank_t         size      = (ucc_rank_t)task->subset.map.ep_num;
-    ucc_kn_radix_t     radix =
-        ucc_min(TASK_LIB(task)->cfg.allreduce_kn_radix, size);
+    ucc_kn_radix_t     radix     = ucc_tl_ucp_kn_radix(
+        TASK_TEAM(task), TASK_TEAM(task)->cfg.allreduce_kn_radix,
+        UCC_KN_PATTERN_EXCHANGE, size, data_size);
     ucc_status_t       status;
 
+    task->allreduce_kn.radix = radix;
     task->super.post     = ucc_tl_ucp_allreduce_knomial_start;
     task->super.progress = ucc_tl_ucp_allreduce_knomial_progress;
     task->super.finalize = ucc_tl_ucp_allreduce_knomial_finalize;
-    status               = ucc_mc_alloc(&task->allreduce_kn.scratch_mc_header,
-                          (radix - 1) * data_size,
-                          task->super.args.dst.info.mem_type);
-    task->allreduce_kn.scratch = task->allreduce_kn.scratch_mc_header->addr;
+    status = ucc_scratch_get(&TASK_TEAM(task)->scratch,
+                             (radix - 1) * data_size,
+                             task->super.args.dst.info.mem_type,
+                             &task->allreduce_kn.scratch_buf);
     if (ucc_unlikely(status != UCC_OK)) {
         tl_error(UCC_TASK_LIB(task), "failed to allocate scratch buffer");
         return status;
     }
+    task->allreduce_kn.scratch = task->allreduce_kn.scratch_buf->addr;
     return UCC_OK;
 }
 
 ucc_status_t ucc_tl_ucp_allreduce_knomial_finalize(ucc_coll_task_t *coll_task)
 {
     ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
-    ucc_status_t st, global_st;
+    ucc_status_t st, global_st = UCC_OK;
 
-    global_st = ucc_mc_free(task->allreduce_kn.scratch_mc_header);
-    if (ucc_unlikely(global_st != UCC_OK)) {
-        tl_error(UCC_TASK_LIB(task), "failed to free scratch buffer");
-    }
+    ucc_scratch_put(&TASK_TEAM(task)->scratch,
+                    task->allreduce_kn.scratch_buf);
 
     st = ucc_tl_ucp_coll_finalize(&task->super);
     if (ucc_unlikely(st != UCC_OK)) {
@@ -37,7 +37,35 @@
    7. After the completion of reduce-scatter phase the local result (at non EXTRA
       ranks) will be located in dst buffer at offset the can be commputed by the
       routine from coll_patterns/sra_knomial.h: ucc_sra_kn_get_offset.
+   8. Float32 SUM on host memory can optionally use lossy 16 bit wire format
+      (ALLREDUCE_SRA_KN_COMPRESS): reduce-scatter sends fp16/bf16 segments and
+      accumulates them in fp32, allgather runs on the 16 bit local results
+      which are converted back to fp32 at the end, so every rank gets the
+      same values. With ALLREDUCE_SRA_KN_ERROR_FEEDBACK the quantization
+      error is kept per team and buffer and added to the next allreduce on
+      that buffer.
  */
+static inline int
+ucc_tl_ucp_allreduce_sra_kn_wire_dt(const ucc_coll_args_t *args,
+                                    ucc_tl_ucp_team_t     *team,
+                                    ucc_datatype_t        *wire_dt)
+{
+    switch (team->cfg.allreduce_sra_kn_compress) {
+    case UCC_TL_UCP_COMPRESS_FP16:
+        *wire_dt = UCC_DT_FLOAT16;
+        break;
+    case UCC_TL_UCP_COMPRESS_BF16:
+        *wire_dt = UCC_DT_BFLOAT16;
+        break;
+    default:
+        return 0;
+    }
+    return (UCC_DT_FLOAT32 == args->dst.info.datatype) &&
+           (UCC_MEMORY_TYPE_HOST == args->dst.info.mem_type) &&
+           !(args->mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) &&
+           (UCC_OP_SUM == args->reduce.predefined_op);
+}
+
 static ucc_status_t
 ucc_tl_ucp_allreduce_sra_knomial_frag_start(ucc_coll_task_t *task)
 {
@@ -60,19 +88,23 @@ ucc_tl_ucp_allreduce_sra_knomial_frag_finalize(ucc_coll_task_t *task)
 static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_setup(
     ucc_schedule_pipelined_t *schedule_p, ucc_schedule_t *frag, int frag_num)
 {
-    ucc_coll_args_t *args    = &schedule_p->super.super.args;
-    ucc_datatype_t   dt      = args->src.info.datatype;
-    size_t           dt_size = ucc_dt_size(dt);
-    ucc_coll_args_t *targs;
+    ucc_tl_ucp_team_t   *team    = ucc_derived_of(schedule_p->super.super.team,
+                                                  ucc_tl_ucp_team_t);
+    ucc_coll_args_t     *args    = &schedule_p->super.super.args;
+    ucc_datatype_t       dt      = args->src.info.datatype;
+    size_t               dt_size = ucc_dt_size(dt);
+    ucc_tl_ucp_worker_t *worker  = team->lanes[frag_num % team->n_lanes];
+    ucc_tl_ucp_task_t   *rs_task = ucc_derived_of(frag->tasks[0],
+                                                  ucc_tl_ucp_task_t);
+    ucc_tl_ucp_task_t   *ag_task = ucc_derived_of(frag->tasks[1],
+                                                  ucc_tl_ucp_task_t);
+    ucc_coll_args_t     *targs;
+    ucc_status_t         status;
     int              n_frags    = schedule_p->super.n_tasks;
-    size_t           frag_count = args->src.info.count / n_frags;
-    size_t           left       = args->src.info.count % n_frags;
-    size_t           offset     = frag_num * frag_count + left;
-
-    if (frag_num < left) {
-        frag_count++;
-        offset -= left - frag_num;
-    }
+    size_t           frag_count = ucc_buffer_block_count(args->src.info.count,
+                                                         n_frags, frag_num);
+    size_t           offset     = ucc_buffer_block_offset(args->src.info.count,
+                                                          n_frags, frag_num);
 
     targs = &frag->tasks[0]->args; //REDUCE_SCATTER
     targs->src.info.buffer =
@@ -89,6 +121,28 @@ static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_setup(
     targs->src.info.count = 0;
     targs->dst.info.count = frag_count;
 
+    if (rs_task->reduce_scatter_kn.wire_buf) {
+        /* allgather of the 16 bit local results */
+        ag_task->allgather_kn.decompress_dst = targs->dst.info.buffer;
+        targs->dst.info.buffer = rs_task->reduce_scatter_kn.wire_buf->addr;
+        if (team->cfg.allreduce_sra_kn_error_feedback) {
+            status = ucc_tl_ucp_ef_store_get(
+                &team->ef,
+                UCC_IS_INPLACE(*args) ? ag_task->allgather_kn.decompress_dst
+                                      : frag->tasks[0]->args.src.info.buffer,
+                frag_count, &rs_task->reduce_scatter_kn.ef);
+            if (UCC_OK != status) {
+                return status;
+            }
+        }
+    }
+
+    /* multi-context team: fragments are distributed round-robin across
+       the lanes */
+    if (team->n_lanes > 1) {
+        rs_task->worker = worker;
+        ag_task->worker = worker;
+    }
     return UCC_OK;
 }
 
@@ -104,10 +158,13 @@ static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_init(
     ucc_coll_task_t     *task, *rs_task;
     ucc_status_t         status;
     ucc_kn_radix_t       radix;
+    ucc_datatype_t       wire_dt;
 
     ucc_schedule_init(schedule, &coll_args->args, team);
-    radix = ucc_min(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.allreduce_sra_kn_radix,
-                    tl_team->size);
+    radix = ucc_tl_ucp_kn_radix(tl_team, tl_team->cfg.allreduce_sra_kn_radix,
+                                UCC_KN_PATTERN_SRA, tl_team->size,
+                                count * ucc_dt_size(
+                                            coll_args->args.dst.info.datatype));
 
     if (((count + radix - 1) / radix * (radix - 1) > count) ||
         ((radix - 1) > count)) {
@@ -121,8 +178,25 @@ static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_init(
                  "failed to init reduce_scatter_knomial task");
         goto out;
     }
-    ucc_schedule_add_task(schedule, task);
-    ucc_task_subscribe_dep(&schedule->super, task, UCC_EVENT_SCHEDULE_STARTED);
+    if (ucc_tl_ucp_allreduce_sra_kn_wire_dt(&coll_args->args, tl_team,
+                                            &wire_dt)) {
+        status = ucc_tl_ucp_reduce_scatter_knomial_set_wire_dt(task, wire_dt);
+        if (UCC_OK != status) {
+            tl_error(UCC_TL_TEAM_LIB(tl_team),
+                     "failed to allocate compression buffer");
+            goto out;
+        }
+        args.args.dst.info.datatype = wire_dt;
+    }
+    status = ucc_schedule_add_task(schedule, task);
+    if (UCC_OK != status) {
+        goto out;
+    }
+    status = ucc_task_subscribe_dep(&schedule->super, task,
+                                    UCC_EVENT_SCHEDULE_STARTED);
+    if (UCC_OK != status) {
+        goto out;
+    }
     rs_task = task;
     /* 2nd step of allreduce: knomial allgather. 2nd task subscribes
      to completion event of reduce_scatter task. */
@@ -134,8 +208,14 @@ static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_init(
                  "failed to init allgather_knomial task");
         goto out;
     }
-    ucc_schedule_add_task(schedule, task);
-    ucc_task_subscribe_dep(rs_task, task, UCC_EVENT_COMPLETED);
+    status = ucc_schedule_add_task(schedule, task);
+    if (UCC_OK != status) {
+        goto out;
+    }
+    status = ucc_task_subscribe_dep(rs_task, task, UCC_EVENT_COMPLETED);
+    if (UCC_OK != status) {
+        goto out;
+    }
     schedule->super.finalize = ucc_tl_ucp_allreduce_sra_knomial_frag_finalize;
     schedule->super.post     = ucc_tl_ucp_allreduce_sra_knomial_frag_start;
     *frag_p                  = schedule;
@@ -149,18 +229,53 @@ static inline void get_sra_n_frags(ucc_base_coll_args_t *coll_args,
                                    int *pipeline_depth)
 {
     //TODO make selection mem_type - specific
-    ucc_tl_ucp_lib_config_t *cfg     = &UCC_TL_UCP_TEAM_LIB(team)->cfg;
+    ucc_tl_ucp_lib_config_t *cfg     = &team->cfg;
     size_t                   msgsize = coll_args->args.src.info.count *
                      ucc_dt_size(coll_args->args.src.info.datatype);
-    int min_num_frags;
+    ucc_pipeline_model_t  model;
+    ucc_knomial_pattern_t p;
+    int                   min_num_frags;
 
-    *n_frags = 1;
+    if (UCC_IS_PARTITIONED(coll_args->args)) {
+        /* fragment i is partition i of the user buffer */
+        *n_frags        = coll_args->args.n_partitions;
+        *pipeline_depth = ucc_min(ucc_min(*n_frags,
+                                          ucc_max(cfg->partition_pipeline_depth,
+                                                  1)),
+                                  UCC_SCHEDULE_PIPELINED_MAX_FRAGS);
+        return;
+    }
+    *n_frags        = 1;
+    *pipeline_depth = 1;
     if (msgsize > cfg->allreduce_sra_kn_frag_thresh) {
-        min_num_frags = ucc_div_round_up(msgsize,
+        if (cfg->allreduce_sra_kn_frag_size == UCC_MEMUNITS_AUTO) {
+            /* every fragment goes through the reduce_scatter and the
+               allgather steps */
+            ucc_knomial_pattern_init(
+                team->size, team->rank,
+                ucc_tl_ucp_kn_radix(team, cfg->allreduce_sra_kn_radix,
+                                    UCC_KN_PATTERN_SRA, team->size,
+                                    msgsize), &p);
+            model.frag_latency = cfg->pipeline_frag_latency;
+            model.bw           = cfg->pipeline_bw;
+            ucc_schedule_pipelined_select(&model, msgsize,
+                                          2 * p.pow_radix_sup,
+                                          coll_args->args.src.info.count,
+                                          n_frags, pipeline_depth);
+        } else {
+            min_num_frags = ucc_div_round_up(msgsize,
                                              cfg->allreduce_sra_kn_frag_size);
-        *n_frags = ucc_max(min_num_frags, cfg->allreduce_sra_kn_n_frags);
+            *n_frags = ucc_max(min_num_frags, cfg->allreduce_sra_kn_n_frags);
+            *pipeline_depth = ucc_min(*n_frags,
+                                      cfg->allreduce_sra_kn_pipeline_depth);
+        }
+    }
+    if (team->n_lanes > 1 && msgsize > cfg->multi_ctx_stripe_thresh) {
+        /* keep at least one fragment in flight on every lane */
+        *n_frags        = ucc_max(*n_frags, team->n_lanes);
+        *pipeline_depth = ucc_min(ucc_max(*pipeline_depth, team->n_lanes),
+                                  UCC_SCHEDULE_PIPELINED_MAX_FRAGS);
     }
-    *pipeline_depth = ucc_min(*n_frags, cfg->allreduce_sra_kn_pipeline_depth);
 }
 
 static ucc_status_t
@@ -188,12 +303,20 @@ ucc_tl_ucp_allreduce_sra_knomial_init(ucc_base_coll_args_t *coll_args,
                                       ucc_coll_task_t     **task_h)
 {
     ucc_tl_ucp_team_t        *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
-    ucc_tl_ucp_lib_config_t  *cfg     = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    ucc_tl_ucp_lib_config_t  *cfg     = &tl_team->cfg;
     int                       n_frags, pipeline_depth;
-    ucc_schedule_pipelined_t *schedule_p =
-        ucc_tl_ucp_get_schedule_pipelined(tl_team);
-    ucc_status_t status;
+    ucc_schedule_pipelined_t *schedule_p;
+    ucc_status_t              status;
 
+    ALLREDUCE_TASK_CHECK(coll_args->args, tl_team);
+    if (UCC_IS_PARTITIONED(coll_args->args) &&
+        coll_args->args.n_partitions > coll_args->args.dst.info.count) {
+        tl_debug(team->context->lib, "number of partitions %lu exceeds "
+                 "count %lu", (unsigned long)coll_args->args.n_partitions,
+                 (unsigned long)coll_args->args.dst.info.count);
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    schedule_p = ucc_tl_ucp_get_schedule_pipelined(tl_team);
     if (!schedule_p) {
         tl_error(team->context->lib, "failed to allocate pipelined schedule");
         return UCC_ERR_NO_MEMORY;
@@ -208,10 +331,25 @@ ucc_tl_ucp_allreduce_sra_knomial_init(ucc_base_coll_args_t *coll_args,
         ucc_tl_ucp_put_schedule_pipelined(schedule_p);
         return status;
     }
+    if (UCC_IS_PARTITIONED(coll_args->args)) {
+        status = ucc_schedule_pipelined_set_partitioned(schedule_p, 1);
+        if (UCC_OK != status) {
+            ucc_schedule_pipelined_finalize(&schedule_p->super.super);
+            ucc_tl_ucp_put_schedule_pipelined(schedule_p);
+            return status;
+        }
+    } else if (cfg->allreduce_sra_kn_frag_size == UCC_MEMUNITS_AUTO) {
+        schedule_p->stats     = &tl_team->pipeline_stats;
+        schedule_p->frag_size = ucc_div_round_up(
+            coll_args->args.src.info.count, n_frags) *
+            ucc_dt_size(coll_args->args.src.info.datatype);
+    }
     schedule_p->super.super.finalize =
         ucc_tl_ucp_allreduce_sra_knomial_finalize;
     schedule_p->super.super.triggered_post = ucc_tl_ucp_triggered_post;
     schedule_p->super.super.post = ucc_tl_ucp_allreduce_sra_knomial_start;
     *task_h                                = &schedule_p->super.super;
     return UCC_OK;
+out:
+    return status;
 }
@@ -8,15 +8,40 @@
 #include "tl_ucp.h"
 #include "alltoall.h"
 
+ucc_base_coll_alg_info_t
+    ucc_tl_ucp_alltoall_algs[UCC_TL_UCP_ALLTOALL_ALG_LAST + 1] = {
+        [UCC_TL_UCP_ALLTOALL_ALG_PAIRWISE] =
+            {.id   = UCC_TL_UCP_ALLTOALL_ALG_PAIRWISE,
+             .name = "pairwise",
+             .desc = "pairwise exchange with every rank of the team"},
+        [UCC_TL_UCP_ALLTOALL_ALG_NODE_AGG] =
+            {.id   = UCC_TL_UCP_ALLTOALL_ALG_NODE_AGG,
+             .name = "node_agg",
+             .desc = "data of a node is aggregated on its leader, leaders "
+                     "exchange one message per pair of nodes (small blocks "
+                     "on many ranks per node)"},
+        [UCC_TL_UCP_ALLTOALL_ALG_LAST] = {
+            .id = 0, .name = NULL, .desc = NULL}};
+
 ucc_status_t ucc_tl_ucp_alltoall_pairwise_start(ucc_coll_task_t *task);
 ucc_status_t ucc_tl_ucp_alltoall_pairwise_progress(ucc_coll_task_t *task);
 
 ucc_status_t ucc_tl_ucp_alltoall_init(ucc_tl_ucp_task_t *task)
 {
-    ucc_status_t status;
+    ucc_tl_ucp_team_t *team   = TASK_TEAM(task);
+    ucc_coll_args_t   *args   = &task->super.args;
+    size_t             thresh = team->cfg.alltoall_node_agg_thresh;
+    ucc_status_t       status;
 
-    ALLTOALL_TASK_CHECK(task->super.args, TASK_TEAM(task));
-    status = ucc_tl_ucp_alltoall_pairwise_init_common(task);
+    ALLTOALL_TASK_CHECK(task->super.args, team);
+    /* block size is the same on all the ranks, so is the selection */
+    if (thresh > 0 && ucc_tl_ucp_alltoall_node_agg_supported(team, args) &&
+        (args->src.info.count / team->size) *
+                ucc_dt_size(args->src.info.datatype) <= thresh) {
+        status = ucc_tl_ucp_alltoall_node_agg_init_common(task);
+    } else {
+        status = ucc_tl_ucp_alltoall_pairwise_init_common(task);
+    }
 out:
     return status;
 }
@@ -30,9 +55,13 @@ ucc_status_t ucc_tl_ucp_alltoall_pairwise_init(ucc_base_coll_args_t *coll_args,
     ucc_status_t       status;
 
     ALLTOALL_TASK_CHECK(coll_args->args, tl_team);
-    task                 = ucc_tl_ucp_init_task(coll_args, team);
-    *task_h              = &task->super;
+    task   = ucc_tl_ucp_init_task(coll_args, team);
     status = ucc_tl_ucp_alltoall_pairwise_init_common(task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        goto out;
+    }
+    *task_h = &task->super;
 out:
     return status;
 }
@@ -9,6 +9,16 @@
 
 #include "../tl_ucp.h"
 #include "../tl_ucp_coll.h"
+#include "utils/ucc_coll_utils.h"
+
+enum {
+    UCC_TL_UCP_ALLTOALL_ALG_PAIRWISE,
+    UCC_TL_UCP_ALLTOALL_ALG_NODE_AGG,
+    UCC_TL_UCP_ALLTOALL_ALG_LAST
+};
+
+extern ucc_base_coll_alg_info_t
+             ucc_tl_ucp_alltoall_algs[UCC_TL_UCP_ALLTOALL_ALG_LAST + 1];
 
 ucc_status_t ucc_tl_ucp_alltoall_init(ucc_tl_ucp_task_t *task);
 
@@ -18,6 +28,16 @@ ucc_status_t ucc_tl_ucp_alltoall_pairwise_init(ucc_base_coll_args_t *coll_args,
 
 ucc_status_t ucc_tl_ucp_alltoall_pairwise_init_common(ucc_tl_ucp_task_t *task);
 
+/* Node aggregated alltoall and alltoallv, see alltoall_node_agg.c */
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_init(ucc_base_coll_args_t *coll_args,
+                                               ucc_base_team_t      *team,
+                                               ucc_coll_task_t     **task_h);
+
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_init_common(ucc_tl_ucp_task_t *task);
+
+int ucc_tl_ucp_alltoall_node_agg_supported(ucc_tl_ucp_team_t *team,
+                                           ucc_coll_args_t   *args);
+
 #define ALLTOALL_CHECK_INPLACE(_args, _team)                \
     do {                                                    \
         if (UCC_IS_INPLACE(_args)) {                        \
@@ -28,19 +48,34 @@ ucc_status_t ucc_tl_ucp_alltoall_pairwise_init_common(ucc_tl_ucp_task_t *task);
         }                                                   \
     } while (0)
 
-#define ALLTOALL_CHECK_USERDEFINED_DT(_args, _team)             \
-    do {                                                        \
-        if ((_args.src.info.datatype == UCC_DT_USERDEFINED) ||  \
-            (_args.dst.info.datatype == UCC_DT_USERDEFINED)) {  \
-            tl_error(UCC_TL_TEAM_LIB(_team),                    \
-                     "user defined datatype is not supported"); \
-            status = UCC_ERR_NOT_SUPPORTED;                     \
-            goto out;                                           \
-        }                                                       \
+#define ALLTOALL_CHECK_USERDEFINED_DT(_args, _team)                   \
+    do {                                                              \
+        if ((_args.src.info.datatype == UCC_DT_USERDEFINED &&         \
+             !ucc_coll_args_dt_layout(&_args,                         \
+                                      _args.src.info.datatype, 1)) || \
+            (_args.dst.info.datatype == UCC_DT_USERDEFINED &&         \
+             !ucc_coll_args_dt_layout(&_args,                         \
+                                      _args.dst.info.datatype, 0))) { \
+            tl_error(UCC_TL_TEAM_LIB(_team),                          \
+                     "layout of user defined datatype is not set");   \
+            status = UCC_ERR_NOT_SUPPORTED;                           \
+            goto out;                                                 \
+        }                                                             \
     } while (0)
 
 #define ALLTOALL_TASK_CHECK(_args, _team)              \
     ALLTOALL_CHECK_INPLACE((_args), (_team));          \
     ALLTOALL_CHECK_USERDEFINED_DT((_args), (_team));
 
+static inline int ucc_tl_ucp_alltoall_alg_from_str(const char *str)
+{
+    int i;
+    for (i = 0; i < UCC_TL_UCP_ALLTOALL_ALG_LAST; i++) {
+        if (0 == strcasecmp(str, ucc_tl_ucp_alltoall_algs[i].name)) {
+            break;
+        }
+    }
+    return i;
+}
+
 #endif
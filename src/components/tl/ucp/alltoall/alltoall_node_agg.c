@@ -0,0 +1,816 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "alltoall.h"
+#include "core/ucc_progress_queue.h"
+#include "core/ucc_mc.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "tl_ucp_sendrecv.h"
+
+/* Node aggregated alltoall and alltoallv.
+
+   Ranks of a node send all their data to the node leader, the leaders
+   exchange a single aggregated message per pair of nodes and scatter the
+   received data to the ranks of their node. The number of inter-node
+   messages goes down from P^2 to nnodes^2 at the cost of copying the data
+   of the node on its leader.
+
+   Buffers of a leader, k - number of ranks on the node, q - position of a
+   rank in node_map->members:
+   G - rows of the local ranks, every row in destination rank order
+   S - region per node n: [local src j][dst of n], sent to the leader of n
+   R - region per remote node n: [src of n][local dst j], received from
+       the leader of n; the region of the own node is taken from S
+   T - data of the local dst j in source rank order, sent to j
+
+   Block sizes of alltoall are the same for all the pairs. For alltoallv
+   local ranks send their send sizes to the leader before the data, and
+   the leaders exchange the sizes of the blocks of S and R ("headers")
+   before the blocks themselves. */
+
+enum {
+    NODE_AGG_PHASE_COUNTS,   /*< leader: send sizes of local ranks */
+    NODE_AGG_PHASE_GATHER,   /*< leader: rows of local ranks, headers */
+    NODE_AGG_PHASE_EXCHANGE, /*< leader: regions of remote nodes */
+    NODE_AGG_PHASE_SCATTER   /*< all: own result */
+};
+
+/* Offsets and block sizes, all in bytes, carved from task sizes */
+typedef struct node_agg_arrays {
+    uint64_t *goff; /*< k + 1 offsets of the rows in G */
+    uint64_t *soff; /*< nnodes + 1 offsets of the regions in S */
+    uint64_t *roff; /*< nnodes + 1 offsets of the regions in R */
+    uint64_t *toff; /*< k + 1 offsets of the local dsts in T */
+    uint64_t *acc;  /*< nnodes running offsets */
+    uint64_t *cur;  /*< P running offsets, indexed by position */
+    uint64_t *cnt;  /*< alltoallv: [j][dst rank] send sizes */
+    uint64_t *hs;   /*< alltoallv: headers of S regions */
+    uint64_t *hr;   /*< alltoallv: [src position][local dst] sizes */
+} node_agg_arrays_t;
+
+/* Coalesces copies of adjacent blocks into a single memcpy */
+typedef struct node_agg_copy {
+    void             *dst;
+    const void       *src;
+    size_t            len;
+    ucc_memory_type_t mt;
+} node_agg_copy_t;
+
+static inline ucc_status_t node_agg_copy_flush(node_agg_copy_t *c)
+{
+    ucc_status_t status = UCC_OK;
+
+    if (c->len) {
+        status = ucc_mc_memcpy(c->dst, c->src, c->len, c->mt, c->mt);
+        c->len = 0;
+    }
+    return status;
+}
+
+static inline ucc_status_t node_agg_copy(node_agg_copy_t *c, void *dst,
+                                         const void *src, size_t len)
+{
+    ucc_status_t status;
+
+    if (len == 0) {
+        return UCC_OK;
+    }
+    if (c->len && dst == PTR_OFFSET(c->dst, c->len) &&
+        src == PTR_OFFSET(c->src, c->len)) {
+        c->len += len;
+        return UCC_OK;
+    }
+    status = node_agg_copy_flush(c);
+    c->dst = dst;
+    c->src = src;
+    c->len = len;
+    return status;
+}
+
+static inline int node_agg_is_v(ucc_tl_ucp_task_t *task)
+{
+    return task->super.args.coll_type == UCC_COLL_TYPE_ALLTOALLV;
+}
+
+static inline ucc_memory_type_t node_agg_mem_type(ucc_tl_ucp_task_t *task)
+{
+    return node_agg_is_v(task) ? task->super.args.src.info_v.mem_type
+                               : task->super.args.src.info.mem_type;
+}
+
+/* alltoall block size */
+static inline size_t node_agg_block(ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t *args = &task->super.args;
+
+    return (size_t)(args->src.info.count / TASK_TEAM(task)->size) *
+           ucc_dt_size(args->src.info.datatype);
+}
+
+static inline int node_agg_is_leader(ucc_tl_ucp_team_t *team)
+{
+    ucc_tl_ucp_node_map_t *map = team->node_map;
+
+    return UCC_TL_UCP_NODE_LEADER(map, map->my_node) == team->rank;
+}
+
+static inline void node_agg_get_arrays(ucc_tl_ucp_task_t *task,
+                                       node_agg_arrays_t *a)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, map->my_node);
+    ucc_rank_t             n    = map->nnodes;
+    uint64_t              *p    = task->alltoall_node_agg.sizes;
+
+    a->goff = p;
+    a->soff = a->goff + k + 1;
+    a->roff = a->soff + n + 1;
+    a->toff = a->roff + n + 1;
+    a->acc  = a->toff + k + 1;
+    a->cur  = a->acc + n;
+    a->cnt  = a->cur + team->size;
+    a->hs   = a->cnt + (size_t)k * team->size;
+    a->hr   = a->hs + (size_t)k * team->size;
+}
+
+static inline size_t node_agg_n_sizes(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    size_t                 k    = UCC_TL_UCP_NODE_SIZE(map, map->my_node);
+    size_t                 n    = 2 * (k + 1) + 3 * map->nnodes + 2 +
+                                  team->size;
+
+    if (!node_agg_is_leader(team)) {
+        return node_agg_is_v(task) ? team->size : 0;
+    }
+    return node_agg_is_v(task) ? n + 3 * k * team->size : n;
+}
+
+/* send size from local rank j to team rank t */
+static inline uint64_t node_agg_send_size(ucc_tl_ucp_task_t *task,
+                                          node_agg_arrays_t *a, ucc_rank_t j,
+                                          ucc_rank_t t)
+{
+    return node_agg_is_v(task) ? a->cnt[(size_t)j * TASK_TEAM(task)->size + t]
+                               : node_agg_block(task);
+}
+
+/* size of the block from the rank at position q to local rank j */
+static inline uint64_t node_agg_recv_size(ucc_tl_ucp_task_t *task,
+                                          node_agg_arrays_t *a, ucc_rank_t q,
+                                          ucc_rank_t j)
+{
+    ucc_tl_ucp_node_map_t *map = TASK_TEAM(task)->node_map;
+
+    return node_agg_is_v(task)
+               ? a->hr[(size_t)q * UCC_TL_UCP_NODE_SIZE(map, map->my_node) +
+                       j]
+               : node_agg_block(task);
+}
+
+/* Send sizes of the calling rank, in bytes */
+static void node_agg_fill_counts(ucc_tl_ucp_task_t *task, uint64_t *cnt)
+{
+    ucc_coll_args_t *args    = &task->super.args;
+    size_t           dt_size = ucc_dt_size(args->src.info_v.datatype);
+    ucc_rank_t       t;
+
+    for (t = 0; t < TASK_TEAM(task)->size; t++) {
+        cnt[t] = ucc_coll_args_get_count(args, args->src.info_v.counts, t) *
+                 dt_size;
+    }
+}
+
+/* Copies the send data of the calling rank to dst in destination order */
+static ucc_status_t node_agg_pack_row(ucc_tl_ucp_task_t *task, void *dst)
+{
+    ucc_coll_args_t *args = &task->super.args;
+    node_agg_copy_t  c    = {.len = 0, .mt = node_agg_mem_type(task)};
+    size_t           dt_size, len, offset = 0;
+    ucc_rank_t       t;
+    ucc_status_t     status;
+
+    if (!node_agg_is_v(task)) {
+        return ucc_mc_memcpy(dst, args->src.info.buffer,
+                             node_agg_block(task) * TASK_TEAM(task)->size,
+                             c.mt, c.mt);
+    }
+    dt_size = ucc_dt_size(args->src.info_v.datatype);
+    for (t = 0; t < TASK_TEAM(task)->size; t++) {
+        len = ucc_coll_args_get_count(args, args->src.info_v.counts, t) *
+              dt_size;
+        status = node_agg_copy(
+            &c, PTR_OFFSET(dst, offset),
+            PTR_OFFSET(args->src.info_v.buffer,
+                       ucc_coll_args_get_displacement(
+                           args, args->src.info_v.displacements, t) *
+                           dt_size),
+            len);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        offset += len;
+    }
+    return node_agg_copy_flush(&c);
+}
+
+/* Address of the block from team rank s in the destination buffer */
+static inline void *node_agg_dst(ucc_tl_ucp_task_t *task, ucc_rank_t s)
+{
+    ucc_coll_args_t *args = &task->super.args;
+
+    if (!node_agg_is_v(task)) {
+        return PTR_OFFSET(args->dst.info.buffer, node_agg_block(task) * s);
+    }
+    return PTR_OFFSET(args->dst.info_v.buffer,
+                      ucc_coll_args_get_displacement(
+                          args, args->dst.info_v.displacements, s) *
+                          ucc_dt_size(args->dst.info_v.datatype));
+}
+
+static inline size_t node_agg_dst_size(ucc_tl_ucp_task_t *task, ucc_rank_t s)
+{
+    ucc_coll_args_t *args = &task->super.args;
+
+    if (!node_agg_is_v(task)) {
+        return node_agg_block(task);
+    }
+    return ucc_coll_args_get_count(args, args->dst.info_v.counts, s) *
+           ucc_dt_size(args->dst.info_v.datatype);
+}
+
+/* Leader: offsets of G rows and S regions, alltoallv headers of S */
+static void node_agg_prepare_rows(ucc_tl_ucp_task_t *task,
+                                  node_agg_arrays_t *a)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             m    = map->my_node;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, m);
+    ucc_rank_t             j, t, n, kn;
+    uint64_t               sz;
+
+    memset(a->acc, 0, map->nnodes * sizeof(uint64_t));
+    a->goff[0] = 0;
+    for (j = 0; j < k; j++) {
+        a->goff[j + 1] = a->goff[j];
+        for (t = 0; t < team->size; t++) {
+            n  = map->node_of[t];
+            sz = node_agg_send_size(task, a, j, t);
+            a->goff[j + 1] += sz;
+            a->acc[n]      += sz;
+            if (node_agg_is_v(task)) {
+                kn = UCC_TL_UCP_NODE_SIZE(map, n);
+                a->hs[(size_t)k * map->node_start[n] + (size_t)j * kn +
+                      map->pos[t] - map->node_start[n]] = sz;
+            }
+        }
+    }
+    a->soff[0] = 0;
+    for (n = 0; n < map->nnodes; n++) {
+        a->soff[n + 1] = a->soff[n] + a->acc[n];
+    }
+    if (node_agg_is_v(task)) {
+        /* blocks within the own node are not exchanged, their sizes are
+           known locally */
+        memcpy(a->hr + (size_t)k * map->node_start[m],
+               a->hs + (size_t)k * map->node_start[m],
+               (size_t)k * k * sizeof(uint64_t));
+    }
+}
+
+/* Leader: offsets of R regions and T, requires the headers */
+static void node_agg_prepare_recv(ucc_tl_ucp_task_t *task,
+                                  node_agg_arrays_t *a)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             m    = map->my_node;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, m);
+    ucc_rank_t             q, j, n;
+    uint64_t               sz, region;
+
+    memset(a->toff, 0, (k + 1) * sizeof(uint64_t));
+    a->roff[0] = 0;
+    for (n = 0; n < map->nnodes; n++) {
+        region = 0;
+        for (q = map->node_start[n]; q < map->node_start[n + 1]; q++) {
+            a->cur[q] = region;
+            for (j = 0; j < k; j++) {
+                sz               = node_agg_recv_size(task, a, q, j);
+                region          += sz;
+                a->toff[j + 1]  += sz;
+            }
+        }
+        a->roff[n + 1] = a->roff[n] + ((n == m) ? 0 : region);
+    }
+    for (j = 0; j < k; j++) {
+        a->toff[j + 1] += a->toff[j];
+    }
+}
+
+static inline size_t node_agg_xchg_size(ucc_tl_ucp_task_t *task,
+                                        node_agg_arrays_t *a)
+{
+    ucc_tl_ucp_node_map_t *map = TASK_TEAM(task)->node_map;
+    ucc_rank_t             k   = UCC_TL_UCP_NODE_SIZE(map, map->my_node);
+
+    return a->soff[map->nnodes] + a->roff[map->nnodes] + a->toff[k];
+}
+
+/* Leader, counts are known: posts receives of the rows and the headers
+   and sends the headers */
+static ucc_status_t node_agg_gather(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             m    = map->my_node;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, m);
+    ucc_memory_type_t      mt   = node_agg_mem_type(task);
+    node_agg_arrays_t      a;
+    ucc_rank_t             j, n, kn;
+    ucc_status_t           status;
+    void                  *g;
+
+    node_agg_get_arrays(task, &a);
+    if (node_agg_is_v(task)) {
+        node_agg_prepare_rows(task, &a);
+        status = ucc_scratch_get(&team->scratch,
+                                 ucc_max(a.goff[k], 1), mt,
+                                 &task->alltoall_node_agg.gather);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        for (n = 0; n < map->nnodes; n++) {
+            if (n == m) {
+                continue;
+            }
+            kn = UCC_TL_UCP_NODE_SIZE(map, n);
+            status = ucc_tl_ucp_send_nb(
+                a.hs + (size_t)k * map->node_start[n],
+                (size_t)k * kn * sizeof(uint64_t), UCC_MEMORY_TYPE_HOST,
+                UCC_TL_UCP_NODE_LEADER(map, n), team, task);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+            status = ucc_tl_ucp_recv_nb(
+                a.hr + (size_t)k * map->node_start[n],
+                (size_t)k * kn * sizeof(uint64_t), UCC_MEMORY_TYPE_HOST,
+                UCC_TL_UCP_NODE_LEADER(map, n), team, task);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+        }
+    }
+    g = task->alltoall_node_agg.gather->addr;
+    for (j = 1; j < k; j++) {
+        status = ucc_tl_ucp_recv_nz(PTR_OFFSET(g, a.goff[j]),
+                                    a.goff[j + 1] - a.goff[j], mt,
+                                    map->members[map->node_start[m] + j],
+                                    team, task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return node_agg_pack_row(task, g);
+}
+
+/* Leader, rows and headers are received: packs S and exchanges the
+   regions with the remote leaders */
+static ucc_status_t node_agg_exchange(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             m    = map->my_node;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, m);
+    ucc_memory_type_t      mt   = node_agg_mem_type(task);
+    node_agg_copy_t        c    = {.len = 0, .mt = mt};
+    node_agg_arrays_t      a;
+    ucc_rank_t             j, t, n;
+    ucc_status_t           status;
+    uint64_t               sz, pos;
+    void                  *g, *s, *r;
+
+    node_agg_get_arrays(task, &a);
+    /* also resets the read offsets of the regions used by the scatter */
+    node_agg_prepare_recv(task, &a);
+    if (node_agg_is_v(task)) {
+        status = ucc_scratch_get(&team->scratch,
+                                 ucc_max(node_agg_xchg_size(task, &a),
+                                         1),
+                                 mt, &task->alltoall_node_agg.xchg);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    g = task->alltoall_node_agg.gather->addr;
+    s = task->alltoall_node_agg.xchg->addr;
+    r = PTR_OFFSET(s, a.soff[map->nnodes]);
+    /* destinations of a row are visited in rank order, which is the order
+       of the ranks within every node */
+    memset(a.acc, 0, map->nnodes * sizeof(uint64_t));
+    for (j = 0; j < k; j++) {
+        pos = a.goff[j];
+        for (t = 0; t < team->size; t++) {
+            n      = map->node_of[t];
+            sz     = node_agg_send_size(task, &a, j, t);
+            status = node_agg_copy(&c, PTR_OFFSET(s, a.soff[n] + a.acc[n]),
+                                   PTR_OFFSET(g, pos), sz);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+            a.acc[n] += sz;
+            pos      += sz;
+        }
+    }
+    status = node_agg_copy_flush(&c);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    for (n = 0; n < map->nnodes; n++) {
+        if (n == m) {
+            continue;
+        }
+        status = ucc_tl_ucp_recv_nz(PTR_OFFSET(r, a.roff[n]),
+                                    a.roff[n + 1] - a.roff[n], mt,
+                                    UCC_TL_UCP_NODE_LEADER(map, n), team,
+                                    task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        status = ucc_tl_ucp_send_nz(PTR_OFFSET(s, a.soff[n]),
+                                    a.soff[n + 1] - a.soff[n], mt,
+                                    UCC_TL_UCP_NODE_LEADER(map, n), team,
+                                    task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
+
+/* Leader, regions are received: builds T of every local rank in source
+   order, the result of the leader goes to its dst directly */
+static ucc_status_t node_agg_scatter(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             m    = map->my_node;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, m);
+    ucc_memory_type_t      mt   = node_agg_mem_type(task);
+    node_agg_copy_t        c    = {.len = 0, .mt = mt};
+    node_agg_arrays_t      a;
+    ucc_rank_t             j, s, q, n;
+    ucc_status_t           status;
+    uint64_t               sz, pos;
+    void                  *xs, *xr, *xt, *src, *dst;
+
+    node_agg_get_arrays(task, &a);
+    xs = task->alltoall_node_agg.xchg->addr;
+    xr = PTR_OFFSET(xs, a.soff[map->nnodes]);
+    xt = PTR_OFFSET(xr, a.roff[map->nnodes]);
+    for (j = 0; j < k; j++) {
+        pos = a.toff[j];
+        for (s = 0; s < team->size; s++) {
+            q   = map->pos[s];
+            n   = map->node_of[s];
+            sz  = node_agg_recv_size(task, &a, q, j);
+            src = (n == m) ? PTR_OFFSET(xs, a.soff[m] + a.cur[q])
+                           : PTR_OFFSET(xr, a.roff[n] + a.cur[q]);
+            if (j == 0) {
+                ucc_assert(sz == node_agg_dst_size(task, s));
+                dst = node_agg_dst(task, s);
+            } else {
+                dst  = PTR_OFFSET(xt, pos);
+                pos += sz;
+            }
+            status = node_agg_copy(&c, dst, src, sz);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+            a.cur[q] += sz;
+        }
+    }
+    status = node_agg_copy_flush(&c);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    for (j = 1; j < k; j++) {
+        status = ucc_tl_ucp_send_nz(PTR_OFFSET(xt, a.toff[j]),
+                                    a.toff[j + 1] - a.toff[j], mt,
+                                    map->members[map->node_start[m] + j],
+                                    team, task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
+
+/* Non leader alltoallv: moves the result from scratch to dst */
+static ucc_status_t node_agg_unpack(ucc_tl_ucp_task_t *task)
+{
+    node_agg_copy_t c   = {.len = 0, .mt = node_agg_mem_type(task)};
+    void           *src = PTR_OFFSET(task->alltoall_node_agg.gather->addr,
+                                     task->alltoall_node_agg.recv_offset);
+    ucc_rank_t      s;
+    size_t          sz;
+    ucc_status_t    status;
+
+    for (s = 0; s < TASK_TEAM(task)->size; s++) {
+        sz     = node_agg_dst_size(task, s);
+        status = node_agg_copy(&c, node_agg_dst(task, s), src, sz);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        src = PTR_OFFSET(src, sz);
+    }
+    return node_agg_copy_flush(&c);
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_status_t       status;
+
+    while (UCC_OK == ucc_tl_ucp_test(task)) {
+        switch (task->alltoall_node_agg.phase) {
+        case NODE_AGG_PHASE_COUNTS:
+            status                        = node_agg_gather(task);
+            task->alltoall_node_agg.phase = NODE_AGG_PHASE_GATHER;
+            break;
+        case NODE_AGG_PHASE_GATHER:
+            status                        = node_agg_exchange(task);
+            task->alltoall_node_agg.phase = NODE_AGG_PHASE_EXCHANGE;
+            break;
+        case NODE_AGG_PHASE_EXCHANGE:
+            status                        = node_agg_scatter(task);
+            task->alltoall_node_agg.phase = NODE_AGG_PHASE_SCATTER;
+            break;
+        default:
+            status = UCC_OK;
+            if (node_agg_is_v(task) && !node_agg_is_leader(TASK_TEAM(task))) {
+                status = node_agg_unpack(task);
+            }
+            task->super.super.status = status;
+            UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task,
+                                             "ucp_alltoall_node_agg_done", 0);
+            return status;
+        }
+        if (ucc_unlikely(UCC_OK != status)) {
+            tl_error(UCC_TASK_LIB(task), "node aggregated alltoall failed");
+            task->super.super.status = status;
+            return status;
+        }
+    }
+    return task->super.super.status;
+}
+
+/* Non leader: sends the sizes and data to the leader and posts the
+   receive of the result */
+static ucc_status_t node_agg_post_member(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t     *team   = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map    = team->node_map;
+    ucc_rank_t             leader = UCC_TL_UCP_NODE_LEADER(map, map->my_node);
+    ucc_coll_args_t       *args   = &task->super.args;
+    ucc_memory_type_t      mt     = node_agg_mem_type(task);
+    uint64_t              *cnt    = task->alltoall_node_agg.sizes;
+    size_t                 send_size, recv_size;
+    ucc_rank_t             t;
+    ucc_status_t           status;
+    void                  *buf;
+
+    if (!node_agg_is_v(task)) {
+        send_size = node_agg_block(task) * team->size;
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nz(args->src.info.buffer, send_size, mt,
+                                         leader, team, task),
+                      task, out);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nz(args->dst.info.buffer, send_size, mt,
+                                         leader, team, task),
+                      task, out);
+        return UCC_OK;
+    }
+    node_agg_fill_counts(task, cnt);
+    send_size = 0;
+    recv_size = 0;
+    for (t = 0; t < team->size; t++) {
+        send_size += cnt[t];
+        recv_size += node_agg_dst_size(task, t);
+    }
+    status = ucc_scratch_get(&team->scratch,
+                             ucc_max(send_size + recv_size, 1), mt,
+                             &task->alltoall_node_agg.gather);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    buf    = task->alltoall_node_agg.gather->addr;
+    status = node_agg_pack_row(task, buf);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    task->alltoall_node_agg.recv_offset = send_size;
+    UCPCHECK_GOTO(ucc_tl_ucp_send_nb(cnt, team->size * sizeof(uint64_t),
+                                     UCC_MEMORY_TYPE_HOST, leader, team, task),
+                  task, out);
+    UCPCHECK_GOTO(ucc_tl_ucp_send_nz(buf, send_size, mt, leader, team, task),
+                  task, out);
+    UCPCHECK_GOTO(ucc_tl_ucp_recv_nz(PTR_OFFSET(buf, send_size), recv_size, mt,
+                                     leader, team, task),
+                  task, out);
+    return UCC_OK;
+out:
+    return task->super.super.status;
+}
+
+/* Leader: posts the receives of the sizes of the local ranks */
+static ucc_status_t node_agg_post_leader(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_tl_ucp_node_map_t *map  = team->node_map;
+    ucc_rank_t             m    = map->my_node;
+    ucc_rank_t             k    = UCC_TL_UCP_NODE_SIZE(map, m);
+    node_agg_arrays_t      a;
+    ucc_rank_t             j;
+
+    node_agg_get_arrays(task, &a);
+    node_agg_fill_counts(task, a.cnt);
+    for (j = 1; j < k; j++) {
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_recv_nb(a.cnt + (size_t)j * team->size,
+                               team->size * sizeof(uint64_t),
+                               UCC_MEMORY_TYPE_HOST,
+                               map->members[map->node_start[m] + j], team,
+                               task),
+            task, out);
+    }
+    return UCC_OK;
+out:
+    return task->super.super.status;
+}
+
+static void node_agg_release(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+
+    if (task->alltoall_node_agg.gather) {
+        ucc_scratch_put(&team->scratch,
+                        task->alltoall_node_agg.gather);
+        task->alltoall_node_agg.gather = NULL;
+    }
+    if (task->alltoall_node_agg.xchg) {
+        ucc_scratch_put(&team->scratch, task->alltoall_node_agg.xchg);
+        task->alltoall_node_agg.xchg = NULL;
+    }
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_alltoall_node_agg_start",
+                                     0);
+    ucc_tl_ucp_task_reset(task);
+    task->alltoall_node_agg.phase = NODE_AGG_PHASE_SCATTER;
+    if (node_agg_is_v(task)) {
+        /* buffers of a previous run of a persistent collective, sizes may
+           be different */
+        node_agg_release(task);
+    }
+    if (!node_agg_is_leader(team)) {
+        status = node_agg_post_member(task);
+    } else if (node_agg_is_v(task)) {
+        task->alltoall_node_agg.phase = NODE_AGG_PHASE_COUNTS;
+        status                        = node_agg_post_leader(task);
+    } else {
+        task->alltoall_node_agg.phase = NODE_AGG_PHASE_GATHER;
+        status                        = node_agg_gather(task);
+    }
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->super.super.status = status;
+        return status;
+    }
+    status = ucc_tl_ucp_alltoall_node_agg_progress(&task->super);
+    if (UCC_INPROGRESS == status) {
+        ucc_progress_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+        return UCC_OK;
+    }
+    return ucc_task_complete(coll_task);
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    node_agg_release(task);
+    ucc_free(task->alltoall_node_agg.sizes);
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+int ucc_tl_ucp_alltoall_node_agg_supported(ucc_tl_ucp_team_t *team,
+                                           ucc_coll_args_t   *args)
+{
+    if (!team->node_map) {
+        return 0;
+    }
+    /* aggregated buffers are contiguous */
+    if (args->coll_type == UCC_COLL_TYPE_ALLTOALLV) {
+        return (args->src.info_v.mem_type == args->dst.info_v.mem_type) &&
+               (args->src.info_v.datatype != UCC_DT_USERDEFINED) &&
+               (args->dst.info_v.datatype != UCC_DT_USERDEFINED);
+    }
+    return (args->src.info.mem_type == args->dst.info.mem_type) &&
+           (args->src.info.datatype != UCC_DT_USERDEFINED) &&
+           (args->dst.info.datatype != UCC_DT_USERDEFINED);
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_init_common(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    size_t             n_sizes;
+    node_agg_arrays_t  a;
+    ucc_status_t       status;
+
+    ucc_assert(ucc_tl_ucp_alltoall_node_agg_supported(team,
+                                                      &task->super.args));
+    task->super.post                = ucc_tl_ucp_alltoall_node_agg_start;
+    task->super.progress            = ucc_tl_ucp_alltoall_node_agg_progress;
+    task->super.finalize            = ucc_tl_ucp_alltoall_node_agg_finalize;
+    task->alltoall_node_agg.gather  = NULL;
+    task->alltoall_node_agg.xchg    = NULL;
+    task->alltoall_node_agg.sizes   = NULL;
+    n_sizes                         = node_agg_n_sizes(task);
+    if (n_sizes > 0) {
+        task->alltoall_node_agg.sizes =
+            ucc_malloc(n_sizes * sizeof(uint64_t), "node_agg_sizes");
+        if (!task->alltoall_node_agg.sizes) {
+            tl_error(UCC_TASK_LIB(task), "failed to allocate %zd bytes",
+                     n_sizes * sizeof(uint64_t));
+            return UCC_ERR_NO_MEMORY;
+        }
+    }
+    if (node_agg_is_v(task) || !node_agg_is_leader(team)) {
+        return UCC_OK;
+    }
+    /* all the sizes of alltoall are known, buffers are allocated once */
+    node_agg_get_arrays(task, &a);
+    node_agg_prepare_rows(task, &a);
+    node_agg_prepare_recv(task, &a);
+    status = ucc_scratch_get(&team->scratch,
+                             ucc_max(a.goff[UCC_TL_UCP_NODE_SIZE(
+                                         team->node_map,
+                                         team->node_map->my_node)],
+                                     1),
+                             node_agg_mem_type(task),
+                             &task->alltoall_node_agg.gather);
+    if (ucc_unlikely(UCC_OK != status)) {
+        goto err;
+    }
+    status = ucc_scratch_get(&team->scratch,
+                             ucc_max(node_agg_xchg_size(task, &a), 1),
+                             node_agg_mem_type(task),
+                             &task->alltoall_node_agg.xchg);
+    if (ucc_unlikely(UCC_OK != status)) {
+        goto err;
+    }
+    return UCC_OK;
+err:
+    node_agg_release(task);
+    ucc_free(task->alltoall_node_agg.sizes);
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_node_agg_init(ucc_base_coll_args_t *coll_args,
+                                               ucc_base_team_t      *team,
+                                               ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    ALLTOALL_TASK_CHECK(coll_args->args, tl_team);
+    task = ucc_tl_ucp_init_task(coll_args, team);
+    if (ucc_tl_ucp_alltoall_node_agg_supported(tl_team, &coll_args->args)) {
+        status = ucc_tl_ucp_alltoall_node_agg_init_common(task);
+    } else {
+        /* single node team or one rank per node: nothing to aggregate */
+        status = ucc_tl_ucp_alltoall_pairwise_init_common(task);
+    }
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        goto out;
+    }
+    *task_h = &task->super;
+out:
+    return status;
+}
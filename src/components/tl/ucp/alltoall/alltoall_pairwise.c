@@ -9,6 +9,7 @@
 #include "alltoall.h"
 #include "core/ucc_progress_queue.h"
 #include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
 #include "tl_ucp_sendrecv.h"
 
 static inline ucc_rank_t get_recv_peer(ucc_rank_t rank, ucc_rank_t size,
@@ -27,37 +28,44 @@ ucc_status_t ucc_tl_ucp_alltoall_pairwise_progress(ucc_coll_task_t *coll_task)
 {
     ucc_tl_ucp_task_t *task  = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
     ucc_tl_ucp_team_t *team  = TASK_TEAM(task);
-    ptrdiff_t          sbuf  = (ptrdiff_t)coll_task->args.src.info.buffer;
-    ptrdiff_t          rbuf  = (ptrdiff_t)coll_task->args.dst.info.buffer;
-    ucc_memory_type_t  smem  = coll_task->args.src.info.mem_type;
-    ucc_memory_type_t  rmem  = coll_task->args.dst.info.mem_type;
+    ucc_coll_args_t   *args  = &coll_task->args;
+    ptrdiff_t          sbuf  = (ptrdiff_t)args->src.info.buffer;
+    ptrdiff_t          rbuf  = (ptrdiff_t)args->dst.info.buffer;
+    ucc_memory_type_t  smem  = args->src.info.mem_type;
+    ucc_memory_type_t  rmem  = args->dst.info.mem_type;
+    ucc_datatype_t     sdt   = args->src.info.datatype;
+    ucc_datatype_t     rdt   = args->dst.info.datatype;
     ucc_rank_t         grank = team->rank;
     ucc_rank_t         gsize = team->size;
     ucc_rank_t         peer;
     int                polls = 0;
     int                posts, nreqs;
-    size_t             data_size;
+    size_t             scount, rcount, sblock, rblock;
 
-    posts     = UCC_TL_UCP_TEAM_LIB(team)->cfg.alltoall_pairwise_num_posts;
-    nreqs     = (posts > gsize || posts == 0) ? gsize : posts;
-    data_size = (size_t)(coll_task->args.src.info.count / gsize) *
-                ucc_dt_size(coll_task->args.src.info.datatype);
+    posts  = team->cfg.alltoall_pairwise_num_posts;
+    nreqs  = (posts > gsize || posts == 0) ? gsize : posts;
+    scount = (size_t)(args->src.info.count / gsize);
+    rcount = (size_t)(args->dst.info.count / gsize);
+    sblock = scount * ucc_coll_args_dt_extent(args, sdt, 1);
+    rblock = rcount * ucc_coll_args_dt_extent(args, rdt, 0);
     while ((task->send_posted < gsize || task->recv_posted < gsize) &&
            (polls++ < task->n_polls)) {
-        ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+        ucp_worker_progress(task->worker->ucp_worker);
         while ((task->recv_posted < gsize) &&
                ((task->recv_posted - task->recv_completed) < nreqs)) {
             peer = get_recv_peer(grank, gsize, task->recv_posted);
-            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb((void *)(rbuf + peer * data_size),
-                                             data_size, rmem, peer, team, task),
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_elems((void *)(rbuf + peer * rblock),
+                                                rcount, rdt, UCC_TL_UCP_DT_DST,
+                                                rmem, peer, team, task),
                           task, out);
             polls = 0;
         }
         while ((task->send_posted < gsize) &&
                ((task->send_posted - task->send_completed) < nreqs)) {
             peer = get_send_peer(grank, gsize, task->send_posted);
-            UCPCHECK_GOTO(ucc_tl_ucp_send_nb((void *)(sbuf + peer * data_size),
-                                             data_size, smem, peer, team, task),
+            UCPCHECK_GOTO(ucc_tl_ucp_send_elems((void *)(sbuf + peer * sblock),
+                                                scount, sdt, UCC_TL_UCP_DT_SRC,
+                                                smem, peer, team, task),
                           task, out);
             polls = 0;
         }
@@ -95,19 +103,30 @@ ucc_status_t ucc_tl_ucp_alltoall_pairwise_init_common(ucc_tl_ucp_task_t *task)
 {
     ucc_tl_ucp_team_t *team = TASK_TEAM(task);
     ucc_coll_args_t   *args = &task->super.args;
-    size_t data_size;
+    ucc_status_t       status;
 
     task->super.post     = ucc_tl_ucp_alltoall_pairwise_start;
     task->super.progress = ucc_tl_ucp_alltoall_pairwise_progress;
 
+    status = ucc_tl_ucp_task_dt_init(task, args->src.info.datatype,
+                                     args->src.info.mem_type,
+                                     args->dst.info.datatype,
+                                     args->dst.info.mem_type);
+    if (UCC_OK != status) {
+        return status;
+    }
     task->n_polls = ucc_min(1, task->n_polls);
     if (UCC_TL_UCP_TEAM_CTX(team)->cfg.pre_reg_mem) {
-        data_size =
-            (size_t)args->src.info.count * ucc_dt_size(args->src.info.datatype);
-        ucc_tl_ucp_pre_register_mem(team, args->src.info.buffer, data_size,
-                                    args->src.info.mem_type);
-        ucc_tl_ucp_pre_register_mem(team, args->dst.info.buffer, data_size,
-                                    args->dst.info.mem_type);
+        ucc_tl_ucp_pre_register_mem(
+            team, args->src.info.buffer,
+            (size_t)args->src.info.count *
+                ucc_coll_args_dt_extent(args, args->src.info.datatype, 1),
+            args->src.info.mem_type);
+        ucc_tl_ucp_pre_register_mem(
+            team, args->dst.info.buffer,
+            (size_t)args->dst.info.count *
+                ucc_coll_args_dt_extent(args, args->dst.info.datatype, 0),
+            args->dst.info.mem_type);
     }
 
     return UCC_OK;
@@ -7,6 +7,22 @@
 #include "config.h"
 #include "tl_ucp.h"
 #include "alltoallv.h"
+#include "alltoall/alltoall.h"
+
+ucc_base_coll_alg_info_t
+    ucc_tl_ucp_alltoallv_algs[UCC_TL_UCP_ALLTOALLV_ALG_LAST + 1] = {
+        [UCC_TL_UCP_ALLTOALLV_ALG_PAIRWISE] =
+            {.id   = UCC_TL_UCP_ALLTOALLV_ALG_PAIRWISE,
+             .name = "pairwise",
+             .desc = "pairwise exchange with every rank of the team"},
+        [UCC_TL_UCP_ALLTOALLV_ALG_NODE_AGG] =
+            {.id   = UCC_TL_UCP_ALLTOALLV_ALG_NODE_AGG,
+             .name = "node_agg",
+             .desc = "data of a node is aggregated on its leader, leaders "
+                     "exchange one message per pair of nodes (small blocks "
+                     "on many ranks per node)"},
+        [UCC_TL_UCP_ALLTOALLV_ALG_LAST] = {
+            .id = 0, .name = NULL, .desc = NULL}};
 
 ucc_status_t ucc_tl_ucp_alltoallv_pairwise_start(ucc_coll_task_t *task);
 ucc_status_t ucc_tl_ucp_alltoallv_pairwise_progress(ucc_coll_task_t *task);
@@ -30,9 +46,37 @@ ucc_status_t ucc_tl_ucp_alltoallv_pairwise_init(ucc_base_coll_args_t *coll_args,
     ucc_status_t       status;
 
     ALLTOALLV_TASK_CHECK(coll_args->args, tl_team);
-    task                 = ucc_tl_ucp_init_task(coll_args, team);
-    *task_h              = &task->super;
+    task   = ucc_tl_ucp_init_task(coll_args, team);
     status = ucc_tl_ucp_alltoallv_pairwise_init_common(task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        goto out;
+    }
+    *task_h = &task->super;
+out:
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_alltoallv_node_agg_init(ucc_base_coll_args_t *coll_args,
+                                                ucc_base_team_t      *team,
+                                                ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    ALLTOALLV_TASK_CHECK(coll_args->args, tl_team);
+    task = ucc_tl_ucp_init_task(coll_args, team);
+    if (ucc_tl_ucp_alltoall_node_agg_supported(tl_team, &coll_args->args)) {
+        status = ucc_tl_ucp_alltoall_node_agg_init_common(task);
+    } else {
+        status = ucc_tl_ucp_alltoallv_pairwise_init_common(task);
+    }
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        goto out;
+    }
+    *task_h = &task->super;
 out:
     return status;
 }
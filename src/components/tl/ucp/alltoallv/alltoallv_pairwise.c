@@ -10,6 +10,7 @@
 #include "core/ucc_progress_queue.h"
 #include "utils/ucc_math.h"
 #include "utils/ucc_coll_utils.h"
+#include "utils/ucc_malloc.h"
 #include "tl_ucp_sendrecv.h"
 
 static inline ucc_rank_t get_recv_peer(ucc_rank_t rank, ucc_rank_t size,
@@ -24,62 +25,114 @@ static inline ucc_rank_t get_send_peer(ucc_rank_t rank, ucc_rank_t size,
     return (rank - step + size) % size;
 }
 
+/* Appends the peers with nonzero blocks in pairwise order to peers and
+   their cumulative sizes in bytes on the wire to offset, returns the
+   number of peers */
+static ucc_rank_t build_schedule(ucc_tl_ucp_task_t *task, int is_send,
+                                 ucc_rank_t *peers, uint64_t *offset)
+{
+    ucc_coll_args_t          *args = &task->super.args;
+    ucc_tl_ucp_team_t        *team = TASK_TEAM(task);
+    ucc_coll_buffer_info_v_t *info = is_send ? &args->src.info_v
+                                             : &args->dst.info_v;
+    size_t                    dt_size =
+        ucc_coll_args_dt_size(args, info->datatype, is_send);
+    ucc_rank_t                n       = 0;
+    ucc_rank_t                step, peer;
+    size_t                    size;
+
+    offset[0] = 0;
+    for (step = 0; step < team->size; step++) {
+        peer = is_send ? get_send_peer(team->rank, team->size, step)
+                       : get_recv_peer(team->rank, team->size, step);
+        size = ucc_coll_args_get_count(args, info->counts, peer) * dt_size;
+        if (size == 0) {
+            continue;
+        }
+        peers[n]      = peer;
+        offset[n + 1] = offset[n] + size;
+        n++;
+    }
+    return n;
+}
+
+/* Next message of the schedule may be posted if both the number of
+   outstanding messages and their volume are within the limits. Messages
+   are assumed to complete in the order they were posted, so the volume
+   estimate is off by at most the largest message in flight. */
+static inline int can_post(uint32_t posted, uint32_t completed, ucc_rank_t n,
+                           uint32_t nreqs, const uint64_t *offset,
+                           size_t max_inflight)
+{
+    return (posted < n) && ((posted - completed) < nreqs) &&
+           ((posted == completed) ||
+            (offset[posted + 1] - offset[completed] <= max_inflight));
+}
+
 ucc_status_t ucc_tl_ucp_alltoallv_pairwise_progress(ucc_coll_task_t *coll_task)
 {
     ucc_tl_ucp_task_t *task  = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
     ucc_tl_ucp_team_t *team  = TASK_TEAM(task);
-    ptrdiff_t          sbuf  = (ptrdiff_t)coll_task->args.src.info_v.buffer;
-    ptrdiff_t          rbuf  = (ptrdiff_t)coll_task->args.dst.info_v.buffer;
-    ucc_memory_type_t  smem  = coll_task->args.src.info_v.mem_type;
-    ucc_memory_type_t  rmem  = coll_task->args.dst.info_v.mem_type;
-    ucc_rank_t         grank = team->rank;
+    ucc_coll_args_t   *args  = &coll_task->args;
+    ptrdiff_t          sbuf  = (ptrdiff_t)args->src.info_v.buffer;
+    ptrdiff_t          rbuf  = (ptrdiff_t)args->dst.info_v.buffer;
+    ucc_memory_type_t  smem  = args->src.info_v.mem_type;
+    ucc_memory_type_t  rmem  = args->dst.info_v.mem_type;
+    ucc_datatype_t     sdt   = args->src.info_v.datatype;
+    ucc_datatype_t     rdt   = args->dst.info_v.datatype;
     ucc_rank_t         gsize = team->size;
+    ucc_rank_t         nsend = task->alltoallv_pairwise.n_send;
+    ucc_rank_t         nrecv = task->alltoallv_pairwise.n_recv;
+    ucc_rank_t        *speer = task->alltoallv_pairwise.peers;
+    ucc_rank_t        *rpeer = speer + gsize;
+    uint64_t          *soff  = task->alltoallv_pairwise.offset;
+    uint64_t          *roff  = soff + gsize + 1;
+    size_t             window = team->cfg.alltoallv_pairwise_max_inflight;
     int                polls = 0;
     ucc_rank_t         peer;
-    int                posts, nreqs;//, count_stride, displ_stride;
-    size_t             rdt_size, sdt_size, data_size, data_displ;
+    uint32_t           posts, nreqs;
+    size_t             rdt_size, sdt_size, rdt_ext, sdt_ext;
+    size_t             data_size, data_displ;
 
-    posts    = UCC_TL_UCP_TEAM_LIB(team)->cfg.alltoallv_pairwise_num_posts;
+    posts    = team->cfg.alltoallv_pairwise_num_posts;
     nreqs    = (posts > gsize || posts == 0) ? gsize : posts;
-    rdt_size = ucc_dt_size(coll_task->args.src.info_v.datatype);
-    sdt_size = ucc_dt_size(coll_task->args.dst.info_v.datatype);
-    while ((task->send_posted < gsize || task->recv_posted < gsize) &&
+    rdt_size = ucc_coll_args_dt_size(args, rdt, 0);
+    sdt_size = ucc_coll_args_dt_size(args, sdt, 1);
+    rdt_ext  = ucc_coll_args_dt_extent(args, rdt, 0);
+    sdt_ext  = ucc_coll_args_dt_extent(args, sdt, 1);
+    while ((task->send_posted < nsend || task->recv_posted < nrecv) &&
            (polls++ < task->n_polls)) {
-        ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
-        while ((task->recv_posted < gsize) &&
-               ((task->recv_posted - task->recv_completed) < nreqs)) {
-            peer       = get_recv_peer(grank, gsize, task->recv_posted);
-            data_size =
-                ucc_coll_args_get_count(
-                    &coll_task->args, coll_task->args.dst.info_v.counts, peer) *
-                rdt_size;
+        ucp_worker_progress(task->worker->ucp_worker);
+        while (can_post(task->recv_posted, task->recv_completed, nrecv, nreqs,
+                        roff, window)) {
+            peer       = rpeer[task->recv_posted];
+            data_size  = roff[task->recv_posted + 1] - roff[task->recv_posted];
             data_displ = ucc_coll_args_get_displacement(
-                             &coll_task->args,
-                             coll_task->args.dst.info_v.displacements, peer) *
-                         rdt_size;
-            UCPCHECK_GOTO(ucc_tl_ucp_recv_nz((void *)(rbuf + data_displ),
-                                             data_size, rmem, peer, team, task),
+                             args, args->dst.info_v.displacements, peer) *
+                         rdt_ext;
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_elems((void *)(rbuf + data_displ),
+                                                data_size / rdt_size, rdt,
+                                                UCC_TL_UCP_DT_DST, rmem, peer,
+                                                team, task),
                           task, out);
             polls = 0;
         }
-        while ((task->send_posted < gsize) &&
-               ((task->send_posted - task->send_completed) < nreqs)) {
-            peer       = get_send_peer(grank, gsize, task->send_posted);
-            data_size =
-                ucc_coll_args_get_count(
-                    &coll_task->args, coll_task->args.src.info_v.counts, peer) *
-                sdt_size;
+        while (can_post(task->send_posted, task->send_completed, nsend, nreqs,
+                        soff, window)) {
+            peer       = speer[task->send_posted];
+            data_size  = soff[task->send_posted + 1] - soff[task->send_posted];
             data_displ = ucc_coll_args_get_displacement(
-                             &coll_task->args,
-                             coll_task->args.src.info_v.displacements, peer) *
-                         sdt_size;
-            UCPCHECK_GOTO(ucc_tl_ucp_send_nz((void *)(sbuf + data_displ),
-                                             data_size, smem, peer, team, task),
+                             args, args->src.info_v.displacements, peer) *
+                         sdt_ext;
+            UCPCHECK_GOTO(ucc_tl_ucp_send_elems((void *)(sbuf + data_displ),
+                                                data_size / sdt_size, sdt,
+                                                UCC_TL_UCP_DT_SRC, smem, peer,
+                                                team, task),
                           task, out);
             polls = 0;
         }
     }
-    if ((task->send_posted < gsize) || (task->recv_posted < gsize)) {
+    if ((task->send_posted < nsend) || (task->recv_posted < nrecv)) {
         return task->super.super.status;
     }
     task->super.super.status = ucc_tl_ucp_test(task);
@@ -100,6 +153,13 @@ ucc_status_t ucc_tl_ucp_alltoallv_pairwise_start(ucc_coll_task_t *coll_task)
     UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_alltoallv_pairwise_start",
                                      0);
     ucc_tl_ucp_task_reset(task);
+    /* counts of a persistent collective may change between the starts */
+    task->alltoallv_pairwise.n_send =
+        build_schedule(task, 1, task->alltoallv_pairwise.peers,
+                       task->alltoallv_pairwise.offset);
+    task->alltoallv_pairwise.n_recv =
+        build_schedule(task, 0, task->alltoallv_pairwise.peers + team->size,
+                       task->alltoallv_pairwise.offset + team->size + 1);
 
     ucc_tl_ucp_alltoallv_pairwise_progress(&task->super);
     if (UCC_INPROGRESS == task->super.super.status) {
@@ -109,13 +169,44 @@ ucc_status_t ucc_tl_ucp_alltoallv_pairwise_start(ucc_coll_task_t *coll_task)
     return ucc_task_complete(coll_task);
 }
 
+static ucc_status_t
+ucc_tl_ucp_alltoallv_pairwise_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    ucc_free(task->alltoallv_pairwise.peers);
+    ucc_free(task->alltoallv_pairwise.offset);
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
 ucc_status_t ucc_tl_ucp_alltoallv_pairwise_init_common(ucc_tl_ucp_task_t *task)
 {
     ucc_tl_ucp_team_t *team = TASK_TEAM(task);
     ucc_coll_args_t   *args = &task->super.args;
+    ucc_status_t       status;
 
     task->super.post     = ucc_tl_ucp_alltoallv_pairwise_start;
     task->super.progress = ucc_tl_ucp_alltoallv_pairwise_progress;
+    task->super.finalize = ucc_tl_ucp_alltoallv_pairwise_finalize;
+
+    status = ucc_tl_ucp_task_dt_init(task, args->src.info_v.datatype,
+                                     args->src.info_v.mem_type,
+                                     args->dst.info_v.datatype,
+                                     args->dst.info_v.mem_type);
+    if (UCC_OK != status) {
+        return status;
+    }
+
+    task->alltoallv_pairwise.peers =
+        ucc_malloc(2 * team->size * sizeof(ucc_rank_t), "a2av_peers");
+    task->alltoallv_pairwise.offset =
+        ucc_malloc(2 * (team->size + 1) * sizeof(uint64_t), "a2av_offset");
+    if (!task->alltoallv_pairwise.peers || !task->alltoallv_pairwise.offset) {
+        tl_error(UCC_TASK_LIB(task), "failed to allocate alltoallv schedule");
+        ucc_free(task->alltoallv_pairwise.peers);
+        ucc_free(task->alltoallv_pairwise.offset);
+        return UCC_ERR_NO_MEMORY;
+    }
 
     task->n_polls = ucc_min(1, task->n_polls);
     if (UCC_TL_UCP_TEAM_CTX(team)->cfg.pre_reg_mem) {
@@ -124,7 +215,8 @@ ucc_status_t ucc_tl_ucp_alltoallv_pairwise_init_common(ucc_tl_ucp_task_t *task)
                 team, args->src.info_v.buffer,
                 (ucc_coll_args_get_total_count(args, args->src.info_v.counts,
                                                team->size) *
-                 ucc_dt_size(args->src.info_v.datatype)),
+                 ucc_coll_args_dt_extent(args, args->src.info_v.datatype,
+                                         1)),
                 args->src.info_v.mem_type);
         }
 
@@ -133,7 +225,8 @@ ucc_status_t ucc_tl_ucp_alltoallv_pairwise_init_common(ucc_tl_ucp_task_t *task)
                 team, args->dst.info_v.buffer,
                 (ucc_coll_args_get_total_count(args, args->dst.info_v.counts,
                                                team->size) *
-                 ucc_dt_size(args->dst.info_v.datatype)),
+                 ucc_coll_args_dt_extent(args, args->dst.info_v.datatype,
+                                         0)),
                 args->dst.info_v.mem_type);
         }
     }
@@ -12,7 +12,12 @@ ucc_status_t ucc_tl_ucp_barrier_knomial_progress(ucc_coll_task_t *task);
 
 ucc_status_t ucc_tl_ucp_barrier_init(ucc_tl_ucp_task_t *task)
 {
-    task->super.post     = ucc_tl_ucp_barrier_knomial_start;
-    task->super.progress = ucc_tl_ucp_barrier_knomial_progress;
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+
+    task->super.post      = ucc_tl_ucp_barrier_knomial_start;
+    task->super.progress  = ucc_tl_ucp_barrier_knomial_progress;
+    task->barrier.p.radix = ucc_tl_ucp_kn_radix(
+        team, team->cfg.barrier_kn_radix, UCC_KN_PATTERN_EXCHANGE,
+        team->size, 0);
     return UCC_OK;
 }
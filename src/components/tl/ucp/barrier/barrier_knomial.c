@@ -109,10 +109,10 @@ ucc_status_t ucc_tl_ucp_barrier_knomial_start(ucc_coll_task_t *coll_task)
 
     UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_barrier_kn_start", 0);
     task->barrier.phase = UCC_KN_PHASE_INIT;
-    ucc_knomial_pattern_init(team->size, team->rank,
-                             ucc_min(UCC_TL_UCP_TEAM_LIB(team)->
-                                     cfg.barrier_kn_radix, team->size),
+    ucc_knomial_pattern_init(team->size, team->rank, task->barrier.p.radix,
                              &task->barrier.p);
+    ucc_tl_ucp_kn_pattern_set_table(team, team->size, team->rank,
+                                    &task->barrier.p);
     task->super.super.status = UCC_INPROGRESS;
     status = ucc_tl_ucp_barrier_knomial_progress(&task->super);
     if (UCC_INPROGRESS == status) {
@@ -10,4 +10,9 @@
 
 ucc_status_t ucc_tl_ucp_bcast_init(ucc_tl_ucp_task_t *task);
 
+/* Pipeline of knomial bcasts, one per partition of the buffer */
+ucc_status_t ucc_tl_ucp_bcast_partitioned_init(ucc_base_coll_args_t *coll_args,
+                                               ucc_base_team_t      *team,
+                                               ucc_coll_task_t     **task_h);
+
 #endif
@@ -76,8 +76,10 @@ ucc_status_t ucc_tl_ucp_bcast_knomial_start(ucc_coll_task_t *coll_task)
     UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_bcast_kn_start", 0);
     ucc_tl_ucp_task_reset(task);
 
-    task->bcast_kn.radix =
-        ucc_min(UCC_TL_UCP_TEAM_LIB(team)->cfg.bcast_kn_radix, team->size);
+    task->bcast_kn.radix = ucc_tl_ucp_kn_radix(
+        team, team->cfg.bcast_kn_radix, UCC_KN_PATTERN_TREE, team->size,
+        coll_task->args.src.info.count *
+        ucc_dt_size(coll_task->args.src.info.datatype));
     CALC_KN_TREE_DIST(team->size, task->bcast_kn.radix, task->bcast_kn.dist);
 
     status = ucc_tl_ucp_bcast_knomial_progress(&task->super);
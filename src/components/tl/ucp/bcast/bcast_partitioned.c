@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "bcast.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+
+/* Partitioned bcast: pipelined schedule with a knomial bcast per
+   partition of the buffer. The root starts the bcast of a partition
+   when the partition is marked ready, the other ranks post the receives
+   of PARTITION_PIPELINE_DEPTH partitions right away. */
+
+static ucc_status_t
+ucc_tl_ucp_bcast_partitioned_frag_start(ucc_coll_task_t *task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(task, ucc_schedule_t);
+
+    return ucc_schedule_start(schedule);
+}
+
+static ucc_status_t
+ucc_tl_ucp_bcast_partitioned_frag_finalize(ucc_coll_task_t *task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(task, ucc_schedule_t);
+    ucc_status_t    status;
+
+    status = ucc_schedule_finalize(task);
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_bcast_partitioned_frag_setup(
+    ucc_schedule_pipelined_t *schedule_p, ucc_schedule_t *frag, int frag_num)
+{
+    ucc_tl_ucp_team_t *team    = ucc_derived_of(schedule_p->super.super.team,
+                                                ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args    = &schedule_p->super.super.args;
+    size_t             dt_size = ucc_dt_size(args->src.info.datatype);
+    int                n_parts = schedule_p->super.n_tasks;
+    ucc_tl_ucp_task_t *task    = ucc_derived_of(frag->tasks[0],
+                                                ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *targs   = &frag->tasks[0]->args;
+
+    targs->src.info.buffer = PTR_OFFSET(
+        args->src.info.buffer,
+        ucc_buffer_block_offset(args->src.info.count, n_parts, frag_num) *
+            dt_size);
+    targs->src.info.count =
+        ucc_buffer_block_count(args->src.info.count, n_parts, frag_num);
+    if (team->n_lanes > 1) {
+        task->worker = team->lanes[frag_num % team->n_lanes];
+    }
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_tl_ucp_bcast_partitioned_frag_init(
+    ucc_base_coll_args_t     *coll_args,
+    ucc_schedule_pipelined_t *sp, //NOLINT
+    ucc_base_team_t *team, ucc_schedule_t **frag_p)
+{
+    ucc_tl_ucp_team_t *tl_team  = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_schedule_t    *schedule = ucc_tl_ucp_get_schedule(tl_team);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    ucc_schedule_init(schedule, &coll_args->args, team);
+    task   = ucc_tl_ucp_init_task(coll_args, team);
+    status = ucc_tl_ucp_bcast_init(task);
+    if (UCC_OK != status) {
+        ucc_tl_ucp_put_task(task);
+        goto err;
+    }
+    status = ucc_schedule_add_task(schedule, &task->super);
+    if (UCC_OK != status) {
+        ucc_tl_ucp_put_task(task);
+        goto err;
+    }
+    status = ucc_task_subscribe_dep(&schedule->super, &task->super,
+                                    UCC_EVENT_SCHEDULE_STARTED);
+    if (UCC_OK != status) {
+        goto err_finalize;
+    }
+    schedule->super.finalize = ucc_tl_ucp_bcast_partitioned_frag_finalize;
+    schedule->super.post     = ucc_tl_ucp_bcast_partitioned_frag_start;
+    *frag_p                  = schedule;
+    return UCC_OK;
+err_finalize:
+    ucc_schedule_finalize(&schedule->super);
+err:
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+static ucc_status_t
+ucc_tl_ucp_bcast_partitioned_finalize(ucc_coll_task_t *task)
+{
+    ucc_schedule_pipelined_t *schedule =
+        ucc_derived_of(task, ucc_schedule_pipelined_t);
+    ucc_status_t status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(schedule, "ucp_bcast_part_done", 0);
+    status = ucc_schedule_pipelined_finalize(task);
+    ucc_tl_ucp_put_schedule_pipelined(schedule);
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_bcast_partitioned_start(ucc_coll_task_t *task)
+{
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(task, "ucp_bcast_part_start", 0);
+    return ucc_schedule_pipelined_post(task);
+}
+
+ucc_status_t ucc_tl_ucp_bcast_partitioned_init(ucc_base_coll_args_t *coll_args,
+                                               ucc_base_team_t      *team,
+                                               ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t        *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t          *args    = &coll_args->args;
+    int                       n_parts = (int)args->n_partitions;
+    ucc_schedule_pipelined_t *schedule_p;
+    int                       depth;
+    ucc_status_t              status;
+
+    if (args->n_partitions > args->src.info.count) {
+        tl_debug(team->context->lib, "number of partitions %lu exceeds "
+                 "count %lu", (unsigned long)args->n_partitions,
+                 (unsigned long)args->src.info.count);
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    schedule_p = ucc_tl_ucp_get_schedule_pipelined(tl_team);
+    if (!schedule_p) {
+        tl_error(team->context->lib, "failed to allocate pipelined schedule");
+        return UCC_ERR_NO_MEMORY;
+    }
+    depth  = ucc_min(ucc_min(n_parts,
+                             ucc_max(tl_team->cfg.partition_pipeline_depth, 1)),
+                     UCC_SCHEDULE_PIPELINED_MAX_FRAGS);
+    status = ucc_schedule_pipelined_init(
+        coll_args, team, ucc_tl_ucp_bcast_partitioned_frag_init,
+        ucc_tl_ucp_bcast_partitioned_frag_setup, depth, n_parts, 0,
+        schedule_p);
+    if (UCC_OK != status) {
+        tl_error(team->context->lib, "failed to init pipelined schedule");
+        ucc_tl_ucp_put_schedule_pipelined(schedule_p);
+        return status;
+    }
+    /* only the root waits for the partitions, the other ranks receive */
+    status = ucc_schedule_pipelined_set_partitioned(
+        schedule_p, args->root == tl_team->rank);
+    if (UCC_OK != status) {
+        ucc_schedule_pipelined_finalize(&schedule_p->super.super);
+        ucc_tl_ucp_put_schedule_pipelined(schedule_p);
+        return status;
+    }
+    schedule_p->super.super.finalize       =
+        ucc_tl_ucp_bcast_partitioned_finalize;
+    schedule_p->super.super.triggered_post = ucc_tl_ucp_triggered_post;
+    schedule_p->super.super.post           = ucc_tl_ucp_bcast_partitioned_start;
+    *task_h                                = &schedule_p->super.super;
+    return UCC_OK;
+}
@@ -21,34 +21,47 @@ ucc_status_t ucc_tl_ucp_reduce_init(ucc_tl_ucp_task_t *task)
     ucc_rank_t         vrank     = (myrank - root + team_size) % team_size;
     ucc_status_t       status    = UCC_OK;
     ucc_memory_type_t  mtype;
+    ucc_datatype_t     dt;
     size_t             data_size;
     int                isleaf;
 
     if (root == myrank) {
         data_size = args->dst.info.count * ucc_dt_size(args->dst.info.datatype);
         mtype = args->dst.info.mem_type;
+        dt    = args->dst.info.datatype;
     } else {
         data_size = args->src.info.count * ucc_dt_size(args->src.info.datatype);
         mtype = args->src.info.mem_type;
+        dt    = args->src.info.datatype;
+    }
+    if ((args->mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) &&
+        (UCC_OK != ucc_dt_reduce_userdefined_check(args, dt, mtype))) {
+        tl_error(UCC_TL_TEAM_LIB(team), "userdefined reductions are supported "
+                 "only for host memory and predefined datatypes");
+        return UCC_ERR_NOT_SUPPORTED;
     }
     task->super.post      = ucc_tl_ucp_reduce_knomial_start;
     task->super.progress  = ucc_tl_ucp_reduce_knomial_progress;
     task->super.finalize  = ucc_tl_ucp_reduce_knomial_finalize;
-    task->reduce_kn.radix =
-        ucc_min(UCC_TL_UCP_TEAM_LIB(team)->cfg.reduce_kn_radix, team->size);
+    task->reduce_kn.radix = ucc_tl_ucp_kn_radix(
+        team, team->cfg.reduce_kn_radix, UCC_KN_PATTERN_TREE,
+        team->size, data_size);
     CALC_KN_TREE_DIST(team->size, task->reduce_kn.radix,
                       task->reduce_kn.max_dist);
     isleaf = (vrank % task->reduce_kn.radix != 0 || vrank == team_size - 1);
-    task->reduce_kn.scratch_mc_header = NULL;
+    task->reduce_kn.scratch_buf = NULL;
 
     if (!isleaf) {
     	/* scratch of size radix to fit up to radix - 1 recieved vectors
     	from its children at each step,
     	and an additional 1 for previous step reduce multi result */
-        status = ucc_mc_alloc(&task->reduce_kn.scratch_mc_header,
-                              task->reduce_kn.radix * data_size, mtype);
-        task->reduce_kn.scratch =
-                        task->reduce_kn.scratch_mc_header->addr;
+        status = ucc_scratch_get(&team->scratch,
+                                 task->reduce_kn.radix * data_size,
+                                 mtype, &task->reduce_kn.scratch_buf);
+        if (UCC_OK != status) {
+            return status;
+        }
+        task->reduce_kn.scratch = task->reduce_kn.scratch_buf->addr;
     }
     return status;
 }
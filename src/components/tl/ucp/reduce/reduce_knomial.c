@@ -155,8 +155,9 @@ ucc_status_t ucc_tl_ucp_reduce_knomial_finalize(ucc_coll_task_t *coll_task)
     ucc_tl_ucp_task_t *task      =
         ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
 
-    if (task->reduce_kn.scratch_mc_header) {
-        ucc_mc_free(task->reduce_kn.scratch_mc_header);
+    if (task->reduce_kn.scratch_buf) {
+        ucc_scratch_put(&TASK_TEAM(task)->scratch,
+                        task->reduce_kn.scratch_buf);
     }
     return ucc_tl_ucp_coll_finalize(coll_task);
 }
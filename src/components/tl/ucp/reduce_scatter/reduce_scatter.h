@@ -19,4 +19,13 @@ ucc_tl_ucp_reduce_scatter_knomial_init(ucc_base_coll_args_t *coll_args,
 ucc_status_t ucc_tl_ucp_reduce_scatter_knomial_init_r(
     ucc_base_coll_args_t *coll_args, ucc_base_team_t *team,
     ucc_coll_task_t **task_h, ucc_kn_radix_t radix);
+
+/* Switches KN reduce scatter of fp32 SUM to the lossy 16 bit wire format:
+   segments are converted to wire_dt before sending and accumulated in fp32
+   on receive. On completion the wire buffer additionally holds the local
+   result converted to wire_dt at its allgather offset, optional error
+   feedback residual is set in task->reduce_scatter_kn.ef. */
+ucc_status_t
+ucc_tl_ucp_reduce_scatter_knomial_set_wire_dt(ucc_coll_task_t *task,
+                                              ucc_datatype_t   wire_dt);
 #endif
@@ -19,6 +19,40 @@
         task->reduce_scatter_kn.phase = _phase;                                \
     } while (0)
 
+static inline int ucc_tl_ucp_rs_kn_overlap(const void *a, size_t a_len,
+                                           const void *b, size_t b_len)
+{
+    return ((ptrdiff_t)a < (ptrdiff_t)b + (ptrdiff_t)b_len) &&
+           ((ptrdiff_t)b < (ptrdiff_t)a + (ptrdiff_t)a_len);
+}
+
+/* Compressed mode: the wire buffer holds count 16 bit elements of the data
+   being sent (the quantized local result at the end) followed by the
+   receive area */
+static inline void *ucc_tl_ucp_rs_kn_wire_recv(ucc_tl_ucp_task_t *task,
+                                               size_t count)
+{
+    return PTR_OFFSET(task->reduce_scatter_kn.wire_buf->addr,
+                      count * ucc_dt_size(task->reduce_scatter_kn.wire_dt));
+}
+
+static inline ucc_status_t
+ucc_tl_ucp_rs_kn_compress(ucc_tl_ucp_task_t *task, void *wire,
+                          const void *src, size_t offset, size_t count,
+                          ucc_memory_type_t mem_type)
+{
+    float       *ef = task->reduce_scatter_kn.ef;
+    ucc_status_t status;
+
+    status = ucc_mc_compress(wire, src, ef ? ef + offset : NULL, count,
+                             task->reduce_scatter_kn.wire_dt, mem_type);
+    if (ucc_unlikely(UCC_OK != status)) {
+        tl_error(UCC_TASK_LIB(task), "failed to compress data");
+        task->super.super.status = status;
+    }
+    return status;
+}
+
 ucc_status_t
 ucc_tl_ucp_reduce_scatter_knomial_progress(ucc_coll_task_t *coll_task)
 {
@@ -39,12 +73,19 @@ ucc_tl_ucp_reduce_scatter_knomial_progress(ucc_coll_task_t *coll_task)
     size_t                 data_size = count * dt_size;
     ucc_rank_t             size      = team->size;
     ucc_rank_t             rank      = team->rank;
+    int                    compress  = (task->reduce_scatter_kn.wire_buf != NULL);
+    ucc_datatype_t         wire_dt   = task->reduce_scatter_kn.wire_dt;
+    size_t                 wire_size = compress ? ucc_dt_size(wire_dt) : dt_size;
+    void                  *wire      = compress ?
+        task->reduce_scatter_kn.wire_buf->addr : NULL;
     ptrdiff_t              peer_seg_offset, local_seg_offset, offset;
     ucc_rank_t             peer, step_radix, peer_seg_index, local_seg_index;
     ucc_status_t           status;
     ucc_kn_radix_t         loop_step;
     size_t                 block_count, peer_seg_count, local_seg_count;
-    void                  *reduce_data, *local_data;
+    size_t                 n_vectors, seg_size, stride;
+    void                  *reduce_data, *local_data, *final_data, *send_data;
+    int                    result_in_dst = 0;
 
     local_seg_count = 0;
     block_count     = ucc_sra_kn_compute_block_count(count, rank, p);
@@ -52,15 +93,25 @@ ucc_tl_ucp_reduce_scatter_knomial_progress(ucc_coll_task_t *coll_task)
 
     if (KN_NODE_EXTRA == node_type) {
         peer = ucc_knomial_pattern_get_proxy(p, rank);
+        if (compress) {
+            if (UCC_OK != (status = ucc_tl_ucp_rs_kn_compress(
+                               task, wire, sbuf, 0, count, mem_type))) {
+                return status;
+            }
+            sbuf = wire;
+        }
         UCPCHECK_GOTO(
-            ucc_tl_ucp_send_nb(sbuf, data_size, mem_type, peer, team, task),
+            ucc_tl_ucp_send_nb(sbuf, count * wire_size, mem_type, peer, team,
+                               task),
             task, out);
     }
 
     if (KN_NODE_PROXY == node_type) {
         peer = ucc_knomial_pattern_get_extra(p, rank);
         UCPCHECK_GOTO(
-            ucc_tl_ucp_recv_nb(scratch, data_size, mem_type, peer, team, task),
+            ucc_tl_ucp_recv_nb(compress ? ucc_tl_ucp_rs_kn_wire_recv(task, count)
+                                        : scratch,
+                               count * wire_size, mem_type, peer, team, task),
             task, out);
     }
 
@@ -73,8 +124,15 @@ UCC_KN_PHASE_EXTRA:
         if (KN_NODE_EXTRA == node_type) {
             goto out;
         } else {
-            if (UCC_OK != (status = ucc_dt_reduce(sbuf, scratch, rbuf, count,
-                                                  dt, mem_type, args))) {
+            if (compress) {
+                status = ucc_mc_reduce_multi_decompress(
+                    sbuf, ucc_tl_ucp_rs_kn_wire_recv(task, count), rbuf, 1,
+                    count, 0, wire_dt, mem_type);
+            } else {
+                status = ucc_dt_reduce(sbuf, scratch, rbuf, count, dt,
+                                       mem_type, args);
+            }
+            if (UCC_OK != status) {
                 tl_error(UCC_TASK_LIB(task), "failed to perform dt reduction");
                 task->super.super.status = status;
                 return status;
@@ -93,35 +151,50 @@ UCC_KN_PHASE_EXTRA:
             if (peer == UCC_KN_PEER_NULL)
                 continue;
 
-            peer_seg_index =
-                ucc_sra_kn_compute_seg_index(peer, p->radix_pow, p);
+            peer_seg_index = ucc_sra_kn_get_seg_index(p, peer, loop_step);
             peer_seg_count = ucc_sra_kn_compute_seg_size(
                 block_count, step_radix, peer_seg_index);
             peer_seg_offset = ucc_sra_kn_compute_seg_offset(
                 block_count, step_radix, peer_seg_index);
+            send_data = PTR_OFFSET(sbuf, peer_seg_offset * dt_size);
+            if (compress) {
+                /* segments of a step are disjoint, each is quantized into
+                   its own place of the wire buffer */
+                if (UCC_OK != (status = ucc_tl_ucp_rs_kn_compress(
+                                   task,
+                                   PTR_OFFSET(wire, peer_seg_offset * wire_size),
+                                   send_data,
+                                   task->reduce_scatter_kn.block_offset +
+                                       peer_seg_offset,
+                                   peer_seg_count, mem_type))) {
+                    return status;
+                }
+                send_data = PTR_OFFSET(wire, peer_seg_offset * wire_size);
+            }
             UCPCHECK_GOTO(
-                ucc_tl_ucp_send_nb(PTR_OFFSET(sbuf, peer_seg_offset * dt_size),
-                                   peer_seg_count * dt_size, mem_type, peer,
-                                   team, task),
+                ucc_tl_ucp_send_nb(send_data, peer_seg_count * wire_size,
+                                   mem_type, peer, team, task),
                 task, out);
         }
 
-        local_seg_index = ucc_sra_kn_compute_seg_index(rank, p->radix_pow, p);
+        local_seg_index = ucc_sra_kn_get_seg_index(p, rank, 0);
         local_seg_count = ucc_sra_kn_compute_seg_size(block_count, step_radix,
                                                       local_seg_index);
 
         rbuf = task->reduce_scatter_kn.scratch;
-        if (p->iteration != 0) {
+        if (compress) {
+            rbuf = ucc_tl_ucp_rs_kn_wire_recv(task, count);
+        } else if (p->iteration != 0) {
             rbuf = PTR_OFFSET(rbuf, block_count * dt_size);
         }
         for (loop_step = 1; loop_step < radix; loop_step++) {
             peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, loop_step);
             if (peer == UCC_KN_PEER_NULL)
                 continue;
-            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(rbuf, local_seg_count * dt_size,
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(rbuf, local_seg_count * wire_size,
                                              mem_type, peer, team, task),
                           task, out);
-            rbuf = PTR_OFFSET(rbuf, local_seg_count * dt_size);
+            rbuf = PTR_OFFSET(rbuf, local_seg_count * wire_size);
         }
     UCC_KN_PHASE_LOOP:
         if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
@@ -133,39 +206,81 @@ UCC_KN_PHASE_EXTRA:
                 ? ((KN_NODE_PROXY == node_type  || UCC_IS_INPLACE(*args)) ?
                    args->dst.info.buffer : args->src.info.buffer)
                              : task->reduce_scatter_kn.scratch;
-            rbuf       = (p->iteration != 0)
-                             ? PTR_OFFSET(task->reduce_scatter_kn.scratch,
-                                    block_count * dt_size)
-                             : task->reduce_scatter_kn.scratch;
+            if (compress) {
+                rbuf = ucc_tl_ucp_rs_kn_wire_recv(task, count);
+            } else {
+                rbuf = (p->iteration != 0)
+                           ? PTR_OFFSET(task->reduce_scatter_kn.scratch,
+                                        block_count * dt_size)
+                           : task->reduce_scatter_kn.scratch;
+            }
             step_radix = ucc_sra_kn_compute_step_radix(rank, size, p);
-            local_seg_index =
-                ucc_sra_kn_compute_seg_index(rank, p->radix_pow, p);
+            local_seg_index = ucc_sra_kn_get_seg_index(p, rank, 0);
             local_seg_count = ucc_sra_kn_compute_seg_size(
                 block_count, step_radix, local_seg_index);
             local_seg_offset = ucc_sra_kn_compute_seg_offset(
                 block_count, step_radix, local_seg_index);
             local_data  = PTR_OFFSET(sbuf, local_seg_offset * dt_size);
             reduce_data = task->reduce_scatter_kn.scratch;
-            if (UCC_OK != (status = ucc_dt_reduce_multi(
-                               local_data, rbuf, reduce_data,
-                               task->send_posted - p->iteration * (radix - 1),
-                               local_seg_count, local_seg_count * dt_size, dt,
-                               mem_type, args))) {
+            n_vectors   = task->send_posted - p->iteration * (radix - 1);
+            seg_size    = local_seg_count * dt_size;
+            stride      = local_seg_count * wire_size;
+            if (p->iteration == p->pow_radix_sup - 1) {
+                /* Last step: write the result straight to its final
+                   location instead of reducing into scratch and copying
+                   it afterwards, unless the destination overlaps the
+                   reduction inputs */
+                offset     = ucc_sra_kn_pattern_get_offset(count, dt_size,
+                                                           rank, size, p);
+                final_data = PTR_OFFSET(args->dst.info.buffer, offset);
+                if (!ucc_tl_ucp_rs_kn_overlap(final_data, seg_size, rbuf,
+                                              n_vectors * stride) &&
+                    ((final_data == local_data) ||
+                     !ucc_tl_ucp_rs_kn_overlap(final_data, seg_size,
+                                               local_data, seg_size))) {
+                    reduce_data   = final_data;
+                    result_in_dst = 1;
+                }
+            }
+            if (compress) {
+                status = ucc_mc_reduce_multi_decompress(
+                    local_data, rbuf, reduce_data, n_vectors, local_seg_count,
+                    stride, wire_dt, mem_type);
+            } else {
+                status = ucc_dt_reduce_multi(local_data, rbuf, reduce_data,
+                                             n_vectors, local_seg_count,
+                                             stride, dt, mem_type, args);
+            }
+            if (UCC_OK != status) {
                 tl_error(UCC_TASK_LIB(task), "failed to perform dt reduction");
                 task->super.super.status = status;
                 return status;
             }
+            task->reduce_scatter_kn.block_offset += local_seg_offset;
         }
         ucc_knomial_pattern_next_iteration(p);
     }
 
-    offset = ucc_sra_kn_get_offset(count, dt_size, rank, size, radix);
-    status = ucc_mc_memcpy(PTR_OFFSET(args->dst.info.buffer, offset),
-                           task->reduce_scatter_kn.scratch,
-                           local_seg_count * dt_size, mem_type, mem_type);
+    offset = ucc_sra_kn_pattern_get_offset(count, dt_size, rank, size, p);
+    if (!result_in_dst) {
+        status = ucc_mc_memcpy(PTR_OFFSET(args->dst.info.buffer, offset),
+                               task->reduce_scatter_kn.scratch,
+                               local_seg_count * dt_size, mem_type, mem_type);
 
-    if (UCC_OK != status) {
-        return status;
+        if (UCC_OK != status) {
+            return status;
+        }
+    }
+    if (compress) {
+        /* leave the quantized local result in the wire buffer for the
+           allgather, so that all ranks end up with identical data */
+        if (UCC_OK != (status = ucc_tl_ucp_rs_kn_compress(
+                           task,
+                           PTR_OFFSET(wire, offset / dt_size * wire_size),
+                           PTR_OFFSET(args->dst.info.buffer, offset),
+                           offset / dt_size, local_seg_count, mem_type))) {
+            return status;
+        }
     }
 UCC_KN_PHASE_PROXY: /* unused label */
 out:
@@ -190,11 +305,14 @@ ucc_status_t ucc_tl_ucp_reduce_scatter_knomial_start(ucc_coll_task_t *coll_task)
     ucc_knomial_pattern_init(team->size, team->rank,
                              task->reduce_scatter_kn.p.radix,
                              &task->reduce_scatter_kn.p);
+    ucc_tl_ucp_kn_pattern_set_table(team, team->size, team->rank,
+                                    &task->reduce_scatter_kn.p);
     node_type = task->reduce_scatter_kn.p.node_type;
     if (!(UCC_IS_INPLACE(*args) || (KN_NODE_PROXY == node_type))) {
         task->reduce_scatter_kn.scratch = args->dst.info.buffer;
     }
-    task->reduce_scatter_kn.phase = UCC_KN_PHASE_INIT;
+    task->reduce_scatter_kn.phase        = UCC_KN_PHASE_INIT;
+    task->reduce_scatter_kn.block_offset = 0;
 
     status = ucc_tl_ucp_reduce_scatter_knomial_progress(&task->super);
     if (UCC_INPROGRESS == status) {
@@ -211,7 +329,12 @@ ucc_tl_ucp_reduce_scatter_knomial_finalize(ucc_coll_task_t *coll_task)
     uint8_t            node_type = task->reduce_scatter_kn.p.node_type;
 
     if (UCC_IS_INPLACE(coll_task->args) || (KN_NODE_PROXY == node_type)) {
-        ucc_mc_free(task->reduce_scatter_kn.scratch_mc_header);
+        ucc_scratch_put(&TASK_TEAM(task)->scratch,
+                        task->reduce_scatter_kn.scratch_buf);
+    }
+    if (task->reduce_scatter_kn.wire_buf) {
+        ucc_scratch_put(&TASK_TEAM(task)->scratch,
+                        task->reduce_scatter_kn.wire_buf);
     }
     return ucc_tl_ucp_coll_finalize(coll_task);
 }
@@ -239,22 +362,49 @@ ucc_status_t ucc_tl_ucp_reduce_scatter_knomial_init_r(
     ucc_assert(coll_args->args.src.info.mem_type ==
                coll_args->args.dst.info.mem_type);
     ucc_knomial_pattern_init(size, rank, radix, &task->reduce_scatter_kn.p);
+    task->reduce_scatter_kn.wire_buf = NULL;
+    task->reduce_scatter_kn.ef       = NULL;
 
     if (UCC_IS_INPLACE(coll_args->args) ||
         (KN_NODE_PROXY == task->reduce_scatter_kn.p.node_type)) {
-        status = ucc_mc_alloc(&task->reduce_scatter_kn.scratch_mc_header,
-                              data_size, mem_type);
-        task->reduce_scatter_kn.scratch =
-            task->reduce_scatter_kn.scratch_mc_header->addr;
+        status = ucc_scratch_get(&tl_team->scratch, data_size,
+                                 mem_type,
+                                 &task->reduce_scatter_kn.scratch_buf);
         if (UCC_OK != status) {
+            ucc_tl_ucp_put_task(task);
             return status;
         }
+        task->reduce_scatter_kn.scratch =
+            task->reduce_scatter_kn.scratch_buf->addr;
     }
 
     *task_h = &task->super;
     return UCC_OK;
 }
 
+ucc_status_t
+ucc_tl_ucp_reduce_scatter_knomial_set_wire_dt(ucc_coll_task_t *coll_task,
+                                              ucc_datatype_t   wire_dt)
+{
+    ucc_tl_ucp_task_t *task  = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args  = &coll_task->args;
+    size_t             count = args->dst.info.count;
+    ucc_status_t       status;
+
+    ucc_assert(UCC_DT_FLOAT32 == args->dst.info.datatype);
+    /* send area of count elements + receive area, segments received in
+       one step may add up to count + radix elements */
+    status = ucc_scratch_get(
+        &TASK_TEAM(task)->scratch,
+        (2 * count + task->reduce_scatter_kn.p.radix) * ucc_dt_size(wire_dt),
+        args->dst.info.mem_type, &task->reduce_scatter_kn.wire_buf);
+    if (UCC_OK != status) {
+        return status;
+    }
+    task->reduce_scatter_kn.wire_dt = wire_dt;
+    return UCC_OK;
+}
+
 ucc_status_t
 ucc_tl_ucp_reduce_scatter_knomial_init(ucc_base_coll_args_t *coll_args,
                                        ucc_base_team_t *     team,
@@ -265,8 +415,10 @@ ucc_tl_ucp_reduce_scatter_knomial_init(ucc_base_coll_args_t *coll_args,
     size_t             count   = coll_args->args.dst.info.count;
     ucc_kn_radix_t     radix;
 
-    radix = ucc_min(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.reduce_scatter_kn_radix,
-                    size);
+    radix = ucc_tl_ucp_kn_radix(tl_team, tl_team->cfg.reduce_scatter_kn_radix,
+                                UCC_KN_PATTERN_SCATTER, size,
+                                count * ucc_dt_size(
+                                            coll_args->args.dst.info.datatype));
     if (((count + radix - 1) / radix * (radix - 1) > count) ||
         ((radix - 1) > count)) {
         radix = 2;
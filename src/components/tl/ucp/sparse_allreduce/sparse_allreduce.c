@@ -0,0 +1,58 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+#include "config.h"
+#include "tl_ucp.h"
+#include "sparse_allreduce.h"
+
+ucc_status_t ucc_tl_ucp_sparse_allreduce_init(ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t   *args = &task->super.args;
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    size_t             dt_size;
+    unsigned long      pct;
+
+    if (!(args->mask & UCC_COLL_ARGS_FIELD_SPARSE) ||
+        UCC_IS_INPLACE(*args) ||
+        (args->mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) ||
+        args->reduce.predefined_op != UCC_OP_SUM ||
+        args->src.info.mem_type != UCC_MEMORY_TYPE_HOST ||
+        args->dst.info.mem_type != UCC_MEMORY_TYPE_HOST) {
+        tl_error(UCC_TL_TEAM_LIB(team), "sparse allreduce is supported only "
+                 "for SUM of host memory vectors, not inplace");
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    switch (args->dst.info.datatype) {
+    case UCC_DT_INT32:
+    case UCC_DT_UINT32:
+    case UCC_DT_INT64:
+    case UCC_DT_UINT64:
+    case UCC_DT_FLOAT32:
+    case UCC_DT_FLOAT64:
+        break;
+    default:
+        tl_error(UCC_TL_TEAM_LIB(team), "sparse allreduce doesn't support %s",
+                 ucc_datatype_str(args->dst.info.datatype));
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    dt_size = ucc_dt_size(args->dst.info.datatype);
+    pct     = team->cfg.sparse_allreduce_dense_pct;
+    if (pct == UCC_ULUNITS_AUTO) {
+        /* densify once (index, value) encoding outgrows dense vector */
+        task->sparse_allreduce.max_nnz =
+            args->sparse.dense_count * dt_size / (sizeof(uint64_t) + dt_size);
+    } else {
+        task->sparse_allreduce.max_nnz =
+            (pct >= 100) ? args->sparse.dense_count
+                         : args->sparse.dense_count * pct / 100;
+    }
+    task->super.post     = ucc_tl_ucp_sparse_allreduce_rd_start;
+    task->super.progress = ucc_tl_ucp_sparse_allreduce_rd_progress;
+    task->super.finalize = ucc_tl_ucp_sparse_allreduce_rd_finalize;
+    task->sparse_allreduce.buf       = NULL;
+    task->sparse_allreduce.recv_buf  = NULL;
+    task->sparse_allreduce.dense_buf = NULL;
+    return UCC_OK;
+}
@@ -0,0 +1,38 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+#ifndef SPARSE_ALLREDUCE_H_
+#define SPARSE_ALLREDUCE_H_
+#include "../tl_ucp.h"
+#include "../tl_ucp_coll.h"
+#include "core/ucc_mc.h"
+
+/* nnz header value announcing a dense vector of dense_count elements */
+#define UCC_TL_UCP_SPARSE_DENSE UINT64_MAX
+
+/* Steps of the recursive doubling exchange, extra ranks of non power of 2
+   teams hand their vector to the proxy and get the result back */
+enum {
+    UCC_SPARSE_ALLREDUCE_STEP_EXTRA,
+    UCC_SPARSE_ALLREDUCE_STEP_LOOP,
+    UCC_SPARSE_ALLREDUCE_STEP_PROXY,
+    UCC_SPARSE_ALLREDUCE_STEP_DONE
+};
+
+/* Every step exchanges nnz header first, then the payload of the announced
+   size */
+enum {
+    UCC_SPARSE_ALLREDUCE_PHASE_START,
+    UCC_SPARSE_ALLREDUCE_PHASE_HDR,
+    UCC_SPARSE_ALLREDUCE_PHASE_DATA
+};
+
+ucc_status_t ucc_tl_ucp_sparse_allreduce_init(ucc_tl_ucp_task_t *task);
+
+ucc_status_t ucc_tl_ucp_sparse_allreduce_rd_start(ucc_coll_task_t *task);
+ucc_status_t ucc_tl_ucp_sparse_allreduce_rd_progress(ucc_coll_task_t *task);
+ucc_status_t ucc_tl_ucp_sparse_allreduce_rd_finalize(ucc_coll_task_t *task);
+
+#endif
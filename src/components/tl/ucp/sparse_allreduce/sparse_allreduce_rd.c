@@ -0,0 +1,439 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "sparse_allreduce.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "coll_patterns/recursive_knomial.h"
+#include "utils/ucc_math.h"
+#include "core/ucc_mc.h"
+
+/* Recursive doubling sparse allreduce. Every rank keeps its partial result
+   either as sorted (index, value) lists or, once the number of nonzeros
+   exceeds max_nnz, as a dense vector. Each exchange starts with the nnz
+   header so that the receiver can size the payload and pick the combine
+   kernel: sparse + sparse is a merge, anything with a dense operand is
+   accumulated into the dense vector. Partners of a recursive doubling step
+   end up with the same vector, so they take the dense switch together.
+
+   Sparse vectors live in scratch buffers holding nnz indices followed by nnz
+   values. The dense vector is the user dst buffer when dense output is
+   requested. */
+
+#define SPARSE_TASK_ARGS(_task) (&(_task)->super.args)
+#define SPARSE_DT(_task) (SPARSE_TASK_ARGS(_task)->dst.info.datatype)
+#define SPARSE_DENSE_SIZE(_task)                                               \
+    (SPARSE_TASK_ARGS(_task)->sparse.dense_count *                             \
+     ucc_dt_size(SPARSE_DT(_task)))
+
+static inline size_t ucc_tl_ucp_sparse_size(uint64_t nnz, ucc_datatype_t dt)
+{
+    return nnz * (sizeof(uint64_t) + ucc_dt_size(dt));
+}
+
+static inline void ucc_tl_ucp_sparse_release(ucc_tl_ucp_task_t     *task,
+                                             ucc_scratch_t        **buf)
+{
+    if (*buf) {
+        ucc_scratch_put(&TASK_TEAM(task)->scratch, *buf);
+        *buf = NULL;
+    }
+}
+
+static ucc_status_t ucc_tl_ucp_sparse_get_dense(ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t *args = SPARSE_TASK_ARGS(task);
+    ucc_status_t     status;
+
+    if (task->sparse_allreduce.dense) {
+        return UCC_OK;
+    }
+    if (!args->sparse.dst_indices) {
+        task->sparse_allreduce.dense = args->dst.info.buffer;
+        return UCC_OK;
+    }
+    status = ucc_scratch_get(&TASK_TEAM(task)->scratch,
+                             SPARSE_DENSE_SIZE(task),
+                             UCC_MEMORY_TYPE_HOST,
+                             &task->sparse_allreduce.dense_buf);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    task->sparse_allreduce.dense = task->sparse_allreduce.dense_buf->addr;
+    return UCC_OK;
+}
+
+/* converts local sparse vector to dense one */
+static ucc_status_t ucc_tl_ucp_sparse_densify(ucc_tl_ucp_task_t *task)
+{
+    ucc_status_t status;
+
+    status = ucc_tl_ucp_sparse_get_dense(task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    memset(task->sparse_allreduce.dense, 0, SPARSE_DENSE_SIZE(task));
+    status = ucc_mc_sparse_to_dense(
+        task->sparse_allreduce.dense, task->sparse_allreduce.idx,
+        task->sparse_allreduce.val, task->sparse_allreduce.nnz, SPARSE_DT(task),
+        UCC_MEMORY_TYPE_HOST);
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.buf);
+    task->sparse_allreduce.nnz = UCC_TL_UCP_SPARSE_DENSE;
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_sparse_post_data(ucc_tl_ucp_task_t *task,
+                                                ucc_rank_t peer, int do_send,
+                                                int do_recv, int replace)
+{
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_datatype_t     dt       = SPARSE_DT(task);
+    size_t             dt_size  = ucc_dt_size(dt);
+    uint64_t           nnz      = task->sparse_allreduce.nnz;
+    uint64_t           peer_nnz = task->sparse_allreduce.peer_nnz;
+    ucc_memory_type_t  mt       = UCC_MEMORY_TYPE_HOST;
+    void              *rbuf;
+    ucc_status_t       status;
+
+    if (do_send) {
+        if (nnz == UCC_TL_UCP_SPARSE_DENSE) {
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(task->sparse_allreduce.dense,
+                                             SPARSE_DENSE_SIZE(task), mt, peer,
+                                             team, task),
+                          task, out);
+        } else if (nnz > 0) {
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(task->sparse_allreduce.idx,
+                                             nnz * sizeof(uint64_t), mt, peer,
+                                             team, task),
+                          task, out);
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(task->sparse_allreduce.val,
+                                             nnz * dt_size, mt, peer, team,
+                                             task),
+                          task, out);
+        }
+    }
+    if (!do_recv) {
+        return UCC_OK;
+    }
+    if (peer_nnz == UCC_TL_UCP_SPARSE_DENSE) {
+        if (nnz == UCC_TL_UCP_SPARSE_DENSE && !replace) {
+            /* own dense vector is being sent */
+            status = ucc_scratch_get(&team->scratch,
+                                     SPARSE_DENSE_SIZE(task), mt,
+                                     &task->sparse_allreduce.recv_buf);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+            rbuf = task->sparse_allreduce.recv_buf->addr;
+        } else {
+            status = ucc_tl_ucp_sparse_get_dense(task);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+            rbuf = task->sparse_allreduce.dense;
+        }
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(rbuf, SPARSE_DENSE_SIZE(task), mt,
+                                         peer, team, task),
+                      task, out);
+    } else if (peer_nnz > 0) {
+        status = ucc_scratch_get(&team->scratch,
+                                 ucc_tl_ucp_sparse_size(peer_nnz, dt),
+                                 mt, &task->sparse_allreduce.recv_buf);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        rbuf = task->sparse_allreduce.recv_buf->addr;
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(rbuf, peer_nnz * sizeof(uint64_t), mt,
+                                         peer, team, task),
+                      task, out);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(
+                          PTR_OFFSET(rbuf, peer_nnz * sizeof(uint64_t)),
+                          peer_nnz * dt_size, mt, peer, team, task),
+                      task, out);
+    }
+    return UCC_OK;
+out:
+    return task->super.super.status;
+}
+
+/* combines received vector with the local one, or replaces the local one
+   with it on the extra rank */
+static ucc_status_t ucc_tl_ucp_sparse_combine(ucc_tl_ucp_task_t *task,
+                                              int                replace)
+{
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_datatype_t     dt       = SPARSE_DT(task);
+    ucc_memory_type_t  mt       = UCC_MEMORY_TYPE_HOST;
+    uint64_t           nnz      = task->sparse_allreduce.nnz;
+    uint64_t           peer_nnz = task->sparse_allreduce.peer_nnz;
+    ucc_status_t       status   = UCC_OK;
+    ucc_scratch_t        *merged;
+    uint64_t             *peer_idx = NULL;
+    void                 *peer_val = NULL;
+    size_t                n;
+
+    if (task->sparse_allreduce.recv_buf) {
+        peer_idx = task->sparse_allreduce.recv_buf->addr;
+        peer_val = PTR_OFFSET(peer_idx, peer_nnz * sizeof(uint64_t));
+    }
+    if (peer_nnz == UCC_TL_UCP_SPARSE_DENSE) {
+        if (replace) {
+            /* received directly into the dense vector */
+        } else if (nnz == UCC_TL_UCP_SPARSE_DENSE) {
+            status = ucc_mc_reduce(task->sparse_allreduce.dense, peer_idx,
+                                   task->sparse_allreduce.dense,
+                                   SPARSE_TASK_ARGS(task)->sparse.dense_count,
+                                   dt, UCC_OP_SUM, mt);
+        } else {
+            status = ucc_mc_sparse_to_dense(task->sparse_allreduce.dense,
+                                            task->sparse_allreduce.idx,
+                                            task->sparse_allreduce.val, nnz,
+                                            dt, mt);
+        }
+        ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.buf);
+        task->sparse_allreduce.nnz = UCC_TL_UCP_SPARSE_DENSE;
+    } else if (replace) {
+        ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.buf);
+        task->sparse_allreduce.buf      = task->sparse_allreduce.recv_buf;
+        task->sparse_allreduce.recv_buf = NULL;
+        task->sparse_allreduce.idx      = peer_idx;
+        task->sparse_allreduce.val      = peer_val;
+        task->sparse_allreduce.nnz      = peer_nnz;
+    } else if (nnz == UCC_TL_UCP_SPARSE_DENSE) {
+        status = ucc_mc_sparse_to_dense(task->sparse_allreduce.dense, peer_idx,
+                                        peer_val, peer_nnz, dt, mt);
+    } else if (peer_nnz > 0) {
+        status = ucc_scratch_get(&team->scratch,
+                                 ucc_tl_ucp_sparse_size(nnz + peer_nnz,
+                                                        dt),
+                                 mt, &merged);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        status = ucc_mc_reduce_sparse(
+            task->sparse_allreduce.idx, task->sparse_allreduce.val, nnz,
+            peer_idx, peer_val, peer_nnz, merged->addr,
+            PTR_OFFSET(merged->addr, (nnz + peer_nnz) * sizeof(uint64_t)), &n,
+            dt, mt);
+        ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.buf);
+        task->sparse_allreduce.buf = merged;
+        task->sparse_allreduce.idx = merged->addr;
+        task->sparse_allreduce.val =
+            PTR_OFFSET(merged->addr, (nnz + peer_nnz) * sizeof(uint64_t));
+        task->sparse_allreduce.nnz = n;
+        if (UCC_OK == status && n > task->sparse_allreduce.max_nnz) {
+            status = ucc_tl_ucp_sparse_densify(task);
+        }
+    }
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.recv_buf);
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_sparse_output(ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t *args   = SPARSE_TASK_ARGS(task);
+    uint64_t         nnz    = task->sparse_allreduce.nnz;
+    size_t           n      = 0;
+    ucc_status_t     status = UCC_OK;
+
+    if (!args->sparse.dst_indices) {
+        if (nnz != UCC_TL_UCP_SPARSE_DENSE) {
+            status = ucc_tl_ucp_sparse_densify(task);
+        }
+        n = args->sparse.dense_count;
+    } else if (nnz == UCC_TL_UCP_SPARSE_DENSE) {
+        status = ucc_mc_dense_to_sparse(
+            args->sparse.dst_indices, args->dst.info.buffer, &n,
+            args->dst.info.count, task->sparse_allreduce.dense,
+            args->sparse.dense_count, SPARSE_DT(task), UCC_MEMORY_TYPE_HOST);
+    } else if (nnz > args->dst.info.count) {
+        status = UCC_ERR_NO_RESOURCE;
+    } else {
+        memcpy(args->sparse.dst_indices, task->sparse_allreduce.idx,
+               nnz * sizeof(uint64_t));
+        memcpy(args->dst.info.buffer, task->sparse_allreduce.val,
+               nnz * ucc_dt_size(SPARSE_DT(task)));
+        n = nnz;
+    }
+    if (UCC_ERR_NO_RESOURCE == status) {
+        tl_error(UCC_TASK_LIB(task), "sparse allreduce result doesn't fit "
+                 "dst count %zu", (size_t)args->dst.info.count);
+    }
+    *args->sparse.dst_nnz = n;
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_sparse_allreduce_rd_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t     *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    ucc_knomial_pattern_t *p    = &task->sparse_allreduce.p;
+    ucc_rank_t             size = (ucc_rank_t)task->subset.map.ep_num;
+    ucc_rank_t             rank = task->subset.myrank;
+    int                    do_send, do_recv, replace;
+    ucc_rank_t             peer;
+    ucc_status_t           status;
+
+    while (task->sparse_allreduce.step != UCC_SPARSE_ALLREDUCE_STEP_DONE) {
+        replace = 0;
+        switch (task->sparse_allreduce.step) {
+        case UCC_SPARSE_ALLREDUCE_STEP_EXTRA:
+            if (KN_NODE_EXTRA == p->node_type) {
+                peer    = ucc_knomial_pattern_get_proxy(p, rank);
+                do_send = 1;
+                do_recv = 0;
+            } else if (KN_NODE_PROXY == p->node_type) {
+                peer    = ucc_knomial_pattern_get_extra(p, rank);
+                do_send = 0;
+                do_recv = 1;
+            } else {
+                task->sparse_allreduce.step = UCC_SPARSE_ALLREDUCE_STEP_LOOP;
+                continue;
+            }
+            break;
+        case UCC_SPARSE_ALLREDUCE_STEP_LOOP:
+            if (KN_NODE_EXTRA == p->node_type ||
+                ucc_knomial_pattern_loop_done(p)) {
+                task->sparse_allreduce.step = UCC_SPARSE_ALLREDUCE_STEP_PROXY;
+                continue;
+            }
+            peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, 1);
+            if (peer == UCC_KN_PEER_NULL) {
+                ucc_knomial_pattern_next_iteration(p);
+                continue;
+            }
+            do_send = 1;
+            do_recv = 1;
+            break;
+        default:
+            if (KN_NODE_PROXY == p->node_type) {
+                peer    = ucc_knomial_pattern_get_extra(p, rank);
+                do_send = 1;
+                do_recv = 0;
+            } else if (KN_NODE_EXTRA == p->node_type) {
+                peer    = ucc_knomial_pattern_get_proxy(p, rank);
+                do_send = 0;
+                do_recv = 1;
+                replace = 1;
+            } else {
+                task->sparse_allreduce.step = UCC_SPARSE_ALLREDUCE_STEP_DONE;
+                continue;
+            }
+            break;
+        }
+        peer = ucc_ep_map_eval(task->subset.map, peer);
+
+        switch (task->sparse_allreduce.phase) {
+        case UCC_SPARSE_ALLREDUCE_PHASE_START:
+            if (do_send) {
+                UCPCHECK_GOTO(ucc_tl_ucp_send_nb(&task->sparse_allreduce.nnz,
+                                                 sizeof(uint64_t),
+                                                 UCC_MEMORY_TYPE_HOST, peer,
+                                                 team, task),
+                              task, out);
+            }
+            if (do_recv) {
+                UCPCHECK_GOTO(
+                    ucc_tl_ucp_recv_nb(&task->sparse_allreduce.peer_nnz,
+                                       sizeof(uint64_t), UCC_MEMORY_TYPE_HOST,
+                                       peer, team, task),
+                    task, out);
+            }
+            task->sparse_allreduce.phase = UCC_SPARSE_ALLREDUCE_PHASE_HDR;
+            /* fall through */
+        case UCC_SPARSE_ALLREDUCE_PHASE_HDR:
+            if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+                return task->super.super.status;
+            }
+            status = ucc_tl_ucp_sparse_post_data(task, peer, do_send, do_recv,
+                                                 replace);
+            if (ucc_unlikely(UCC_OK != status)) {
+                task->super.super.status = status;
+                goto out;
+            }
+            task->sparse_allreduce.phase = UCC_SPARSE_ALLREDUCE_PHASE_DATA;
+            /* fall through */
+        default:
+            if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+                return task->super.super.status;
+            }
+            if (do_recv) {
+                status = ucc_tl_ucp_sparse_combine(task, replace);
+                if (ucc_unlikely(UCC_OK != status)) {
+                    tl_error(UCC_TASK_LIB(task),
+                             "failed to combine sparse vectors");
+                    task->super.super.status = status;
+                    goto out;
+                }
+            }
+            task->sparse_allreduce.phase = UCC_SPARSE_ALLREDUCE_PHASE_START;
+            if (task->sparse_allreduce.step == UCC_SPARSE_ALLREDUCE_STEP_LOOP) {
+                ucc_knomial_pattern_next_iteration(p);
+            } else {
+                task->sparse_allreduce.step++;
+            }
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.super.status = ucc_tl_ucp_sparse_output(task);
+out:
+    return task->super.super.status;
+}
+
+ucc_status_t ucc_tl_ucp_sparse_allreduce_rd_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_coll_args_t   *args = &coll_task->args;
+    ucc_rank_t         size = (ucc_rank_t)task->subset.map.ep_num;
+    ucc_rank_t         rank = task->subset.myrank;
+    ucc_status_t       status;
+
+    /* buffers of a previous run of a persistent collective */
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.buf);
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.dense_buf);
+    task->sparse_allreduce.step  = UCC_SPARSE_ALLREDUCE_STEP_EXTRA;
+    task->sparse_allreduce.phase = UCC_SPARSE_ALLREDUCE_PHASE_START;
+    task->sparse_allreduce.nnz   = args->src.info.count;
+    task->sparse_allreduce.idx   = args->sparse.src_indices;
+    task->sparse_allreduce.val   = args->src.info.buffer;
+    task->sparse_allreduce.dense = NULL;
+    ucc_knomial_pattern_init(size, rank, 2, &task->sparse_allreduce.p);
+    ucc_tl_ucp_kn_pattern_set_table(team, size, rank,
+                                    &task->sparse_allreduce.p);
+    ucc_tl_ucp_task_reset(task);
+    if (task->sparse_allreduce.nnz > task->sparse_allreduce.max_nnz) {
+        status = ucc_tl_ucp_sparse_densify(task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+
+    status = ucc_tl_ucp_sparse_allreduce_rd_progress(&task->super);
+    if (UCC_INPROGRESS == status) {
+        ucc_progress_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+        return UCC_OK;
+    }
+    return ucc_task_complete(coll_task);
+}
+
+ucc_status_t ucc_tl_ucp_sparse_allreduce_rd_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_status_t       st, global_st = UCC_OK;
+
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.buf);
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.recv_buf);
+    ucc_tl_ucp_sparse_release(task, &task->sparse_allreduce.dense_buf);
+    st = ucc_tl_ucp_coll_finalize(&task->super);
+    if (ucc_unlikely(st != UCC_OK)) {
+        tl_error(UCC_TASK_LIB(task), "failed finalize collective");
+        global_st = st;
+    }
+    return global_st;
+}
@@ -9,12 +9,20 @@
 #include "core/ucc_mc.h"
 #include "components/mc/base/ucc_mc_base.h"
 #include "allreduce/allreduce.h"
+#include "alltoall/alltoall.h"
+#include "alltoallv/alltoallv.h"
 
 ucc_status_t ucc_tl_ucp_get_lib_attr(const ucc_base_lib_t *lib,
                                      ucc_base_lib_attr_t  *base_attr);
 ucc_status_t ucc_tl_ucp_get_context_attr(const ucc_base_context_t *context,
                                          ucc_base_ctx_attr_t      *base_attr);
 
+static const char *ucc_tl_ucp_compress_names[] = {
+    [UCC_TL_UCP_COMPRESS_NONE] = "none",
+    [UCC_TL_UCP_COMPRESS_FP16] = "fp16",
+    [UCC_TL_UCP_COMPRESS_BF16] = "bf16",
+    [UCC_TL_UCP_COMPRESS_LAST] = NULL};
+
 static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
     {"", "", NULL, ucc_offsetof(ucc_tl_ucp_lib_config_t, super),
      UCC_CONFIG_TYPE_TABLE(ucc_tl_lib_config_table)},
@@ -25,32 +33,53 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoall_pairwise_num_posts),
      UCC_CONFIG_TYPE_UINT},
 
-    {"ALLTOALLV_PAIRWISE_NUM_POSTS", "1",
+    {"ALLTOALLV_PAIRWISE_NUM_POSTS", "0",
      "Maximum number of outstanding send and receive messages in alltoallv "
-     "pairwise algorithm",
+     "pairwise algorithm, 0 - no limit. Peers with zero counts are skipped "
+     "and do not take part in the limit",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoallv_pairwise_num_posts),
      UCC_CONFIG_TYPE_UINT},
 
+    {"ALLTOALLV_PAIRWISE_MAX_INFLIGHT", "1M",
+     "Maximum number of bytes of outstanding sends, and separately of "
+     "outstanding receives, in alltoallv pairwise algorithm. A message "
+     "larger than the limit is posted alone, inf - no limit",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoallv_pairwise_max_inflight),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"ALLTOALL_NODE_AGG_THRESH", "0",
+     "Maximal block size of alltoall which uses the node aggregated "
+     "algorithm by default: ranks send their data to the node leader, "
+     "leaders exchange one message per pair of nodes and scatter the result "
+     "on the node. Used only by teams spanning several nodes with more than "
+     "one rank per node, 0 disables. Alltoallv selects it with "
+     "\"alltoallv:@node_agg\" in TUNE",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoall_node_agg_thresh),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {"KN_RADIX", "0",
      "Radix of all algorithms based on knomial pattern. When set to a "
      "positive value it is used as a convinience parameter to set all "
-     "other KN_RADIX values",
+     "other KN_RADIX values\n"
+     "auto value of the other KN_RADIX parameters - radix is selected for "
+     "every collective from the message size and the team shape by a cost "
+     "model using KN_LINK_LATENCY, KN_SEND_OVERHEAD and PIPELINE_BW",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, kn_radix), UCC_CONFIG_TYPE_UINT},
 
     {"BARRIER_KN_RADIX", "4",
      "Radix of the recursive-knomial barrier algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, barrier_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {"ALLREDUCE_KN_RADIX", "4",
      "Radix of the recursive-knomial allreduce algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {"ALLREDUCE_SRA_KN_RADIX", "4",
      "Radix of the scatter-reduce-allgather (SRA) knomial allreduce algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {"ALLREDUCE_SRA_KN_FRAG_THRESH", "inf",
      "Threshold to enable fragmentation and pipelining of SRA Knomial "
@@ -59,7 +88,11 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      UCC_CONFIG_TYPE_MEMUNITS},
 
     {"ALLREDUCE_SRA_KN_FRAG_SIZE", "inf",
-     "Maximum allowed fragment size of SRA knomial alg",
+     "Maximum allowed fragment size of SRA knomial alg\n"
+     "auto - number of fragments and pipeline depth are selected from the "
+     "message size and the team size using PIPELINE_FRAG_LATENCY and "
+     "PIPELINE_BW, ALLREDUCE_SRA_KN_N_FRAGS and "
+     "ALLREDUCE_SRA_KN_PIPELINE_DEPTH are ignored",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_frag_size),
      UCC_CONFIG_TYPE_MEMUNITS},
 
@@ -81,25 +114,97 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_seq),
      UCC_CONFIG_TYPE_BOOL},
 
+    {"ALLREDUCE_SRA_KN_COMPRESS", "none",
+     "Lossy wire format of float32 SUM host allreduce with SRA knomial alg: "
+     "data is sent as 16 bit floats and accumulated in float32\n"
+     "none - no compression\n"
+     "fp16 - IEEE half precision, 10 bit mantissa, limited range\n"
+     "bf16 - bfloat16, float32 range, 7 bit mantissa",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_compress),
+     UCC_CONFIG_TYPE_ENUM(ucc_tl_ucp_compress_names)},
+
+    {"ALLREDUCE_SRA_KN_ERROR_FEEDBACK", "n",
+     "Keep per team and buffer residuals of the allreduce compression and add "
+     "them to the data of the next allreduce on the same buffer",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_error_feedback),
+     UCC_CONFIG_TYPE_BOOL},
+
+    {"PIPELINE_FRAG_LATENCY", "20us",
+     "Fixed cost of a fragment of a pipelined collective, used by the "
+     "automatic pipeline selection. The value measured by a team is "
+     "reported in the debug log when the team is destroyed",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, pipeline_frag_latency),
+     UCC_CONFIG_TYPE_TIME},
+
+    {"PIPELINE_BW", "10GBps",
+     "Bandwidth of a fragment of a pipelined collective, used by the "
+     "automatic pipeline and radix selection. Ranks of a node share it when "
+     "the team spans several nodes",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, pipeline_bw),
+     UCC_CONFIG_TYPE_BW},
+
+    {"PARTITION_PIPELINE_DEPTH", "4",
+     "Number of partitions of a partitioned collective progressed "
+     "simultaneously",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, partition_pipeline_depth),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"KN_LINK_LATENCY", "2us",
+     "Latency of a single step of a knomial algorithm, used by the automatic "
+     "radix selection",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, kn_link_latency),
+     UCC_CONFIG_TYPE_TIME},
+
+    {"KN_SEND_OVERHEAD", "1us",
+     "Cost of posting a single message, used by the automatic radix "
+     "selection. Every step of a knomial algorithm sends radix - 1 messages",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, kn_send_overhead),
+     UCC_CONFIG_TYPE_TIME},
+
+    {"MULTI_CTX_STRIPE_THRESH", "256k",
+     "Message size threshold above which collectives of a team created over "
+     "multiple contexts are fragmented and the fragments are distributed "
+     "round-robin across the workers of all the team contexts",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, multi_ctx_stripe_thresh),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"SCRATCH_ARENA_MAX", "64m",
+     "Maximal amount of memory cached by the per-team scratch arena used by "
+     "the knomial reduction algorithms, 0 - disable caching",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, scratch_arena_max),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {"REDUCE_SCATTER_KN_RADIX", "4",
      "Radix of the knomial reduce-scatter algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_scatter_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {"ALLGATHER_KN_RADIX", "4", "Radix of the knomial allgather algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allgather_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {"BCAST_KN_RADIX", "4", "Radix of the recursive-knomial bcast algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, bcast_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {"REDUCE_KN_RADIX", "4", "Radix of the knomial tree reduce algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_kn_radix),
-     UCC_CONFIG_TYPE_UINT},
+     UCC_CONFIG_TYPE_ULUNITS},
+
+    {"SPARSE_ALLREDUCE_DENSE_PCT", "auto",
+     "Density in percent of the dense vector size above which sparse "
+     "allreduce switches from (index, value) lists to dense vectors, "
+     "auto - when the dense vector becomes smaller than the lists",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, sparse_allreduce_dense_pct),
+     UCC_CONFIG_TYPE_ULUNITS},
 
     {NULL}};
 
+static const char *ucc_tl_ucp_worker_bind_names[] = {
+    [UCC_TL_UCP_WORKER_BIND_TEAM]   = "team",
+    [UCC_TL_UCP_WORKER_BIND_COLL]   = "coll",
+    [UCC_TL_UCP_WORKER_BIND_LAST]   = NULL};
+
 static ucs_config_field_t ucc_tl_ucp_context_config_table[] = {
     {"", "", NULL, ucc_offsetof(ucc_tl_ucp_context_config_t, super),
      UCC_CONFIG_TYPE_TABLE(ucc_tl_context_config_table)},
@@ -124,6 +229,29 @@ static ucs_config_field_t ucc_tl_ucp_context_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_context_config_t, pre_reg_mem),
      UCC_CONFIG_TYPE_UINT},
 
+    {"WORKER_POOL_SIZE", "1",
+     "Number of UCP workers created by the context. Additional workers are "
+     "only created in UCC_THREAD_MULTIPLE mode. Must be the same on all the "
+     "processes",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, worker_pool_size),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"WORKER_POOL_BIND", "team",
+     "Binding of collective tasks to the pool workers:\n"
+     "team - each team uses a single worker selected by team id\n"
+     "coll - collectives of a team are spread over the workers by their "
+     "tag, so that concurrent collectives do not share a worker",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, worker_pool_bind),
+     UCC_CONFIG_TYPE_ENUM(ucc_tl_ucp_worker_bind_names)},
+
+    {"TUNE_FILE", "",
+     "Tuning file generated by ucc_tune. The TUNE string and the TL/UCP "
+     "parameters of the file section matching the number of nodes and ppn "
+     "of a team are applied to the team, UCC_TL_UCP_TUNE takes precedence "
+     "over the file",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, tune_file),
+     UCC_CONFIG_TYPE_STRING},
+
     {NULL}};
 
 UCC_CLASS_DEFINE_NEW_FUNC(ucc_tl_ucp_lib_t, ucc_base_lib_t,
@@ -132,6 +260,13 @@ UCC_CLASS_DEFINE_NEW_FUNC(ucc_tl_ucp_lib_t, ucc_base_lib_t,
 
 UCC_CLASS_DEFINE_DELETE_FUNC(ucc_tl_ucp_lib_t, ucc_base_lib_t);
 
+ucc_status_t ucc_tl_ucp_lib_config_set(ucc_tl_ucp_lib_config_t *cfg,
+                                       const char *name, const char *value)
+{
+    return ucc_config_parser_set_value(cfg, ucc_tl_ucp_lib_config_table, name,
+                                       value);
+}
+
 UCC_CLASS_DEFINE_NEW_FUNC(ucc_tl_ucp_context_t, ucc_base_context_t,
                           const ucc_base_context_params_t *,
                           const ucc_base_config_t *);
@@ -222,4 +357,9 @@ __attribute__((constructor)) static void tl_ucp_iface_init(void)
     ucc_tl_ucp.super.scoll.update_id = ucc_tl_ucp_service_update_id;
     ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_ALLREDUCE)] =
         ucc_tl_ucp_allreduce_algs;
+    ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_ALLTOALL)] =
+        ucc_tl_ucp_alltoall_algs;
+    ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_ALLTOALLV)] =
+        ucc_tl_ucp_alltoallv_algs;
+    ucc_tl_ucp.super.alg_id_to_init = ucc_tl_ucp_alg_id_to_init;
 }
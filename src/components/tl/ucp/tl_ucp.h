@@ -9,8 +9,12 @@
 #include "components/tl/ucc_tl.h"
 #include "components/tl/ucc_tl_log.h"
 #include "core/ucc_ee.h"
+#include "schedule/ucc_schedule_pipelined.h"
 #include "utils/ucc_mpool.h"
 #include "tl_ucp_ep_hash.h"
+#include "utils/ucc_scratch.h"
+#include "tl_ucp_compress.h"
+#include "utils/ucc_tune_file.h"
 #include <ucp/api/ucp.h>
 #include <ucs/memory/memory_type.h>
 
@@ -35,33 +39,65 @@ typedef struct ucc_tl_ucp_iface {
 /* Extern iface should follow the pattern: ucc_tl_<tl_name> */
 extern ucc_tl_ucp_iface_t ucc_tl_ucp;
 
+typedef enum ucc_tl_ucp_compress {
+    UCC_TL_UCP_COMPRESS_NONE,
+    UCC_TL_UCP_COMPRESS_FP16,
+    UCC_TL_UCP_COMPRESS_BF16,
+    UCC_TL_UCP_COMPRESS_LAST
+} ucc_tl_ucp_compress_t;
+
 typedef struct ucc_tl_ucp_lib_config {
-    ucc_tl_lib_config_t super;
-    uint32_t            kn_radix;
-    uint32_t            barrier_kn_radix;
-    uint32_t            allreduce_kn_radix;
-    uint32_t            allreduce_sra_kn_radix;
-    uint32_t            reduce_scatter_kn_radix;
-    uint32_t            allgather_kn_radix;
-    uint32_t            bcast_kn_radix;
-    uint32_t            reduce_kn_radix;
-    uint32_t            alltoall_pairwise_num_posts;
-    uint32_t            alltoallv_pairwise_num_posts;
-    uint32_t            allreduce_sra_kn_n_frags;
-    uint32_t            allreduce_sra_kn_pipeline_depth;
-    int                 allreduce_sra_kn_seq;
-    size_t              allreduce_sra_kn_frag_thresh;
-    size_t              allreduce_sra_kn_frag_size;
+    ucc_tl_lib_config_t   super;
+    uint32_t              kn_radix;
+    unsigned long         barrier_kn_radix;
+    unsigned long         allreduce_kn_radix;
+    unsigned long         allreduce_sra_kn_radix;
+    unsigned long         reduce_scatter_kn_radix;
+    unsigned long         allgather_kn_radix;
+    unsigned long         bcast_kn_radix;
+    unsigned long         reduce_kn_radix;
+    uint32_t              alltoall_pairwise_num_posts;
+    uint32_t              alltoallv_pairwise_num_posts;
+    size_t                alltoallv_pairwise_max_inflight;
+    size_t                alltoall_node_agg_thresh;
+    uint32_t              allreduce_sra_kn_n_frags;
+    uint32_t              allreduce_sra_kn_pipeline_depth;
+    int                   allreduce_sra_kn_seq;
+    ucc_tl_ucp_compress_t allreduce_sra_kn_compress;
+    int                   allreduce_sra_kn_error_feedback;
+    size_t                allreduce_sra_kn_frag_thresh;
+    size_t                allreduce_sra_kn_frag_size;
+    double                pipeline_frag_latency;
+    double                pipeline_bw;
+    uint32_t              partition_pipeline_depth;
+    double                kn_link_latency;
+    double                kn_send_overhead;
+    size_t                multi_ctx_stripe_thresh;
+    size_t                scratch_arena_max;
+    unsigned long         sparse_allreduce_dense_pct;
 } ucc_tl_ucp_lib_config_t;
 
+typedef enum ucc_tl_ucp_worker_bind {
+    UCC_TL_UCP_WORKER_BIND_TEAM,
+    UCC_TL_UCP_WORKER_BIND_COLL,
+    UCC_TL_UCP_WORKER_BIND_LAST
+} ucc_tl_ucp_worker_bind_t;
+
 typedef struct ucc_tl_ucp_context_config {
-    ucc_tl_context_config_t super;
-    uint32_t                preconnect;
-    uint32_t                n_polls;
-    uint32_t                oob_npolls;
-    uint32_t                pre_reg_mem;
+    ucc_tl_context_config_t  super;
+    uint32_t                 preconnect;
+    uint32_t                 n_polls;
+    uint32_t                 oob_npolls;
+    uint32_t                 pre_reg_mem;
+    uint32_t                 worker_pool_size;
+    ucc_tl_ucp_worker_bind_t worker_pool_bind;
+    char                    *tune_file;
 } ucc_tl_ucp_context_config_t;
 
+/* Sets a lib parameter given by its name without the UCC_TL_UCP_ prefix */
+ucc_status_t ucc_tl_ucp_lib_config_set(ucc_tl_ucp_lib_config_t *cfg,
+                                       const char *name, const char *value);
+
 typedef struct ucc_tl_ucp_lib {
     ucc_tl_lib_t            super;
     ucc_tl_ucp_lib_config_t cfg;
@@ -69,31 +105,102 @@ typedef struct ucc_tl_ucp_lib {
 UCC_CLASS_DECLARE(ucc_tl_ucp_lib_t, const ucc_base_lib_params_t *,
                   const ucc_base_config_t *);
 
+typedef struct ucc_tl_ucp_context ucc_tl_ucp_context_t;
+
+/* UCP worker together with the endpoints created on it. Tasks post their
+   p2p operations on task->worker, which by default is the worker the
+   team is bound to. */
+typedef struct ucc_tl_ucp_worker {
+    ucc_tl_ucp_context_t *ctx; /*< tl context owning the worker */
+    int                   id;  /*< index of the worker in the context */
+    ucp_worker_h          ucp_worker;
+    int                   efd; /*< event fd, -1 if blocking progress is
+                                 disabled */
+    ucp_address_t        *address;
+    size_t                address_len;
+    tl_ucp_ep_hash_t     *ep_hash;
+    ucp_ep_h             *eps;
+} ucc_tl_ucp_worker_t;
+
+/* Packed address of TL/UCP context:
+   --------------------------------------------------------
+   |n_workers|addr_len0|..|addr_lenN|addr0|addr1|..|addrN|
+   --------------------------------------------------------
+   n_workers and addr_len are uint32_t. Worker "i" of a peer is connected
+   from the local worker with the same index. */
 typedef struct ucc_tl_ucp_context {
     ucc_tl_context_t            super;
     ucc_tl_ucp_context_config_t cfg;
     ucp_context_h               ucp_context;
-    ucp_worker_h                ucp_worker;
-    size_t                      ucp_addrlen;
-    ucp_address_t              *worker_address;
+    ucc_tl_ucp_worker_t         worker;
+    ucc_tl_ucp_worker_t        *pool; /*< additional workers of the pool */
+    uint32_t                    n_workers;
+    size_t                      addr_len;
+    void                       *addr;
     ucc_mpool_t                 req_mp;
-    tl_ucp_ep_hash_t           *ep_hash;
-    ucp_ep_h                   *eps;
+    ucc_mpool_t                 dt_iov_mp; /*< iov requests of user defined
+                                               datatype messages */
+    ucc_tune_file_t             tune; /*< entries of TUNE_FILE */
 } ucc_tl_ucp_context_t;
+
+#define UCC_TL_UCP_CTX_WORKER(_ctx, _idx)                                      \
+    ((_idx) == 0 ? &(_ctx)->worker : &(_ctx)->pool[(_idx) - 1])
+
 UCC_CLASS_DECLARE(ucc_tl_ucp_context_t, const ucc_base_context_params_t *,
                   const ucc_base_config_t *);
 
+/* Team ranks grouped by node, built from the core team topology when the
+   team spans several nodes with more than one rank on some node. Nodes are
+   numbered and ranks of a node are listed in the order of their team
+   ranks, the first rank of a node is its leader. */
+typedef struct ucc_tl_ucp_node_map {
+    ucc_rank_t  nnodes;
+    ucc_rank_t  my_node;
+    ucc_rank_t *node_of;    /*< node of every team rank */
+    ucc_rank_t *pos;        /*< position of every team rank in members */
+    ucc_rank_t *node_start; /*< nnodes + 1 offsets of the nodes in members */
+    ucc_rank_t *members;    /*< team ranks grouped by node */
+} ucc_tl_ucp_node_map_t;
+
+#define UCC_TL_UCP_NODE_SIZE(_map, _node)                                      \
+    ((_map)->node_start[(_node) + 1] - (_map)->node_start[(_node)])
+
+#define UCC_TL_UCP_NODE_LEADER(_map, _node)                                    \
+    ((_map)->members[(_map)->node_start[(_node)]])
+
+/* Largest radix for which the team caches knomial peer tables */
+#define UCC_TL_UCP_KN_TABLE_MAX_RADIX 32
+
 typedef struct ucc_tl_ucp_task ucc_tl_ucp_task_t;
 typedef struct ucc_tl_ucp_team {
     ucc_tl_team_t              super;
     ucc_status_t               status;
     ucc_rank_t                 size;
     ucc_rank_t                 rank;
+    ucc_rank_t                 nnodes; /*< team shape, nnodes = size and */
+    ucc_rank_t                 ppn;    /*< ppn = 1 if topo is not known */
+    ucc_tl_ucp_node_map_t     *node_map; /*< NULL if the team is on one
+                                             node or has one rank per node */
     uint32_t                   id;
     uint32_t                   scope;
     uint32_t                   scope_id;
     uint32_t                   seq_num;
     ucc_tl_ucp_task_t         *preconnect_task;
+    ucc_tl_ucp_worker_t      **lanes; /*< workers of the team contexts, lane 0
+                                         is the worker the team is bound to
+                                         in the team context */
+    int                        n_lanes;
+    ucc_scratch_arena_t        scratch;
+    ucc_tl_ucp_ef_store_t      ef; /*< allreduce compression residuals */
+    ucc_pipeline_stats_t       pipeline_stats;
+    ucc_tl_ucp_lib_config_t    cfg; /*< lib config with the parameters of
+                                       the tuning file entry applied */
+    const char                *tune_score_str; /*< TUNE string of the tuning
+                                                   file entry or NULL */
+    struct ucc_knomial_table  *kn_tables[UCC_TL_UCP_KN_TABLE_MAX_RADIX + 1];
+                               /*< knomial peer tables for the team size and
+                                   rank indexed by radix, built at team
+                                   creation and read only afterwards */
 } ucc_tl_ucp_team_t;
 UCC_CLASS_DECLARE(ucc_tl_ucp_team_t, ucc_base_context_t *,
                   const ucc_base_team_params_t *);
@@ -102,7 +209,8 @@ UCC_CLASS_DECLARE(ucc_tl_ucp_team_t, ucc_base_context_t *,
     (UCC_COLL_TYPE_ALLTOALL  | UCC_COLL_TYPE_ALLTOALLV  |  \
      UCC_COLL_TYPE_ALLGATHER | UCC_COLL_TYPE_ALLGATHERV |  \
      UCC_COLL_TYPE_ALLREDUCE | UCC_COLL_TYPE_BCAST      |  \
-     UCC_COLL_TYPE_BARRIER   | UCC_COLL_TYPE_REDUCE)
+     UCC_COLL_TYPE_BARRIER   | UCC_COLL_TYPE_REDUCE     |  \
+     UCC_COLL_TYPE_SPARSE_ALLREDUCE)
 
 #define UCC_TL_UCP_TEAM_LIB(_team)                                             \
     (ucc_derived_of((_team)->super.super.context->lib, ucc_tl_ucp_lib_t))
@@ -110,7 +218,7 @@ UCC_CLASS_DECLARE(ucc_tl_ucp_team_t, ucc_base_context_t *,
 #define UCC_TL_UCP_TEAM_CTX(_team)                                             \
     (ucc_derived_of((_team)->super.super.context, ucc_tl_ucp_context_t))
 
-#define UCC_TL_UCP_WORKER(_team) UCC_TL_UCP_TEAM_CTX(_team)->ucp_worker
+#define UCC_TL_UCP_WORKER(_team) UCC_TL_UCP_TEAM_CTX(_team)->worker.ucp_worker
 
 #define UCC_TL_CTX_HAS_OOB(_ctx) ((_ctx)->super.super.ucc_context->params.mask & \
                                   UCC_CONTEXT_PARAM_FIELD_OOB)
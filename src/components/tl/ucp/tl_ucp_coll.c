@@ -8,6 +8,7 @@
 #include "tl_ucp_coll.h"
 #include "core/ucc_mc.h"
 #include "core/ucc_team.h"
+#include "utils/ucc_coll_utils.h"
 #include "barrier/barrier.h"
 #include "alltoall/alltoall.h"
 #include "alltoallv/alltoallv.h"
@@ -16,6 +17,7 @@
 #include "allgatherv/allgatherv.h"
 #include "bcast/bcast.h"
 #include "reduce/reduce.h"
+#include "sparse_allreduce/sparse_allreduce.h"
 const char
     *ucc_tl_ucp_default_alg_select_str[UCC_TL_UCP_N_DEFAULT_ALG_SELECT_STR] = {
         UCC_TL_UCP_ALLREDUCE_DEFAULT_ALG_SELECT_STR};
@@ -56,13 +58,41 @@ ucc_status_t ucc_tl_ucp_coll_finalize(ucc_coll_task_t *coll_task)
     return UCC_OK;
 }
 
+/* Publishes the event on the ee output queue, the event is copied */
+static ucc_status_t ucc_tl_ucp_ee_publish(ucc_ee_h ee, ucc_event_type_t type,
+                                          ucc_coll_task_t *coll_task)
+{
+    ucc_ev_t ev;
+
+    ev.ev_type         = type;
+    ev.ev_context      = NULL;
+    ev.ev_context_size = 0;
+    ev.req             = &coll_task->super;
+    return ucc_ee_set_event_internal(ee, &ev, &ee->event_out_queue);
+}
+
 static ucc_status_t
 ucc_tl_ucp_triggered_coll_complete(ucc_coll_task_t *parent_task, //NOLINT
                                    ucc_coll_task_t *coll_task)
 {
+    ucc_status_t status = UCC_OK;
+
     tl_trace(UCC_TASK_LIB(coll_task), "triggered collective complete. task:%p",
              coll_task);
-    return ucc_mc_ee_task_end(coll_task->ee_task, coll_task->ee->ee_type);
+    if (coll_task->ee_task) {
+        status = ucc_mc_ee_task_end(coll_task->ee_task, coll_task->ee->ee_type);
+        if (ucc_unlikely(status != UCC_OK)) {
+            return status;
+        }
+    }
+    if (coll_task->ee->ee_type == UCC_EE_CPU_THREAD) {
+        /* host ee has no stream to order on, the application learns about
+           completion from the ee event queue */
+        status = ucc_tl_ucp_ee_publish(coll_task->ee,
+                                       UCC_EVENT_COLLECTIVE_COMPLETE,
+                                       coll_task);
+    }
+    return status;
 }
 
 static ucc_status_t
@@ -76,6 +106,11 @@ ucc_tl_ucp_event_trigger_complete(ucc_coll_task_t *parent_task,
              parent_task, coll_task);
 
     coll_task->ee_task = parent_task->ee_task;
+    if (coll_task->ee->ee_type == UCC_EE_CPU_THREAD) {
+        /* trigger event was consumed */
+        ucc_ee_ack_event(coll_task->ee, parent_task->ev);
+        parent_task->ev = NULL;
+    }
     status = coll_task->post(coll_task);
     if (ucc_unlikely(status != UCC_OK)) {
         tl_error(UCC_TASK_LIB(task),
@@ -87,10 +122,18 @@ ucc_tl_ucp_event_trigger_complete(ucc_coll_task_t *parent_task,
         return ucc_tl_ucp_triggered_coll_complete(coll_task, coll_task);
     } else {
         ucc_assert(coll_task->super.status == UCC_INPROGRESS);
-        if (coll_task->ee_task) {
-            ucc_event_manager_init(&coll_task->em);
-            ucc_event_manager_subscribe(&coll_task->em, UCC_EVENT_COMPLETED, coll_task,
-                                        ucc_tl_ucp_triggered_coll_complete);
+        if (coll_task->ee_task ||
+            coll_task->ee->ee_type == UCC_EE_CPU_THREAD) {
+            /* the em may hold a grown listeners array */
+            ucc_event_manager_cleanup(&coll_task->em);
+            status = ucc_event_manager_subscribe(
+                &coll_task->em, UCC_EVENT_COMPLETED, coll_task,
+                ucc_tl_ucp_triggered_coll_complete);
+            if (ucc_unlikely(status != UCC_OK)) {
+                tl_error(UCC_TASK_LIB(task), "failed to subscribe to "
+                         "completion of the triggered collective");
+                return status;
+            }
         }
     }
 
@@ -100,7 +143,6 @@ ucc_tl_ucp_event_trigger_complete(ucc_coll_task_t *parent_task,
 //TODO can we move this logic to CORE
 static ucc_status_t ucc_tl_ucp_ee_wait_for_event_trigger(ucc_coll_task_t *coll_task)
 {
-    ucc_ev_t *post_event;
     ucc_status_t status;
     ucc_ev_t *ev;
     ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
@@ -112,6 +154,15 @@ static ucc_status_t ucc_tl_ucp_ee_wait_for_event_trigger(ucc_coll_task_t *coll_t
             task->super.ee_task = NULL;
         } else if (UCC_OK == ucc_ee_get_event_internal(task->super.ee, &ev,
                                                 &task->super.ee->event_in_queue)) {
+            if (ev->ev_type != UCC_EVENT_COMPUTE_COMPLETE) {
+                /* only compute completion triggers a collective, triggered
+                   collectives of the ee consume these events in order */
+                tl_warn(UCC_TASK_LIB(task),
+                        "unexpected event %s on ee %p is dropped",
+                        ucc_ee_ev_names[ev->ev_type], task->super.ee);
+                ucc_ee_ack_event(task->super.ee, ev);
+                return UCC_OK;
+            }
             tl_trace(UCC_TASK_LIB(task), "triggered event arrived. ev_task:%p",
                      coll_task);
             task->super.ev = ev;
@@ -130,17 +181,13 @@ static ucc_status_t ucc_tl_ucp_ee_wait_for_event_trigger(ucc_coll_task_t *coll_t
             return status;
         }
 
-        /* TODO: mpool */
-        post_event = ucc_malloc(sizeof(ucc_ev_t), "event");
-        if (ucc_unlikely(post_event == NULL)) {
-            tl_error(UCC_TASK_LIB(task), "failed to allocate memory for event");
-            return UCC_ERR_NO_MEMORY;
+        status = ucc_tl_ucp_ee_publish(coll_task->ee,
+                                       UCC_EVENT_COLLECTIVE_POST,
+                                       coll_task->triggered_task);
+        if (ucc_unlikely(status != UCC_OK)) {
+            task->super.super.status = status;
+            return status;
         }
-
-        post_event->ev_type = UCC_EVENT_COLLECTIVE_POST;
-        post_event->ev_context_size = 0;
-        post_event->req = &coll_task->triggered_task->super;
-        ucc_ee_set_event_internal(coll_task->ee, post_event, &coll_task->ee->event_out_queue);
     }
 
     if (task->super.ee_task == NULL ||
@@ -170,9 +217,13 @@ ucc_status_t ucc_tl_ucp_triggered_post(ucc_ee_h ee, ucc_ev_t *ev, //NOLINT
     tl_trace(UCC_TASK_LIB(task), "triggered post. ev_task:%p coll_task:%p",
             &ev_task->super, coll_task);
     ev_task->super.progress = ucc_tl_ucp_ee_wait_for_event_trigger;
-    ucc_event_manager_init(&ev_task->super.em);
-    ucc_event_manager_subscribe(&ev_task->super.em, UCC_EVENT_COMPLETED, coll_task,
-                                ucc_tl_ucp_event_trigger_complete);
+    status = ucc_event_manager_subscribe(&ev_task->super.em,
+                                         UCC_EVENT_COMPLETED, coll_task,
+                                         ucc_tl_ucp_event_trigger_complete);
+    if (ucc_unlikely(status != UCC_OK)) {
+        ucc_tl_ucp_put_task(ev_task);
+        return status;
+    }
 
     status = ucc_tl_ucp_ee_wait_for_event_trigger(&ev_task->super);
     if (ucc_unlikely(status != UCC_OK)) {
@@ -188,13 +239,36 @@ ucc_status_t ucc_tl_ucp_triggered_post(ucc_ee_h ee, ucc_ev_t *ev, //NOLINT
     return UCC_OK;
 }
 
+/* Partitioned collectives are pipelined schedules with a fragment per
+   partition */
+static ucc_status_t
+ucc_tl_ucp_coll_init_partitioned(ucc_base_coll_args_t *coll_args,
+                                 ucc_base_team_t      *team,
+                                 ucc_coll_task_t     **task_h)
+{
+    switch (coll_args->args.coll_type) {
+    case UCC_COLL_TYPE_ALLREDUCE:
+        return ucc_tl_ucp_allreduce_sra_knomial_init(coll_args, team, task_h);
+    case UCC_COLL_TYPE_BCAST:
+        return ucc_tl_ucp_bcast_partitioned_init(coll_args, team, task_h);
+    default:
+        tl_debug(team->context->lib, "partitioned %s is not supported",
+                 ucc_coll_type_str(coll_args->args.coll_type));
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+}
+
 ucc_status_t ucc_tl_ucp_coll_init(ucc_base_coll_args_t *coll_args,
                                   ucc_base_team_t *team,
                                   ucc_coll_task_t **task_h)
 {
-    ucc_tl_ucp_task_t    *task = ucc_tl_ucp_init_task(coll_args, team);
+    ucc_tl_ucp_task_t    *task;
     ucc_status_t          status;
 
+    if (UCC_IS_PARTITIONED(coll_args->args)) {
+        return ucc_tl_ucp_coll_init_partitioned(coll_args, team, task_h);
+    }
+    task = ucc_tl_ucp_init_task(coll_args, team);
     switch (coll_args->args.coll_type) {
     case UCC_COLL_TYPE_BARRIER:
         status = ucc_tl_ucp_barrier_init(task);
@@ -220,6 +294,9 @@ ucc_status_t ucc_tl_ucp_coll_init(ucc_base_coll_args_t *coll_args,
     case UCC_COLL_TYPE_REDUCE:
         status = ucc_tl_ucp_reduce_init(task);
         break;
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
+        status = ucc_tl_ucp_sparse_allreduce_init(task);
+        break;
     default:
         status = UCC_ERR_NOT_SUPPORTED;
     }
@@ -237,6 +314,10 @@ static inline int alg_id_from_str(ucc_coll_type_t coll_type, const char *str)
     switch (coll_type) {
     case UCC_COLL_TYPE_ALLREDUCE:
         return ucc_tl_ucp_allreduce_alg_from_str(str);
+    case UCC_COLL_TYPE_ALLTOALL:
+        return ucc_tl_ucp_alltoall_alg_from_str(str);
+    case UCC_COLL_TYPE_ALLTOALLV:
+        return ucc_tl_ucp_alltoallv_alg_from_str(str);
     default:
         break;
     }
@@ -267,9 +348,65 @@ ucc_status_t ucc_tl_ucp_alg_id_to_init(int alg_id, const char *alg_id_str,
             break;
         };
         break;
+    case UCC_COLL_TYPE_ALLTOALL:
+        switch (alg_id) {
+        case UCC_TL_UCP_ALLTOALL_ALG_PAIRWISE:
+            *init = ucc_tl_ucp_alltoall_pairwise_init;
+            break;
+        case UCC_TL_UCP_ALLTOALL_ALG_NODE_AGG:
+            *init = ucc_tl_ucp_alltoall_node_agg_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_ALLTOALLV:
+        switch (alg_id) {
+        case UCC_TL_UCP_ALLTOALLV_ALG_PAIRWISE:
+            *init = ucc_tl_ucp_alltoallv_pairwise_init;
+            break;
+        case UCC_TL_UCP_ALLTOALLV_ALG_NODE_AGG:
+            *init = ucc_tl_ucp_alltoallv_node_agg_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
     default:
         status = UCC_ERR_NOT_SUPPORTED;
         break;
     }
     return status;
 }
+
+int ucc_tl_ucp_kn_radix_is_auto(const ucc_tl_ucp_lib_config_t *cfg)
+{
+    return cfg->barrier_kn_radix == UCC_ULUNITS_AUTO ||
+           cfg->allreduce_kn_radix == UCC_ULUNITS_AUTO ||
+           cfg->allreduce_sra_kn_radix == UCC_ULUNITS_AUTO ||
+           cfg->reduce_scatter_kn_radix == UCC_ULUNITS_AUTO ||
+           cfg->allgather_kn_radix == UCC_ULUNITS_AUTO ||
+           cfg->bcast_kn_radix == UCC_ULUNITS_AUTO ||
+           cfg->reduce_kn_radix == UCC_ULUNITS_AUTO;
+}
+
+ucc_kn_radix_t ucc_tl_ucp_kn_radix(ucc_tl_ucp_team_t      *team,
+                                   unsigned long           cfg_radix,
+                                   ucc_kn_pattern_t        pattern,
+                                   ucc_rank_t size, size_t msgsize)
+{
+    ucc_kn_model_t model = {
+        .latency  = team->cfg.kn_link_latency,
+        .overhead = team->cfg.kn_send_overhead,
+        .bw       = team->cfg.pipeline_bw,
+        .nnodes   = team->nnodes,
+        .ppn      = team->ppn,
+    };
+
+    if (cfg_radix != UCC_ULUNITS_AUTO) {
+        return ucc_min(cfg_radix, size);
+    }
+    return ucc_kn_model_radix(&model, pattern, size, msgsize);
+}
@@ -12,6 +12,8 @@
 #include "coll_patterns/recursive_knomial.h"
 #include "components/mc/base/ucc_mc_base.h"
 #include "tl_ucp_tag.h"
+#include "tl_ucp_dt.h"
+#include "coll_patterns/knomial_model.h"
 
 #define UCC_TL_UCP_N_DEFAULT_ALG_SELECT_STR 1
 extern const char
@@ -26,14 +28,17 @@ extern const char
     } while (0)
 
 typedef struct ucc_tl_ucp_task {
-    ucc_coll_task_t   super;
-    uint32_t          send_posted;
-    uint32_t          send_completed;
-    uint32_t          recv_posted;
-    uint32_t          recv_completed;
-    uint32_t          tag;
-    uint32_t          n_polls;
-    ucc_team_subset_t subset;
+    ucc_coll_task_t      super;
+    uint32_t             send_posted;
+    uint32_t             send_completed;
+    uint32_t             recv_posted;
+    uint32_t             recv_completed;
+    uint32_t             tag;
+    uint32_t             n_polls;
+    ucc_team_subset_t    subset;
+    ucc_tl_ucp_worker_t *worker;
+    ucc_tl_ucp_dt_t     *dt; /*< src and dst user defined datatypes, NULL
+                                if both are predefined */
     union {
         struct {
             int                     phase;
@@ -43,18 +48,30 @@ typedef struct ucc_tl_ucp_task {
             int                     phase;
             ucc_knomial_pattern_t   p;
             void                   *scratch;
-            ucc_mc_buffer_header_t *scratch_mc_header;
+            ucc_scratch_t          *scratch_buf;
+            ucc_kn_radix_t          radix;
         } allreduce_kn;
         struct {
             int                     phase;
             ucc_knomial_pattern_t   p;
             void                   *scratch;
-            ucc_mc_buffer_header_t *scratch_mc_header;
+            ucc_scratch_t          *scratch_buf;
+            ucc_scratch_t          *wire_buf;     /*< 16 bit send/recv
+                                                     staging, NULL if data
+                                                     is not compressed */
+            ucc_datatype_t          wire_dt;
+            float                  *ef;           /*< error feedback
+                                                     residual or NULL */
+            size_t                  block_offset; /*< offset of the current
+                                                     block in the vector */
         } reduce_scatter_kn;
         struct {
             int                     phase;
             ucc_knomial_pattern_t   p;
             void                   *sbuf;
+            void                   *decompress_dst; /*< if set, 16 bit
+                                                       result is converted
+                                                       to fp32 here */
         } allgather_kn;
         struct {
             ucc_rank_t              dist;
@@ -67,8 +84,46 @@ typedef struct ucc_tl_ucp_task {
             uint32_t                radix;
             int                     phase;
             void                   *scratch;
-            ucc_mc_buffer_header_t *scratch_mc_header;
+            ucc_scratch_t          *scratch_buf;
         } reduce_kn;
+        struct {
+            int                     step;
+            int                     phase;
+            ucc_knomial_pattern_t   p;
+            uint64_t                nnz;       /*< nonzeros of the local
+                                                  vector or
+                                                  UCC_TL_UCP_SPARSE_DENSE */
+            uint64_t                peer_nnz;
+            size_t                  max_nnz;   /*< switch to dense above */
+            uint64_t               *idx;
+            void                   *val;
+            void                   *dense;
+            ucc_scratch_t          *buf;       /*< holds idx and val, NULL
+                                                  if they are user src */
+            ucc_scratch_t          *recv_buf;
+            ucc_scratch_t          *dense_buf; /*< NULL if dense is user
+                                                  dst */
+        } sparse_allreduce;
+        struct {
+            int                     phase;
+            ucc_scratch_t          *gather;      /*< rows of the node on
+                                                    the leader, packed
+                                                    data of alltoallv on
+                                                    other ranks */
+            ucc_scratch_t          *xchg;        /*< regions exchanged by
+                                                    the leaders */
+            uint64_t               *sizes;       /*< offsets and block
+                                                    sizes */
+            size_t                  recv_offset; /*< result in gather */
+        } alltoall_node_agg;
+        struct {
+            ucc_rank_t             *peers;  /*< peers with nonzero counts,
+                                               sends followed by recvs */
+            uint64_t               *offset; /*< cumulative bytes of the
+                                               peers, n + 1 per direction */
+            ucc_rank_t              n_send;
+            ucc_rank_t              n_recv;
+        } alltoallv_pairwise;
     };
 } ucc_tl_ucp_task_t;
 
@@ -101,6 +156,8 @@ static inline ucc_tl_ucp_task_t *ucc_tl_ucp_get_task(ucc_tl_ucp_team_t *team)
     task->subset.map.type    = UCC_EP_MAP_FULL;
     task->subset.map.ep_num  = team->size;
     task->subset.myrank      = team->rank;
+    task->worker             = team->lanes[0];
+    task->dt                 = NULL;
     ucc_tl_ucp_task_reset(task);
     return task;
 }
@@ -108,6 +165,10 @@ static inline ucc_tl_ucp_task_t *ucc_tl_ucp_get_task(ucc_tl_ucp_team_t *team)
 static inline void ucc_tl_ucp_put_task(ucc_tl_ucp_task_t *task)
 {
     UCC_TL_UCP_PROFILE_REQUEST_FREE(task);
+    if (task->dt) {
+        ucc_tl_ucp_task_dt_cleanup(task);
+    }
+    ucc_event_manager_cleanup(&task->super.em);
     ucc_mpool_put(task);
 }
 
@@ -134,6 +195,7 @@ ucc_tl_ucp_get_schedule_pipelined(ucc_tl_ucp_team_t *team)
 static inline void ucc_tl_ucp_put_schedule(ucc_schedule_t *schedule)
 {
     UCC_TL_UCP_PROFILE_REQUEST_FREE(schedule);
+    ucc_schedule_cleanup(schedule);
     ucc_mpool_put(schedule);
 }
 
@@ -141,6 +203,7 @@ static inline void
 ucc_tl_ucp_put_schedule_pipelined(ucc_schedule_pipelined_t *schedule)
 {
     UCC_TL_UCP_PROFILE_REQUEST_FREE(schedule);
+    ucc_schedule_cleanup(&schedule->super);
     ucc_mpool_put(schedule);
 }
 
@@ -156,14 +219,26 @@ ucc_status_t ucc_tl_ucp_triggered_post(ucc_ee_h ee, ucc_ev_t *ev,
 static inline ucc_tl_ucp_task_t *
 ucc_tl_ucp_init_task(ucc_base_coll_args_t *coll_args, ucc_base_team_t *team)
 {
-    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
-    ucc_tl_ucp_task_t *task    = ucc_tl_ucp_get_task(tl_team);
+    ucc_tl_ucp_team_t    *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_context_t *ctx     = UCC_TL_UCP_TEAM_CTX(tl_team);
+    ucc_tl_ucp_task_t    *task    = ucc_tl_ucp_get_task(tl_team);
 
     ucc_coll_task_init(&task->super, &coll_args->args, team);
     task->tag            = tl_team->seq_num;
+    if (ctx->cfg.worker_pool_bind == UCC_TL_UCP_WORKER_BIND_COLL &&
+        ctx->n_workers > 1) {
+        /* the tag is the same on all the ranks, so is the worker */
+        task->worker = UCC_TL_UCP_CTX_WORKER(ctx, (task->tag + tl_team->id) %
+                                                  ctx->n_workers);
+    }
     tl_team->seq_num     = (tl_team->seq_num + 1) % UCC_TL_UCP_MAX_COLL_TAG;
     task->super.finalize = ucc_tl_ucp_coll_finalize;
     task->super.triggered_post = ucc_tl_ucp_triggered_post;
+    if (tl_team->n_lanes == 1 && tl_team->lanes[0]->efd >= 0) {
+        /* p2p completions wake up the worker efd of the team context,
+           lanes of other contexts are signaled on their own fds */
+        task->super.flags |= UCC_COLL_TASK_FLAG_EVENT_FD;
+    }
     return task;
 }
 
@@ -181,7 +256,7 @@ static inline ucc_status_t ucc_tl_ucp_test(ucc_tl_ucp_task_t *task)
         if (UCC_TL_UCP_TASK_P2P_COMPLETE(task)) {
             return UCC_OK;
         }
-        ucp_worker_progress(TASK_CTX(task)->ucp_worker);
+        ucp_worker_progress(task->worker->ucp_worker);
     }
     return UCC_INPROGRESS;
 }
@@ -190,6 +265,31 @@ ucc_status_t ucc_tl_ucp_coll_init(ucc_base_coll_args_t *coll_args,
                                   ucc_base_team_t      *team,
                                   ucc_coll_task_t     **task_h);
 
+/* Makes the knomial pattern initialized for size and rank use the peer
+   table built by the team. Patterns of subsets of a different shape and
+   extra ranks, which do not run the loop, compute the peers on the fly. */
+static inline void
+ucc_tl_ucp_kn_pattern_set_table(ucc_tl_ucp_team_t *team, ucc_rank_t size,
+                                ucc_rank_t rank, ucc_knomial_pattern_t *p)
+{
+    if (size != team->size || rank != team->rank ||
+        p->node_type == KN_NODE_EXTRA ||
+        p->radix > UCC_TL_UCP_KN_TABLE_MAX_RADIX) {
+        return;
+    }
+    ucc_knomial_pattern_set_table(p, team->kn_tables[p->radix]);
+}
+
+int ucc_tl_ucp_kn_radix_is_auto(const ucc_tl_ucp_lib_config_t *cfg);
+
+/* Returns the radix of a knomial algorithm: cfg_radix limited by the team
+   size if it is set explicitly, otherwise the radix minimizing the cost
+   model for the pattern, team shape and message size */
+ucc_kn_radix_t ucc_tl_ucp_kn_radix(ucc_tl_ucp_team_t      *team,
+                                   unsigned long           cfg_radix,
+                                   ucc_kn_pattern_t        pattern,
+                                   ucc_rank_t size, size_t msgsize);
+
 ucc_status_t ucc_tl_ucp_alg_id_to_init(int alg_id, const char *alg_id_str,
                                        ucc_coll_type_t          coll_type,
                                        ucc_memory_type_t        mem_type,
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tl_ucp_compress.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_log.h"
+
+void ucc_tl_ucp_ef_store_init(ucc_tl_ucp_ef_store_t *store)
+{
+    ucc_spinlock_init(&store->lock, 0);
+    kh_init_inplace(tl_ucp_ef, &store->map);
+}
+
+void ucc_tl_ucp_ef_store_cleanup(ucc_tl_ucp_ef_store_t *store)
+{
+    ucc_tl_ucp_ef_buf_t *buf;
+
+    kh_foreach_value(&store->map, buf, {
+        ucc_free(buf->err);
+        ucc_free(buf);
+    });
+    kh_destroy_inplace(tl_ucp_ef, &store->map);
+    ucc_spinlock_destroy(&store->lock);
+}
+
+ucc_status_t ucc_tl_ucp_ef_store_get(ucc_tl_ucp_ef_store_t *store,
+                                     const void *buffer, size_t count,
+                                     float **err)
+{
+    ucc_status_t         status = UCC_OK;
+    ucc_tl_ucp_ef_buf_t *buf;
+    khiter_t             k;
+    int                  ret;
+
+    ucc_spin_lock(&store->lock);
+    k = kh_put(tl_ucp_ef, &store->map, (uint64_t)(uintptr_t)buffer, &ret);
+    if (ret < 0) {
+        status = UCC_ERR_NO_MEMORY;
+        goto out;
+    }
+    if (ret == 0) {
+        buf = kh_value(&store->map, k);
+        if (buf->count == count) {
+            *err = buf->err;
+            goto out;
+        }
+        ucc_free(buf->err);
+    } else {
+        buf = ucc_malloc(sizeof(*buf), "tl_ucp_ef_buf");
+        if (!buf) {
+            kh_del(tl_ucp_ef, &store->map, k);
+            status = UCC_ERR_NO_MEMORY;
+            goto out;
+        }
+        kh_value(&store->map, k) = buf;
+    }
+    buf->count = count;
+    buf->err   = ucc_calloc(count, sizeof(float), "tl_ucp_ef_err");
+    if (!buf->err) {
+        ucc_free(buf);
+        kh_del(tl_ucp_ef, &store->map, k);
+        status = UCC_ERR_NO_MEMORY;
+        goto out;
+    }
+    *err = buf->err;
+out:
+    ucc_spin_unlock(&store->lock);
+    if (UCC_OK != status) {
+        ucc_error("failed to allocate error feedback buffer of %zd elements",
+                  count);
+    }
+    return status;
+}
@@ -0,0 +1,43 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_COMPRESS_H_
+#define UCC_TL_UCP_COMPRESS_H_
+
+#include "ucc/api/ucc.h"
+#include "utils/khash.h"
+#include "utils/ucc_spinlock.h"
+
+typedef struct ucc_tl_ucp_ef_buf {
+    float  *err;
+    size_t  count;
+} ucc_tl_ucp_ef_buf_t;
+
+KHASH_MAP_INIT_INT64(tl_ucp_ef, ucc_tl_ucp_ef_buf_t *);
+
+/* Per-team error feedback residuals of the lossy allreduce compression.
+   Each fp32 buffer reduced with 16 bit wire format gets a residual vector
+   of the same count: the quantization error of a value sent by this rank
+   is stored there and added back to the data the next time the same buffer
+   is reduced, so that the rounding error does not accumulate over
+   iterations. Buffers are identified by address and released when the
+   team is destroyed. */
+typedef struct ucc_tl_ucp_ef_store {
+    ucc_spinlock_t     lock;
+    khash_t(tl_ucp_ef) map;
+} ucc_tl_ucp_ef_store_t;
+
+void ucc_tl_ucp_ef_store_init(ucc_tl_ucp_ef_store_t *store);
+
+void ucc_tl_ucp_ef_store_cleanup(ucc_tl_ucp_ef_store_t *store);
+
+/* Returns zero initialized residual of the given count for the buffer,
+   the residual is reset if the buffer was used with a different count */
+ucc_status_t ucc_tl_ucp_ef_store_get(ucc_tl_ucp_ef_store_t *store,
+                                     const void *buffer, size_t count,
+                                     float **err);
+
+#endif
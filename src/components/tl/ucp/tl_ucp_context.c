@@ -19,6 +19,170 @@ static ucc_mpool_ops_t ucc_tl_ucp_req_mpool_ops = {
     .obj_cleanup   = NULL
 };
 
+static ucc_status_t ucc_tl_ucp_worker_arm(void *arg)
+{
+    ucs_status_t status = ucp_worker_arm((ucp_worker_h)arg);
+
+    if (UCS_ERR_BUSY == status) {
+        return UCC_INPROGRESS;
+    }
+    return ucs_status_to_ucc_status(status);
+}
+
+/* Registers worker progress (and event fd if blocking progress is enabled)
+   in the core context and initializes worker endpoints storage */
+static ucc_status_t ucc_tl_ucp_worker_init(ucc_tl_ucp_context_t *ctx,
+                                           ucc_tl_ucp_worker_t  *worker,
+                                           int id, ucp_worker_h ucp_worker,
+                                           const ucc_base_context_params_t *params)
+{
+    ucc_status_t status;
+    ucs_status_t ucs_status;
+
+    worker->ctx         = ctx;
+    worker->id          = id;
+    worker->ucp_worker  = ucp_worker;
+    worker->efd         = -1;
+    worker->address     = NULL;
+    worker->address_len = 0;
+    worker->eps         = NULL;
+    worker->ep_hash     = NULL;
+
+    if (UCC_OK != ucc_context_progress_register(
+                      params->context,
+                      (ucc_context_progress_fn_t)ucp_worker_progress,
+                      ucp_worker)) {
+        tl_error(ctx->super.super.lib, "failed to register progress function");
+        return UCC_ERR_NO_MESSAGE;
+    }
+
+    if (params->blocking_progress) {
+        ucs_status = ucp_worker_get_efd(ucp_worker, &worker->efd);
+        if (UCS_OK != ucs_status) {
+            tl_error(ctx->super.super.lib, "failed to get ucp worker efd, %s",
+                     ucs_status_string(ucs_status));
+            status = ucs_status_to_ucc_status(ucs_status);
+            goto err_efd;
+        }
+        status = ucc_context_event_fd_register(
+            params->context, worker->efd, ucc_tl_ucp_worker_arm, ucp_worker);
+        if (UCC_OK != status) {
+            tl_error(ctx->super.super.lib, "failed to register event fd");
+            worker->efd = -1;
+            goto err_efd;
+        }
+    }
+
+    if (params->context->addr_storage.storage) {
+        /* Global ctx mode, we will have ctx_map so can use array for eps */
+        worker->eps = ucc_calloc(params->context->addr_storage.size,
+                                 sizeof(ucp_ep_h), "ucp_eps");
+        if (!worker->eps) {
+            tl_error(ctx->super.super.lib,
+                     "failed to allocate %zd bytes for ucp_eps",
+                     params->context->addr_storage.size * sizeof(ucp_ep_h));
+            status = UCC_ERR_NO_MEMORY;
+            goto err_eps;
+        }
+    } else {
+        worker->ep_hash = kh_init(tl_ucp_ep_hash);
+    }
+    return UCC_OK;
+
+err_eps:
+    if (worker->efd >= 0) {
+        ucc_context_event_fd_deregister(params->context, worker->efd,
+                                        ucc_tl_ucp_worker_arm, ucp_worker);
+    }
+err_efd:
+    ucc_context_progress_deregister(
+        params->context, (ucc_context_progress_fn_t)ucp_worker_progress,
+        ucp_worker);
+    return status;
+}
+
+static void ucc_tl_ucp_worker_cleanup(ucc_tl_ucp_worker_t *worker)
+{
+    ucc_context_t *core_ctx = worker->ctx->super.super.ucc_context;
+
+    if (worker->eps) {
+        ucc_free(worker->eps);
+    } else {
+        kh_destroy(tl_ucp_ep_hash, worker->ep_hash);
+    }
+    if (worker->efd >= 0) {
+        ucc_context_event_fd_deregister(core_ctx, worker->efd,
+                                        ucc_tl_ucp_worker_arm,
+                                        worker->ucp_worker);
+    }
+    ucc_context_progress_deregister(
+        core_ctx, (ucc_context_progress_fn_t)ucp_worker_progress,
+        worker->ucp_worker);
+    if (worker->address) {
+        ucp_worker_release_address(worker->ucp_worker, worker->address);
+    }
+    ucp_worker_destroy(worker->ucp_worker);
+}
+
+/* Creates the additional workers of the pool. The pool is only used in
+   UCC_THREAD_MULTIPLE mode to reduce contention on the single worker lock.
+   Tasks are bound to the pool workers according to WORKER_POOL_BIND: by
+   team id (team) or by the collective tag (coll), the tag being the same
+   on all the ranks so peers use the same worker index. */
+static ucc_status_t
+ucc_tl_ucp_worker_pool_init(ucc_tl_ucp_context_t            *ctx,
+                            ucp_worker_params_t             *worker_params,
+                            const ucc_base_context_params_t *params)
+{
+    ucc_status_t status;
+    ucs_status_t ucs_status;
+    ucp_worker_h ucp_worker;
+    uint32_t     i;
+
+    ctx->n_workers = 1;
+    ctx->pool      = NULL;
+    if (params->thread_mode != UCC_THREAD_MULTIPLE ||
+        ctx->cfg.worker_pool_size <= 1) {
+        return UCC_OK;
+    }
+    ctx->pool = ucc_calloc(ctx->cfg.worker_pool_size - 1,
+                           sizeof(ucc_tl_ucp_worker_t), "tl_ucp_worker_pool");
+    if (!ctx->pool) {
+        tl_error(ctx->super.super.lib,
+                 "failed to allocate %zd bytes for worker pool",
+                 (ctx->cfg.worker_pool_size - 1) * sizeof(ucc_tl_ucp_worker_t));
+        return UCC_ERR_NO_MEMORY;
+    }
+    for (i = 1; i < ctx->cfg.worker_pool_size; i++) {
+        ucs_status = ucp_worker_create(ctx->ucp_context, worker_params,
+                                       &ucp_worker);
+        if (UCS_OK != ucs_status) {
+            tl_error(ctx->super.super.lib, "failed to create ucp worker, %s",
+                     ucs_status_string(ucs_status));
+            status = ucs_status_to_ucc_status(ucs_status);
+            goto err;
+        }
+        status = ucc_tl_ucp_worker_init(ctx, &ctx->pool[i - 1], i, ucp_worker,
+                                        params);
+        if (UCC_OK != status) {
+            ucp_worker_destroy(ucp_worker);
+            goto err;
+        }
+        ctx->n_workers++;
+    }
+    tl_debug(ctx->super.super.lib, "created worker pool of size %u",
+             ctx->n_workers);
+    return UCC_OK;
+err:
+    for (i = 1; i < ctx->n_workers; i++) {
+        ucc_tl_ucp_worker_cleanup(&ctx->pool[i - 1]);
+    }
+    ucc_free(ctx->pool);
+    ctx->pool      = NULL;
+    ctx->n_workers = 1;
+    return status;
+}
+
 UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
                     const ucc_base_context_params_t *params,
                     const ucc_base_config_t *config)
@@ -49,6 +213,9 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
         UCP_PARAM_FIELD_FEATURES | UCP_PARAM_FIELD_TAG_SENDER_MASK;
     ucp_params.features        = UCP_FEATURE_TAG;
     ucp_params.tag_sender_mask = UCC_TL_UCP_TAG_SENDER_MASK;
+    if (params->blocking_progress) {
+        ucp_params.features |= UCP_FEATURE_WAKEUP;
+    }
 
     if (params->estimated_num_ppn > 0) {
         ucp_params.field_mask |= UCP_PARAM_FIELD_ESTIMATED_NUM_PPN;
@@ -103,8 +270,8 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
     }
 
     self->ucp_context = ucp_context;
-    self->ucp_worker  = ucp_worker;
-    self->worker_address = NULL;
+    self->addr        = NULL;
+    self->addr_len    = 0;
 
     ucc_status = ucc_mpool_init(
         &self->req_mp, 0,
@@ -116,33 +283,48 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
                  "failed to initialize tl_ucp_req mpool");
         goto err_thread_mode;
     }
-    if (UCC_OK != ucc_context_progress_register(
-                      params->context,
-                      (ucc_context_progress_fn_t)ucp_worker_progress,
-                      self->ucp_worker)) {
-        tl_error(self->super.super.lib, "failed to register progress function");
-        ucc_status = UCC_ERR_NO_MESSAGE;
-        goto err_thread_mode;
+    ucc_status = ucc_mpool_init(&self->dt_iov_mp, 0,
+                                sizeof(ucc_tl_ucp_dt_iov_req_t), 0,
+                                UCC_CACHE_LINE_SIZE, 8, UINT_MAX,
+                                &ucc_tl_ucp_req_mpool_ops, params->thread_mode,
+                                "tl_ucp_dt_iov_mp");
+    if (UCC_OK != ucc_status) {
+        tl_error(self->super.super.lib,
+                 "failed to initialize tl_ucp_dt_iov mpool");
+        goto err_dt_iov_mp;
     }
-
-    if (params->context->addr_storage.storage) {
-        /* Global ctx mode, we will have ctx_map so can use array for eps */
-        self->eps = ucc_calloc(params->context->addr_storage.size,
-                               sizeof(ucp_ep_h), "ucp_eps");
-        if (self->eps) {
-            tl_error(self->super.super.lib,
-                     "failed to allocate %zd bytes for ucp_eps",
-                     params->context->addr_storage.size * sizeof(ucp_ep_h));
-            ucc_status = UCC_ERR_NO_MEMORY;
-            goto err_thread_mode;
+    ucc_status = ucc_tl_ucp_worker_init(self, &self->worker, 0, ucp_worker,
+                                        params);
+    if (UCC_OK != ucc_status) {
+        goto err_worker_init;
+    }
+    ucc_status = ucc_tl_ucp_worker_pool_init(self, &worker_params, params);
+    if (UCC_OK != ucc_status) {
+        goto err_pool;
+    }
+    self->tune.entries   = NULL;
+    self->tune.n_entries = 0;
+    if (strlen(tl_ucp_config->tune_file) > 0) {
+        ucc_status = ucc_tune_file_load(tl_ucp_config->tune_file,
+                                        &self->tune);
+        if (UCC_OK != ucc_status) {
+            tl_warn(self->super.super.lib, "tuning file %s is ignored",
+                    tl_ucp_config->tune_file);
         }
-    } else {
-        self->eps     = NULL;
-        self->ep_hash = kh_init(tl_ucp_ep_hash);
     }
     tl_info(self->super.super.lib, "initialized tl context: %p", self);
     return UCC_OK;
 
+err_pool:
+    ucc_tl_ucp_worker_cleanup(&self->worker);
+    ucc_mpool_cleanup(&self->dt_iov_mp, 1);
+    ucc_mpool_cleanup(&self->req_mp, 1);
+    ucp_cleanup(ucp_context);
+    return ucc_status;
+err_worker_init:
+    ucc_mpool_cleanup(&self->dt_iov_mp, 1);
+err_dt_iov_mp:
+    ucc_mpool_cleanup(&self->req_mp, 1);
 err_thread_mode:
     ucp_worker_destroy(ucp_worker);
 err_worker_create:
@@ -170,7 +352,7 @@ static void ucc_tl_ucp_context_barrier(ucc_tl_ucp_context_t *ctx,
                                  &req)) {
         ucc_assert(req);
         while (UCC_OK != (status = oob->req_test(req))) {
-            ucp_worker_progress(ctx->ucp_worker);
+            ucp_worker_progress(ctx->worker.ucp_worker);
             if (status < 0) {
                 tl_error(ctx->super.super.lib, "failed to test oob req");
                 break;
@@ -183,22 +365,24 @@ static void ucc_tl_ucp_context_barrier(ucc_tl_ucp_context_t *ctx,
 
 UCC_CLASS_CLEANUP_FUNC(ucc_tl_ucp_context_t)
 {
+    uint32_t i;
+
     tl_info(self->super.super.lib, "finalizing tl context: %p", self);
-    ucc_tl_ucp_close_eps(self);
-    if (self->eps) {
-        ucc_free(self->eps);
-    } else {
-        kh_destroy(tl_ucp_ep_hash, self->ep_hash);
+    for (i = 0; i < self->n_workers; i++) {
+        ucc_tl_ucp_close_eps(UCC_TL_UCP_CTX_WORKER(self, i));
     }
     if (UCC_TL_CTX_HAS_OOB(self)) {
         ucc_tl_ucp_context_barrier(self, &UCC_TL_CTX_OOB(self));
     }
-    ucc_context_progress_deregister(
-        self->super.super.ucc_context,
-        (ucc_context_progress_fn_t)ucp_worker_progress, self->ucp_worker);
-    ucp_worker_destroy(self->ucp_worker);
+    for (i = 0; i < self->n_workers; i++) {
+        ucc_tl_ucp_worker_cleanup(UCC_TL_UCP_CTX_WORKER(self, i));
+    }
+    ucc_free(self->pool);
+    ucc_free(self->addr);
+    ucc_mpool_cleanup(&self->dt_iov_mp, 1);
     ucc_mpool_cleanup(&self->req_mp, 1);
     ucp_cleanup(self->ucp_context);
+    ucc_tune_file_free(&self->tune);
 }
 
 UCC_CLASS_DEFINE(ucc_tl_ucp_context_t, ucc_tl_context_t);
@@ -232,27 +416,71 @@ ucc_status_t ucc_tl_ucp_populate_rcache(void *addr, size_t length,
     return UCC_OK;
 }
 
+static ucc_status_t ucc_tl_ucp_pack_addr(ucc_tl_ucp_context_t *ctx)
+{
+    ucc_tl_ucp_worker_t *worker;
+    ucs_status_t         ucs_status;
+    uint32_t            *header;
+    size_t               offset;
+    uint32_t             i;
+
+    offset = sizeof(uint32_t) * (ctx->n_workers + 1);
+    for (i = 0; i < ctx->n_workers; i++) {
+        worker     = UCC_TL_UCP_CTX_WORKER(ctx, i);
+        ucs_status = ucp_worker_get_address(
+            worker->ucp_worker, &worker->address, &worker->address_len);
+        if (UCS_OK != ucs_status) {
+            tl_error(ctx->super.super.lib, "failed to get ucp worker address");
+            return ucs_status_to_ucc_status(ucs_status);
+        }
+        offset += worker->address_len;
+    }
+    ctx->addr = ucc_malloc(offset, "tl_ucp_ctx_addr");
+    if (!ctx->addr) {
+        tl_error(ctx->super.super.lib,
+                 "failed to allocate %zd bytes for ctx address", offset);
+        return UCC_ERR_NO_MEMORY;
+    }
+    ctx->addr_len = offset;
+    header        = ctx->addr;
+    header[0]     = ctx->n_workers;
+    offset        = sizeof(uint32_t) * (ctx->n_workers + 1);
+    for (i = 0; i < ctx->n_workers; i++) {
+        worker        = UCC_TL_UCP_CTX_WORKER(ctx, i);
+        header[i + 1] = (uint32_t)worker->address_len;
+        memcpy(PTR_OFFSET(ctx->addr, offset), worker->address,
+               worker->address_len);
+        offset += worker->address_len;
+    }
+    return UCC_OK;
+}
+
 ucc_status_t ucc_tl_ucp_get_context_attr(const ucc_base_context_t *context,
                                          ucc_base_ctx_attr_t      *attr)
 {
     ucc_tl_ucp_context_t *ctx = ucc_derived_of(context, ucc_tl_ucp_context_t);
-    ucs_status_t          ucs_status;
+    ucc_tl_ucp_lib_t     *lib =
+        ucc_derived_of(ctx->super.super.lib, ucc_tl_ucp_lib_t);
+    ucc_status_t          status;
+
     if ((attr->attr.mask & (UCC_CONTEXT_ATTR_FIELD_CTX_ADDR_LEN |
                             UCC_CONTEXT_ATTR_FIELD_CTX_ADDR)) &&
-        (NULL == ctx->worker_address)) {
-        ucs_status = ucp_worker_get_address(
-            ctx->ucp_worker, &ctx->worker_address, &ctx->ucp_addrlen);
-        if (UCS_OK != ucs_status) {
-            tl_error(ctx->super.super.lib, "failed to get ucp worker address");
-            return ucs_status_to_ucc_status(ucs_status);
+        (NULL == ctx->addr)) {
+        status = ucc_tl_ucp_pack_addr(ctx);
+        if (UCC_OK != status) {
+            return status;
         }
     }
     if (attr->attr.mask & UCC_CONTEXT_ATTR_FIELD_CTX_ADDR_LEN) {
-        attr->attr.ctx_addr_len = ctx->ucp_addrlen;
+        attr->attr.ctx_addr_len = ctx->addr_len;
     }
     if (attr->attr.mask & UCC_CONTEXT_ATTR_FIELD_CTX_ADDR) {
-        memcpy(attr->attr.ctx_addr, ctx->worker_address, ctx->ucp_addrlen);
+        memcpy(attr->attr.ctx_addr, ctx->addr, ctx->addr_len);
     }
-    attr->topo_required = 0;
+    /* team shape is needed to find the tuning file entry, to select
+       knomial radix automatically and to aggregate alltoall on nodes */
+    attr->topo_required = (ctx->tune.n_entries > 0) ||
+                          ucc_tl_ucp_kn_radix_is_auto(&lib->cfg) ||
+                          (lib->cfg.alltoall_node_agg_thresh > 0);
     return UCC_OK;
 }
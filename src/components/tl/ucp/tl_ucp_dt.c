@@ -0,0 +1,358 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tl_ucp.h"
+#include "tl_ucp_coll.h"
+#include "tl_ucp_sendrecv.h"
+#include "core/ucc_mc.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_coll_utils.h"
+
+/* State of a single message of the generic datatype */
+typedef struct ucc_tl_ucp_dt_state {
+    const ucc_tl_ucp_dt_t *dt;
+    void                  *buffer;
+    size_t                 total; /*< packed size of the message */
+} ucc_tl_ucp_dt_state_t;
+
+static void *ucc_tl_ucp_dt_start(void *context, void *buffer, size_t count)
+{
+    ucc_tl_ucp_dt_t       *dt = context;
+    ucc_tl_ucp_dt_state_t *state;
+
+    state = ucc_malloc(sizeof(*state), "tl_ucp_dt_state");
+    if (ucc_unlikely(!state)) {
+        return NULL;
+    }
+    state->dt     = dt;
+    state->buffer = buffer;
+    state->total  = count * dt->size;
+    return state;
+}
+
+static void *ucc_tl_ucp_dt_start_pack(void *context, const void *buffer,
+                                      size_t count)
+{
+    return ucc_tl_ucp_dt_start(context, (void *)buffer, count);
+}
+
+static void *ucc_tl_ucp_dt_start_unpack(void *context, void *buffer,
+                                        size_t count)
+{
+    return ucc_tl_ucp_dt_start(context, buffer, count);
+}
+
+static size_t ucc_tl_ucp_dt_packed_size(void *state)
+{
+    return ((ucc_tl_ucp_dt_state_t *)state)->total;
+}
+
+static size_t ucc_tl_ucp_dt_pack(void *state, size_t offset, void *dest,
+                                 size_t max_length)
+{
+    ucc_tl_ucp_dt_state_t *s   = state;
+    size_t                 len = ucc_min(max_length, s->total - offset);
+
+    /* UCP has no way to fail a pack, returning less data than requested
+       would silently corrupt the message */
+    if (ucc_unlikely(UCC_OK != ucc_mc_pack(dest, s->buffer, s->dt->layout,
+                                           offset, len,
+                                           UCC_MEMORY_TYPE_HOST))) {
+        ucc_fatal("failed to pack %zd bytes at offset %zd of user defined "
+                  "datatype", len, offset);
+    }
+    return len;
+}
+
+static ucs_status_t ucc_tl_ucp_dt_unpack(void *state, size_t offset,
+                                         const void *src, size_t length)
+{
+    ucc_tl_ucp_dt_state_t *s = state;
+
+    if (ucc_unlikely(offset + length > s->total)) {
+        return UCS_ERR_MESSAGE_TRUNCATED;
+    }
+    if (ucc_unlikely(UCC_OK != ucc_mc_unpack(s->buffer, src, s->dt->layout,
+                                             offset, length,
+                                             UCC_MEMORY_TYPE_HOST))) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+    return UCS_OK;
+}
+
+static void ucc_tl_ucp_dt_finish(void *state)
+{
+    ucc_free(state);
+}
+
+static ucp_generic_dt_ops_t ucc_tl_ucp_dt_ops = {
+    .start_pack   = ucc_tl_ucp_dt_start_pack,
+    .start_unpack = ucc_tl_ucp_dt_start_unpack,
+    .packed_size  = ucc_tl_ucp_dt_packed_size,
+    .pack         = ucc_tl_ucp_dt_pack,
+    .unpack       = ucc_tl_ucp_dt_unpack,
+    .finish       = ucc_tl_ucp_dt_finish};
+
+static ucc_status_t ucc_tl_ucp_dt_create(ucc_tl_ucp_task_t *task,
+                                         ucc_tl_ucp_dt_t   *dt,
+                                         ucc_datatype_t     datatype,
+                                         ucc_memory_type_t  mem_type,
+                                         int                is_src)
+{
+    ucs_status_t status;
+
+    dt->layout  = ucc_coll_args_dt_layout(&task->super.args, datatype,
+                                          is_src);
+    dt->generic = 0;
+    if (datatype != UCC_DT_USERDEFINED) {
+        dt->size = ucc_dt_size(datatype);
+        return UCC_OK;
+    }
+    if (!dt->layout || dt->layout->n_blocks == 0) {
+        tl_debug(UCC_TASK_LIB(task), "layout of user defined datatype is "
+                 "not provided");
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    if (mem_type != UCC_MEMORY_TYPE_HOST) {
+        tl_debug(UCC_TASK_LIB(task), "user defined datatypes are supported "
+                 "only for host memory");
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    dt->size = ucc_dt_userdefined_size(dt->layout);
+    status   = ucp_dt_create_generic(&ucc_tl_ucp_dt_ops, dt, &dt->generic);
+    if (UCS_OK != status) {
+        tl_error(UCC_TASK_LIB(task), "failed to create ucp datatype: %s",
+                 ucs_status_string(status));
+        return ucs_status_to_ucc_status(status);
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_task_dt_init(ucc_tl_ucp_task_t *task,
+                                     ucc_datatype_t     src_dt,
+                                     ucc_memory_type_t  src_mem,
+                                     ucc_datatype_t     dst_dt,
+                                     ucc_memory_type_t  dst_mem)
+{
+    ucc_status_t status;
+
+    if (src_dt != UCC_DT_USERDEFINED && dst_dt != UCC_DT_USERDEFINED) {
+        return UCC_OK;
+    }
+    task->dt = ucc_calloc(2, sizeof(ucc_tl_ucp_dt_t), "tl_ucp_task_dt");
+    if (!task->dt) {
+        tl_error(UCC_TASK_LIB(task), "failed to allocate %zd bytes",
+                 2 * sizeof(ucc_tl_ucp_dt_t));
+        return UCC_ERR_NO_MEMORY;
+    }
+    status = ucc_tl_ucp_dt_create(task, &task->dt[UCC_TL_UCP_DT_SRC], src_dt,
+                                  src_mem, 1);
+    if (UCC_OK == status) {
+        status = ucc_tl_ucp_dt_create(task, &task->dt[UCC_TL_UCP_DT_DST],
+                                      dst_dt, dst_mem, 0);
+    }
+    if (UCC_OK != status) {
+        ucc_tl_ucp_task_dt_cleanup(task);
+    }
+    return status;
+}
+
+void ucc_tl_ucp_task_dt_cleanup(ucc_tl_ucp_task_t *task)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        if (task->dt[i].generic) {
+            ucp_dt_destroy(task->dt[i].generic);
+        }
+    }
+    ucc_free(task->dt);
+    task->dt = NULL;
+}
+
+/* Fills iov with the pieces of count elements, adjacent pieces are
+   merged. Returns the number of pieces or 0 if there are more than
+   UCC_TL_UCP_DT_IOV_MAX of them. */
+static size_t ucc_tl_ucp_dt_iov(void *buffer, size_t count,
+                                const ucc_dt_userdefined_t *layout,
+                                ucp_dt_iov_t *iov)
+{
+    size_t   n = 0;
+    size_t   i;
+    uint64_t b;
+    void    *piece;
+
+    for (i = 0; i < count; i++) {
+        for (b = 0; b < layout->n_blocks; b++) {
+            if (layout->blocks[b].length == 0) {
+                continue;
+            }
+            piece = PTR_OFFSET(buffer,
+                               i * layout->extent + layout->blocks[b].offset);
+            if (n > 0 && PTR_OFFSET(iov[n - 1].buffer,
+                                    iov[n - 1].length) == piece) {
+                iov[n - 1].length += layout->blocks[b].length;
+                continue;
+            }
+            if (n == UCC_TL_UCP_DT_IOV_MAX) {
+                return 0;
+            }
+            iov[n].buffer = piece;
+            iov[n].length = layout->blocks[b].length;
+            n++;
+        }
+    }
+    return n;
+}
+
+static void ucc_tl_ucp_dt_iov_send_cb(void *request, ucs_status_t status,
+                                      void *user_data)
+{
+    ucc_tl_ucp_dt_iov_req_t *req = user_data;
+
+    ucc_tl_ucp_send_completion_cb(request, status, req->task);
+    ucc_mpool_put(req);
+}
+
+static void ucc_tl_ucp_dt_iov_recv_cb(void *request, ucs_status_t status,
+                                      const ucp_tag_recv_info_t *info,
+                                      void *user_data)
+{
+    ucc_tl_ucp_dt_iov_req_t *req = user_data;
+
+    ucc_tl_ucp_recv_completion_cb(request, status, info, req->task);
+    ucc_mpool_put(req);
+}
+
+/* Sets the datatype of the message: iov if the message has a few pieces,
+   generic otherwise. *iov_req is set if the request owns an iov array,
+   only such messages take a request from the context mpool. */
+static ucc_status_t ucc_tl_ucp_dt_req_param(void *buffer, size_t *count,
+                                            ucc_tl_ucp_dt_t   *dt,
+                                            ucc_tl_ucp_task_t *task,
+                                            ucp_request_param_t *param,
+                                            ucc_tl_ucp_dt_iov_req_t **iov_req)
+{
+    ucp_dt_iov_t             iov[UCC_TL_UCP_DT_IOV_MAX];
+    ucc_tl_ucp_dt_iov_req_t *req;
+    size_t                   n;
+
+    *iov_req = NULL;
+    param->op_attr_mask =
+        UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_DATATYPE |
+        UCP_OP_ATTR_FIELD_USER_DATA | UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+    param->memory_type = UCS_MEMORY_TYPE_HOST;
+    param->user_data   = task;
+    param->datatype    = dt->generic;
+    if (*count * dt->layout->n_blocks > UCC_TL_UCP_DT_IOV_MAX * 4) {
+        /* too many pieces even if some of them are merged */
+        return UCC_OK;
+    }
+    n = ucc_tl_ucp_dt_iov(buffer, *count, dt->layout, iov);
+    if (n == 0) {
+        return UCC_OK;
+    }
+    req = ucc_mpool_get(&TASK_CTX(task)->dt_iov_mp);
+    if (ucc_unlikely(!req)) {
+        tl_error(UCC_TASK_LIB(task), "failed to get iov request from mpool");
+        return UCC_ERR_NO_MEMORY;
+    }
+    memcpy(req->iov, iov, n * sizeof(*iov));
+    req->task        = task;
+    param->datatype  = ucp_dt_make_iov();
+    param->user_data = req;
+    *count           = n;
+    *iov_req         = req;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_dt_send_nb(void *buffer, size_t count,
+                                   ucc_tl_ucp_dt_t   *dt,
+                                   ucc_rank_t         dest_group_rank,
+                                   ucc_tl_ucp_team_t *team,
+                                   ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_dt_iov_req_t *iov_req;
+    ucp_request_param_t      req_param;
+    ucs_status_ptr_t         ucp_status;
+    ucc_status_t             status;
+    ucp_ep_h                 ep;
+    ucp_tag_t                ucp_tag;
+
+    status = ucc_tl_ucp_get_ep(team, task->worker, dest_group_rank, &ep);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    status = ucc_tl_ucp_dt_req_param(buffer, &count, dt, task, &req_param,
+                                     &iov_req);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    ucp_tag = UCC_TL_UCP_MAKE_SEND_TAG(task->tag, team->rank, team->id,
+                                       team->scope_id, team->scope);
+    if (iov_req) {
+        req_param.cb.send = ucc_tl_ucp_dt_iov_send_cb;
+        buffer            = iov_req->iov;
+    } else {
+        req_param.cb.send = ucc_tl_ucp_send_completion_cb;
+    }
+    ucp_status = ucp_tag_send_nbx(ep, buffer, count, ucp_tag, &req_param);
+    task->send_posted++;
+    if (UCC_OK != ucp_status) {
+        if (ucc_unlikely(UCS_PTR_IS_ERR(ucp_status)) && iov_req) {
+            ucc_mpool_put(iov_req);
+        }
+        UCC_TL_UCP_CHECK_REQ_STATUS();
+    } else {
+        if (iov_req) {
+            ucc_mpool_put(iov_req);
+        }
+        task->send_completed++;
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_dt_recv_nb(void *buffer, size_t count,
+                                   ucc_tl_ucp_dt_t   *dt,
+                                   ucc_rank_t         dest_group_rank,
+                                   ucc_tl_ucp_team_t *team,
+                                   ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_dt_iov_req_t *iov_req;
+    ucp_request_param_t      req_param;
+    ucs_status_ptr_t         ucp_status;
+    ucc_status_t             status;
+    ucp_tag_t                ucp_tag, ucp_tag_mask;
+
+    status = ucc_tl_ucp_dt_req_param(buffer, &count, dt, task, &req_param,
+                                     &iov_req);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    UCC_TL_UCP_MAKE_RECV_TAG(ucp_tag, ucp_tag_mask, task->tag, dest_group_rank,
+                             team->id, team->scope_id, team->scope);
+    if (iov_req) {
+        req_param.cb.recv = ucc_tl_ucp_dt_iov_recv_cb;
+        buffer            = iov_req->iov;
+    } else {
+        req_param.cb.recv = ucc_tl_ucp_recv_completion_cb;
+    }
+    ucp_status = ucp_tag_recv_nbx(task->worker->ucp_worker, buffer, count,
+                                  ucp_tag, ucp_tag_mask, &req_param);
+    task->recv_posted++;
+    if (UCC_OK != ucp_status) {
+        if (ucc_unlikely(UCS_PTR_IS_ERR(ucp_status)) && iov_req) {
+            ucc_mpool_put(iov_req);
+        }
+        UCC_TL_UCP_CHECK_REQ_STATUS();
+    } else {
+        if (iov_req) {
+            ucc_mpool_put(iov_req);
+        }
+        task->recv_completed++;
+    }
+    return UCC_OK;
+}
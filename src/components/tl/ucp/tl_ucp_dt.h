@@ -0,0 +1,61 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_DT_H_
+#define UCC_TL_UCP_DT_H_
+
+#include "tl_ucp.h"
+
+/* Largest number of contiguous pieces of a message sent as UCP iov */
+#define UCC_TL_UCP_DT_IOV_MAX 16
+
+enum {
+    UCC_TL_UCP_DT_SRC,
+    UCC_TL_UCP_DT_DST
+};
+
+/* UCP representation of a user defined datatype. Messages made of a few
+   contiguous pieces are sent as UCP iov, the others use a UCP generic
+   datatype which packs and unpacks the data fragment by fragment with
+   MC pack/unpack straight from the user buffer, so the user does not
+   need a contiguous copy of the data. */
+typedef struct ucc_tl_ucp_dt {
+    const ucc_dt_userdefined_t *layout;  /*< NULL for predefined datatype */
+    size_t                      size;    /*< packed size of an element */
+    ucp_datatype_t              generic;
+} ucc_tl_ucp_dt_t;
+
+/* Request of a message sent as iov, the iov array must stay valid until
+   the message completes. Taken from the context dt_iov_mp. */
+typedef struct ucc_tl_ucp_dt_iov_req {
+    ucc_tl_ucp_task_t *task;
+    ucp_dt_iov_t       iov[UCC_TL_UCP_DT_IOV_MAX];
+} ucc_tl_ucp_dt_iov_req_t;
+
+/* Creates UCP datatypes for the user defined src and dst datatypes of the
+   task, task->dt stays NULL if both are predefined. User defined
+   datatypes require the layout in the collective args and host memory. */
+ucc_status_t ucc_tl_ucp_task_dt_init(ucc_tl_ucp_task_t *task,
+                                     ucc_datatype_t     src_dt,
+                                     ucc_memory_type_t  src_mem,
+                                     ucc_datatype_t     dst_dt,
+                                     ucc_memory_type_t  dst_mem);
+
+void ucc_tl_ucp_task_dt_cleanup(ucc_tl_ucp_task_t *task);
+
+ucc_status_t ucc_tl_ucp_dt_send_nb(void *buffer, size_t count,
+                                   ucc_tl_ucp_dt_t   *dt,
+                                   ucc_rank_t         dest_group_rank,
+                                   ucc_tl_ucp_team_t *team,
+                                   ucc_tl_ucp_task_t *task);
+
+ucc_status_t ucc_tl_ucp_dt_recv_nb(void *buffer, size_t count,
+                                   ucc_tl_ucp_dt_t   *dt,
+                                   ucc_rank_t         dest_group_rank,
+                                   ucc_tl_ucp_team_t *team,
+                                   ucc_tl_ucp_task_t *task);
+
+#endif
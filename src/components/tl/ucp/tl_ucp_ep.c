@@ -9,12 +9,13 @@ static void ucc_tl_ucp_err_handler(void *arg, ucp_ep_h ep, ucs_status_t status)
     ;
 }
 
-static inline ucc_status_t ucc_tl_ucp_connect_ep(ucc_tl_ucp_context_t *ctx,
-                                                 ucp_ep_h             *ep,
+static inline ucc_status_t ucc_tl_ucp_connect_ep(ucc_tl_ucp_worker_t *worker,
+                                                 ucp_ep_h            *ep,
                                                  void *ucp_address)
 {
-    ucp_ep_params_t ep_params;
-    ucs_status_t    status;
+    ucc_tl_ucp_context_t *ctx = worker->ctx;
+    ucp_ep_params_t       ep_params;
+    ucs_status_t          status;
     if (*ep) {
         /* Already connected */
         return UCC_OK;
@@ -29,7 +30,7 @@ static inline ucc_status_t ucc_tl_ucp_connect_ep(ucc_tl_ucp_context_t *ctx,
         ep_params.field_mask     |= UCP_EP_PARAM_FIELD_ERR_HANDLING_MODE |
                                     UCP_EP_PARAM_FIELD_ERR_HANDLER;
     }
-    status = ucp_ep_create(ctx->ucp_worker, &ep_params, ep);
+    status = ucp_ep_create(worker->ucp_worker, &ep_params, ep);
 
     if (ucc_unlikely(UCS_OK != status)) {
         tl_error(ctx->super.super.lib, "ucp returned connect error: %s",
@@ -39,33 +40,83 @@ static inline ucc_status_t ucc_tl_ucp_connect_ep(ucc_tl_ucp_context_t *ctx,
     return UCC_OK;
 }
 
+/* Returns the address of the peer worker with the same index as the local
+   one from the packed TL/UCP context address */
+static inline void *ucc_tl_ucp_unpack_worker_addr(ucc_tl_ucp_worker_t *worker,
+                                                  void *packed)
+{
+    uint32_t *header    = packed;
+    uint32_t  n_workers = header[0];
+    size_t    offset    = sizeof(uint32_t) * (n_workers + 1);
+    int       i;
+
+    if (ucc_unlikely(worker->id >= n_workers)) {
+        tl_error(worker->ctx->super.super.lib,
+                 "peer has %u workers, can't connect worker %d", n_workers,
+                 worker->id);
+        return NULL;
+    }
+    for (i = 0; i < worker->id; i++) {
+        offset += header[i + 1];
+    }
+    return PTR_OFFSET(packed, offset);
+}
+
 ucc_status_t ucc_tl_ucp_connect_team_ep(ucc_tl_ucp_team_t         *team,
+                                        ucc_tl_ucp_worker_t       *worker,
                                         ucc_rank_t                 team_rank,
                                         ucp_ep_h                  *ep)
 {
-    ucc_tl_ucp_context_t *ctx = UCC_TL_UCP_TEAM_CTX(team);
-    void                 *addr;
+    void *addr;
 
-    addr = ucc_get_team_ep_addr(UCC_TL_CORE_CTX(team), team->super.super.team,
-                                team_rank, ucc_tl_ucp.super.super.id);
-    return ucc_tl_ucp_connect_ep(ctx, ep, addr);
+    addr = ucc_get_team_ep_addr(worker->ctx->super.super.ucc_context,
+                                team->super.super.team, team_rank,
+                                ucc_tl_ucp.super.super.id);
+    addr = ucc_tl_ucp_unpack_worker_addr(worker, addr);
+    if (ucc_unlikely(!addr)) {
+        return UCC_ERR_NOT_FOUND;
+    }
+    return ucc_tl_ucp_connect_ep(worker, ep, addr);
+}
+
+static inline ucp_ep_h ucc_tl_ucp_pop_ep(ucc_tl_ucp_worker_t *worker,
+                                         size_t *idx)
+{
+    ucp_ep_h ep;
+
+    if (!worker->eps) {
+        return tl_ucp_hash_pop(worker->ep_hash);
+    }
+    while (*idx < worker->ctx->super.super.ucc_context->addr_storage.size) {
+        ep = worker->eps[*idx];
+        worker->eps[(*idx)++] = NULL;
+        if (ep) {
+            return ep;
+        }
+    }
+    return NULL;
 }
 
-void ucc_tl_ucp_close_eps(ucc_tl_ucp_context_t *ctx)
+void ucc_tl_ucp_close_eps(ucc_tl_ucp_worker_t *worker)
 {
+     ucc_tl_ucp_context_t        *ctx    = worker->ctx;
+     size_t                       ep_idx = 0;
      ucp_ep_h                     ep;
      ucs_status_t                 status;
      void **                      close_reqs;
      void *                       close_req;
+     size_t                       max_eps;
      int                          i, close_reqs_counter = 0;
 
-     close_reqs = (void **)ucc_malloc(sizeof(void *) * kh_size(ctx->ep_hash),
+     max_eps = worker->eps ? ctx->super.super.ucc_context->addr_storage.size
+                           : kh_size(worker->ep_hash);
+     close_reqs = (void **)ucc_malloc(sizeof(void *) * max_eps,
                                       "ep close requests array");
      if (!close_reqs) {
          tl_error(ctx->super.super.lib, "Unable to allocate memory");
          return;
      }
-     ep = tl_ucp_hash_pop(ctx->ep_hash);
+     ep = ucc_tl_ucp_pop_ep(worker, &ep_idx);
      while (ep) {
          close_req = ucp_ep_close_nb(ep, UCP_EP_CLOSE_MODE_FLUSH);
          if (UCS_PTR_IS_PTR(close_req)) {
@@ -78,13 +129,13 @@ void ucc_tl_ucp_close_eps(ucc_tl_ucp_context_t *ctx)
                       ep, ucc_status_string(ucs_status_to_ucc_status(UCS_PTR_STATUS(close_req))));
              // In case we have no OOB, we have no barrier to sync closure, and we can ignore errors, which are expected
          }
-         ep = tl_ucp_hash_pop(ctx->ep_hash);
+         ep = ucc_tl_ucp_pop_ep(worker, &ep_idx);
      }
      for (i = 0; i < close_reqs_counter; i++) {
          close_req = close_reqs[i];
          // TODO: Should we put a timer? in UCX, some examples have timer, and some don't
          do {
-             ucp_worker_progress(ctx->ucp_worker);
+             ucp_worker_progress(worker->ucp_worker);
              status = ucp_request_check_status(close_req);
          } while (status == UCS_INPROGRESS && close_req);
          if (close_req) {
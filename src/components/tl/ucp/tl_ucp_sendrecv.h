@@ -9,6 +9,7 @@
 #define UCC_TL_UCP_SENDRECV_H_
 #include "tl_ucp_tag.h"
 #include "tl_ucp_ep.h"
+#include "tl_ucp_dt.h"
 #include "utils/ucc_compiler_def.h"
 #include "components/mc/base/ucc_mc_base.h"
 
@@ -48,7 +49,7 @@ void ucc_tl_ucp_recv_completion_cb(void *request, ucs_status_t status,
                      "tag %u; dest %d; team_id %u; errmsg %s", task->tag,      \
                      dest_group_rank, team->id,                                \
                      ucs_status_string(UCS_PTR_STATUS(ucp_status)));           \
-            ucp_request_cancel(UCC_TL_UCP_WORKER(team), ucp_status);           \
+            ucp_request_cancel(task->worker->ucp_worker, ucp_status);          \
             ucp_request_free(ucp_status);                                      \
             return UCC_ERR_NO_MESSAGE;                                         \
         }                                                                      \
@@ -66,7 +67,7 @@ static inline ucc_status_t ucc_tl_ucp_send_nb(void *buffer, size_t msglen,
     ucp_ep_h            ep;
     ucp_tag_t           ucp_tag;
 
-    status = ucc_tl_ucp_get_ep(team, dest_group_rank, &ep);
+    status = ucc_tl_ucp_get_ep(team, task->worker, dest_group_rank, &ep);
     if (ucc_unlikely(UCC_OK != status)) {
         return status;
     }
@@ -108,7 +109,7 @@ static inline ucc_status_t ucc_tl_ucp_recv_nb(void *buffer, size_t msglen,
     req_param.cb.recv     = ucc_tl_ucp_recv_completion_cb;
     req_param.memory_type = ucc_memtype_to_ucs[mtype];
     req_param.user_data   = (void *)task;
-    ucp_status = ucp_tag_recv_nbx(UCC_TL_UCP_WORKER(team), buffer, 1, ucp_tag,
+    ucp_status = ucp_tag_recv_nbx(task->worker->ucp_worker, buffer, 1, ucp_tag,
                                   ucp_tag_mask, &req_param);
     task->recv_posted++;
     if (UCC_OK != ucp_status) {
@@ -151,6 +152,50 @@ static inline ucc_status_t ucc_tl_ucp_send_nz(void *buffer, size_t msglen,
                               dest_group_rank, team, task);
 }
 
+/* Sends count elements of datatype: through the UCP datatype of the task
+   for the user defined src (idx == UCC_TL_UCP_DT_SRC) or dst datatype,
+   as contiguous buffer otherwise. */
+static inline ucc_status_t ucc_tl_ucp_send_elems(void *buffer, size_t count,
+                                                 ucc_datatype_t datatype,
+                                                 int idx,
+                                                 ucc_memory_type_t mtype,
+                                                 ucc_rank_t dest_group_rank,
+                                                 ucc_tl_ucp_team_t *team,
+                                                 ucc_tl_ucp_task_t *task)
+{
+    if (task->dt && task->dt[idx].layout) {
+        if (count == 0) {
+            task->send_posted++;
+            task->send_completed++;
+            return UCC_OK;
+        }
+        return ucc_tl_ucp_dt_send_nb(buffer, count, &task->dt[idx],
+                                     dest_group_rank, team, task);
+    }
+    return ucc_tl_ucp_send_nz(buffer, count * ucc_dt_size(datatype), mtype,
+                              dest_group_rank, team, task);
+}
+
+static inline ucc_status_t ucc_tl_ucp_recv_elems(void *buffer, size_t count,
+                                                 ucc_datatype_t datatype,
+                                                 int idx,
+                                                 ucc_memory_type_t mtype,
+                                                 ucc_rank_t dest_group_rank,
+                                                 ucc_tl_ucp_team_t *team,
+                                                 ucc_tl_ucp_task_t *task)
+{
+    if (task->dt && task->dt[idx].layout) {
+        if (count == 0) {
+            task->recv_posted++;
+            task->recv_completed++;
+            return UCC_OK;
+        }
+        return ucc_tl_ucp_dt_recv_nb(buffer, count, &task->dt[idx],
+                                     dest_group_rank, team, task);
+    }
+    return ucc_tl_ucp_recv_nz(buffer, count * ucc_dt_size(datatype), mtype,
+                              dest_group_rank, team, task);
+}
 
 #define UCPCHECK_GOTO(_cmd, _task, _label)                                     \
     do {                                                                       \
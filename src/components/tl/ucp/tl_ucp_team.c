@@ -10,12 +10,220 @@
 #include "tl_ucp_sendrecv.h"
 #include "utils/ucc_malloc.h"
 #include "coll_score/ucc_coll_score.h"
+#include "coll_patterns/sra_knomial.h"
+
+/* If the core team is created over multiple contexts then the workers of
+   TL/UCP contexts of all of them are used as communication lanes. Lane 0
+   is always the worker of the team context. If the contexts have worker
+   pools then the team is bound to the pool worker selected by team id.
+   The contexts configuration is expected to be the same on all the ranks
+   of the team, so that the number of lanes is the same everywhere. */
+static ucc_status_t ucc_tl_ucp_team_init_lanes(ucc_tl_ucp_team_t    *team,
+                                               ucc_tl_ucp_context_t *ctx,
+                                               ucc_team_t           *core_team)
+{
+    uint32_t              n_ctxs = core_team ? core_team->num_contexts : 1;
+    ucc_tl_context_t     *tl_ctx;
+    ucc_tl_ucp_context_t *lane_ctx;
+    uint32_t              i;
+
+    team->lanes = ucc_malloc(sizeof(ucc_tl_ucp_worker_t *) * n_ctxs,
+                             "tl_ucp_lanes");
+    if (!team->lanes) {
+        tl_error(ctx->super.super.lib,
+                 "failed to allocate %zd bytes for lanes array",
+                 sizeof(ucc_tl_ucp_worker_t *) * n_ctxs);
+        return UCC_ERR_NO_MEMORY;
+    }
+    team->lanes[0] = UCC_TL_UCP_CTX_WORKER(ctx, team->id % ctx->n_workers);
+    team->n_lanes  = 1;
+    for (i = 1; i < n_ctxs; i++) {
+        if (UCC_OK != ucc_tl_context_get(core_team->contexts[i], "ucp",
+                                         &tl_ctx)) {
+            tl_debug(ctx->super.super.lib,
+                     "tl ucp is not available on context %p, lane skipped",
+                     core_team->contexts[i]);
+            continue;
+        }
+        lane_ctx = ucc_derived_of(tl_ctx, ucc_tl_ucp_context_t);
+        team->lanes[team->n_lanes++] =
+            UCC_TL_UCP_CTX_WORKER(lane_ctx, team->id % lane_ctx->n_workers);
+    }
+    return UCC_OK;
+}
+
+/* Number of nodes and ppn of the team taken from the context topology, so
+   all the ranks see the same shape. The shape is computed over the ranks of
+   the TL team itself, which may be a subset of the core team. Without the
+   topology every rank is assumed to run on its own node. */
+static ucc_status_t ucc_tl_ucp_team_init_shape(ucc_tl_ucp_team_t *team,
+                                               ucc_team_t        *core_team)
+{
+    ucc_topo_t   *topo;
+    ucc_rank_t   *n_local;
+    ucc_rank_t    i;
+    ucc_host_id_t host;
+
+    team->nnodes = team->size;
+    team->ppn    = 1;
+    if (!core_team || !core_team->topo) {
+        return UCC_OK;
+    }
+    topo    = core_team->topo->topo;
+    n_local = ucc_calloc(topo->nnodes, sizeof(ucc_rank_t), "n_local");
+    if (!n_local) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate %zd bytes for "
+                 "n_local", topo->nnodes * sizeof(ucc_rank_t));
+        return UCC_ERR_NO_MEMORY;
+    }
+    team->nnodes = 0;
+    team->ppn    = 0;
+    for (i = 0; i < team->size; i++) {
+        host = topo->procs[ucc_get_ctx_rank(core_team, i)].host_id;
+        if (n_local[host]++ == 0) {
+            team->nnodes++;
+        }
+        team->ppn = ucc_max(team->ppn, n_local[host]);
+    }
+    ucc_free(n_local);
+    return UCC_OK;
+}
+
+#define UCC_TL_UCP_NO_NODE ((ucc_rank_t)-1)
+
+/* Node map is built on every rank or team creation fails, so that all the
+   ranks make the same node aggregation decisions. */
+static ucc_status_t ucc_tl_ucp_team_init_node_map(ucc_tl_ucp_team_t *team,
+                                                  ucc_team_t        *core_team)
+{
+    ucc_topo_t            *topo;
+    ucc_tl_ucp_node_map_t *map;
+    ucc_rank_t            *host_node, *fill;
+    ucc_rank_t             i, n;
+    ucc_host_id_t          host;
+
+    team->node_map = NULL;
+    if (team->nnodes < 2 || team->ppn < 2) {
+        return UCC_OK;
+    }
+    topo      = core_team->topo->topo;
+    host_node = ucc_malloc(topo->nnodes * sizeof(ucc_rank_t), "host_node");
+    map       = ucc_malloc(sizeof(*map) + (3 * team->size + 2 * team->nnodes +
+                                           1) * sizeof(ucc_rank_t),
+                           "node_map");
+    if (!host_node || !map) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate node map");
+        ucc_free(host_node);
+        ucc_free(map);
+        return UCC_ERR_NO_MEMORY;
+    }
+    map->nnodes     = team->nnodes;
+    map->node_of    = PTR_OFFSET(map, sizeof(*map));
+    map->pos        = map->node_of + team->size;
+    map->members    = map->pos + team->size;
+    map->node_start = map->members + team->size;
+    fill            = map->node_start + team->nnodes + 1;
+    for (i = 0; i < topo->nnodes; i++) {
+        host_node[i] = UCC_TL_UCP_NO_NODE;
+    }
+    memset(map->node_start, 0, (team->nnodes + 1) * sizeof(ucc_rank_t));
+    n = 0;
+    for (i = 0; i < team->size; i++) {
+        host = topo->procs[ucc_get_ctx_rank(core_team, i)].host_id;
+        if (host_node[host] == UCC_TL_UCP_NO_NODE) {
+            host_node[host] = n++;
+        }
+        map->node_of[i] = host_node[host];
+        map->node_start[map->node_of[i] + 1]++;
+    }
+    ucc_assert(n == team->nnodes);
+    for (n = 0; n < team->nnodes; n++) {
+        map->node_start[n + 1] += map->node_start[n];
+        fill[n]                 = map->node_start[n];
+    }
+    for (i = 0; i < team->size; i++) {
+        map->pos[i]                = fill[map->node_of[i]]++;
+        map->members[map->pos[i]] = i;
+    }
+    map->my_node   = map->node_of[team->rank];
+    team->node_map = map;
+    ucc_free(host_node);
+    return UCC_OK;
+}
+
+/* Builds the knomial peer tables of the team rank for all the radices up
+   to UCC_TL_UCP_KN_TABLE_MAX_RADIX, so that collectives only read them.
+   Radices for which the rank is extra and tables that can not be allocated
+   are left NULL, the pattern then computes the peers on the fly. */
+static void ucc_tl_ucp_team_init_kn_tables(ucc_tl_ucp_team_t *team)
+{
+    ucc_kn_radix_t        max_radix = ucc_min(team->size,
+                                              UCC_TL_UCP_KN_TABLE_MAX_RADIX);
+    ucc_knomial_table_t  *tbl;
+    ucc_knomial_pattern_t p;
+    ucc_kn_radix_t        radix;
+
+    memset(team->kn_tables, 0, sizeof(team->kn_tables));
+    for (radix = 2; radix <= max_radix; radix++) {
+        ucc_knomial_pattern_init(team->size, team->rank, radix, &p);
+        if (p.node_type == KN_NODE_EXTRA) {
+            continue;
+        }
+        tbl = ucc_malloc(ucc_knomial_table_size(&p), "kn_table");
+        if (!tbl) {
+            tl_debug(UCC_TL_TEAM_LIB(team), "failed to allocate kn table");
+            return;
+        }
+        ucc_sra_kn_table_init(tbl, team->size, team->rank, &p);
+        team->kn_tables[radix] = tbl;
+    }
+}
+
+/* Applies the tuning file entry matching the number of nodes and ppn of
+   the team. */
+static void ucc_tl_ucp_team_apply_tune(ucc_tl_ucp_team_t    *team,
+                                       ucc_tl_ucp_context_t *ctx,
+                                       ucc_team_t           *core_team)
+{
+    const ucc_tune_file_entry_t *e;
+    ucc_rank_t                     nnodes = team->nnodes;
+    ucc_rank_t                     ppn    = team->ppn;
+    int                            i;
+
+    if (ctx->tune.n_entries == 0) {
+        return;
+    }
+    if (!core_team || !core_team->topo) {
+        tl_debug(ctx->super.super.lib, "team %p has no topology, tuning file "
+                 "is not applied", team);
+        return;
+    }
+    e = ucc_tune_file_lookup(&ctx->tune, nnodes, ppn);
+    if (!e) {
+        tl_debug(ctx->super.super.lib, "no tuning entry for nnodes %u ppn %u",
+                 nnodes, ppn);
+        return;
+    }
+    tl_debug(ctx->super.super.lib,
+             "team %p nnodes %u ppn %u uses tuning entry nnodes %u ppn %u",
+             team, nnodes, ppn, e->nnodes, e->ppn);
+    for (i = 0; i < e->n_params; i++) {
+        if (UCC_OK != ucc_tl_ucp_lib_config_set(&team->cfg, e->params[i].name,
+                                                e->params[i].value)) {
+            tl_warn(ctx->super.super.lib, "invalid tuning parameter %s=%s",
+                    e->params[i].name, e->params[i].value);
+        }
+    }
+    team->tune_score_str = e->score_str;
+}
 
 UCC_CLASS_INIT_FUNC(ucc_tl_ucp_team_t, ucc_base_context_t *tl_context,
                     const ucc_base_team_params_t *params)
 {
     ucc_tl_ucp_context_t *ctx =
         ucc_derived_of(tl_context, ucc_tl_ucp_context_t);
+    ucc_status_t          status;
+
     UCC_CLASS_CALL_SUPER_INIT(ucc_tl_team_t, &ctx->super, params->team);
     /* TODO: init based on ctx settings and on params: need to check
              if all the necessary ranks mappings are provided */
@@ -27,16 +235,59 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_team_t, ucc_base_context_t *tl_context,
     self->id                 = params->id;
     self->seq_num            = 0;
     self->status             = UCC_INPROGRESS;
-    tl_info(tl_context->lib, "posted tl team: %p", self);
+    self->tune_score_str     = NULL;
+    memcpy(&self->cfg, &UCC_TL_UCP_TEAM_LIB(self)->cfg, sizeof(self->cfg));
+    status = ucc_tl_ucp_team_init_shape(self, params->team);
+    if (UCC_OK != status) {
+        return status;
+    }
+    status = ucc_tl_ucp_team_init_node_map(self, params->team);
+    if (UCC_OK != status) {
+        return status;
+    }
+    ucc_tl_ucp_team_apply_tune(self, ctx, params->team);
+    status = ucc_tl_ucp_team_init_lanes(self, ctx, params->team);
+    if (UCC_OK != status) {
+        ucc_free(self->node_map);
+        return status;
+    }
+    ucc_tl_ucp_team_init_kn_tables(self);
+    ucc_scratch_arena_init(
+        &self->scratch, self->cfg.scratch_arena_max);
+    ucc_tl_ucp_ef_store_init(&self->ef);
+    ucc_pipeline_stats_init(&self->pipeline_stats);
+    tl_info(tl_context->lib, "posted tl team: %p, n_lanes %d", self,
+            self->n_lanes);
     return UCC_OK;
 }
 
 UCC_CLASS_CLEANUP_FUNC(ucc_tl_ucp_team_t)
 {
+    ucc_pipeline_model_t model;
+    int                  i;
+
     tl_info(self->super.super.context->lib, "finalizing tl team: %p", self);
+    if (UCC_OK == ucc_pipeline_stats_estimate(&self->pipeline_stats, &model)) {
+        tl_debug(self->super.super.context->lib,
+                 "team %p measured pipeline fragment latency %.2f us, "
+                 "bandwidth %.2f MB/s over %lu fragments", self,
+                 model.frag_latency * 1e6, model.bw / 1e6,
+                 (unsigned long)self->pipeline_stats.n_samples);
+    }
+    for (i = 1; i < self->n_lanes; i++) {
+        ucc_tl_context_put(&self->lanes[i]->ctx->super);
+    }
+    ucc_free(self->lanes);
+    ucc_free(self->node_map);
+    for (i = 0; i <= UCC_TL_UCP_KN_TABLE_MAX_RADIX; i++) {
+        ucc_free(self->kn_tables[i]);
+    }
+    ucc_scratch_arena_cleanup(&self->scratch);
+    ucc_tl_ucp_ef_store_cleanup(&self->ef);
 }
 
 UCC_CLASS_DEFINE_DELETE_FUNC(ucc_tl_ucp_team_t, ucc_base_team_t);
+
 UCC_CLASS_DEFINE(ucc_tl_ucp_team_t, ucc_tl_team_t);
 
 ucc_status_t ucc_tl_ucp_team_destroy(ucc_base_team_t *tl_team)
@@ -134,6 +385,15 @@ ucc_status_t ucc_tl_ucp_team_get_scores(ucc_base_team_t   *tl_team,
             goto err;
         }
     }
+    if (team->tune_score_str) {
+        status = ucc_coll_score_update_from_str(
+            team->tune_score_str, score, team->size, NULL, &team->super.super,
+            UCC_TL_UCP_DEFAULT_SCORE, ucc_tl_ucp_alg_id_to_init);
+        if ((status < 0) && (status != UCC_ERR_INVALID_PARAM) &&
+            (status != UCC_ERR_NOT_SUPPORTED)) {
+            goto err;
+        }
+    }
     if (strlen(lib->super.super.score_str) > 0) {
         status = ucc_coll_score_update_from_str(
             lib->super.super.score_str, score, team->size, NULL,
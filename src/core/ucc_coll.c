@@ -13,6 +13,7 @@
 #include "utils/ucc_coll_utils.h"
 #include "utils/profile/ucc_profile_core.h"
 #include "schedule/ucc_schedule.h"
+#include <limits.h>
 
 /* NOLINTNEXTLINE  */
 static ucc_cl_team_t *ucc_select_cl_team(ucc_coll_args_t *coll_args,
@@ -64,6 +65,16 @@ static ucc_status_t ucc_check_coll_args(const ucc_coll_args_t *coll_args,
                                            coll_args->dst.info);
         }
         break;
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
+        if (!(coll_args->mask & UCC_COLL_ARGS_FIELD_SPARSE) ||
+            UCC_IS_INPLACE(*coll_args)) {
+            ucc_error("sparse allreduce requires sparse info and does not "
+                      "support inplace");
+            return UCC_ERR_INVALID_PARAM;
+        }
+        UCC_BUFFER_INFO_CHECK_DATATYPE(coll_args->src.info,
+                                       coll_args->dst.info);
+        break;
     default:
         return UCC_OK;
     }
@@ -95,6 +106,7 @@ static ucc_status_t ucc_coll_args_check_mem_type(ucc_coll_args_t *coll_args,
     case UCC_COLL_TYPE_ALLGATHER:
     case UCC_COLL_TYPE_ALLTOALL:
     case UCC_COLL_TYPE_REDUCE_SCATTER:
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
         UCC_BUFFER_INFO_CHECK_MEM_TYPE(coll_args->dst.info);
         if (!UCC_IS_INPLACE(*coll_args)) {
             UCC_BUFFER_INFO_CHECK_MEM_TYPE(coll_args->src.info);
@@ -174,6 +186,12 @@ UCC_CORE_PROFILE_FUNC(ucc_status_t, ucc_collective_init,
         ucc_error("collective arguments check failed");
         return status;
     }
+    if (UCC_IS_PARTITIONED(*coll_args) &&
+        (coll_args->n_partitions == 0 || coll_args->n_partitions > INT_MAX)) {
+        ucc_error("invalid number of partitions %lu",
+                  (unsigned long)coll_args->n_partitions);
+        return UCC_ERR_INVALID_PARAM;
+    }
 
     /* TO discuss: maybe we want to pass around user pointer ? */
     op_args.mask = 0;
@@ -189,6 +207,12 @@ UCC_CORE_PROFILE_FUNC(ucc_status_t, ucc_collective_init,
         ucc_error("failed to init collective: %s", ucc_status_string(status));
         return status;
     }
+    if (UCC_IS_PARTITIONED(*coll_args) && !task->pready) {
+        ucc_debug("failed to init collective: partitions are not supported "
+                  "by the selected algorithm");
+        task->finalize(task);
+        return UCC_ERR_NOT_SUPPORTED;
+    }
     if (coll_args->mask & UCC_COLL_ARGS_FIELD_CB) {
         task->cb = coll_args->cb;
         task->flags |= UCC_COLL_TASK_FLAG_CB;
@@ -210,6 +234,21 @@ ucc_status_t ucc_collective_post(ucc_coll_req_h request)
     return task->post(task);
 }
 
+ucc_status_t ucc_collective_pready(ucc_coll_req_h request, uint64_t partition)
+{
+    ucc_coll_task_t *task = ucc_derived_of(request, ucc_coll_task_t);
+
+    if (ucc_unlikely(!UCC_IS_PARTITIONED(task->args) ||
+                     (partition >= task->args.n_partitions))) {
+        ucc_error("invalid partition %lu of req %p",
+                  (unsigned long)partition, task);
+        return UCC_ERR_INVALID_PARAM;
+    }
+    ucc_trace("coll_pready: req %p, partition %lu", task,
+              (unsigned long)partition);
+    return task->pready(task, partition);
+}
+
 ucc_status_t ucc_collective_triggered_post(ucc_ee_h ee, ucc_ev_t *ev)
 {
     ucc_coll_task_t *task = ucc_derived_of(ev->req, ucc_coll_task_t);
@@ -227,3 +266,311 @@ UCC_CORE_PROFILE_FUNC(ucc_status_t, ucc_collective_finalize, (request),
     ucc_debug("coll_finalize: req %p", task);
     return task->finalize(task);
 }
+
+/* Collective group: the collectives are executed as tasks of a single
+   schedule. Small allreduces with the same datatype, reduction and memory
+   type are packed into a staging buffer of that memory type and reduced by
+   one in-place allreduce.
+   Fusion depends only on the collective arguments, so that all ranks
+   build the same set of collectives. */
+typedef struct ucc_coll_group_bucket {
+    ucc_coll_task_t        *task;
+    ucc_mc_buffer_header_t *staging;
+    ucc_memory_type_t       mem_type;
+    ucc_datatype_t          dt;
+    ucc_reduction_op_t      op;
+    size_t                  count;
+    uint32_t                n_members;
+} ucc_coll_group_bucket_t;
+
+typedef struct ucc_coll_group {
+    ucc_schedule_t           super;
+    ucc_coll_args_t         *args;
+    uint32_t                 n_args;
+    int                     *bucket_id; /*< bucket of a fused arg or -1 */
+    size_t                  *offset;    /*< offset of a fused arg in staging */
+    ucc_coll_group_bucket_t *buckets;
+    int                      n_buckets;
+} ucc_coll_group_t;
+
+static inline int ucc_coll_group_fusible(const ucc_coll_args_t *args,
+                                         size_t                 fuse_max)
+{
+    return (args->coll_type == UCC_COLL_TYPE_ALLREDUCE) &&
+           !(args->mask & (UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS |
+                           UCC_COLL_ARGS_FIELD_CB)) &&
+           ucc_dt_is_predefined(args->dst.info.datatype) &&
+           (UCC_IS_INPLACE(*args) ||
+            args->src.info.mem_type == args->dst.info.mem_type) &&
+           (args->dst.info.count * ucc_dt_size(args->dst.info.datatype) <=
+            fuse_max);
+}
+
+static void ucc_coll_group_copy(ucc_coll_group_t *group, int bucket, int pack)
+{
+    ucc_coll_group_bucket_t *b;
+    ucc_coll_args_t         *args;
+    ucc_coll_buffer_info_t  *info;
+    void                    *staging;
+    size_t                   len;
+    uint32_t                 i;
+
+    for (i = 0; i < group->n_args; i++) {
+        if (group->bucket_id[i] < 0 ||
+            (bucket >= 0 && group->bucket_id[i] != bucket)) {
+            continue;
+        }
+        b       = &group->buckets[group->bucket_id[i]];
+        args    = &group->args[i];
+        info    = (pack && !UCC_IS_INPLACE(*args)) ? &args->src.info
+                                                   : &args->dst.info;
+        staging = PTR_OFFSET(b->staging->addr, group->offset[i]);
+        len     = info->count * ucc_dt_size(info->datatype);
+        if (pack) {
+            ucc_mc_memcpy(staging, info->buffer, len, b->mem_type,
+                          info->mem_type);
+        } else {
+            ucc_mc_memcpy(info->buffer, staging, len, info->mem_type,
+                          b->mem_type);
+        }
+    }
+}
+
+static ucc_status_t ucc_coll_group_unpack(ucc_coll_task_t *parent,
+                                          ucc_coll_task_t *task)
+{
+    ucc_coll_group_t *group = ucc_derived_of(task, ucc_coll_group_t);
+    int               i;
+
+    for (i = 0; i < group->n_buckets; i++) {
+        if (group->buckets[i].task == parent) {
+            ucc_coll_group_copy(group, i, 0);
+            break;
+        }
+    }
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_coll_group_post(ucc_coll_task_t *task)
+{
+    ucc_coll_group_t *group = ucc_derived_of(task, ucc_coll_group_t);
+
+    ucc_coll_group_copy(group, -1, 1);
+    return ucc_schedule_start(&group->super);
+}
+
+static ucc_status_t ucc_coll_group_finalize(ucc_coll_task_t *task)
+{
+    ucc_coll_group_t *group  = ucc_derived_of(task, ucc_coll_group_t);
+    ucc_status_t      status = UCC_OK;
+    int               i;
+
+    ucc_debug("coll_group_finalize: req %p", group);
+    status = ucc_schedule_finalize(task);
+    for (i = 0; group->buckets && i < group->n_buckets; i++) {
+        if (group->buckets[i].staging) {
+            ucc_mc_free(group->buckets[i].staging);
+        }
+    }
+    ucc_schedule_cleanup(&group->super);
+    ucc_free(group->buckets);
+    ucc_free(group->offset);
+    ucc_free(group->bucket_id);
+    ucc_free(group->args);
+    ucc_free(group);
+    return status;
+}
+
+/* Groups fusible allreduces by datatype, reduction and memory type, buckets
+   with a single member are not fused */
+static ucc_status_t ucc_coll_group_bucketize(ucc_coll_group_t *group,
+                                             size_t            fuse_max)
+{
+    ucc_coll_group_bucket_t *b;
+    ucc_coll_args_t         *args;
+    uint32_t                 i;
+    int                      j;
+
+    for (i = 0; i < group->n_args; i++) {
+        args                = &group->args[i];
+        group->bucket_id[i] = -1;
+        if (!ucc_coll_group_fusible(args, fuse_max)) {
+            continue;
+        }
+        for (j = 0; j < group->n_buckets; j++) {
+            b = &group->buckets[j];
+            if (b->dt == args->dst.info.datatype &&
+                b->op == args->reduce.predefined_op &&
+                b->mem_type == args->dst.info.mem_type) {
+                break;
+            }
+        }
+        b = &group->buckets[j];
+        if (j == group->n_buckets) {
+            group->n_buckets++;
+            b->dt       = args->dst.info.datatype;
+            b->op       = args->reduce.predefined_op;
+            b->mem_type = args->dst.info.mem_type;
+        }
+        group->bucket_id[i] = j;
+        group->offset[i]    = b->count * ucc_dt_size(b->dt);
+        b->count           += args->dst.info.count;
+        b->n_members++;
+    }
+    for (i = 0; i < group->n_args; i++) {
+        j = group->bucket_id[i];
+        if (j >= 0 && group->buckets[j].n_members == 1) {
+            group->bucket_id[i] = -1;
+        }
+    }
+    for (j = 0; j < group->n_buckets; j++) {
+        b = &group->buckets[j];
+        if (b->n_members < 2) {
+            continue;
+        }
+        if (UCC_OK != ucc_mc_alloc(&b->staging, b->count * ucc_dt_size(b->dt),
+                                   b->mem_type)) {
+            ucc_error("failed to allocate %zd bytes for collective group "
+                      "staging buffer", b->count * ucc_dt_size(b->dt));
+            return UCC_ERR_NO_MEMORY;
+        }
+    }
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_coll_group_add(ucc_coll_group_t *group,
+                                       ucc_coll_args_t *args, int bucket,
+                                       ucc_team_h team)
+{
+    ucc_coll_req_h   req;
+    ucc_coll_task_t *task;
+    ucc_status_t     status;
+
+    status = ucc_collective_init(args, &req, team);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    task = ucc_derived_of(req, ucc_coll_task_t);
+    if (bucket >= 0) {
+        group->buckets[bucket].task = task;
+        /* subscribed before the schedule, so that the results are
+           unpacked before the group completes */
+        status = ucc_event_manager_subscribe(&task->em, UCC_EVENT_COMPLETED,
+                                             &group->super.super,
+                                             ucc_coll_group_unpack);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err;
+        }
+    }
+    status = ucc_schedule_add_task(&group->super, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        goto err;
+    }
+    return ucc_event_manager_subscribe(&group->super.super.em,
+                                       UCC_EVENT_SCHEDULE_STARTED, task,
+                                       ucc_task_start_handler);
+err:
+    if (bucket >= 0) {
+        group->buckets[bucket].task = NULL;
+    }
+    if (group->super.n_tasks == 0 ||
+        group->super.tasks[group->super.n_tasks - 1] != task) {
+        task->finalize(task);
+    }
+    return status;
+}
+
+ucc_status_t ucc_collective_init_group(ucc_coll_args_t *coll_args,
+                                       uint32_t n_colls,
+                                       ucc_coll_req_h *request,
+                                       ucc_team_h team)
+{
+    ucc_coll_args_t   fused;
+    ucc_coll_group_t *group;
+    ucc_status_t      status;
+    uint32_t          i;
+    int               j;
+
+    if (n_colls == 0) {
+        ucc_error("collective group must contain at least one collective");
+        return UCC_ERR_INVALID_PARAM;
+    }
+    group = ucc_calloc(1, sizeof(*group), "coll_group");
+    if (!group) {
+        ucc_error("failed to allocate %zd bytes for collective group",
+                  sizeof(*group));
+        return UCC_ERR_NO_MEMORY;
+    }
+    ucc_schedule_init(&group->super, NULL, &team->cl_teams[0]->super);
+    group->super.super.post     = ucc_coll_group_post;
+    group->super.super.finalize = ucc_coll_group_finalize;
+    group->n_args               = n_colls;
+
+    group->args      = ucc_malloc(n_colls * sizeof(*group->args), "args");
+    group->bucket_id = ucc_malloc(n_colls * sizeof(int), "bucket_id");
+    group->offset    = ucc_malloc(n_colls * sizeof(size_t), "offset");
+    group->buckets   = ucc_calloc(n_colls, sizeof(*group->buckets), "buckets");
+    if (!group->args || !group->bucket_id || !group->offset ||
+        !group->buckets) {
+        ucc_error("failed to allocate collective group");
+        status = UCC_ERR_NO_MEMORY;
+        goto err;
+    }
+    memcpy(group->args, coll_args, n_colls * sizeof(*group->args));
+
+    for (i = 0; i < n_colls; i++) {
+        status = ucc_coll_args_check_mem_type(&group->args[i], team->rank);
+        if (ucc_unlikely(status != UCC_OK)) {
+            ucc_error("memory type detection failed");
+            goto err;
+        }
+        status = ucc_check_coll_args(&group->args[i], team->rank);
+        if (ucc_unlikely(status != UCC_OK)) {
+            ucc_error("collective arguments check failed");
+            goto err;
+        }
+        if (UCC_IS_PARTITIONED(group->args[i])) {
+            ucc_debug("partitioned collectives can not be grouped");
+            status = UCC_ERR_NOT_SUPPORTED;
+            goto err;
+        }
+    }
+    status = ucc_coll_group_bucketize(
+        group, team->contexts[0]->coll_group_fuse_max);
+    if (ucc_unlikely(status != UCC_OK)) {
+        goto err;
+    }
+
+    /* init order is the same on all ranks: fused allreduce is initialized
+       at the position of its first member */
+    for (i = 0; i < n_colls; i++) {
+        j = group->bucket_id[i];
+        if (j < 0) {
+            status = ucc_coll_group_add(group, &group->args[i], -1, team);
+        } else if (!group->buckets[j].task) {
+            memset(&fused, 0, sizeof(fused));
+            fused.mask                 = UCC_COLL_ARGS_FIELD_FLAGS;
+            fused.flags                = UCC_COLL_ARGS_FLAG_IN_PLACE;
+            fused.coll_type            = UCC_COLL_TYPE_ALLREDUCE;
+            fused.reduce.predefined_op = group->buckets[j].op;
+            fused.dst.info.buffer      = group->buckets[j].staging->addr;
+            fused.dst.info.count       = group->buckets[j].count;
+            fused.dst.info.datatype    = group->buckets[j].dt;
+            fused.dst.info.mem_type    = group->buckets[j].mem_type;
+            fused.src.info             = fused.dst.info;
+            status = ucc_coll_group_add(group, &fused, j, team);
+        }
+        if (ucc_unlikely(status != UCC_OK)) {
+            ucc_error("failed to init collective %u of group: %s", i,
+                      ucc_status_string(status));
+            goto err;
+        }
+    }
+    ucc_debug("coll_init_group: %u collectives, %d tasks, req %p", n_colls,
+              group->super.n_tasks, group);
+    *request = &group->super.super.super;
+    return UCC_OK;
+err:
+    ucc_coll_group_finalize(&group->super.super);
+    return status;
+}
@@ -10,7 +10,13 @@
 #include "utils/ucc_malloc.h"
 #include "utils/ucc_log.h"
 #include "utils/ucc_list.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_time.h"
 #include "ucc_progress_queue.h"
+#include "ucc_mc.h"
+#include <sys/epoll.h>
+#include <errno.h>
+#include <unistd.h>
 
 static uint32_t ucc_context_seq_num = 0;
 static ucc_config_field_t ucc_context_config_table[] = {
@@ -43,6 +49,60 @@ static ucc_config_field_t ucc_context_config_table[] = {
      "is configured with OOB (global mode). 0 - disable, 1 - try, 2 - force.",
      ucc_offsetof(ucc_context_config_t, internal_oob), UCC_CONFIG_TYPE_UINT},
 
+    {"BLOCKING_PROGRESS", "0",
+     "Enable event driven blocking progress. When enabled, the context "
+     "provides a waitable fd (ucc_context_get_fd) and supports "
+     "ucc_context_arm and ucc_context_wait",
+     ucc_offsetof(ucc_context_config_t, blocking_progress),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"BLOCKING_SPIN_MIN", "16",
+     "Minimal number of progress iterations done by ucc_context_wait before "
+     "blocking on the context fd",
+     ucc_offsetof(ucc_context_config_t, blocking_spin_min),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"BLOCKING_SPIN_MAX", "4096",
+     "Maximal number of progress iterations done by ucc_context_wait before "
+     "blocking on the context fd. The actual spin budget is adapted between "
+     "min and max: it grows when spinning finds events and shrinks when the "
+     "context has to block",
+     ucc_offsetof(ucc_context_config_t, blocking_spin_max),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"PROGRESS_THREAD", "0",
+     "Enable asynchronous progress thread for the context. When enabled, the "
+     "context internals are created in thread multiple mode. Requires the "
+     "lib to be initialized with UCC_THREAD_MULTIPLE since the thread shares "
+     "the memory components with the application threads, otherwise the "
+     "progress thread is disabled with a warning",
+     ucc_offsetof(ucc_context_config_t, progress_thread),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"PROGRESS_THREAD_CPU", "-1",
+     "CPU to bind the progress thread to, -1 - do not bind",
+     ucc_offsetof(ucc_context_config_t, progress_thread_cpu),
+     UCC_CONFIG_TYPE_INT},
+
+    {"PROGRESS_THREAD_POLLS", "1000",
+     "Number of idle progress iterations of the progress thread before it "
+     "starts backing off",
+     ucc_offsetof(ucc_context_config_t, progress_thread_polls),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"PROGRESS_THREAD_BACKOFF", "100",
+     "Maximal sleep interval (usec) of the idle progress thread. The interval "
+     "grows exponentially while the context stays idle",
+     ucc_offsetof(ucc_context_config_t, progress_thread_backoff),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"COLL_GROUP_FUSE_MAX", "16k",
+     "Maximal message size of an allreduce which is fused with other "
+     "allreduces of a collective group (ucc_collective_init_group) into a "
+     "single allreduce, 0 - disable fusion",
+     ucc_offsetof(ucc_context_config_t, coll_group_fuse_max),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {NULL}};
 UCC_CONFIG_REGISTER_TABLE(ucc_context_config_table, "UCC context", NULL,
                           ucc_context_config_t, &ucc_config_global_list);
@@ -451,6 +511,28 @@ poll:
     return UCC_OK;
 }
 
+/* The progress thread allocates scratch memory from the memory components
+   concurrently with the collective init and finalize of the application
+   threads, so MC has to be thread safe */
+static int ucc_context_progress_thread_allowed(ucc_lib_info_t *lib)
+{
+    ucc_mc_attr_t attr;
+
+    if (lib->attr.thread_mode != UCC_THREAD_MULTIPLE) {
+        ucc_warn("UCC_PROGRESS_THREAD requires lib thread mode "
+                 "UCC_THREAD_MULTIPLE, progress thread is disabled");
+        return 0;
+    }
+    attr.field_mask = UCC_MC_ATTR_FIELD_THREAD_MODE;
+    if (UCC_OK != ucc_mc_get_attr(UCC_MEMORY_TYPE_HOST, &attr) ||
+        attr.thread_mode != UCC_THREAD_MULTIPLE) {
+        ucc_warn("host memory component is not thread safe, progress "
+                 "thread is disabled");
+        return 0;
+    }
+    return 1;
+}
+
 ucc_status_t ucc_context_create(ucc_lib_h lib,
                                 const ucc_context_params_t *params,
                                 const ucc_context_config_h  config,
@@ -466,8 +548,11 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
     ucc_status_t               status;
     uint64_t                   i;
     int                        num_cls;
+    int                        progress_thread;
 
-    num_cls = config->n_cl_cfg;
+    num_cls         = config->n_cl_cfg;
+    progress_thread = config->progress_thread &&
+                      ucc_context_progress_thread_allowed(lib);
     ctx     = ucc_calloc(1, sizeof(ucc_context_t), "ucc_context");
     if (!ctx) {
         ucc_error("failed to allocate %zd bytes for ucc_context",
@@ -479,13 +564,32 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
     ctx->lib           = lib;
     ctx->ids.pool_size = config->team_ids_pool_size;
     ucc_list_head_init(&ctx->progress_list);
+    ucc_list_head_init(&ctx->event_fd_list);
+    ctx->epfd                = -1;
+    ctx->coll_group_fuse_max = config->coll_group_fuse_max;
+    if (config->blocking_progress) {
+        ctx->epfd = epoll_create(1);
+        if (ctx->epfd < 0) {
+            ucc_error("failed to create epoll fd, %m");
+            status = UCC_ERR_NO_RESOURCE;
+            goto error_ctx;
+        }
+        ctx->spin_min   = config->blocking_spin_min;
+        ctx->spin_max   = ucc_max(config->blocking_spin_max, ctx->spin_min);
+        ctx->spin_count = ctx->spin_min;
+    }
     ucc_copy_context_params(&ctx->params, params);
     ucc_copy_context_params(&b_params.params, params);
     b_params.context           = ctx;
     b_params.estimated_num_eps = config->estimated_num_eps;
     b_params.estimated_num_ppn = config->estimated_num_ppn;
+    b_params.blocking_progress = config->blocking_progress;
     b_params.prefix            = lib->full_prefix;
     b_params.thread_mode       = lib->attr.thread_mode;
+    if (progress_thread) {
+        /* progress thread runs concurrently with user threads */
+        b_params.thread_mode = UCC_THREAD_MULTIPLE;
+    }
     if (params->mask & UCC_CONTEXT_PARAM_FIELD_OOB) {
         ctx->rank = params->oob.oob_ep;
     }
@@ -556,12 +660,17 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
                         (params->mask & UCC_CONTEXT_PARAM_FIELD_TYPE))
                            ? UCC_THREAD_SINGLE
                            : lib->attr.thread_mode;
+    if (progress_thread) {
+        ctx->thread_mode = UCC_THREAD_MULTIPLE;
+    }
     status           = ucc_progress_queue_init(&ctx->pq, ctx->thread_mode,
                                                config->lock_free_progress_q);
     if (UCC_OK != status) {
         ucc_error("failed to init progress queue for context %p", ctx);
         goto error_ctx_create;
     }
+    /* ucc_context_wait has to know if queued tasks can wake up the fd */
+    ctx->pq->count_polled = (ctx->epfd >= 0);
     ctx->id.pi      = ucc_local_proc;
     ctx->id.seq_num = ucc_atomic_fadd32(&ucc_context_seq_num, 1);
     if (params->mask & UCC_CONTEXT_PARAM_FIELD_OOB) {
@@ -641,6 +750,16 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
             goto error_ctx_create;
         }
     }
+    if (progress_thread) {
+        status = ucc_progress_thread_start(ctx, config->progress_thread_cpu,
+                                           config->progress_thread_polls,
+                                           config->progress_thread_backoff,
+                                           &ctx->progress_thread);
+        if (UCC_OK != status) {
+            ucc_error("failed to start progress thread");
+            goto error_ctx_create;
+        }
+    }
     ucc_info("created ucc context %p for lib %s", ctx, lib->full_prefix);
     *context = ctx;
     return UCC_OK;
@@ -652,6 +771,9 @@ error_ctx_create:
     }
     ucc_free(ctx->cl_ctx);
 error_ctx:
+    if (ctx->epfd >= 0) {
+        close(ctx->epfd);
+    }
     ucc_free(ctx);
 error:
     return status;
@@ -674,6 +796,9 @@ ucc_status_t ucc_context_destroy(ucc_context_t *context)
     int               i;
     ucc_status_t      status;
 
+    if (context->progress_thread) {
+        ucc_progress_thread_stop(context->progress_thread);
+    }
     if (context->service_team) {
         while (UCC_INPROGRESS ==
                (status = UCC_TL_CTX_IFACE(context->service_ctx)
@@ -704,6 +829,10 @@ ucc_status_t ucc_context_destroy(ucc_context_t *context)
         tl_lib->iface->context.destroy(&tl_ctx->super);
     }
     ucc_progress_queue_finalize(context->pq);
+    if (context->epfd >= 0) {
+        ucc_assert(ucc_list_is_empty(&context->event_fd_list));
+        close(context->epfd);
+    }
     ucc_free(context->addr_storage.storage);
     ucc_free(context->all_tls.names);
     ucc_free(context->tl_ctx);
@@ -750,19 +879,205 @@ void ucc_context_progress_deregister(ucc_context_t *ctx,
     ucc_assert(0);
 }
 
-ucc_status_t ucc_context_progress(ucc_context_h context)
+int ucc_context_progress_count(ucc_context_t *context)
 {
-    ucc_status_t                  status;
     ucc_context_progress_entry_t *entry;
+    int                           n_events = 0;
+    int                           n_done;
+
     /* progress registered progress fns */
     ucc_list_for_each(entry, &context->progress_list, list_elem) {
-        entry->fn(entry->arg);
+        n_events += entry->fn(entry->arg);
     }
-    /* the fn below returns int - number of completed tasks.
+    n_done = ucc_progress_queue(context->pq);
+    if (n_done < 0) {
+        return n_done;
+    }
+    return n_events + n_done;
+}
+
+ucc_status_t ucc_context_progress(ucc_context_h context)
+{
+    int n_events;
+
+    /* the fn below returns int - number of processed events.
        TODO : do we need to handle it ? Maybe return to user
        as int as well? */
-    status = (ucc_status_t)ucc_progress_queue(context->pq);
-    return (status >= 0 ? UCC_OK : status);
+    n_events = ucc_context_progress_count(context);
+    return (n_events >= 0 ? UCC_OK : (ucc_status_t)n_events);
+}
+
+typedef struct ucc_context_event_fd_entry {
+    ucc_list_link_t       list_elem;
+    int                   fd;
+    ucc_context_arm_fn_t  fn;
+    void                 *arg;
+} ucc_context_event_fd_entry_t;
+
+ucc_status_t ucc_context_event_fd_register(ucc_context_t *ctx, int fd,
+                                           ucc_context_arm_fn_t fn,
+                                           void *arm_arg)
+{
+    ucc_context_event_fd_entry_t *entry;
+    struct epoll_event            ev;
+
+    if (ctx->epfd < 0) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    entry = ucc_malloc(sizeof(*entry), "event_fd_entry");
+    if (!entry) {
+        ucc_error("failed to allocate %zd bytes for event fd entry",
+                  sizeof(*entry));
+        return UCC_ERR_NO_MEMORY;
+    }
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    if (0 != epoll_ctl(ctx->epfd, EPOLL_CTL_ADD, fd, &ev)) {
+        ucc_error("failed to add fd %d to context epoll set, %m", fd);
+        ucc_free(entry);
+        return UCC_ERR_NO_MESSAGE;
+    }
+    entry->fd  = fd;
+    entry->fn  = fn;
+    entry->arg = arm_arg;
+    ucc_list_add_tail(&ctx->event_fd_list, &entry->list_elem);
+    return UCC_OK;
+}
+
+void ucc_context_event_fd_deregister(ucc_context_t *ctx, int fd,
+                                     ucc_context_arm_fn_t fn, void *arm_arg)
+{
+    ucc_context_event_fd_entry_t *entry, *tmp;
+    ucc_list_for_each_safe(entry, tmp, &ctx->event_fd_list, list_elem) {
+        if (entry->fd == fd && entry->fn == fn && entry->arg == arm_arg) {
+            epoll_ctl(ctx->epfd, EPOLL_CTL_DEL, fd, NULL);
+            ucc_list_del(&entry->list_elem);
+            ucc_free(entry);
+            return;
+        }
+    }
+    ucc_assert(0);
+}
+
+ucc_status_t ucc_context_get_fd(ucc_context_h context, int *fd)
+{
+    if (context->epfd < 0) {
+        ucc_debug("blocking progress is not enabled for context %p", context);
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    *fd = context->epfd;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_context_arm(ucc_context_h context)
+{
+    ucc_context_event_fd_entry_t *entry;
+    ucc_status_t                  status;
+
+    if (context->epfd < 0) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    ucc_list_for_each(entry, &context->event_fd_list, list_elem) {
+        status = entry->fn(entry->arg);
+        if (UCC_OK != status) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
+
+/* The context fd is only signaled by the components that registered an
+   event fd. Blocking is safe if every registered progress fn has an event
+   fd with the same argument and no queued task is completed by polling
+   only (e.g. tasks of the TLs without event fd). */
+static int ucc_context_can_block(ucc_context_t *context)
+{
+    ucc_context_progress_entry_t *p_entry;
+    ucc_context_event_fd_entry_t *fd_entry;
+    int                           found;
+
+    if (context->pq->n_polled > 0) {
+        return 0;
+    }
+    ucc_list_for_each(p_entry, &context->progress_list, list_elem) {
+        found = 0;
+        ucc_list_for_each(fd_entry, &context->event_fd_list, list_elem) {
+            if (fd_entry->arg == p_entry->arg) {
+                found = 1;
+                break;
+            }
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Polls the context until an event is processed or the timeout expires */
+static ucc_status_t ucc_context_poll(ucc_context_t *context, int timeout)
+{
+    double deadline = ucc_get_time() + timeout * 1e-3;
+    int    n_events;
+
+    do {
+        n_events = ucc_context_progress_count(context);
+        if (n_events < 0) {
+            return (ucc_status_t)n_events;
+        }
+        if (n_events > 0) {
+            return UCC_OK;
+        }
+    } while (timeout < 0 || ucc_get_time() < deadline);
+    return UCC_INPROGRESS;
+}
+
+ucc_status_t ucc_context_wait(ucc_context_h context, int timeout)
+{
+    struct epoll_event ev;
+    ucc_status_t       status;
+    uint32_t           i;
+    int                n_events;
+
+    if (context->epfd < 0) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    /* Spin phase: most of the short latency events are caught here
+       without paying for the syscall and the wakeup */
+    for (i = 0; i < context->spin_count; i++) {
+        n_events = ucc_context_progress_count(context);
+        if (n_events < 0) {
+            return (ucc_status_t)n_events;
+        }
+        if (n_events > 0) {
+            /* spinning paid off - allow spinning longer next time */
+            context->spin_count = ucc_min(context->spin_count * 2,
+                                          context->spin_max);
+            return UCC_OK;
+        }
+    }
+    if (!ucc_context_can_block(context)) {
+        /* outstanding work would not wake up the fd, do not block on it */
+        return ucc_context_poll(context, timeout);
+    }
+    /* Block phase: events did not arrive within the spin budget, shrink it
+       so that the next wait gives up the cpu earlier */
+    context->spin_count = ucc_max(context->spin_count / 2, context->spin_min);
+    status = ucc_context_arm(context);
+    if (UCC_INPROGRESS == status) {
+        /* events arrived in between, no need to block */
+        return UCC_OK;
+    } else if (UCC_OK != status) {
+        return status;
+    }
+    do {
+        n_events = epoll_wait(context->epfd, &ev, 1, timeout);
+    } while (n_events < 0 && errno == EINTR);
+    if (n_events < 0) {
+        ucc_error("epoll_wait failed on context %p, %m", context);
+        return UCC_ERR_NO_MESSAGE;
+    }
+    return (n_events == 0) ? UCC_INPROGRESS : UCC_OK;
 }
 
 static ucc_status_t ucc_context_pack_addr(ucc_context_t             *context,
@@ -8,6 +8,7 @@
 
 #include "ucc/api/ucc.h"
 #include "ucc_progress_queue.h"
+#include "ucc_progress_thread.h"
 #include "utils/ucc_list.h"
 #include "utils/ucc_proc_info.h"
 #include "ucc_topo.h"
@@ -24,6 +25,11 @@ typedef struct ucc_context_progress {
     void                     *progress_arg;
 } ucc_context_progress_t;
 
+/* Arms the event fd registered by a component. Returns UCC_OK if the fd
+   was armed and it is safe to block on it, UCC_INPROGRESS if there are
+   unprocessed events and ucc_context_progress must be called again. */
+typedef ucc_status_t (*ucc_context_arm_fn_t)(void *arm_arg);
+
 typedef struct ucc_team_id_pool {
     uint64_t *pool;
     uint32_t  pool_size;
@@ -67,6 +73,15 @@ typedef struct ucc_context {
     ucc_topo_t              *topo;
     uint64_t                 cl_flags;
     ucc_tl_team_t           *service_team;
+    int                      epfd; /*< aggregates event fds of components,
+                                     -1 if blocking progress is disabled */
+    ucc_list_link_t          event_fd_list;
+    uint32_t                 spin_count; /*< current spin budget of
+                                           ucc_context_wait */
+    uint32_t                 spin_min;
+    uint32_t                 spin_max;
+    ucc_progress_thread_t   *progress_thread;
+    size_t                   coll_group_fuse_max;
 } ucc_context_t;
 
 typedef struct ucc_context_config {
@@ -78,6 +93,14 @@ typedef struct ucc_context_config {
     uint32_t                  estimated_num_ppn;
     uint32_t                  lock_free_progress_q;
     uint32_t                  internal_oob;
+    uint32_t                  blocking_progress;
+    uint32_t                  blocking_spin_min;
+    uint32_t                  blocking_spin_max;
+    uint32_t                  progress_thread;
+    int                       progress_thread_cpu;
+    uint32_t                  progress_thread_polls;
+    uint32_t                  progress_thread_backoff;
+    size_t                    coll_group_fuse_max;
 } ucc_context_config_t;
 
 /* Any internal UCC component (TL, CL, etc) may register its own
@@ -94,6 +117,24 @@ ucc_status_t ucc_context_progress_register(ucc_context_t *ctx,
 void         ucc_context_progress_deregister(ucc_context_t *ctx,
                                              ucc_context_progress_fn_t fn,
                                              void *progress_arg);
+
+/* Progresses registered progress fns and the progress queue of the
+   context. Returns the number of processed events or negative error. */
+int          ucc_context_progress_count(ucc_context_t *ctx);
+
+/* Components that can signal the arrival of events through a file
+   descriptor (e.g. TL/UCP via ucp_worker_get_efd) register it together
+   with the arm callback. All registered fds are aggregated into a single
+   epoll fd returned to the user by ucc_context_get_fd. Registration is
+   only possible when blocking progress is enabled for the context. */
+ucc_status_t ucc_context_event_fd_register(ucc_context_t *ctx, int fd,
+                                           ucc_context_arm_fn_t fn,
+                                           void *arm_arg);
+
+void         ucc_context_event_fd_deregister(ucc_context_t *ctx, int fd,
+                                             ucc_context_arm_fn_t fn,
+                                             void *arm_arg);
+
 /* Performs address exchange between the processes group defined by OOB.
    This function can be used either at context creation time
    (if ctx is global) or at team creation time. The corresponding oob
@@ -44,9 +44,23 @@ ucc_status_t ucc_ee_create(ucc_team_h team, const ucc_ee_params_t *params,
     return UCC_OK;
 }
 
+static void ucc_ee_queue_purge(ucc_queue_head_t *queue)
+{
+    ucc_queue_elem_t *elem;
+
+    while (!ucc_queue_is_empty(queue)) {
+        elem = ucc_queue_pull_non_empty(queue);
+        ucc_free(ucc_container_of(elem, ucc_event_desc_t, queue));
+    }
+}
+
 ucc_status_t ucc_ee_destroy(ucc_ee_h ee)
 {
     ucc_info("ee is destroyed: %p", ee);
+    /* events which were not fetched by the user or by triggered
+       collectives */
+    ucc_ee_queue_purge(&ee->event_in_queue);
+    ucc_ee_queue_purge(&ee->event_out_queue);
     ucc_spinlock_destroy(&ee->lock);
     ucc_free(ee);
 
@@ -106,6 +106,16 @@ ucc_status_t ucc_mc_available(ucc_memory_type_t mem_type)
     return UCC_OK;
 }
 
+ucc_status_t ucc_mc_get_attr(ucc_memory_type_t mem_type,
+                             ucc_mc_attr_t    *mc_attr)
+{
+    ucc_mc_base_t *mc;
+
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    mc = ucc_container_of(mc_ops[mem_type], ucc_mc_base_t, ops);
+    return mc->get_attr(mc_attr);
+}
+
 ucc_status_t ucc_mc_get_mem_attr(const void *ptr, ucc_mem_attr_t *mem_attr)
 {
     ucc_status_t      status;
@@ -166,6 +176,115 @@ UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_reduce_multi,
                                           dtype, op);
 }
 
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_compress,
+                    (dst, src, err, count, dst_dt, mem_type), void *dst,
+                    const void *src, float *err, size_t count,
+                    ucc_datatype_t dst_dt, ucc_memory_type_t mem_type)
+{
+    if (count == 0) {
+        return UCC_OK;
+    }
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->compress) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->compress(dst, src, err, count, dst_dt);
+}
+
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_reduce_multi_decompress,
+                    (src1, src2, dst, n_vectors, count, stride, src2_dt,
+                     mem_type),
+                    const void *src1, const void *src2, void *dst,
+                    size_t n_vectors, size_t count, size_t stride,
+                    ucc_datatype_t src2_dt, ucc_memory_type_t mem_type)
+{
+    if (count == 0) {
+        return UCC_OK;
+    }
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->reduce_multi_decompress) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->reduce_multi_decompress(src1, src2, dst,
+                                                     n_vectors, count, stride,
+                                                     src2_dt);
+}
+
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_reduce_sparse,
+                    (idx1, val1, n1, idx2, val2, n2, dst_idx, dst_val, dst_n,
+                     dt, mem_type),
+                    const uint64_t *idx1, const void *val1, size_t n1,
+                    const uint64_t *idx2, const void *val2, size_t n2,
+                    uint64_t *dst_idx, void *dst_val, size_t *dst_n,
+                    ucc_datatype_t dt, ucc_memory_type_t mem_type)
+{
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->reduce_sparse) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->reduce_sparse(idx1, val1, n1, idx2, val2, n2,
+                                           dst_idx, dst_val, dst_n, dt);
+}
+
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_sparse_to_dense,
+                    (dense, idx, val, n, dt, mem_type), void *dense,
+                    const uint64_t *idx, const void *val, size_t n,
+                    ucc_datatype_t dt, ucc_memory_type_t mem_type)
+{
+    if (n == 0) {
+        return UCC_OK;
+    }
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->sparse_to_dense) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->sparse_to_dense(dense, idx, val, n, dt);
+}
+
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_dense_to_sparse,
+                    (idx, val, n, max_n, dense, count, dt, mem_type),
+                    uint64_t *idx, void *val, size_t *n, size_t max_n,
+                    const void *dense, size_t count, ucc_datatype_t dt,
+                    ucc_memory_type_t mem_type)
+{
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->dense_to_sparse) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->dense_to_sparse(idx, val, n, max_n, dense,
+                                             count, dt);
+}
+
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_pack,
+                    (dst, src, dt, offset, len, mem_type), void *dst,
+                    const void *src, const ucc_dt_userdefined_t *dt,
+                    size_t offset, size_t len, ucc_memory_type_t mem_type)
+{
+    if (len == 0) {
+        return UCC_OK;
+    }
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->pack) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->pack(dst, src, dt, offset, len);
+}
+
+UCC_MC_PROFILE_FUNC(ucc_status_t, ucc_mc_unpack,
+                    (dst, src, dt, offset, len, mem_type), void *dst,
+                    const void *src, const ucc_dt_userdefined_t *dt,
+                    size_t offset, size_t len, ucc_memory_type_t mem_type)
+{
+    if (len == 0) {
+        return UCC_OK;
+    }
+    UCC_CHECK_MC_AVAILABLE(mem_type);
+    if (!mc_ops[mem_type]->unpack) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return mc_ops[mem_type]->unpack(dst, src, dt, offset, len);
+}
+
 ucc_status_t ucc_mc_free(ucc_mc_buffer_header_t *h_ptr)
 {
     UCC_CHECK_MC_AVAILABLE(h_ptr->mt);
@@ -8,11 +8,20 @@
 
 #include "ucc/api/ucc.h"
 #include "components/mc/base/ucc_mc_base.h"
+#include "utils/ucc_math.h"
 
 ucc_status_t ucc_mc_init(const ucc_mc_params_t *mc_params);
 
 ucc_status_t ucc_mc_available(ucc_memory_type_t mem_type);
 
+/**
+ * Query for memory component attributes.
+ * @param [in]        mem_type  Memory type of the component.
+ * @param [in,out]    mc_attr   Memory component attributes.
+ */
+ucc_status_t ucc_mc_get_attr(ucc_memory_type_t mem_type,
+                             ucc_mc_attr_t    *mc_attr);
+
 /**
  * Query for memory attributes.
  * @param [in]        ptr       Memory pointer to query.
@@ -80,6 +89,151 @@ ucc_status_t ucc_mc_reduce_multi(void *src1, void *src2, void *dst,
                                  ucc_datatype_t dtype, ucc_reduction_op_t op,
                                  ucc_memory_type_t mem_type);
 
+/**
+ * Converts fp32 vector to 16 bit wire format with round to nearest even
+ * @param [out]   dst      Converted vector of dst_dt elements
+ * @param [in]    src      fp32 vector
+ * @param [inout] err      Optional error feedback vector: added to src before
+ *                         conversion and updated with the conversion error,
+ *                         can be NULL
+ * @param [in]    count    Number of elements
+ * @param [in]    dst_dt   UCC_DT_FLOAT16 or UCC_DT_BFLOAT16
+ * @param [in]    mem_type Vectors memory type
+ */
+ucc_status_t ucc_mc_compress(void *dst, const void *src, float *err,
+                             size_t count, ucc_datatype_t dst_dt,
+                             ucc_memory_type_t mem_type);
+
+/**
+ * Sum reduction of multiple 16 bit wire format vectors accumulated in fp32
+ * @param [in]  src1      First fp32 operand, if NULL dst is the sum of src2
+ *                        vectors only
+ * @param [in]  src2      Array of src2_dt vectors
+ * @param [out] dst       fp32 dst = src1 + src2{0} + ... + src2{size-1}
+ * @param [in]  n_vectors Number of vectors in src2
+ * @param [in]  count     Number of elements in dst
+ * @param [in]  stride    Offset between vectors in src2
+ * @param [in]  src2_dt   UCC_DT_FLOAT16 or UCC_DT_BFLOAT16
+ * @param [in]  mem_type  Vectors memory type
+ */
+ucc_status_t ucc_mc_reduce_multi_decompress(const void *src1, const void *src2,
+                                            void *dst, size_t n_vectors,
+                                            size_t count, size_t stride,
+                                            ucc_datatype_t    src2_dt,
+                                            ucc_memory_type_t mem_type);
+
+/**
+ * Sum reduction of two sparse vectors
+ * @param [in]  idx1     Strictly increasing indices of the first vector
+ * @param [in]  val1     Values of the first vector
+ * @param [in]  n1       Number of elements of the first vector
+ * @param [in]  idx2     Strictly increasing indices of the second vector
+ * @param [in]  val2     Values of the second vector
+ * @param [in]  n2       Number of elements of the second vector
+ * @param [out] dst_idx  Indices of the result, capacity n1 + n2
+ * @param [out] dst_val  Values of the result, capacity n1 + n2
+ * @param [out] dst_n    Number of elements of the result
+ * @param [in]  dt       Values datatype
+ * @param [in]  mem_type Vectors memory type
+ * Result can not alias the inputs.
+ */
+ucc_status_t ucc_mc_reduce_sparse(const uint64_t *idx1, const void *val1,
+                                  size_t n1, const uint64_t *idx2,
+                                  const void *val2, size_t n2,
+                                  uint64_t *dst_idx, void *dst_val,
+                                  size_t *dst_n, ucc_datatype_t dt,
+                                  ucc_memory_type_t mem_type);
+
+/**
+ * Adds sparse vector to dense one: dense[idx[i]] += val[i]
+ */
+ucc_status_t ucc_mc_sparse_to_dense(void *dense, const uint64_t *idx,
+                                    const void *val, size_t n,
+                                    ucc_datatype_t dt,
+                                    ucc_memory_type_t mem_type);
+
+/**
+ * Extracts nonzero elements of dense vector
+ * @param [out] idx      Indices of nonzero elements
+ * @param [out] val      Values of nonzero elements
+ * @param [out] n        Number of nonzero elements stored
+ * @param [in]  max_n    Capacity of idx and val
+ * @param [in]  dense    Dense vector
+ * @param [in]  count    Number of elements of dense vector
+ * @param [in]  dt       Values datatype
+ * @param [in]  mem_type Vectors memory type
+ * @return UCC_ERR_NO_RESOURCE if there are more than max_n nonzeros
+ */
+ucc_status_t ucc_mc_dense_to_sparse(uint64_t *idx, void *val, size_t *n,
+                                    size_t max_n, const void *dense,
+                                    size_t count, ucc_datatype_t dt,
+                                    ucc_memory_type_t mem_type);
+
+/**
+ * Copies bytes [offset, offset + len) of the packed representation of the
+ * user defined datatype elements starting at src to contiguous dst. The
+ * packed representation is the concatenation of the blocks of the
+ * elements, so a large message can be packed fragment by fragment.
+ */
+ucc_status_t ucc_mc_pack(void *dst, const void *src,
+                         const ucc_dt_userdefined_t *dt, size_t offset,
+                         size_t len, ucc_memory_type_t mem_type);
+
+/**
+ * Copies contiguous src to bytes [offset, offset + len) of the packed
+ * representation of the user defined datatype elements starting at dst.
+ */
+ucc_status_t ucc_mc_unpack(void *dst, const void *src,
+                           const ucc_dt_userdefined_t *dt, size_t offset,
+                           size_t len, ucc_memory_type_t mem_type);
+
+/**
+ * Checks that user defined reduction of the collective can be executed:
+ * the op descriptor is set, element size is known and buffers are in host
+ * memory.
+ */
+static inline ucc_status_t
+ucc_dt_reduce_userdefined_check(const ucc_coll_args_t *args,
+                                ucc_datatype_t dt, ucc_memory_type_t mem_type)
+{
+    const ucc_reduction_op_desc_t *op = args->reduce.custom_op;
+
+    if (!op || !op->cb || (0 == ucc_dt_size(dt)) ||
+        (UCC_MEMORY_TYPE_HOST != mem_type)) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return UCC_OK;
+}
+
+/**
+ * Invokes user defined reduction callback, vectors longer than max_count
+ * of the op descriptor are reduced in chunks.
+ */
+static inline ucc_status_t
+ucc_dt_reduce_userdefined(const void *src1, const void *src2, void *dst,
+                          size_t n_vectors, size_t count, size_t stride,
+                          ucc_datatype_t dt, ucc_coll_args_t *args)
+{
+    const ucc_reduction_op_desc_t *op      = args->reduce.custom_op;
+    size_t                         dt_size = ucc_dt_size(dt);
+    size_t                         chunk   = op->max_count ? op->max_count :
+                                                             count;
+    size_t                         offset, n;
+    ucc_status_t                   status;
+
+    for (offset = 0; offset < count; offset += n) {
+        n      = ucc_min(chunk, count - offset);
+        status = op->cb(PTR_OFFSET(src1, offset * dt_size),
+                        PTR_OFFSET(src2, offset * dt_size),
+                        PTR_OFFSET(dst, offset * dt_size), n_vectors, n,
+                        stride, dt, op->cb_ctx);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
+
 static inline ucc_status_t ucc_dt_reduce(const void *src1, const void *src2,
                                          void *dst, size_t count,
                                          ucc_datatype_t dt,
@@ -87,7 +241,9 @@ static inline ucc_status_t ucc_dt_reduce(const void *src1, const void *src2,
                                          ucc_coll_args_t *args)
 {
     if (args->mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) {
-        return UCC_ERR_NOT_SUPPORTED; //TODO
+        ucc_assert(UCC_MEMORY_TYPE_HOST == mem_type);
+        return ucc_dt_reduce_userdefined(src1, src2, dst, 1, count, 0, dt,
+                                         args);
     } else {
         return ucc_mc_reduce(src1, src2, dst, count, dt,
                              args->reduce.predefined_op, mem_type);
@@ -102,7 +258,9 @@ static inline ucc_status_t ucc_dt_reduce_multi(void *src1, void *src2,
                                                ucc_coll_args_t *args)
 {
     if (args->mask & UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS) {
-        return UCC_ERR_NOT_SUPPORTED; //TODO
+        ucc_assert(UCC_MEMORY_TYPE_HOST == mem_type);
+        return ucc_dt_reduce_userdefined(src1, src2, dst, n_vectors, count,
+                                         stride, dt, args);
     } else {
         return ucc_mc_reduce_multi(src1, src2, dst, n_vectors, count, stride,
                                    dt, args->reduce.predefined_op, mem_type);
@@ -13,11 +13,18 @@ ucc_status_t ucc_progress_queue_init(ucc_progress_queue_t **pq,
                                      ucc_thread_mode_t      tm,
                                      uint32_t lock_free_progress_q)
 {
+    ucc_status_t status;
+
     if (tm == UCC_THREAD_SINGLE) {
-        return ucc_pq_st_init(pq);
+        status = ucc_pq_st_init(pq);
     } else { // TODO also for UCC_THREAD_FUNNELED?
-        return ucc_pq_mt_init(pq, lock_free_progress_q);
+        status = ucc_pq_mt_init(pq, lock_free_progress_q);
+    }
+    if (UCC_OK == status) {
+        (*pq)->count_polled = 0;
+        (*pq)->n_polled     = 0;
     }
+    return status;
 }
 
 void ucc_progress_queue_finalize(ucc_progress_queue_t *pq)
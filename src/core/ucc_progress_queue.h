@@ -8,12 +8,17 @@
 
 #include "ucc/api/ucc.h"
 #include "schedule/ucc_schedule.h"
+#include "utils/ucc_atomic.h"
 typedef struct ucc_progress_queue ucc_progress_queue_t;
 struct ucc_progress_queue {
     void (*enqueue)(ucc_progress_queue_t *pq, ucc_coll_task_t *task);
     void (*dequeue)(ucc_progress_queue_t *pq, ucc_coll_task_t **task);
     int  (*progress)(ucc_progress_queue_t *pq);
     void (*finalize)(ucc_progress_queue_t *pq);
+    int      count_polled; /*< count tasks without UCC_COLL_TASK_FLAG_EVENT_FD,
+                             set when blocking progress is enabled */
+    uint32_t n_polled;     /*< number of queued tasks that are only
+                             completed by polling */
 };
 
 ucc_status_t ucc_progress_queue_init(ucc_progress_queue_t **pq,
@@ -23,9 +28,22 @@ ucc_status_t ucc_progress_queue_init(ucc_progress_queue_t **pq,
 static inline void ucc_progress_enqueue(ucc_progress_queue_t *pq,
                                         ucc_coll_task_t *task)
 {
+    if (pq->count_polled && !(task->flags & UCC_COLL_TASK_FLAG_EVENT_FD)) {
+        ucc_atomic_add32(&pq->n_polled, 1);
+    }
     pq->enqueue(pq, task);
 }
 
+/* Must be called by the queue implementation when the task leaves the
+   queue for good, before the task is completed */
+static inline void ucc_progress_queue_task_done(ucc_progress_queue_t *pq,
+                                                ucc_coll_task_t      *task)
+{
+    if (pq->count_polled && !(task->flags & UCC_COLL_TASK_FLAG_EVENT_FD)) {
+        ucc_atomic_sub32(&pq->n_polled, 1);
+    }
+}
+
 static inline int ucc_progress_queue(ucc_progress_queue_t *pq)
 {
     return pq->progress(pq);
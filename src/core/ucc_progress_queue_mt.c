@@ -75,6 +75,7 @@ static int ucc_pq_mt_progress(ucc_progress_queue_t *pq)
             pq->enqueue(pq, task);
             return n_progressed;
         }
+        ucc_progress_queue_task_done(pq, task);
         n_progressed++;
         if (ucc_unlikely(0 > (status = ucc_task_complete(task)))) {
             return status;
@@ -29,6 +29,7 @@ static int ucc_pq_st_progress(ucc_progress_queue_t *pq)
             continue;
         }
         ucc_list_del(&task->list_elem);
+        ucc_progress_queue_task_done(pq, task);
         n_progressed++;
         if (0 > (status = ucc_task_complete(task))) {
             return status;
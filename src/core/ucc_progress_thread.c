@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "ucc_progress_thread.h"
+#include "ucc_context.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_log.h"
+#include "utils/ucc_math.h"
+#include <sched.h>
+#include <time.h>
+
+static void ucc_progress_thread_sleep(uint32_t usec)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = usec / 1000000;
+    ts.tv_nsec = (usec % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+}
+
+static void *ucc_progress_thread_func(void *arg)
+{
+    ucc_progress_thread_t *pt      = arg;
+    uint32_t               n_idle  = 0;
+    uint32_t               backoff = 0;
+    cpu_set_t              cpuset;
+    int                    n_events;
+
+    if (pt->cpu >= 0) {
+        CPU_ZERO(&cpuset);
+        CPU_SET(pt->cpu, &cpuset);
+        if (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+                                        &cpuset)) {
+            ucc_warn("failed to bind progress thread of context %p to cpu %d",
+                     pt->ctx, pt->cpu);
+        }
+    }
+    while (!pt->stop) {
+        n_events = ucc_context_progress_count(pt->ctx);
+        if (ucc_unlikely(n_events < 0)) {
+            ucc_error("progress thread of context %p got error %s", pt->ctx,
+                      ucc_status_string((ucc_status_t)n_events));
+            break;
+        }
+        if (n_events > 0) {
+            n_idle  = 0;
+            backoff = 0;
+            continue;
+        }
+        if (++n_idle < pt->n_polls) {
+            continue;
+        }
+        if (backoff == 0) {
+            sched_yield();
+            backoff = 1;
+        } else {
+            ucc_progress_thread_sleep(backoff);
+            backoff = ucc_min(backoff * 2, pt->backoff_max);
+        }
+    }
+    return NULL;
+}
+
+ucc_status_t ucc_progress_thread_start(ucc_context_t *ctx, int cpu,
+                                       uint32_t n_polls, uint32_t backoff_max,
+                                       ucc_progress_thread_t **thread)
+{
+    ucc_progress_thread_t *pt;
+    int                    ret;
+
+    pt = ucc_malloc(sizeof(*pt), "progress_thread");
+    if (!pt) {
+        ucc_error("failed to allocate %zd bytes for progress thread",
+                  sizeof(*pt));
+        return UCC_ERR_NO_MEMORY;
+    }
+    pt->ctx         = ctx;
+    pt->stop        = 0;
+    pt->cpu         = cpu;
+    pt->n_polls     = n_polls;
+    pt->backoff_max = ucc_max(backoff_max, 1);
+    ret = pthread_create(&pt->thread, NULL, ucc_progress_thread_func, pt);
+    if (0 != ret) {
+        ucc_error("failed to create progress thread for context %p, ret %d",
+                  ctx, ret);
+        ucc_free(pt);
+        return UCC_ERR_NO_RESOURCE;
+    }
+    ucc_debug("started progress thread for context %p, cpu %d", ctx, cpu);
+    *thread = pt;
+    return UCC_OK;
+}
+
+void ucc_progress_thread_stop(ucc_progress_thread_t *pt)
+{
+    pt->stop = 1;
+    pthread_join(pt->thread, NULL);
+    ucc_debug("stopped progress thread for context %p", pt->ctx);
+    ucc_free(pt);
+}
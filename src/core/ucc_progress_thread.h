@@ -0,0 +1,39 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_PROGRESS_THREAD_H_
+#define UCC_PROGRESS_THREAD_H_
+
+#include "ucc/api/ucc.h"
+#include <pthread.h>
+
+typedef struct ucc_context ucc_context_t;
+
+/* Optional per-context asynchronous progress thread. The thread calls
+   the same progress routine as ucc_context_progress: registered
+   component progress callbacks and the context progress queue. When
+   the thread is enabled the context internals (progress queue, TL
+   workers, mpools) are created in UCC_THREAD_MULTIPLE mode, so the
+   user may still call ucc_context_progress concurrently.
+
+   When no events are processed for n_polls iterations the thread backs
+   off: it sleeps for an exponentially growing interval bounded by
+   backoff_max usec. The interval is reset as soon as events arrive. */
+typedef struct ucc_progress_thread {
+    pthread_t       thread;
+    ucc_context_t  *ctx;
+    volatile int    stop;
+    int             cpu;         /*< cpu to bind the thread to, -1 - none */
+    uint32_t        n_polls;
+    uint32_t        backoff_max;
+} ucc_progress_thread_t;
+
+ucc_status_t ucc_progress_thread_start(ucc_context_t *ctx, int cpu,
+                                       uint32_t n_polls, uint32_t backoff_max,
+                                       ucc_progress_thread_t **thread);
+
+void         ucc_progress_thread_stop(ucc_progress_thread_t *thread);
+
+#endif
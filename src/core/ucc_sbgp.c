@@ -20,8 +20,27 @@ const char*  ucc_sbgp_str(ucc_sbgp_type_t type)
     return ucc_sbgp_type_str[type];
 }
 
-static inline ucc_status_t sbgp_create_socket(ucc_team_topo_t *topo,
-                                              ucc_sbgp_t *     sbgp)
+/* Socket and numa subgroups are built the same way: the ranks of the
+   node sharing the domain with the calling rank */
+static inline int sbgp_rank_on_local_domain(ucc_sbgp_t *sbgp, ucc_rank_t r)
+{
+    if (sbgp->type == UCC_SBGP_NUMA) {
+        return ucc_rank_on_local_numa(r, sbgp->team);
+    }
+    return ucc_rank_on_local_socket(r, sbgp->team);
+}
+
+static inline int sbgp_domain_id(ucc_team_topo_t *topo, ucc_sbgp_t *sbgp,
+                                 ucc_rank_t ctx_rank)
+{
+    if (sbgp->type == UCC_SBGP_NUMA_LEADERS) {
+        return topo->topo->procs[ctx_rank].numa_id;
+    }
+    return topo->topo->procs[ctx_rank].socket_id;
+}
+
+static inline ucc_status_t sbgp_create_domain(ucc_team_topo_t *topo,
+                                              ucc_sbgp_t      *sbgp)
 {
     ucc_team_t *team       = sbgp->team;
     ucc_sbgp_t *node_sbgp  = &topo->sbgps[UCC_SBGP_NODE];
@@ -41,7 +60,7 @@ static inline ucc_status_t sbgp_create_socket(ucc_team_topo_t *topo,
     }
     for (i = 0; i < node_sbgp->group_size; i++) {
         r = ucc_ep_map_eval(node_sbgp->map, i);
-        if (ucc_rank_on_local_socket(r, team)) {
+        if (sbgp_rank_on_local_domain(sbgp, r)) {
             local_ranks[sock_size] = r;
             if (r == group_rank) {
                 sock_rank = sock_size;
@@ -238,15 +257,17 @@ skip:
     return UCC_OK;
 }
 
-static ucc_status_t sbgp_create_socket_leaders(ucc_team_topo_t *topo,
-                                               ucc_sbgp_t *     sbgp)
+static ucc_status_t sbgp_create_domain_leaders(ucc_team_topo_t *topo,
+                                               ucc_sbgp_t      *sbgp)
 {
     ucc_team_t *team               = sbgp->team;
     ucc_sbgp_t *node_sbgp          = &topo->sbgps[UCC_SBGP_NODE];
     ucc_rank_t  comm_rank          = team->rank;
     ucc_rank_t  nlr                = topo->node_leader_rank;
     int         i_am_socket_leader = (nlr == comm_rank);
-    int         max_n_sockets      = topo->topo->max_n_sockets;
+    int         max_n_sockets      = (sbgp->type == UCC_SBGP_NUMA_LEADERS)
+                                         ? topo->topo->max_n_numas
+                                         : topo->topo->max_n_sockets;
     ucc_rank_t *sl_array =
         ucc_malloc(max_n_sockets * sizeof(ucc_rank_t), "sl_array");
     ucc_rank_t      n_socket_leaders = 1;
@@ -262,13 +283,13 @@ static ucc_status_t sbgp_create_socket_leaders(ucc_team_topo_t *topo,
         sl_array[i] = INT_MAX;
     }
     nlr_sock_id =
-        topo->topo->procs[ucc_ep_map_eval(team->ctx_map, nlr)].socket_id;
+        sbgp_domain_id(topo, sbgp, ucc_ep_map_eval(team->ctx_map, nlr));
     sl_array[nlr_sock_id] = nlr;
 
     for (i = 0; i < node_sbgp->group_size; i++) {
         ucc_rank_t      r         = ucc_ep_map_eval(node_sbgp->map, i);
         ucc_rank_t      ctx_rank  = ucc_ep_map_eval(team->ctx_map, r);
-        ucc_socket_id_t socket_id = topo->topo->procs[ctx_rank].socket_id;
+        ucc_socket_id_t socket_id = sbgp_domain_id(topo, sbgp, ctx_rank);
         if (sl_array[socket_id] == INT_MAX) {
             n_socket_leaders++;
             sl_array[socket_id] = r;
@@ -351,7 +372,7 @@ ucc_status_t ucc_sbgp_create(ucc_team_topo_t *topo, ucc_sbgp_type_t type)
             ucc_sbgp_create(topo, UCC_SBGP_NODE);
         }
         if (topo->sbgps[UCC_SBGP_NODE].status == UCC_SBGP_ENABLED) {
-            status = sbgp_create_socket(topo, sbgp);
+            status = sbgp_create_domain(topo, sbgp);
         }
         break;
     case UCC_SBGP_NODE_LEADERS:
@@ -376,7 +397,29 @@ ucc_status_t ucc_sbgp_create(ucc_team_topo_t *topo, ucc_sbgp_type_t type)
             ucc_sbgp_create(topo, UCC_SBGP_NODE);
         }
         if (topo->sbgps[UCC_SBGP_NODE].status == UCC_SBGP_ENABLED) {
-            status = sbgp_create_socket_leaders(topo, sbgp);
+            status = sbgp_create_domain_leaders(topo, sbgp);
+        }
+        break;
+    case UCC_SBGP_NUMA:
+        if (!topo->topo->numa_bound) {
+            break;
+        }
+        if (topo->sbgps[UCC_SBGP_NODE].status == UCC_SBGP_NOT_INIT) {
+            ucc_sbgp_create(topo, UCC_SBGP_NODE);
+        }
+        if (topo->sbgps[UCC_SBGP_NODE].status == UCC_SBGP_ENABLED) {
+            status = sbgp_create_domain(topo, sbgp);
+        }
+        break;
+    case UCC_SBGP_NUMA_LEADERS:
+        if (!topo->topo->numa_bound) {
+            break;
+        }
+        if (topo->sbgps[UCC_SBGP_NODE].status == UCC_SBGP_NOT_INIT) {
+            ucc_sbgp_create(topo, UCC_SBGP_NODE);
+        }
+        if (topo->sbgps[UCC_SBGP_NODE].status == UCC_SBGP_ENABLED) {
+            status = sbgp_create_domain_leaders(topo, sbgp);
         }
         break;
     default:
@@ -83,12 +83,27 @@ ucc_status_t ucc_team_create_post(ucc_context_h *contexts, uint32_t num_contexts
     ucc_rank_t   team_size = 0;
     ucc_team_t  *team;
     ucc_status_t status;
+    uint32_t     i;
 
     if (num_contexts < 1) {
         return UCC_ERR_INVALID_PARAM;
-    } else if (num_contexts > 1) {
-        ucc_error("team creation from multiple contexts is not supported yet");
-        return UCC_ERR_NOT_SUPPORTED;
+    }
+    /* Team is created over contexts[0]: it is used for addressing, service
+       team and CL teams. Additional contexts are used by TLs as extra
+       communication lanes (e.g. TL/UCP stripes large collectives across
+       the workers of all the contexts). Peers addresses in the additional
+       contexts are taken from the context addr storage, therefore all the
+       contexts must be global and created over the same OOB. */
+    for (i = 1; i < num_contexts; i++) {
+        if (!contexts[0]->addr_storage.storage ||
+            !contexts[i]->addr_storage.storage ||
+            contexts[i]->addr_storage.size !=
+                contexts[0]->addr_storage.size ||
+            contexts[i]->rank != contexts[0]->rank) {
+            ucc_error("team creation from multiple contexts requires all the "
+                      "contexts to be created with the same OOB");
+            return UCC_ERR_NOT_SUPPORTED;
+        }
     }
 
     if (params->mask & UCC_TEAM_PARAM_FIELD_TEAM_SIZE) {
@@ -370,8 +385,6 @@ ucc_status_t ucc_team_create_test(ucc_team_h team)
         ucc_error("ucc_team_create_test: invalid team handle: NULL");
         return UCC_ERR_INVALID_PARAM;
     }
-    /* we don't support multiple contexts per team yet */
-    ucc_assert(team->num_contexts == 1);
     if (team->status == UCC_OK) {
         return UCC_OK;
     }
@@ -383,14 +396,9 @@ static ucc_status_t ucc_team_destroy_single(ucc_team_h team)
     ucc_cl_iface_t *cl_iface;
     int             i;
     ucc_status_t    status;
-    if (team->service_team) {
-        if (UCC_OK != (status = UCC_TL_CTX_IFACE(team->contexts[0]->service_ctx)
-                       ->team.destroy(&team->service_team->super))) {
-            return status;
-        }
-        team->service_team = NULL;
-        ucc_tl_context_put(team->contexts[0]->service_ctx);
-    }
+
+    /* CL teams may still complete service collectives while destroyed,
+       so the service team goes last */
     for (i = 0; i < team->n_cl_teams; i++) {
         if (!team->cl_teams[i])
             continue;
@@ -401,6 +409,14 @@ static ucc_status_t ucc_team_destroy_single(ucc_team_h team)
         }
         team->cl_teams[i] = NULL;
     }
+    if (team->service_team) {
+        if (UCC_OK != (status = UCC_TL_CTX_IFACE(team->contexts[0]->service_ctx)
+                       ->team.destroy(&team->service_team->super))) {
+            return status;
+        }
+        team->service_team = NULL;
+        ucc_tl_context_put(team->contexts[0]->service_ctx);
+    }
 
     ucc_team_topo_cleanup(team->topo);
 
@@ -429,8 +445,6 @@ ucc_status_t ucc_team_destroy(ucc_team_h team)
         return UCC_ERR_INVALID_PARAM;
     }
 
-    /* we don't support multiple contexts per team yet */
-    ucc_assert(team->num_contexts == 1);
     return ucc_team_destroy_single(team);
 }
 
@@ -448,12 +462,35 @@ find_first_set_and_zero(uint64_t *value) {
 
 static inline void
 set_id_bit(uint64_t *local, int id) {
-    int map_pos = id / 64;
+    int map_pos = (id - 1) / 64;
     int pos = (id-1) % 64;
     ucc_assert(id >= 1);
     local[map_pos] |= ((uint64_t)1 << pos);
 }
 
+/* Id pool of the context: local availability, result of the service
+   allreduce and the intersection of the local pools of all the team
+   contexts */
+static ucc_status_t ucc_team_ids_pool_init(ucc_context_t *ctx)
+{
+    size_t size = ctx->ids.pool_size * 3 * sizeof(uint64_t);
+
+    if (!ctx->ids.pool) {
+        ctx->ids.pool = ucc_malloc(size, "ids_pool");
+        if (!ctx->ids.pool) {
+            ucc_error("failed to allocate %zd bytes for team_ids_pool", size);
+            return UCC_ERR_NO_MEMORY;
+        }
+        /* init all bits to 1 - all available */
+        memset(ctx->ids.pool, 255, size);
+    }
+    return UCC_OK;
+}
+
+/* The id has to be unique on every context of the team: TLs use the
+   resources of all of them (e.g. TL/UCP lanes), so traffic of the team
+   can not be told apart from the traffic of another team with the same
+   id created on any of these contexts. */
 static ucc_status_t ucc_team_alloc_id(ucc_team_t *team)
 {
     /* at least 1 ctx is always available */
@@ -461,21 +498,23 @@ static ucc_status_t ucc_team_alloc_id(ucc_team_t *team)
     uint64_t        *local, *global;
     ucc_status_t     status;
     int              pos, i;
+    uint32_t         c;
 
     if (team->id > 0) {
         ucc_assert(UCC_TEAM_ID_IS_EXTERNAL(team));
         return UCC_OK;
     }
 
-    if (!ctx->ids.pool) {
-        ctx->ids.pool = ucc_malloc(ctx->ids.pool_size*2*sizeof(uint64_t), "ids_pool");
-        if (!ctx->ids.pool) {
-            ucc_error("failed to allocate %zd bytes for team_ids_pool",
-                      ctx->ids.pool_size*2*sizeof(uint64_t));
-            return UCC_ERR_NO_MEMORY;
+    for (c = 0; c < team->num_contexts; c++) {
+        status = ucc_team_ids_pool_init(team->contexts[c]);
+        if (UCC_OK != status) {
+            return status;
+        }
+        if (team->contexts[c]->ids.pool_size != ctx->ids.pool_size) {
+            ucc_error("contexts of the team have different "
+                      "UCC_TEAM_IDS_POOL_SIZE");
+            return UCC_ERR_INVALID_PARAM;
         }
-        /* init all bits to 1 - all available */
-        memset(ctx->ids.pool, 255, ctx->ids.pool_size*2*sizeof(uint64_t));
     }
     local  = ctx->ids.pool;
     global = ctx->ids.pool + ctx->ids.pool_size;
@@ -484,6 +523,15 @@ static ucc_status_t ucc_team_alloc_id(ucc_team_t *team)
         ucc_team_subset_t subset = {.map.type   = UCC_EP_MAP_FULL,
                                     .map.ep_num = team->size,
                                     .myrank     = team->rank};
+        if (team->num_contexts > 1) {
+            local = ctx->ids.pool + 2 * ctx->ids.pool_size;
+            memcpy(local, ctx->ids.pool, ctx->ids.pool_size * sizeof(uint64_t));
+            for (c = 1; c < team->num_contexts; c++) {
+                for (i = 0; i < ctx->ids.pool_size; i++) {
+                    local[i] &= team->contexts[c]->ids.pool[i];
+                }
+            }
+        }
         status = ucc_service_allreduce(team, local, global, UCC_DT_UINT64,
                                        ctx->ids.pool_size, UCC_OP_BAND, subset,
                                        &team->sreq);
@@ -502,15 +550,17 @@ static ucc_status_t ucc_team_alloc_id(ucc_team_t *team)
     }
     ucc_service_coll_finalize(team->sreq);
     team->sreq = NULL;
-    memcpy(local, global, ctx->ids.pool_size*sizeof(uint64_t));
     pos = 0;
     for (i=0; i<ctx->ids.pool_size; i++) {
-        if ((pos = find_first_set_and_zero(&local[i])) > 0) {
+        if ((pos = find_first_set_and_zero(&global[i])) > 0) {
             break;
         }
     }
     if (pos > 0) {
         ucc_assert(pos <= 64);
+        for (c = 0; c < team->num_contexts; c++) {
+            team->contexts[c]->ids.pool[i] &= ~((uint64_t)1 << (pos - 1));
+        }
         team->id = (uint16_t)(i*64+pos);
         ucc_info("allocated ID %d for team %p", team->id, team);
     } else {
@@ -524,9 +574,12 @@ static ucc_status_t ucc_team_alloc_id(ucc_team_t *team)
 
 static void ucc_team_relase_id(ucc_team_t *team)
 {
-    ucc_context_t *ctx = team->contexts[0];
+    uint32_t c;
+
     /* release the id pool bit if it was not provided by user */
     if (0 != team->id && !UCC_TEAM_ID_IS_EXTERNAL(team)) {
-        set_id_bit(ctx->ids.pool, team->id);
+        for (c = 0; c < team->num_contexts; c++) {
+            set_id_bit(team->contexts[c]->ids.pool, team->id);
+        }
     }
 }
@@ -34,7 +34,7 @@ typedef struct ucc_team {
     ucc_cl_team_t **        cl_teams;
     int                     n_cl_teams;
     int                     last_team_create_posted;
-    uint16_t                id; /*< context-uniq team identifier */
+    uint16_t                id; /*< unique on every context of the team */
     ucc_rank_t              rank;
     ucc_rank_t              size;
     ucc_tl_team_t *         service_team;
@@ -125,4 +125,18 @@ static inline int ucc_rank_on_local_socket(int team_rank, ucc_team_t *team)
            proc->socket_id == my_proc->socket_id;
 }
 
+static inline int ucc_rank_on_local_numa(int team_rank, ucc_team_t *team)
+{
+    ucc_rank_t       ctx_rank    = ucc_ep_map_eval(team->ctx_map, team_rank);
+    ucc_rank_t       my_ctx_rank = ucc_ep_map_eval(team->ctx_map, team->rank);
+    ucc_proc_info_t *proc        = &team->topo->topo->procs[ctx_rank];
+    ucc_proc_info_t *my_proc     = &team->topo->topo->procs[my_ctx_rank];
+
+    if (my_proc->numa_id == -1) {
+        return 0;
+    }
+    return proc->host_hash == my_proc->host_hash &&
+           proc->numa_id == my_proc->numa_id;
+}
+
 #endif
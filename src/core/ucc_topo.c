@@ -20,6 +20,8 @@ static int ucc_topo_compare_proc_info(const void *a, const void *b)
         return d1->host_hash > d2->host_hash ? 1 : -1;
     } else if (d1->socket_id != d2->socket_id) {
         return d1->socket_id - d2->socket_id;
+    } else if (d1->numa_id != d2->numa_id) {
+        return d1->numa_id - d2->numa_id;
     } else {
         return d1->pid - d2->pid;
     }
@@ -32,6 +34,7 @@ static ucc_status_t ucc_topo_compute_layout(ucc_topo_t *topo, ucc_rank_t size)
     ucc_rank_t       max_ppn      = 0;
     ucc_rank_t       nnodes       = 1;
     int              max_sockid   = 0;
+    int              max_numaid   = 0;
     ucc_proc_info_t *sorted;
     ucc_host_id_t    current_hash, hash;
     int              i, j;
@@ -70,6 +73,9 @@ static ucc_status_t ucc_topo_compute_layout(ucc_topo_t *topo, ucc_rank_t size)
         if (topo->procs[j].socket_id > max_sockid) {
             max_sockid = topo->procs[j].socket_id;
         }
+        if ((int)topo->procs[j].numa_id > max_numaid) {
+            max_numaid = topo->procs[j].numa_id;
+        }
         if (topo->procs[j].host_hash == current_hash) {
             topo->procs[j].host_id = nnodes - 1;
         }
@@ -88,6 +94,7 @@ static ucc_status_t ucc_topo_compute_layout(ucc_topo_t *topo, ucc_rank_t size)
     topo->min_ppn       = min_ppn;
     topo->max_ppn       = max_ppn;
     topo->max_n_sockets = max_sockid + 1;
+    topo->max_n_numas   = max_numaid + 1;
     return UCC_OK;
 }
 
@@ -110,6 +117,7 @@ ucc_status_t ucc_topo_init(ucc_addr_storage_t *storage, ucc_topo_t **_topo)
     }
 
     topo->sock_bound = 1;
+    topo->numa_bound = 1;
     topo->n_procs    = storage->size;
     topo->procs =
         (ucc_proc_info_t *)ucc_malloc(storage->size * sizeof(ucc_proc_info_t),
@@ -127,6 +135,9 @@ ucc_status_t ucc_topo_init(ucc_addr_storage_t *storage, ucc_topo_t **_topo)
         if (h->ctx_id.pi.socket_id == -1) {
             topo->sock_bound = 0;
         }
+        if (h->ctx_id.pi.numa_id == -1) {
+            topo->numa_bound = 0;
+        }
     }
     status = ucc_topo_compute_layout(topo, storage->size);
     if (UCC_OK != status) {
@@ -14,7 +14,9 @@ typedef struct ucc_topo {
     ucc_rank_t       min_ppn;
     ucc_rank_t       max_ppn;
     ucc_rank_t       max_n_sockets;
+    ucc_rank_t       max_n_numas;
     uint32_t         sock_bound;
+    uint32_t         numa_bound;
 } ucc_topo_t;
 
 typedef struct ucc_team         ucc_team_t;
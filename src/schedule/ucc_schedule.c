@@ -4,31 +4,70 @@
  */
 #include "ucc_schedule.h"
 #include "utils/ucc_compiler_def.h"
+#include "utils/ucc_malloc.h"
 #include "components/base/ucc_base_iface.h"
 
-ucc_status_t ucc_event_manager_init(ucc_event_manager_t *em)
+/* Doubles the capacity of an array which is either the inline storage of
+   the object or previously grown heap array */
+static ucc_status_t ucc_schedule_array_grow(void **array, void *array_inline,
+                                            size_t elem_size, size_t n_elems,
+                                            const char *name)
 {
-    int i;
-    for (i = 0; i < MAX_LISTENERS; i++) {
-        em->listeners[i].task = NULL;
+    void *grown;
+
+    grown = ucc_malloc(2 * n_elems * elem_size, name);
+    if (ucc_unlikely(!grown)) {
+        ucc_error("failed to allocate %zd bytes for %s",
+                  2 * n_elems * elem_size, name);
+        return UCC_ERR_NO_MEMORY;
+    }
+    memcpy(grown, *array, n_elems * elem_size);
+    if (*array != array_inline) {
+        ucc_free(*array);
     }
+    *array = grown;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_event_manager_init(ucc_event_manager_t *em)
+{
+    em->listeners     = em->listeners_inline;
+    em->n_listeners   = 0;
+    em->max_listeners = UCC_EVENT_MANAGER_INLINE_LISTENERS;
     return UCC_OK;
 }
 
-void ucc_event_manager_subscribe(ucc_event_manager_t *em, ucc_event_t event,
-                                 ucc_coll_task_t *task,
-                                 ucc_task_event_handler_p handler)
+void ucc_event_manager_cleanup(ucc_event_manager_t *em)
+{
+    if (em->listeners != em->listeners_inline) {
+        ucc_free(em->listeners);
+    }
+    ucc_event_manager_init(em);
+}
+
+ucc_status_t ucc_event_manager_subscribe(ucc_event_manager_t *em,
+                                         ucc_event_t event,
+                                         ucc_coll_task_t *task,
+                                         ucc_task_event_handler_p handler)
 {
-    int i;
-    for (i = 0; i < MAX_LISTENERS; i++) {
-        if (!em->listeners[i].task) {
-            em->listeners[i].task    = task;
-            em->listeners[i].event   = event;
-            em->listeners[i].handler = handler;
-            break;
+    ucc_em_listener_t *l;
+    ucc_status_t       status;
+
+    if (ucc_unlikely(em->n_listeners == em->max_listeners)) {
+        status = ucc_schedule_array_grow((void **)&em->listeners,
+                                         em->listeners_inline,
+                                         sizeof(ucc_em_listener_t),
+                                         em->max_listeners, "em_listeners");
+        if (UCC_OK != status) {
+            return status;
         }
+        em->max_listeners *= 2;
     }
-    ucc_assert(i < MAX_LISTENERS);
+    l          = &em->listeners[em->n_listeners++];
+    l->task    = task;
+    l->event   = event;
+    l->handler = handler;
+    return UCC_OK;
 }
 
 ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task, ucc_coll_args_t *args,
@@ -37,6 +76,7 @@ ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task, ucc_coll_args_t *args,
     task->super.status     = UCC_OPERATION_INITIALIZED;
     task->ee               = NULL;
     task->flags            = 0;
+    task->pready           = NULL;
     task->team             = team;
     task->n_deps           = 0;
     task->n_deps_satisfied = 0;
@@ -53,13 +93,12 @@ ucc_task_error_handler(ucc_coll_task_t *parent_task,
 {
     ucc_event_manager_t *em = &parent_task->em;
     ucc_coll_task_t     *listener;
-    int                 i;
+    uint32_t             i;
 
     task->super.status = parent_task->super.status;
-    for (i = 0; i < MAX_LISTENERS; i++) {
+    for (i = 0; i < em->n_listeners; i++) {
         listener = em->listeners[i].task;
-        if (listener &&
-            listener->super.status != parent_task->super.status) {
+        if (listener->super.status != parent_task->super.status) {
             /* status has not been propagated yet */
             ucc_task_error_handler(task, listener);
         }
@@ -73,18 +112,19 @@ ucc_status_t ucc_event_manager_notify(ucc_coll_task_t *parent_task,
     ucc_event_manager_t *em = &parent_task->em;
     ucc_coll_task_t     *task;
     ucc_status_t        status;
-    int                 i;
+    uint32_t            i;
 
-    for (i = 0; i < MAX_LISTENERS; i++) {
+    /* all listeners whose dependencies become satisfied by this event are
+       posted from this loop, ready branches of the DAG run concurrently.
+       n_listeners is re-read since a handler may subscribe to em */
+    for (i = 0; i < em->n_listeners; i++) {
         task = em->listeners[i].task;
-        if (task) {
-            if (UCC_EVENT_ERROR == event) {
-                ucc_task_error_handler(parent_task, task);
-            } else if (em->listeners[i].event == event) {
-                status = em->listeners[i].handler(parent_task, task);
-                if (ucc_unlikely(status != UCC_OK)) {
-                    return status;
-                }
+        if (UCC_EVENT_ERROR == event) {
+            ucc_task_error_handler(parent_task, task);
+        } else if (em->listeners[i].event == event) {
+            status = em->listeners[i].handler(parent_task, task);
+            if (ucc_unlikely(status != UCC_OK)) {
+                return status;
             }
         }
     }
@@ -109,18 +149,48 @@ ucc_status_t ucc_schedule_init(ucc_schedule_t *schedule, ucc_coll_args_t *args,
 {
     ucc_status_t status;
 
-    status            = ucc_coll_task_init(&schedule->super, args, team);
-    schedule->ctx     = team->context->ucc_context;
-    schedule->n_tasks = 0;
+    status              = ucc_coll_task_init(&schedule->super, args, team);
+    schedule->ctx       = team->context->ucc_context;
+    schedule->n_tasks   = 0;
+    schedule->max_tasks = UCC_SCHEDULE_INLINE_TASKS;
+    schedule->tasks     = schedule->tasks_inline;
     return status;
 }
 
-void ucc_schedule_add_task(ucc_schedule_t *schedule, ucc_coll_task_t *task)
+void ucc_schedule_cleanup(ucc_schedule_t *schedule)
+{
+    if (schedule->tasks != schedule->tasks_inline) {
+        ucc_free(schedule->tasks);
+        schedule->tasks = schedule->tasks_inline;
+    }
+    ucc_event_manager_cleanup(&schedule->super.em);
+}
+
+ucc_status_t ucc_schedule_add_task(ucc_schedule_t  *schedule,
+                                   ucc_coll_task_t *task)
 {
-    ucc_event_manager_subscribe(&task->em, UCC_EVENT_COMPLETED,
-                            &schedule->super, ucc_schedule_completed_handler);
+    ucc_status_t status;
+
+    if (ucc_unlikely(schedule->n_tasks == schedule->max_tasks)) {
+        status = ucc_schedule_array_grow((void **)&schedule->tasks,
+                                         schedule->tasks_inline,
+                                         sizeof(ucc_coll_task_t *),
+                                         schedule->max_tasks,
+                                         "schedule_tasks");
+        if (UCC_OK != status) {
+            return status;
+        }
+        schedule->max_tasks *= 2;
+    }
+    status = ucc_event_manager_subscribe(&task->em, UCC_EVENT_COMPLETED,
+                                         &schedule->super,
+                                         ucc_schedule_completed_handler);
+    if (UCC_OK != status) {
+        return status;
+    }
     task->schedule                       = schedule;
     schedule->tasks[schedule->n_tasks++] = task;
+    return UCC_OK;
 }
 
 ucc_status_t ucc_schedule_start(ucc_schedule_t *schedule)
@@ -10,7 +10,11 @@
 #include "utils/ucc_log.h"
 #include "utils/ucc_lock_free_queue.h"
 
-#define MAX_LISTENERS 4
+/* Number of listeners and schedule tasks stored inside the task/schedule
+   object itself. Larger DAGs switch to heap allocated arrays which grow
+   on demand, so small schedules never allocate. */
+#define UCC_EVENT_MANAGER_INLINE_LISTENERS 4
+#define UCC_SCHEDULE_INLINE_TASKS          8
 
 typedef enum {
     UCC_EVENT_COMPLETED = 0,
@@ -27,6 +31,8 @@ typedef ucc_status_t (*ucc_task_event_handler_p)(ucc_coll_task_t *parent,
 typedef ucc_status_t (*ucc_coll_post_fn_t)(ucc_coll_task_t *task);
 typedef ucc_status_t (*ucc_coll_triggered_post_fn_t)(ucc_ee_h ee, ucc_ev_t *ev, ucc_coll_task_t *task);
 typedef ucc_status_t (*ucc_coll_finalize_fn_t)(ucc_coll_task_t *task);
+typedef ucc_status_t (*ucc_coll_pready_fn_t)(ucc_coll_task_t *task,
+                                             uint64_t         partition);
 
 typedef struct ucc_em_listener {
     ucc_coll_task_t          *task;
@@ -35,12 +41,18 @@ typedef struct ucc_em_listener {
 } ucc_em_listener_t;
 
 typedef struct ucc_event_manager {
-    ucc_em_listener_t listeners[MAX_LISTENERS];
+    ucc_em_listener_t *listeners; /*< listeners_inline or heap array */
+    uint32_t           n_listeners;
+    uint32_t           max_listeners;
+    ucc_em_listener_t  listeners_inline[UCC_EVENT_MANAGER_INLINE_LISTENERS];
 } ucc_event_manager_t;
 
 enum {
     UCC_COLL_TASK_FLAG_INTERNAL = UCC_BIT(0),
-    UCC_COLL_TASK_FLAG_CB       = UCC_BIT(1)
+    UCC_COLL_TASK_FLAG_CB       = UCC_BIT(1),
+    /* progress of the task is signaled through an event fd registered in
+       the core context, ucc_context_wait may block while it is queued */
+    UCC_COLL_TASK_FLAG_EVENT_FD = UCC_BIT(2)
 };
 
 typedef struct ucc_coll_task {
@@ -51,6 +63,7 @@ typedef struct ucc_coll_task {
     ucc_coll_post_fn_t           post;
     ucc_coll_triggered_post_fn_t triggered_post;
     ucc_coll_finalize_fn_t       finalize;
+    ucc_coll_pready_fn_t         pready; /*< NULL if partitions unsupported */
     ucc_coll_callback_t          cb;
     ucc_event_manager_t          em;
     ucc_status_t               (*progress)(struct ucc_coll_task *self);
@@ -65,31 +78,35 @@ typedef struct ucc_coll_task {
         /* used for lf mt progress queue */
         ucc_lf_queue_elem_t          lf_elem;
     };
-    uint8_t n_deps;
-    uint8_t n_deps_satisfied;
-    uint8_t n_deps_base;
+    uint32_t n_deps;
+    uint32_t n_deps_satisfied;
+    uint32_t n_deps_base;
 } ucc_coll_task_t;
 
 typedef struct ucc_context ucc_context_t;
 
-#define UCC_SCHEDULE_MAX_TASKS 8
-
 typedef struct ucc_schedule {
-    ucc_coll_task_t  super;
-    int              n_completed_tasks;
-    int              n_tasks;
-    ucc_context_t   *ctx;
-    ucc_coll_task_t *tasks[UCC_SCHEDULE_MAX_TASKS];
+    ucc_coll_task_t   super;
+    int               n_completed_tasks;
+    int               n_tasks;
+    int               max_tasks;
+    ucc_context_t    *ctx;
+    ucc_coll_task_t **tasks; /*< tasks_inline or heap array */
+    ucc_coll_task_t  *tasks_inline[UCC_SCHEDULE_INLINE_TASKS];
 } ucc_schedule_t;
 
 ucc_status_t ucc_event_manager_init(ucc_event_manager_t *em);
 
+/* Releases listener array of the event manager if it was grown */
+void ucc_event_manager_cleanup(ucc_event_manager_t *em);
+
 ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task, ucc_coll_args_t *args,
                                 ucc_base_team_t *team);
 
-void ucc_event_manager_subscribe(ucc_event_manager_t *em, ucc_event_t event,
-                                 ucc_coll_task_t *task,
-                                 ucc_task_event_handler_p handler);
+ucc_status_t ucc_event_manager_subscribe(ucc_event_manager_t *em,
+                                         ucc_event_t event,
+                                         ucc_coll_task_t *task,
+                                         ucc_task_event_handler_p handler);
 
 ucc_status_t ucc_event_manager_notify(ucc_coll_task_t *parent_task,
                                       ucc_event_t event);
@@ -97,7 +114,12 @@ ucc_status_t ucc_event_manager_notify(ucc_coll_task_t *parent_task,
 ucc_status_t ucc_schedule_init(ucc_schedule_t *schedule, ucc_coll_args_t *args,
                                ucc_base_team_t *team);
 
-void ucc_schedule_add_task(ucc_schedule_t *schedule, ucc_coll_task_t *task);
+ucc_status_t ucc_schedule_add_task(ucc_schedule_t  *schedule,
+                                   ucc_coll_task_t *task);
+
+/* Releases arrays of the schedule, must be called before the schedule
+   object is returned to its mpool */
+void ucc_schedule_cleanup(ucc_schedule_t *schedule);
 
 ucc_status_t ucc_schedule_start(ucc_schedule_t *schedule);
 
@@ -133,13 +155,18 @@ static inline ucc_status_t ucc_task_complete(ucc_coll_task_t *task)
     return status;
 }
 
-static inline void ucc_task_subscribe_dep(ucc_coll_task_t *target,
-                                          ucc_coll_task_t *subscriber,
-                                          ucc_event_t      event)
+static inline ucc_status_t ucc_task_subscribe_dep(ucc_coll_task_t *target,
+                                                  ucc_coll_task_t *subscriber,
+                                                  ucc_event_t      event)
 {
-    ucc_event_manager_subscribe(&target->em, event, subscriber,
-                                ucc_dependency_handler);
-    subscriber->n_deps++;
+    ucc_status_t status;
+
+    status = ucc_event_manager_subscribe(&target->em, event, subscriber,
+                                         ucc_dependency_handler);
+    if (ucc_likely(UCC_OK == status)) {
+        subscriber->n_deps++;
+    }
+    return status;
 }
 
 #define UCC_TASK_LIB(_task) (((ucc_coll_task_t *)_task)->team->context->lib)
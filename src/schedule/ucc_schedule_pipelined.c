@@ -4,13 +4,19 @@
  */
 #include "ucc_schedule.h"
 #include "ucc_schedule_pipelined.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_time.h"
+#include "utils/ucc_malloc.h"
+#include <limits.h>
+#include <string.h>
 
-static ucc_status_t ucc_frag_start_handler(ucc_coll_task_t *parent,
-                                           ucc_coll_task_t *task)
+/* weight of the previous samples in ucc_pipeline_stats_t */
+#define UCC_PIPELINE_STATS_DECAY 0.99
+
+static ucc_status_t ucc_frag_post(ucc_schedule_pipelined_t *schedule,
+                                  ucc_coll_task_t          *task)
 {
-    ucc_schedule_pipelined_t *schedule =
-        ucc_derived_of(parent, ucc_schedule_pipelined_t);
-    ucc_schedule_t *frag               = ucc_derived_of(task, ucc_schedule_t);
+    ucc_schedule_t *frag = ucc_derived_of(task, ucc_schedule_t);
     ucc_status_t    status;
 
     if (schedule->frag_setup) {
@@ -22,6 +28,9 @@ static ucc_status_t ucc_frag_start_handler(ucc_coll_task_t *parent,
             return status;
         }
     }
+    if (schedule->stats) {
+        schedule->frag_start[schedule->next_frag_to_post] = ucc_get_time();
+    }
     schedule->next_frag_to_post =
         (schedule->next_frag_to_post + 1) % schedule->n_frags;
     ucc_trace_req("sched %p started frag %p frag_num %d next_to_post %d",
@@ -32,6 +41,129 @@ static ucc_status_t ucc_frag_start_handler(ucc_coll_task_t *parent,
     return task->post(task);
 }
 
+static ucc_status_t ucc_frag_start_handler(ucc_coll_task_t *parent,
+                                           ucc_coll_task_t *task)
+{
+    ucc_schedule_pipelined_t *schedule =
+        ucc_derived_of(parent, ucc_schedule_pipelined_t);
+
+    /* frags are started in the ring order, so the pending ones are
+       the next n_frags_pending frags starting from next_frag_to_post */
+    if (schedule->ready && (schedule->n_frags_pending > 0 ||
+                            !schedule->ready[schedule->n_frags_started])) {
+        ucc_trace_req("sched %p frag %p waits for partition %d", schedule,
+                      task, schedule->n_frags_started +
+                      schedule->n_frags_pending);
+        schedule->n_frags_pending++;
+        return UCC_OK;
+    }
+    return ucc_frag_post(schedule, task);
+}
+
+/* ready, n_frags_pending and the ring position are updated by pready from
+   the user thread and by the frag completions from the context progress, a
+   partitioned schedule serializes them with a lock. The lock is recursive
+   since a frag may complete inside its post. */
+static inline void ucc_schedule_pipelined_lock(ucc_schedule_pipelined_t *s)
+{
+    if (s->ready) {
+        ucc_recursive_spin_lock(&s->lock);
+    }
+}
+
+static inline void ucc_schedule_pipelined_unlock(ucc_schedule_pipelined_t *s)
+{
+    if (s->ready) {
+        ucc_recursive_spin_unlock(&s->lock);
+    }
+}
+
+/* Restarts the completed frags in the ring order while more frags have to
+   be launched. A restarted frag either starts right away or, if its
+   partition is not ready yet, becomes pending. */
+static void
+ucc_schedule_pipelined_restart_frags(ucc_schedule_pipelined_t *schedule)
+{
+    ucc_schedule_t *frag;
+    int             i;
+
+    while (schedule->super.n_completed_tasks + schedule->n_frags_in_pipeline +
+           schedule->n_frags_pending < schedule->super.n_tasks) {
+        frag = schedule->frags[schedule->next_frag_to_post];
+        if (frag->super.super.status != UCC_OK) {
+            /* still in flight or waiting for its partition */
+            break;
+        }
+        ucc_trace_req("sched %p restarting frag %d %p", schedule,
+                      schedule->next_frag_to_post, frag);
+        frag->super.super.status = UCC_OPERATION_INITIALIZED;
+        frag->n_completed_tasks  = 0;
+        for (i = 0; i < frag->n_tasks; i++) {
+            frag->tasks[i]->n_deps += frag->tasks[i]->n_deps_base;
+            frag->tasks[i]->super.status = UCC_OPERATION_INITIALIZED;
+        }
+        ucc_frag_start_handler(&schedule->super.super, &frag->super);
+    }
+}
+
+static ucc_status_t ucc_schedule_pipelined_pready(ucc_coll_task_t *task,
+                                                  uint64_t         partition)
+{
+    ucc_schedule_pipelined_t *schedule =
+        ucc_derived_of(task, ucc_schedule_pipelined_t);
+    ucc_status_t status = UCC_OK;
+
+    if (!schedule->ready) {
+        return UCC_OK;
+    }
+    ucc_schedule_pipelined_lock(schedule);
+    if (ucc_unlikely(schedule->ready[partition])) {
+        ucc_error("partition %lu of sched %p is already ready",
+                  (unsigned long)partition, schedule);
+        status = UCC_ERR_INVALID_PARAM;
+        goto out;
+    }
+    schedule->ready[partition] = 1;
+    while (schedule->n_frags_pending > 0 &&
+           schedule->ready[schedule->n_frags_started]) {
+        schedule->n_frags_pending--;
+        status = ucc_frag_post(
+            schedule, &schedule->frags[schedule->next_frag_to_post]->super);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto out;
+        }
+    }
+    /* a frag that completed while the partition of its next launch was not
+       ready yet is idle, neither in flight nor pending */
+    ucc_schedule_pipelined_restart_frags(schedule);
+out:
+    ucc_schedule_pipelined_unlock(schedule);
+    return status;
+}
+
+ucc_status_t
+ucc_schedule_pipelined_set_partitioned(ucc_schedule_pipelined_t *schedule_p,
+                                       int                       wait_ready)
+{
+    schedule_p->super.super.pready = ucc_schedule_pipelined_pready;
+    if (!wait_ready) {
+        return UCC_OK;
+    }
+    if (UCS_OK != ucc_recursive_spinlock_init(&schedule_p->lock, 0)) {
+        ucc_error("failed to initialize lock of sched %p", schedule_p);
+        return UCC_ERR_NO_RESOURCE;
+    }
+    schedule_p->ready = ucc_calloc(schedule_p->super.n_tasks, 1,
+                                   "sched_partitions");
+    if (!schedule_p->ready) {
+        ucc_error("failed to allocate %d bytes for partitions",
+                  schedule_p->super.n_tasks);
+        ucc_recursive_spinlock_destroy(&schedule_p->lock);
+        return UCC_ERR_NO_MEMORY;
+    }
+    return UCC_OK;
+}
+
 static ucc_status_t
 ucc_schedule_pipelined_completed_handler(ucc_coll_task_t *parent_task, //NOLINT
                                          ucc_coll_task_t *task)
@@ -41,6 +173,7 @@ ucc_schedule_pipelined_completed_handler(ucc_coll_task_t *parent_task, //NOLINT
     ucc_schedule_t *frag = ucc_derived_of(parent_task, ucc_schedule_t);
     int             i;
 
+    ucc_schedule_pipelined_lock(schedule);
     schedule->super.n_completed_tasks += 1;
     schedule->n_frags_in_pipeline--;
     ucc_trace_req(
@@ -48,31 +181,24 @@ ucc_schedule_pipelined_completed_handler(ucc_coll_task_t *parent_task, //NOLINT
         schedule, frag, schedule->super.n_completed_tasks,
         schedule->n_frags_started, schedule->super.n_tasks);
     ucc_assert(frag->super.super.status == UCC_OK);
+    if (schedule->stats) {
+        for (i = 0; i < schedule->n_frags; i++) {
+            if (schedule->frags[i] == frag) {
+                ucc_pipeline_stats_update(schedule->stats, schedule->frag_size,
+                                          ucc_get_time() -
+                                              schedule->frag_start[i]);
+                break;
+            }
+        }
+    }
     if (schedule->super.n_completed_tasks == schedule->super.n_tasks) {
+        ucc_schedule_pipelined_unlock(schedule);
         schedule->super.super.super.status = UCC_OK;
         ucc_task_complete(task);
         return UCC_OK;
     }
-    while ((schedule->super.n_completed_tasks + schedule->n_frags_in_pipeline <
-            schedule->super.n_tasks) &&
-           (frag->super.super.status == UCC_OK)) {
-        /* need to post more frags*/
-        if (frag == schedule->frags[schedule->next_frag_to_post]) {
-            ucc_trace_req("sched %p restarting frag %d %p", schedule,
-                          schedule->next_frag_to_post, frag);
-            frag->super.super.status = UCC_OPERATION_INITIALIZED;
-            frag->n_completed_tasks  = 0;
-            for (i = 0; i < frag->n_tasks; i++) {
-                frag->tasks[i]->n_deps += frag->tasks[i]->n_deps_base;
-                frag->tasks[i]->super.status = UCC_OPERATION_INITIALIZED;
-            }
-            ucc_frag_start_handler(&schedule->super.super, &frag->super);
-        }
-        frag = schedule->frags[schedule->next_frag_to_post];
-        if (&frag->super == parent_task) {
-            break;
-        }
-    }
+    ucc_schedule_pipelined_restart_frags(schedule);
+    ucc_schedule_pipelined_unlock(schedule);
     return UCC_OK;
 }
 
@@ -87,6 +213,11 @@ ucc_status_t ucc_schedule_pipelined_finalize(ucc_coll_task_t *task)
     for (i = 0; i < schedule_p->n_frags; i++) {
         schedule_p->frags[i]->super.finalize(&frags[i]->super);
     }
+    if (schedule_p->ready) {
+        ucc_recursive_spinlock_destroy(&schedule_p->lock);
+        ucc_free(schedule_p->ready);
+        schedule_p->ready = NULL;
+    }
     return UCC_OK;
 }
 
@@ -95,6 +226,7 @@ ucc_status_t ucc_schedule_pipelined_post(ucc_coll_task_t *task)
     ucc_schedule_pipelined_t *schedule_p =
         ucc_derived_of(task, ucc_schedule_pipelined_t);
     ucc_schedule_t **frags = schedule_p->frags;
+    ucc_status_t     status;
     int              i, j;
 
     schedule_p->super.super.super.status = UCC_OPERATION_INITIALIZED;
@@ -102,6 +234,10 @@ ucc_status_t ucc_schedule_pipelined_post(ucc_coll_task_t *task)
     schedule_p->n_frags_started          = 0;
     schedule_p->next_frag_to_post        = 0;
     schedule_p->n_frags_in_pipeline      = 0;
+    schedule_p->n_frags_pending          = 0;
+    if (schedule_p->ready) {
+        memset(schedule_p->ready, 0, schedule_p->super.n_tasks);
+    }
 
     for (i = 0; i < schedule_p->n_frags; i++) {
         frags[i]->n_completed_tasks  = 0;
@@ -116,7 +252,12 @@ ucc_status_t ucc_schedule_pipelined_post(ucc_coll_task_t *task)
         }
     }
 
-    return ucc_schedule_start(&schedule_p->super);
+    /* frags completing from the progress of other threads must not see
+       the pipeline half started */
+    ucc_schedule_pipelined_lock(schedule_p);
+    status = ucc_schedule_start(&schedule_p->super);
+    ucc_schedule_pipelined_unlock(schedule_p);
+    return status;
 }
 
 ucc_status_t ucc_schedule_pipelined_init(
@@ -141,6 +282,10 @@ ucc_status_t ucc_schedule_pipelined_init(
     schedule->frag_setup           = frag_setup;
     schedule->next_frag_to_post    = 0;
     schedule->n_frags_in_pipeline  = 0;
+    schedule->stats                = NULL;
+    schedule->frag_size            = 0;
+    schedule->ready                = NULL;
+    schedule->n_frags_pending      = 0;
     schedule->super.super.finalize = ucc_schedule_pipelined_finalize;
     schedule->super.super.post     = ucc_schedule_pipelined_post;
     frags                          = schedule->frags;
@@ -156,21 +301,35 @@ ucc_status_t ucc_schedule_pipelined_init(
         for (j = 0; j < frags[i]->n_tasks; j++) {
             frags[i]->tasks[j]->n_deps_base = frags[i]->tasks[j]->n_deps;
             if (n_frags > 1 && sequential) {
-                ucc_event_manager_subscribe(
+                status = ucc_event_manager_subscribe(
                     &frags[(i > 0) ? (i - 1) : (n_frags - 1)]->tasks[j]->em,
                     UCC_EVENT_TASK_STARTED, frags[i]->tasks[j],
                     ucc_dependency_handler);
+                if (UCC_OK != status) {
+                    goto err_subscribe;
+                }
                 frags[i]->tasks[j]->n_deps_base++;
             }
         }
-        ucc_event_manager_subscribe(&schedule->super.super.em,
-                                    UCC_EVENT_SCHEDULE_STARTED,
-                                    &frags[i]->super, ucc_frag_start_handler);
-        ucc_event_manager_subscribe(
+        status = ucc_event_manager_subscribe(&schedule->super.super.em,
+                                             UCC_EVENT_SCHEDULE_STARTED,
+                                             &frags[i]->super,
+                                             ucc_frag_start_handler);
+        if (UCC_OK != status) {
+            goto err_subscribe;
+        }
+        status = ucc_event_manager_subscribe(
             &frags[i]->super.em, UCC_EVENT_COMPLETED, &schedule->super.super,
-                        ucc_schedule_pipelined_completed_handler);
+            ucc_schedule_pipelined_completed_handler);
+        if (UCC_OK != status) {
+            goto err_subscribe;
+        }
     }
     return UCC_OK;
+err_subscribe:
+    ucc_error("failed to subscribe pipeline fragments");
+    ucc_event_manager_cleanup(&schedule->super.super.em);
+    i = n_frags;
 err:
     for (i = i - 1; i >= 0; i--) {
         frags[i]->super.finalize(&frags[i]->super);
@@ -184,7 +343,7 @@ ucc_status_t ucc_dependency_handler(ucc_coll_task_t *parent, /* NOLINT */
     ucc_status_t status;
 
     task->n_deps_satisfied++;
-    ucc_trace_req("task %p, n_deps %d, satisfied %d", task, task->n_deps,
+    ucc_trace_req("task %p, n_deps %u, satisfied %u", task, task->n_deps,
                   task->n_deps_satisfied);
     if (task->n_deps == task->n_deps_satisfied) {
         status = task->post(task);
@@ -196,3 +355,86 @@ ucc_status_t ucc_dependency_handler(ucc_coll_task_t *parent, /* NOLINT */
 
     return UCC_OK;
 }
+
+/* modeled time of the pipeline in units of frag_latency */
+static inline double ucc_pipeline_cost(double size_cost, int n_stages,
+                                       size_t n_frags)
+{
+    return (double)(n_frags + n_stages - 1) * (1 + size_cost / n_frags);
+}
+
+void ucc_schedule_pipelined_select(const ucc_pipeline_model_t *model,
+                                   size_t msgsize, int n_stages,
+                                   size_t max_frags_total, int *n_frags,
+                                   int *pipeline_depth)
+{
+    double size_cost;
+    size_t lo, hi, mid;
+
+    *n_frags        = 1;
+    *pipeline_depth = 1;
+    if (n_stages < 2 || max_frags_total < 2 ||
+        !(model->frag_latency > 0) || !(model->bw > 0)) {
+        return;
+    }
+    /* the cost is convex in n_frags, find the minimum by bisection */
+    size_cost = msgsize / model->bw / model->frag_latency;
+    lo        = 1;
+    hi        = ucc_min(max_frags_total, (size_t)INT_MAX);
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (ucc_pipeline_cost(size_cost, n_stages, mid) <=
+            ucc_pipeline_cost(size_cost, n_stages, mid + 1)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *n_frags        = (int)lo;
+    *pipeline_depth = ucc_min(ucc_min(*n_frags, n_stages),
+                              UCC_SCHEDULE_PIPELINED_MAX_FRAGS);
+}
+
+void ucc_pipeline_stats_init(ucc_pipeline_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void ucc_pipeline_stats_update(ucc_pipeline_stats_t *stats, size_t frag_size,
+                               double time)
+{
+    double s = (double)frag_size;
+
+    stats->w  = stats->w * UCC_PIPELINE_STATS_DECAY + 1;
+    stats->s  = stats->s * UCC_PIPELINE_STATS_DECAY + s;
+    stats->t  = stats->t * UCC_PIPELINE_STATS_DECAY + time;
+    stats->ss = stats->ss * UCC_PIPELINE_STATS_DECAY + s * s;
+    stats->st = stats->st * UCC_PIPELINE_STATS_DECAY + s * time;
+    stats->n_samples++;
+}
+
+ucc_status_t ucc_pipeline_stats_estimate(const ucc_pipeline_stats_t *stats,
+                                         ucc_pipeline_model_t       *model)
+{
+    double mean_s, mean_t, var_s, cov_st, beta, alpha;
+
+    if (stats->n_samples < 2) {
+        return UCC_ERR_NOT_FOUND;
+    }
+    mean_s = stats->s / stats->w;
+    mean_t = stats->t / stats->w;
+    var_s  = stats->ss / stats->w - mean_s * mean_s;
+    cov_st = stats->st / stats->w - mean_s * mean_t;
+    /* relative threshold: sizes equal up to rounding are one point */
+    if (!(var_s > 1e-6 * mean_s * mean_s)) {
+        return UCC_ERR_NOT_FOUND;
+    }
+    beta  = cov_st / var_s;
+    alpha = mean_t - beta * mean_s;
+    if (!(beta > 0) || !(alpha > 0)) {
+        return UCC_ERR_NOT_FOUND;
+    }
+    model->frag_latency = alpha;
+    model->bw           = 1 / beta;
+    return UCC_OK;
+}
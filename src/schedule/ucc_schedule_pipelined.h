@@ -5,12 +5,35 @@
 #ifndef UCC_SCHEDULE_PIPELINED_H_
 #define UCC_SCHEDULE_PIPELINED_H_
 #include "components/base/ucc_base_iface.h"
+#include "utils/ucc_spinlock.h"
 
 #define UCC_SCHEDULE_FRAG_MAX_TASKS 8
 
 typedef struct ucc_schedule_pipelined ucc_schedule_pipelined_t;
 
-#define UCC_SCHEDULE_PIPELINED_MAX_FRAGS 4
+#define UCC_SCHEDULE_PIPELINED_MAX_FRAGS 16
+
+/* Linear cost model of a single fragment: latency + size / bw. Used to
+   select fragmentation of a pipelined collective. The selection must be
+   identical on all ranks of a team, so it depends only on the model
+   parameters, message size and the number of pipeline stages. */
+typedef struct ucc_pipeline_model {
+    double frag_latency; /*< fixed cost of a fragment, seconds */
+    double bw;           /*< bytes per second */
+} ucc_pipeline_model_t;
+
+/* Per-fragment completion times measured by pipelined schedules. The
+   samples are exponentially weighted so that the estimate follows the
+   recent behavior of the team. Updates are not serialized, concurrent
+   collectives on the same team may lose a sample. */
+typedef struct ucc_pipeline_stats {
+    double   w;
+    double   s;
+    double   t;
+    double   ss;
+    double   st;
+    uint64_t n_samples;
+} ucc_pipeline_stats_t;
 
 /* frag_init is the callback provided by the user of pipelined
    framework (e.g., TL that needs to build a pipeline) that is reponsible
@@ -46,6 +69,19 @@ typedef struct ucc_schedule_pipelined {
     int                          sequential;
     int                          next_frag_to_post;
     ucc_schedule_frag_setup_fn_t frag_setup;
+    /* optional: if set, completion time of every fragment of frag_size
+       bytes is recorded into stats */
+    ucc_pipeline_stats_t        *stats;
+    size_t                       frag_size;
+    double                       frag_start[UCC_SCHEDULE_PIPELINED_MAX_FRAGS];
+    /* optional: if set, fragment i is started only after partition i is
+       marked ready, see ucc_schedule_pipelined_set_partitioned */
+    uint8_t                     *ready;
+    /* number of frags waiting for their partition to become ready */
+    int                          n_frags_pending;
+    /* serializes pready with the frag completions, initialized together
+       with ready */
+    ucc_recursive_spinlock_t     lock;
 } ucc_schedule_pipelined_t;
 
 /* Creates a pipelined schedule for the algorithm defined by "frag_init".
@@ -63,4 +99,35 @@ ucc_status_t ucc_schedule_pipelined_init(
 ucc_status_t ucc_schedule_pipelined_post(ucc_coll_task_t *task);
 
 ucc_status_t ucc_schedule_pipelined_finalize(ucc_coll_task_t *task);
+
+/* Makes the schedule a partitioned collective: fragment i processes
+   partition i of the user buffer and starts after the partition is
+   marked ready with ucc_collective_pready. If wait_ready is 0 (e.g. the
+   rank only receives the data) fragments start as usual and pready is a
+   no-op. */
+ucc_status_t
+ucc_schedule_pipelined_set_partitioned(ucc_schedule_pipelined_t *schedule_p,
+                                       int                       wait_ready);
+
+/* Selects the total number of fragments and the pipeline depth for a
+   message of msgsize bytes processed by a pipeline of n_stages stages
+   (e.g. communication steps of the algorithm), so that the modeled time
+   (n_frags + n_stages - 1) / n_stages * (frag_latency + frag_size / bw)
+   is minimal. n_frags is limited by max_frags_total (e.g. element count).
+   The depth is limited by UCC_SCHEDULE_PIPELINED_MAX_FRAGS. */
+void ucc_schedule_pipelined_select(const ucc_pipeline_model_t *model,
+                                   size_t msgsize, int n_stages,
+                                   size_t max_frags_total, int *n_frags,
+                                   int *pipeline_depth);
+
+void ucc_pipeline_stats_init(ucc_pipeline_stats_t *stats);
+
+void ucc_pipeline_stats_update(ucc_pipeline_stats_t *stats, size_t frag_size,
+                               double time);
+
+/* Fits the linear model to the measured samples. Returns
+   UCC_ERR_NOT_FOUND if the samples do not cover different fragment
+   sizes. */
+ucc_status_t ucc_pipeline_stats_estimate(const ucc_pipeline_stats_t *stats,
+                                         ucc_pipeline_model_t       *model);
 #endif
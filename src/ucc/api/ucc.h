@@ -164,6 +164,8 @@ typedef enum {
  *  @ref ucc_coll_type_t represents the collective operations supported by the
  *  UCC library. Currently, it supports barrier, broadcast, all-reduce, reduce,
  *  alltoall, all-gather, gather, scatter, fan-in and fan-out operations.
+ *  UCC_COLL_TYPE_SPARSE_ALLREDUCE is an all-reduce of sparse vectors given
+ *  as (index, value) pairs, see @ref ucc_coll_sparse_info_t.
  *
  *  @endparblock
  *
@@ -185,6 +187,7 @@ typedef enum {
     UCC_COLL_TYPE_REDUCE_SCATTERV    = UCC_BIT(13),
     UCC_COLL_TYPE_SCATTER            = UCC_BIT(14),
     UCC_COLL_TYPE_SCATTERV           = UCC_BIT(15),
+    UCC_COLL_TYPE_SPARSE_ALLREDUCE   = UCC_BIT(16),
     UCC_COLL_TYPE_LAST
 } ucc_coll_type_t;
 
@@ -200,8 +203,13 @@ typedef enum {
  *
  *  @ref ucc_datatype_t represents the datatypes supported by the UCC library’s
  *  collective and reduction operations. The standard operations are signed and
- *  unsigned integers of various sizes, float 16, 32, and 64, and user-defined
- *  datatypes. The UCC_DT_USERDEFINED represents the user-defined datatype. The
+ *  unsigned integers of various sizes, float 16, 32, and 64, bfloat16 (8 bit
+ *  exponent, 7 bit mantissa) and user-defined datatypes. The value-index pair
+ *  datatypes (UCC_DT_FLOAT32_INT32, ...) are used with UCC_OP_MAXLOC and
+ *  UCC_OP_MINLOC reductions, each element has the layout of the C structure
+ *  { value; int32_t index; } with natural alignment, which matches
+ *  MPI_FLOAT_INT, MPI_DOUBLE_INT, MPI_SHORT_INT, MPI_2INT and MPI_LONG_INT.
+ *  The UCC_DT_USERDEFINED represents the user-defined datatype. The
  *  UCC_DT_OPAQUE is used to represent the user-defined datatypes for
  *  user-defined reductions. When UCC_DT_OPAQUE is used, the library passes the
  *  data to the user-defined reductions without any modifications.
@@ -224,9 +232,115 @@ typedef enum {
     UCC_DT_FLOAT32,
     UCC_DT_FLOAT64,
     UCC_DT_USERDEFINED,
-    UCC_DT_OPAQUE
+    UCC_DT_OPAQUE,
+    UCC_DT_FLOAT32_INT32,
+    UCC_DT_FLOAT64_INT32,
+    UCC_DT_INT16_INT32,
+    UCC_DT_INT32_INT32,
+    UCC_DT_INT64_INT32,
+    UCC_DT_BFLOAT16
 } ucc_datatype_t;
 
+/**
+ *
+ *  @ingroup UCC_LIB_INIT_DT
+ *
+ *  @brief Contiguous block of an element of a user-defined datatype
+ *
+ */
+typedef struct ucc_dt_block {
+    uint64_t offset; /*!< Offset in bytes from the start of the element */
+    uint64_t length; /*!< Length in bytes */
+} ucc_dt_block_t;
+
+/**
+ *
+ *  @ingroup UCC_LIB_INIT_DT
+ *
+ *  @brief Layout of a non-contiguous user-defined datatype
+ *
+ *  @parblock
+ *
+ *  Description
+ *
+ *  @ref ucc_dt_userdefined_t describes an element of a UCC_DT_USERDEFINED
+ *  buffer as a list of contiguous blocks, element i starts "i * extent"
+ *  bytes after the buffer address. The packed representation of an element,
+ *  which is what goes on the wire, is the concatenation of its blocks in
+ *  the order of the list, so the source and destination of a collective
+ *  may use different layouts of the same packed size. Counts of the
+ *  collective are given in elements and displacements of the vector
+ *  collectives in units of extent. For example, a column of a row major
+ *  n x m matrix of doubles is n elements of blocks = {{0, 8}} and
+ *  extent = 8 * m, structure {double x; int pad; float y;} without the
+ *  padding is blocks = {{0, 8}, {12, 4}} and extent = 16.
+ *
+ *  @endparblock
+ *
+ */
+typedef struct ucc_dt_userdefined {
+    uint64_t              n_blocks; /*!< Number of blocks of an element */
+    const ucc_dt_block_t *blocks;   /*!< Blocks of an element */
+    uint64_t              extent;   /*!< Distance in bytes between elements */
+} ucc_dt_userdefined_t;
+
+/**
+ *
+ *  @ingroup UCC_LIB_INIT_DT
+ *
+ *  @brief User-defined reduction callback
+ *
+ *  @parblock
+ *
+ *  Description
+ *
+ *  @ref ucc_reduction_cb_t is invoked by the library to reduce n_vectors
+ *  vectors into dst: for i in [0, count)
+ *  dst[i] = src1[i] (op) src2[i] (op) src2[stride + i] (op) ...
+ *           (op) src2[(n_vectors - 1) * stride + i],
+ *  where stride is in bytes. The layout of a single element is given by "dt",
+ *  the datatype of the collective buffers. The library never splits an
+ *  element, so the datatype size must be equal to the size of the user
+ *  element, e.g. UCC_DT_FLOAT64 for single precision complex numbers. The
+ *  dst buffer may be equal to src1 or to the first vector of src2, otherwise
+ *  the buffers do not overlap. Count never exceeds the max_count of the
+ *  operation descriptor. The callback is called only for host memory and
+ *  must be thread safe if the library is used in UCC_THREAD_MULTIPLE mode.
+ *
+ *  @endparblock
+ *
+ */
+typedef ucc_status_t (*ucc_reduction_cb_t)(const void *src1, const void *src2,
+                                           void *dst, size_t n_vectors,
+                                           size_t count, size_t stride,
+                                           ucc_datatype_t dt, void *cb_ctx);
+
+/**
+ *
+ *  @ingroup UCC_LIB_INIT_DT
+ *
+ *  @brief User-defined reduction operation descriptor
+ *
+ *  @parblock
+ *
+ *  Description
+ *
+ *  @ref ucc_reduction_op_desc_t is passed through "custom_op" field of
+ *  @ref ucc_coll_args_t together with UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS
+ *  mask bit. The descriptor must stay valid until the collective completes.
+ *
+ *  @endparblock
+ *
+ */
+typedef struct ucc_reduction_op_desc {
+    ucc_reduction_cb_t cb;        /*!< Reduction callback */
+    void              *cb_ctx;    /*!< User context passed to the callback */
+    size_t             max_count; /*!< Max number of elements the callback
+                                       can process in a single call, larger
+                                       vectors are reduced in chunks.
+                                       0 - unlimited */
+} ucc_reduction_op_desc_t;
+
 /**
  *
  *  @ingroup UCC_LIB_INIT_DT
@@ -879,6 +993,93 @@ ucc_status_t ucc_context_create(ucc_lib_h lib_handle,
 
 ucc_status_t ucc_context_progress(ucc_context_h context);
 
+/**
+ *  @ingroup UCC_CONTEXT
+ *
+ *  @brief The @ref ucc_context_get_fd routine returns a file descriptor
+ *  that can be used to wait for events on the context.
+ *
+ *  @param [in]  context  Communication context handle
+ *  @param [out] fd       Waitable file descriptor
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  The @ref ucc_context_get_fd routine returns a file descriptor that
+ *  becomes readable when there are events to be processed on the context.
+ *  The descriptor can be used with poll/select/epoll together with other
+ *  application descriptors. The descriptor is only signaled after the
+ *  context was armed with @ref ucc_context_arm. The user must not close
+ *  the descriptor, it is released by @ref ucc_context_destroy. The routine
+ *  returns UCC_ERR_NOT_SUPPORTED if blocking progress is not enabled
+ *  (UCC_BLOCKING_PROGRESS context configuration parameter).
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+
+ucc_status_t ucc_context_get_fd(ucc_context_h context, int *fd);
+
+/**
+ *  @ingroup UCC_CONTEXT
+ *
+ *  @brief The @ref ucc_context_arm routine arms the context file descriptor
+ *  for event notification.
+ *
+ *  @param [in]  context  Communication context handle
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  The @ref ucc_context_arm routine must be called before waiting on the
+ *  descriptor returned by @ref ucc_context_get_fd. If the routine returns
+ *  UCC_OK the descriptor is armed and the user can block on it. If the
+ *  routine returns UCC_INPROGRESS there are unprocessed events and the user
+ *  must call @ref ucc_context_progress before trying to arm the context
+ *  again.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+
+ucc_status_t ucc_context_arm(ucc_context_h context);
+
+/**
+ *  @ingroup UCC_CONTEXT
+ *
+ *  @brief The @ref ucc_context_wait routine progresses the context and
+ *  blocks until an event arrives or the timeout expires.
+ *
+ *  @param [in]  context  Communication context handle
+ *  @param [in]  timeout  Timeout in milliseconds, -1 means infinite
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  The @ref ucc_context_wait routine implements spin-then-block progress.
+ *  The context is first progressed for a number of iterations. If no events
+ *  are processed during that time the context is armed and the calling
+ *  thread blocks on the context file descriptor. The number of spin
+ *  iterations is adapted at runtime between UCC_BLOCKING_SPIN_MIN and
+ *  UCC_BLOCKING_SPIN_MAX. If some outstanding work of the context can not
+ *  signal the descriptor (e.g. collectives of the components that do not
+ *  provide an event fd) the routine polls the context instead of blocking.
+ *  The routine returns UCC_OK if events were processed or the descriptor
+ *  was signaled and UCC_INPROGRESS if the timeout expired. The user is
+ *  expected to test the outstanding requests after the routine returns.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+
+ucc_status_t ucc_context_wait(ucc_context_h context, int timeout);
+
 /**
  *  @ingroup UCC_CONTEXT
  *
@@ -1169,7 +1370,10 @@ typedef struct ucc_team_attr {
  *  the collective operation. ucc_team_create_test operation is used to learn
  *  the status of the new team handle. On error, the team handle will not
  *  be created and corresponding error code as defined by @ref ucc_status_t is
- *  returned.
+ *  returned. If multiple contexts are passed, all of them must be created
+ *  with the same OOB (global contexts). The first context is used to create
+ *  the team, the resources of the other contexts are used as additional
+ *  communication lanes for the team collectives.
  *
  *  @endparblock
  *
@@ -1460,9 +1664,61 @@ enum ucc_coll_args_field {
     UCC_COLL_ARGS_FIELD_PREDEFINED_REDUCTIONS           = UCC_BIT(1),
     UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS          = UCC_BIT(2),
     UCC_COLL_ARGS_FIELD_TAG                             = UCC_BIT(3),
-    UCC_COLL_ARGS_FIELD_CB                              = UCC_BIT(4)
+    UCC_COLL_ARGS_FIELD_CB                              = UCC_BIT(4),
+    UCC_COLL_ARGS_FIELD_SPARSE                          = UCC_BIT(5),
+    UCC_COLL_ARGS_FIELD_USERDEFINED_DATATYPES           = UCC_BIT(6),
+    UCC_COLL_ARGS_FIELD_PARTITIONS                      = UCC_BIT(7)
 };
 
+/**
+ *  @ingroup UCC_COLLECTIVES_DT
+ *
+ *  @brief Index information of a sparse all-reduce
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *  @n @n
+ *  Each participant contributes src.info.count nonzero values stored in
+ *  src.info.buffer, their positions in the dense vector of dense_count
+ *  elements are given by src_indices, which must be sorted in strictly
+ *  increasing order. The result is returned as sparse (dst_indices and
+ *  dst.info.buffer, both of capacity dst.info.count) or, if dst_indices is
+ *  NULL, as a dense vector of dense_count elements in dst.info.buffer. In
+ *  both cases the number of returned elements is stored in dst_nnz.
+ *  Only UCC_OP_SUM is supported and UCC_COLL_ARGS_FLAG_IN_PLACE is not.
+ *  If the sparse result does not fit dst.info.count elements the
+ *  collective completes with UCC_ERR_NO_RESOURCE.
+ *  @endparblock
+ */
+typedef struct ucc_coll_sparse_info {
+    uint64_t *src_indices; /*!< Sorted indices of the local nonzeros */
+    uint64_t *dst_indices; /*!< Indices of the result, NULL for dense
+                                output */
+    uint64_t *dst_nnz;     /*!< Number of elements of the result */
+    uint64_t  dense_count; /*!< Number of elements of the dense vector */
+} ucc_coll_sparse_info_t;
+
+/**
+ *  @ingroup UCC_COLLECTIVES_DT
+ *
+ *  @brief Layouts of UCC_DT_USERDEFINED buffers of a collective
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *  @n @n
+ *  Set together with UCC_COLL_ARGS_FIELD_USERDEFINED_DATATYPES mask bit.
+ *  The layout of a buffer is used when its datatype is UCC_DT_USERDEFINED
+ *  and must stay valid until the collective is finalized. Currently
+ *  supported by alltoall and alltoallv in host memory.
+ *  @endparblock
+ */
+typedef struct ucc_coll_dt_info {
+    const ucc_dt_userdefined_t *src; /*!< Layout of src elements */
+    const ucc_dt_userdefined_t *dst; /*!< Layout of dst elements */
+} ucc_coll_dt_info_t;
+
 /**
  *  @ingroup UCC_COLLECTIVES
  *
@@ -1512,7 +1768,8 @@ typedef struct ucc_coll_args {
                                                         reduce or all-reduce
                                                         operation selected */
         void                       *custom_op; /*!< User defined
-                                                    reduction operation */
+                                                    reduction operation,
+                                                    @ref ucc_reduction_op_desc_t */
         void                       *custom_dtype;
     } reduce;
     uint64_t                        flags;
@@ -1521,6 +1778,12 @@ typedef struct ucc_coll_args {
     ucc_error_type_t                error_type; /*!< Error type */
     ucc_coll_id_t                   tag; /*!< Used for ordering collectives */
     ucc_coll_callback_t             cb;
+    ucc_coll_sparse_info_t          sparse; /*!< Sparse all-reduce indices */
+    ucc_coll_dt_info_t              dt; /*!< Layouts of user-defined
+                                             datatypes */
+    uint64_t                        n_partitions; /*!< Number of partitions,
+                                                       @ref
+                                                       ucc_collective_pready */
 } ucc_coll_args_t;
 
 /**
@@ -1553,6 +1816,40 @@ typedef struct ucc_coll_args {
 ucc_status_t ucc_collective_init(ucc_coll_args_t *coll_args,
                                  ucc_coll_req_h *request, ucc_team_h team);
 
+/**
+ *  @ingroup UCC_COLLECTIVES
+ *
+ *  @brief The routine to initialize a group of collective operations.
+ *
+ *  @param [in]    coll_args   Array of collective arguments descriptors
+ *  @param [in]    n_colls     Number of descriptors in coll_args
+ *  @param [out]   request     Request handle representing the whole group
+ *  @param [in]    team        Team handle
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  @ref ucc_collective_init_group initializes n_colls collective operations
+ *  on the team which are posted, tested and finalized together through the
+ *  single returned request handle. All participants must provide the same
+ *  sequence of collective types, datatypes, reduction operations and counts.
+ *  The library may fuse small allreduce operations with the same datatype and
+ *  reduction operation into a single operation over a staging buffer, the
+ *  size limit is controlled by the UCC_COLL_GROUP_FUSE_MAX context parameter.
+ *  The request completes when all collectives of the group have completed,
+ *  the completion order of individual collectives is undefined.
+ *  Collectives with a callback are never fused.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+ucc_status_t ucc_collective_init_group(ucc_coll_args_t *coll_args,
+                                       uint32_t n_colls,
+                                       ucc_coll_req_h *request,
+                                       ucc_team_h team);
+
 /**
  *  @ingroup UCC_COLLECTIVES
  *
@@ -1574,6 +1871,47 @@ ucc_status_t ucc_collective_init(ucc_coll_args_t *coll_args,
  */
 ucc_status_t ucc_collective_post(ucc_coll_req_h request);
 
+/**
+ *  @ingroup UCC_COLLECTIVES
+ *
+ *  @brief The routine to mark a partition of a partitioned collective ready.
+ *
+ *  @param [in]     request     Request handle
+ *  @param [in]     partition   Index of the partition
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *  @n @n
+ *  A collective initialized with UCC_COLL_ARGS_FIELD_PARTITIONS set in the
+ *  mask is split into "n_partitions" partitions of its source buffer (of
+ *  the destination buffer for in-place collectives): partition i holds
+ *  count / n_partitions elements, the first count % n_partitions
+ *  partitions hold one more element. After @ref ucc_collective_post the
+ *  collective does not access a partition until the producer of the data
+ *  marks it ready with @ref ucc_collective_pready, so that the
+ *  communication of the ready partitions overlaps the computation of the
+ *  rest. Every partition must be marked ready once per post on every
+ *  participant that provides data: all the participants of allreduce and
+ *  the root of bcast (the call is a no-op on the other ranks of bcast).
+ *  Partitions are processed in increasing order, marking them ready in
+ *  that order gives the most overlap. The routine may be called
+ *  concurrently with @ref ucc_context_progress of the context of the
+ *  collective, e.g. by the threads that produce the partitions while
+ *  another thread progresses the context; the collective serializes the
+ *  two internally. Calls for different partitions of the same request may
+ *  also come from different threads.
+ *  @n @n
+ *  Currently supported by allreduce and bcast of TL/UCP,
+ *  @ref ucc_collective_init returns UCC_ERR_NOT_SUPPORTED for the other
+ *  partitioned collectives.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+ucc_status_t ucc_collective_pready(ucc_coll_req_h request, uint64_t partition);
+
 
 /**
  *
@@ -1854,6 +2192,15 @@ ucc_status_t ucc_ee_wait(ucc_ee_h ee, ucc_ev_t *ev);
  * operation that executes in the future when an event occurs on the execution
  * engine.
  *
+ * For the @ref UCC_EE_CPU_THREAD execution engine the collective is launched
+ * by the context progress (e.g. the context progress thread) after the
+ * application sets @ref UCC_EVENT_COMPUTE_COMPLETE with @ref ucc_ee_set_event.
+ * The triggered collectives of an execution engine consume these events in
+ * the order they were triggered. @ref UCC_EVENT_COLLECTIVE_POST and
+ * @ref UCC_EVENT_COLLECTIVE_COMPLETE events with the request of the
+ * collective are published to the execution engine and can be fetched with
+ * @ref ucc_ee_get_event.
+ *
  * @endparblock
  *
  * @return Error code as defined by @ref ucc_status_t
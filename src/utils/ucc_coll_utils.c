@@ -33,6 +33,7 @@ ucc_coll_type_t ucc_coll_type_from_str(const char *str)
     STR_COLL_TYPE_CHECK(str, REDUCE_SCATTERV);
     STR_COLL_TYPE_CHECK(str, SCATTER);
     STR_COLL_TYPE_CHECK(str, SCATTERV);
+    STR_COLL_TYPE_CHECK(str, SPARSE_ALLREDUCE);
     return UCC_COLL_TYPE_LAST;
 }
 
@@ -68,6 +69,7 @@ ucc_coll_args_is_mem_symmetric(const ucc_base_coll_args_t *bargs)
     case UCC_COLL_TYPE_ALLREDUCE:
     case UCC_COLL_TYPE_ALLGATHER:
     case UCC_COLL_TYPE_REDUCE_SCATTER:
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
         return args->dst.info.mem_type == args->src.info.mem_type;
     case UCC_COLL_TYPE_ALLGATHERV:
     case UCC_COLL_TYPE_REDUCE_SCATTERV:
@@ -111,6 +113,7 @@ ucc_memory_type_t ucc_coll_args_mem_type(const ucc_base_coll_args_t *bargs)
     case UCC_COLL_TYPE_ALLREDUCE:
     case UCC_COLL_TYPE_ALLGATHER:
     case UCC_COLL_TYPE_REDUCE_SCATTER:
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
         return args->dst.info.mem_type;
     case UCC_COLL_TYPE_ALLGATHERV:
     case UCC_COLL_TYPE_REDUCE_SCATTERV:
@@ -149,11 +152,16 @@ size_t ucc_coll_args_msgsize(const ucc_base_coll_args_t *bargs)
         return 0;
     case UCC_COLL_TYPE_BCAST:
         return args->src.info.count * ucc_dt_size(args->src.info.datatype);
-    case UCC_COLL_TYPE_ALLREDUCE:
     case UCC_COLL_TYPE_ALLTOALL:
+        return args->dst.info.count *
+               ucc_coll_args_dt_size(args, args->dst.info.datatype, 0);
+    case UCC_COLL_TYPE_ALLREDUCE:
     case UCC_COLL_TYPE_ALLGATHER:
     case UCC_COLL_TYPE_REDUCE_SCATTER:
         return args->dst.info.count * ucc_dt_size(args->dst.info.datatype);
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
+        /* nnz differs across ranks, dense size is the common upper bound */
+        return args->sparse.dense_count * ucc_dt_size(args->dst.info.datatype);
     case UCC_COLL_TYPE_ALLGATHERV:
     case UCC_COLL_TYPE_REDUCE_SCATTERV:
         return ucc_coll_args_get_total_count(args, args->dst.info_v.counts,
@@ -29,6 +29,9 @@
     (((_args).mask & UCC_COLL_ARGS_FIELD_FLAGS) && \
      ((_args).flags & UCC_COLL_ARGS_FLAG_IN_PLACE))
 
+#define UCC_IS_PARTITIONED(_args) \
+    ((_args).mask & UCC_COLL_ARGS_FIELD_PARTITIONS)
+
 static inline size_t
 ucc_coll_args_get_count(const ucc_coll_args_t *args, const ucc_count_t *counts,
                         ucc_rank_t idx)
@@ -71,6 +74,66 @@ ucc_coll_args_get_total_count(const ucc_coll_args_t *args,
 
     return count;
 }
+
+/* Block i of count elements split into n blocks, the first count % n
+   blocks hold one more element. Defines fragments of pipelined
+   collectives and partitions of partitioned ones. */
+static inline size_t ucc_buffer_block_count(size_t count, size_t n, size_t i)
+{
+    return count / n + ((i < count % n) ? 1 : 0);
+}
+
+static inline size_t ucc_buffer_block_offset(size_t count, size_t n, size_t i)
+{
+    return i * (count / n) + ucc_min(i, count % n);
+}
+
+/* Layout of a UCC_DT_USERDEFINED buffer of the collective, NULL if the
+   datatype is predefined or the layout is not given */
+static inline const ucc_dt_userdefined_t *
+ucc_coll_args_dt_layout(const ucc_coll_args_t *args, ucc_datatype_t dt,
+                        int is_src)
+{
+    if ((dt != UCC_DT_USERDEFINED) ||
+        !(args->mask & UCC_COLL_ARGS_FIELD_USERDEFINED_DATATYPES)) {
+        return NULL;
+    }
+    return is_src ? args->dt.src : args->dt.dst;
+}
+
+/* Size of the packed representation of an element */
+static inline size_t ucc_dt_userdefined_size(const ucc_dt_userdefined_t *dt)
+{
+    size_t   size = 0;
+    uint64_t i;
+
+    for (i = 0; i < dt->n_blocks; i++) {
+        size += dt->blocks[i].length;
+    }
+    return size;
+}
+
+/* Size of an element of the src or dst buffer as it goes on the wire,
+   0 if the datatype is user defined without layout */
+static inline size_t ucc_coll_args_dt_size(const ucc_coll_args_t *args,
+                                           ucc_datatype_t dt, int is_src)
+{
+    const ucc_dt_userdefined_t *layout =
+        ucc_coll_args_dt_layout(args, dt, is_src);
+
+    return layout ? ucc_dt_userdefined_size(layout) : ucc_dt_size(dt);
+}
+
+/* Distance between consecutive elements of the src or dst buffer */
+static inline size_t ucc_coll_args_dt_extent(const ucc_coll_args_t *args,
+                                             ucc_datatype_t dt, int is_src)
+{
+    const ucc_dt_userdefined_t *layout =
+        ucc_coll_args_dt_layout(args, dt, is_src);
+
+    return layout ? layout->extent : ucc_dt_size(dt);
+}
+
 typedef struct ucc_base_coll_args ucc_base_coll_args_t;
 
 ucc_coll_type_t   ucc_coll_type_from_str(const char *str);
@@ -9,6 +9,7 @@
 #include "config.h"
 #include "core/ucc_global_opts.h"
 #include <ucs/debug/log_def.h>
+#include <ucs/debug/assert.h>
 
 #define UCC_LOG_LEVEL_ERROR UCS_LOG_LEVEL_ERROR
 #define UCC_LOG_LEVEL_WARN  UCS_LOG_LEVEL_WARN
@@ -26,6 +27,8 @@
 #define ucc_log_component_global(_level, fmt, ...)                             \
     ucc_log_component(_level, ucc_global_config.log_component, fmt,            \
                       ##__VA_ARGS__)
+/* Logs the message and aborts, for failures that can not be reported */
+#define ucc_fatal(_fmt, ...) ucs_fatal(_fmt, ##__VA_ARGS__)
 #define ucc_error(_fmt, ...)                                                   \
     ucc_log_component_global(UCS_LOG_LEVEL_ERROR, _fmt, ##__VA_ARGS__)
 #define ucc_warn(_fmt, ...)                                                    \
@@ -78,6 +81,8 @@ static inline const char* ucc_coll_type_str(ucc_coll_type_t ct)
         return "Fanout";
     case UCC_COLL_TYPE_REDUCE_SCATTER:
         return "Reduce scatter";
+    case UCC_COLL_TYPE_SPARSE_ALLREDUCE:
+        return "Sparse allreduce";
     default:
         break;
     }
@@ -97,6 +102,8 @@ static inline const char* ucc_datatype_str(ucc_datatype_t dt)
         return "uint16";
     case UCC_DT_FLOAT16:
         return "float16";
+    case UCC_DT_BFLOAT16:
+        return "bfloat16";
     case UCC_DT_INT32:
         return "int32";
     case UCC_DT_UINT32:
@@ -113,6 +120,16 @@ static inline const char* ucc_datatype_str(ucc_datatype_t dt)
         return "int128";
     case UCC_DT_UINT128:
         return "uint128";
+    case UCC_DT_FLOAT32_INT32:
+        return "float32_int32";
+    case UCC_DT_FLOAT64_INT32:
+        return "float64_int32";
+    case UCC_DT_INT16_INT32:
+        return "int16_int32";
+    case UCC_DT_INT32_INT32:
+        return "int32_int32";
+    case UCC_DT_INT64_INT32:
+        return "int64_int32";
     case UCC_DT_USERDEFINED:
         return "userdefined";
     case UCC_DT_OPAQUE:
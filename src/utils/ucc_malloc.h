@@ -8,10 +8,12 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define ucc_malloc(_s, ...) malloc(_s)
 #define ucc_calloc(_n, _s, ...) calloc(_n, _s)
 #define ucc_realloc(_p, _s, ...) realloc(_p, _s)
 #define ucc_free(_p) free(_p)
+#define ucc_strdup(_s, ...) strdup(_s)
 
 #endif
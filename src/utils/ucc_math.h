@@ -26,10 +26,21 @@
 #define DO_OP_LXOR(_v1, _v2) ((!_v1) != (!_v2))
 #define DO_OP_BXOR(_v1, _v2) (_v1 ^ _v2)
 
-extern size_t ucc_dt_sizes[UCC_DT_USERDEFINED];
+/* Predefined datatypes added to the API after UCC_DT_OPAQUE keep the values
+   of the existing ones, this is the end of the range of all datatypes */
+#define UCC_DT_PREDEFINED_LAST (UCC_DT_BFLOAT16 + 1)
+
+static inline int ucc_dt_is_predefined(ucc_datatype_t dt)
+{
+    return (dt < UCC_DT_PREDEFINED_LAST) && (dt != UCC_DT_USERDEFINED) &&
+           (dt != UCC_DT_OPAQUE);
+}
+
+extern size_t ucc_dt_sizes[UCC_DT_PREDEFINED_LAST];
 static inline size_t ucc_dt_size(ucc_datatype_t dt)
 {
-    if (ucc_likely(dt < UCC_DT_USERDEFINED)) {
+    if (ucc_likely(dt < UCC_DT_PREDEFINED_LAST)) {
+        /* 0 for UCC_DT_USERDEFINED and UCC_DT_OPAQUE */
         return ucc_dt_sizes[dt];
     }
     // TODO remove ucc_likely once custom datatype is implemented
@@ -66,4 +77,7 @@ int ucc_sort_uniq(int *array, int len, int inverse);
 
 #define ucc_div_round_up(_n, _d) (((_n) + (_d) - 1) / (_d))
 
+#define ucc_align_up(_n, _alignment)                                           \
+    (ucc_div_round_up(_n, _alignment) * (_alignment))
+
 #endif
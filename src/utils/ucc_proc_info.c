@@ -11,6 +11,8 @@
 #include <sched.h>
 #include <limits.h>
 #include <stdint.h>
+#include <dirent.h>
+#include <sys/syscall.h>
 #include "config.h"
 #ifdef HAVE_UCS_GET_SYSTEM_ID
 #include <ucs/sys/uid.h>
@@ -79,14 +81,83 @@ static int parse_cpuset_file(FILE *file, int *nr_psbl_cpus)
     return 0;
 }
 
-ucc_status_t ucc_get_bound_socket_id(int *socketid)
+/* Returns the id of the cpu domain (socket, numa node, L3 cache) the cpu
+   belongs to, -1 if unknown */
+typedef int (*ucc_cpu_domain_id_fn_t)(int cpu);
+
+static int ucc_read_int_file(const char *path)
+{
+    FILE *fptr;
+    int   val;
+
+    fptr = fopen(path, "r");
+    if (!fptr) {
+        return -1;
+    }
+    if (1 != fscanf(fptr, "%d", &val) || val < 0) {
+        val = -1;
+    }
+    fclose(fptr);
+    return val;
+}
+
+static int ucc_cpu_socket_id(int cpu)
+{
+    char str[1024];
+
+    sprintf(str, "/sys/bus/cpu/devices/cpu%d/topology/physical_package_id",
+            cpu);
+    return ucc_read_int_file(str);
+}
+
+static int ucc_cpu_numa_id(int cpu)
+{
+    char           str[1024];
+    DIR           *dir;
+    struct dirent *entry;
+    int            numa_id = -1;
+
+    /* cpu directory contains "node<N>" link to its numa node */
+    sprintf(str, "/sys/bus/cpu/devices/cpu%d", cpu);
+    dir = opendir(str);
+    if (!dir) {
+        return -1;
+    }
+    while (NULL != (entry = readdir(dir))) {
+        if (1 == sscanf(entry->d_name, "node%d", &numa_id)) {
+            break;
+        }
+    }
+    closedir(dir);
+    return numa_id;
+}
+
+static int ucc_cpu_l3_id(int cpu)
+{
+    char str[1024];
+    int  i;
+
+    for (i = 0; i < 8; i++) {
+        sprintf(str, "/sys/bus/cpu/devices/cpu%d/cache/index%d/level", cpu, i);
+        if (3 == ucc_read_int_file(str)) {
+            sprintf(str, "/sys/bus/cpu/devices/cpu%d/cache/index%d/id", cpu, i);
+            return ucc_read_int_file(str);
+        }
+    }
+    return -1;
+}
+
+/* Finds the domain the process is bound to. If "logical" is set then
+   the domain id is converted to the logical index of the domain on the
+   host. */
+static ucc_status_t ucc_get_bound_domain_id(ucc_cpu_domain_id_fn_t domain_id,
+                                            int logical, int *id)
 {
     cpu_set_t *cpuset = NULL;
     int        sockid = -1, sockid2 = -1;
     int        try, i, n_sockets, cpu, nr_cpus, nr_psbl_cpus = 0;
     size_t     setsize;
-    FILE *     fptr, *possible;
-    char       str[1024];
+    FILE *     possible;
     int *      socket_ids, tmpid;
 
     /* Get the number of total procs and online procs */
@@ -142,50 +213,48 @@ ucc_status_t ucc_get_bound_socket_id(int *socketid)
     if (!socket_ids) {
         ucc_error("failed to allocate %zd bytes for socket_ids array",
                   nr_cpus * sizeof(int));
+        __sched_cpufree(cpuset);
         return UCC_ERR_NO_MEMORY;
     }
-    /* Loop through all cpus, and check if I'm bound to the socket */
+    /* Loop through all cpus, and check if I'm bound to the domain */
     for (cpu = 0; cpu < nr_cpus; cpu++) {
-        socket_ids[cpu] = -1;
-        sprintf(str, "/sys/bus/cpu/devices/cpu%d/topology/physical_package_id",
-                cpu);
-        fptr = fopen(str, "r");
-        if (!fptr) {
-            /* Do nothing just skip */
-            continue;
-        }
-        /* Read socket id from file */
-        if ((1 == fscanf(fptr, "%d", &tmpid)) && (tmpid >= 0)) {
-            socket_ids[cpu] = tmpid;
-            if (SBGP_CPU_ISSET(cpu, setsize, cpuset)) {
-                if (sockid == -1) {
-                    sockid = tmpid;
-                } else if (tmpid != sockid && sockid2 == -1) {
-                    sockid2 = tmpid;
-                }
+        tmpid           = domain_id(cpu);
+        socket_ids[cpu] = tmpid;
+        if (tmpid >= 0 && SBGP_CPU_ISSET(cpu, setsize, cpuset)) {
+            if (sockid == -1) {
+                sockid = tmpid;
+            } else if (tmpid != sockid && sockid2 == -1) {
+                sockid2 = tmpid;
             }
         }
-        fclose(fptr);
     }
 
-    /* Check that a process is bound to 1 and only 1 socket */
-    if ((sockid != -1) && (sockid2 == -1)) {
+    /* Check that a process is bound to 1 and only 1 domain */
+    if ((sockid != -1) && (sockid2 == -1) && !logical) {
+        *id = sockid;
+    } else if ((sockid != -1) && (sockid2 == -1)) {
         /* Some archs (eg. POWER) seem to have non-linear socket_ids.
           * Convert to logical index by findig first occurence of tmpid in
           * the global socket_ids array. */
         n_sockets = ucc_sort_uniq(socket_ids, nr_cpus, 0);
         for (i = 0; i < n_sockets; i++) {
             if (socket_ids[i] == sockid) {
-                *socketid = i;
+                *id = i;
                 break;
             }
         }
-        ucc_assert(((*socketid) >= 0) && ((*socketid) < nr_cpus));
+        ucc_assert(((*id) >= 0) && ((*id) < nr_cpus));
     }
     ucc_free(socket_ids);
+    __sched_cpufree(cpuset);
     return UCC_OK;
 }
 
+ucc_status_t ucc_get_bound_socket_id(int *socketid)
+{
+    return ucc_get_bound_domain_id(ucc_cpu_socket_id, 1, socketid);
+}
+
 ucc_status_t ucc_local_proc_info_init()
 {
     ucc_local_proc.host_hash = gethostid();
@@ -199,6 +268,8 @@ ucc_status_t ucc_local_proc_info_init()
     }
     ucc_local_proc.pid       = getpid();
     ucc_local_proc.socket_id = -1;
+    ucc_local_proc.numa_id   = -1;
+    ucc_local_proc.l3_id     = -1;
 
     ucc_debug("proc pid %d, host %s, host_hash %lu",
               ucc_local_proc.pid, ucc_local_hostname, ucc_local_proc.host_hash);
@@ -206,6 +277,46 @@ ucc_status_t ucc_local_proc_info_init()
     if (UCC_OK != ucc_get_bound_socket_id(&ucc_local_proc.socket_id)) {
         ucc_debug("failed to get bound socket id");
     }
+    if (UCC_OK != ucc_get_bound_domain_id(ucc_cpu_numa_id, 0,
+                                          &ucc_local_proc.numa_id)) {
+        ucc_debug("failed to get bound numa id");
+    }
+    if (UCC_OK != ucc_get_bound_domain_id(ucc_cpu_l3_id, 1,
+                                          &ucc_local_proc.l3_id)) {
+        ucc_debug("failed to get bound l3 id");
+    }
+    ucc_debug("proc pid %d, socket %d, numa %d, l3 %d", ucc_local_proc.pid,
+              (int)ucc_local_proc.socket_id, (int)ucc_local_proc.numa_id,
+              (int)ucc_local_proc.l3_id);
 
     return UCC_OK;
 }
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+void ucc_numa_bind_local(void *addr, size_t length)
+{
+#ifdef SYS_mbind
+    int           node = (int)ucc_local_proc.numa_id;
+    unsigned long mask[4];
+    long          page_size;
+    void         *start;
+
+    if (node < 0 || node >= (int)(sizeof(mask) * 8) || !length) {
+        return;
+    }
+    page_size = sysconf(_SC_PAGESIZE);
+    start     = (void *)((uintptr_t)addr & ~((uintptr_t)page_size - 1));
+    length   += (uintptr_t)addr - (uintptr_t)start;
+    memset(mask, 0, sizeof(mask));
+    mask[node / (sizeof(unsigned long) * 8)] =
+        1ul << (node % (sizeof(unsigned long) * 8));
+    if (0 != syscall(SYS_mbind, start, length, MPOL_PREFERRED, mask,
+                     sizeof(mask) * 8, 0)) {
+        ucc_debug("failed to bind memory %p len %zd to numa node %d", addr,
+                  length, node);
+    }
+#endif
+}
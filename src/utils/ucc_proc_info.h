@@ -12,10 +12,17 @@
 
 typedef uint64_t ucc_host_id_t;
 typedef uint32_t ucc_socket_id_t;
+typedef uint32_t ucc_numa_id_t;
+typedef uint32_t ucc_l3_id_t;
 
+/* socket_id and l3_id are logical indexes of the domain on the host,
+   numa_id is the numa node number as reported by the OS. Each of them
+   is -1 if the process is not bound to a single domain of that kind. */
 typedef struct ucc_proc_info {
     ucc_host_id_t   host_hash;
     ucc_socket_id_t socket_id;
+    ucc_numa_id_t   numa_id;
+    ucc_l3_id_t     l3_id;
     ucc_host_id_t   host_id;
     pid_t           pid;
 } ucc_proc_info_t;
@@ -32,4 +39,8 @@ uint64_t ucc_get_system_id();
 
 const char*  ucc_hostname();
 
+/* Sets the preferred numa node of the memory range to the numa node the
+   calling process is bound to. No-op if the process is not bound. */
+void ucc_numa_bind_local(void *addr, size_t length);
+
 #endif
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "utils/ucc_scratch.h"
+#include "core/ucc_mc.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_log.h"
+#include "utils/ucc_proc_info.h"
+
+/* Sizes in (2^k, 2^(k+1)] are split into 4 classes of 2^(k-2) step, so the
+   rounding wastes at most 25%, steps below the page size are rounded up to
+   the page. Returns the class and rounds the size up to it. */
+static inline int ucc_scratch_size_class(size_t *size)
+{
+    size_t step, base;
+    int    k, sub;
+
+    if (*size <= UCC_SCRATCH_ALIGN) {
+        *size = UCC_SCRATCH_ALIGN;
+        return 0;
+    }
+    k = ucc_ilog2(*size - 1);
+    if (k >= UCC_SCRATCH_MAX_CLASS) {
+        *size = ucc_align_up(*size, UCC_SCRATCH_ALIGN);
+        return -1;
+    }
+    base  = (size_t)1 << k;
+    step  = ucc_max(base >> 2, UCC_SCRATCH_ALIGN);
+    sub   = ucc_div_round_up(*size - base, step);
+    *size = base + sub * step;
+    return (k - UCC_SCRATCH_MIN_CLASS) * 4 + sub;
+}
+
+void ucc_scratch_arena_init(ucc_scratch_arena_t *arena, size_t max_cached)
+{
+    int i, j;
+
+    ucc_spinlock_init(&arena->lock, 0);
+    arena->cached     = 0;
+    arena->max_cached = max_cached;
+    for (i = 0; i < UCC_MEMORY_TYPE_LAST; i++) {
+        for (j = 0; j < UCC_SCRATCH_N_CLASSES; j++) {
+            ucc_list_head_init(&arena->free[i][j]);
+        }
+    }
+}
+
+static void ucc_scratch_free(ucc_scratch_t *scratch)
+{
+    ucc_mc_free(scratch->mc_header);
+    ucc_free(scratch);
+}
+
+void ucc_scratch_arena_cleanup(ucc_scratch_arena_t *arena)
+{
+    ucc_scratch_t *scratch, *tmp;
+    int            i, j;
+
+    for (i = 0; i < UCC_MEMORY_TYPE_LAST; i++) {
+        for (j = 0; j < UCC_SCRATCH_N_CLASSES; j++) {
+            ucc_list_for_each_safe(scratch, tmp, &arena->free[i][j],
+                                   list_elem) {
+                ucc_list_del(&scratch->list_elem);
+                ucc_scratch_free(scratch);
+            }
+        }
+    }
+    arena->cached = 0;
+    ucc_spinlock_destroy(&arena->lock);
+}
+
+ucc_status_t ucc_scratch_get(ucc_scratch_arena_t *arena,
+                             size_t size, ucc_memory_type_t mem_type,
+                             ucc_scratch_t **scratch_p)
+{
+    int              size_class = ucc_scratch_size_class(&size);
+    ucc_scratch_t   *scratch;
+    ucc_list_link_t *list;
+    ucc_status_t     status;
+
+    if (ucc_likely(size_class >= 0)) {
+        list = &arena->free[mem_type][size_class];
+        ucc_spin_lock(&arena->lock);
+        if (!ucc_list_is_empty(list)) {
+            scratch = ucc_list_extract_head(list, ucc_scratch_t,
+                                            list_elem);
+            arena->cached -= scratch->size;
+            ucc_spin_unlock(&arena->lock);
+            *scratch_p = scratch;
+            return UCC_OK;
+        }
+        ucc_spin_unlock(&arena->lock);
+    }
+
+    scratch = ucc_malloc(sizeof(*scratch), "scratch");
+    if (!scratch) {
+        ucc_error("failed to allocate %zd bytes for scratch descriptor",
+                  sizeof(*scratch));
+        return UCC_ERR_NO_MEMORY;
+    }
+    status = ucc_mc_alloc(&scratch->mc_header, size, mem_type);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_error("failed to allocate %zd bytes for scratch buffer", size);
+        ucc_free(scratch);
+        return status;
+    }
+    scratch->addr       = scratch->mc_header->addr;
+    scratch->size       = size;
+    scratch->mem_type   = mem_type;
+    scratch->size_class = size_class;
+    if (UCC_MEMORY_TYPE_HOST == mem_type) {
+        /* pages are populated on first touch by the collective, bind them
+           to the local numa node */
+        ucc_numa_bind_local(scratch->addr, size);
+    }
+    *scratch_p = scratch;
+    return UCC_OK;
+}
+
+void ucc_scratch_put(ucc_scratch_arena_t *arena, ucc_scratch_t *scratch)
+{
+    if (scratch->size_class >= 0) {
+        ucc_spin_lock(&arena->lock);
+        if (arena->cached + scratch->size <= arena->max_cached) {
+            arena->cached += scratch->size;
+            /* LIFO keeps the most recently used buffer cache hot */
+            ucc_list_insert_after(
+                &arena->free[scratch->mem_type][scratch->size_class],
+                &scratch->list_elem);
+            ucc_spin_unlock(&arena->lock);
+            return;
+        }
+        ucc_spin_unlock(&arena->lock);
+    }
+    ucc_scratch_free(scratch);
+}
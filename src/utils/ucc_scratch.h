@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_SCRATCH_H_
+#define UCC_SCRATCH_H_
+
+#include "ucc/api/ucc.h"
+#include "components/mc/base/ucc_mc_base.h"
+#include "utils/ucc_list.h"
+#include "utils/ucc_spinlock.h"
+
+/* Scratch buffers are multiples of 4KB, sizes from 4KB to 2^MAX_CLASS are
+   rounded up to a quarter of their power of 2, larger ones are not cached */
+#define UCC_SCRATCH_MIN_CLASS 12
+#define UCC_SCRATCH_MAX_CLASS 40
+#define UCC_SCRATCH_ALIGN     UCC_BIT(UCC_SCRATCH_MIN_CLASS)
+#define UCC_SCRATCH_N_CLASSES                                                  \
+    ((UCC_SCRATCH_MAX_CLASS - UCC_SCRATCH_MIN_CLASS) * 4 + 1)
+
+typedef struct ucc_scratch {
+    ucc_list_link_t         list_elem;
+    ucc_mc_buffer_header_t *mc_header;
+    void                   *addr;
+    size_t                  size;
+    ucc_memory_type_t       mem_type;
+    int                     size_class;
+} ucc_scratch_t;
+
+/* Per-team cache of scratch buffers used by the reduction algorithms.
+   Buffers are kept in size classes per memory type and reused by
+   subsequent collectives, so that in the steady state the scratch
+   allocation does not call the allocator. Every outstanding task owns its
+   own buffer, the arena is protected by the lock since tasks may be
+   initialized and finalized from different threads. At most max_cached
+   bytes are kept in the free lists, buffers released above that limit are
+   freed. */
+typedef struct ucc_scratch_arena {
+    ucc_spinlock_t  lock;
+    size_t          cached;
+    size_t          max_cached;
+    ucc_list_link_t free[UCC_MEMORY_TYPE_LAST][UCC_SCRATCH_N_CLASSES];
+} ucc_scratch_arena_t;
+
+void ucc_scratch_arena_init(ucc_scratch_arena_t *arena, size_t max_cached);
+
+void ucc_scratch_arena_cleanup(ucc_scratch_arena_t *arena);
+
+ucc_status_t ucc_scratch_get(ucc_scratch_arena_t *arena,
+                             size_t size, ucc_memory_type_t mem_type,
+                             ucc_scratch_t **scratch);
+
+void ucc_scratch_put(ucc_scratch_arena_t *arena, ucc_scratch_t *scratch);
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TIME_H_
+#define UCC_TIME_H_
+
+#include "config.h"
+#include <ucs/time/time.h>
+
+/* Returns monotonic time in seconds */
+static inline double ucc_get_time(void)
+{
+    return ucs_time_to_sec(ucs_get_time());
+}
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "utils/ucc_tune_file.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdlib.h>
+
+static char *ucc_tune_file_strip(char *str)
+{
+    char *end;
+
+    while (isspace(*str)) {
+        str++;
+    }
+    end = str + strlen(str);
+    while (end > str && isspace(*(end - 1))) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+static ucc_tune_file_entry_t *
+ucc_tune_file_get_entry(ucc_tune_file_t *tune, ucc_rank_t nnodes,
+                        ucc_rank_t ppn)
+{
+    ucc_tune_file_entry_t *entries, *e;
+    int                    i;
+
+    for (i = 0; i < tune->n_entries; i++) {
+        if (tune->entries[i].nnodes == nnodes && tune->entries[i].ppn == ppn) {
+            return &tune->entries[i];
+        }
+    }
+    entries = ucc_realloc(tune->entries,
+                          (tune->n_entries + 1) * sizeof(*entries),
+                          "tune_entries");
+    if (!entries) {
+        ucc_error("failed to allocate %zd bytes for tune entries",
+                  (tune->n_entries + 1) * sizeof(*entries));
+        return NULL;
+    }
+    tune->entries = entries;
+    e             = &entries[tune->n_entries++];
+    memset(e, 0, sizeof(*e));
+    e->nnodes = nnodes;
+    e->ppn    = ppn;
+    return e;
+}
+
+static ucc_status_t ucc_tune_file_add(ucc_tune_file_entry_t *e,
+                                      const char *name, const char *value)
+{
+    ucc_tune_file_param_t *params;
+    size_t                 len;
+    char                  *str;
+    int                    i;
+
+    if (0 == strcmp(name, "TUNE")) {
+        /* '#' separated tokens of several sections are merged */
+        len = strlen(value) + 1 + (e->score_str ? strlen(e->score_str) + 1 : 0);
+        str = ucc_malloc(len, "tune_score_str");
+        if (!str) {
+            return UCC_ERR_NO_MEMORY;
+        }
+        snprintf(str, len, "%s%s%s", e->score_str ? e->score_str : "",
+                 e->score_str ? "#" : "", value);
+        ucc_free(e->score_str);
+        e->score_str = str;
+        return UCC_OK;
+    }
+    for (i = 0; i < e->n_params; i++) {
+        if (0 == strcmp(e->params[i].name, name)) {
+            /* last value wins */
+            str = ucc_strdup(value, "tune_param_value");
+            if (!str) {
+                return UCC_ERR_NO_MEMORY;
+            }
+            ucc_free(e->params[i].value);
+            e->params[i].value = str;
+            return UCC_OK;
+        }
+    }
+    params = ucc_realloc(e->params, (e->n_params + 1) * sizeof(*params),
+                         "tune_params");
+    if (!params) {
+        return UCC_ERR_NO_MEMORY;
+    }
+    e->params                   = params;
+    params[e->n_params].name    = ucc_strdup(name, "tune_param_name");
+    params[e->n_params].value   = ucc_strdup(value, "tune_param_value");
+    if (!params[e->n_params].name || !params[e->n_params].value) {
+        ucc_free(params[e->n_params].name);
+        ucc_free(params[e->n_params].value);
+        return UCC_ERR_NO_MEMORY;
+    }
+    e->n_params++;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tune_file_load(const char *filename, ucc_tune_file_t *tune)
+{
+    ucc_tune_file_entry_t *e      = NULL;
+    ucc_status_t           status = UCC_OK;
+    char                  *line   = NULL;
+    size_t                 n      = 0;
+    int                    lineno = 0;
+    unsigned               nnodes, ppn;
+    char                  *str, *value;
+    FILE                  *f;
+
+    tune->entries   = NULL;
+    tune->n_entries = 0;
+    f = fopen(filename, "r");
+    if (!f) {
+        ucc_error("failed to open tuning file %s", filename);
+        return UCC_ERR_NOT_FOUND;
+    }
+    while (getline(&line, &n, f) >= 0) {
+        lineno++;
+        str = ucc_tune_file_strip(line);
+        if (str[0] == '\0' || str[0] == '#') {
+            continue;
+        }
+        if (str[0] == '[') {
+            if (2 != sscanf(str, "[nnodes=%u ppn=%u]", &nnodes, &ppn) ||
+                nnodes == 0 || ppn == 0) {
+                status = UCC_ERR_INVALID_PARAM;
+                goto err;
+            }
+            e = ucc_tune_file_get_entry(tune, nnodes, ppn);
+            if (!e) {
+                status = UCC_ERR_NO_MEMORY;
+                goto out;
+            }
+            continue;
+        }
+        value = strchr(str, '=');
+        if (!e || !value) {
+            status = UCC_ERR_INVALID_PARAM;
+            goto err;
+        }
+        *value = '\0';
+        status = ucc_tune_file_add(e, ucc_tune_file_strip(str),
+                                   ucc_tune_file_strip(value + 1));
+        if (UCC_OK != status) {
+            ucc_error("failed to allocate tuning parameter");
+            goto out;
+        }
+    }
+    goto out;
+err:
+    ucc_error("invalid line %d in tuning file %s: %s", lineno, filename, str);
+out:
+    free(line);
+    fclose(f);
+    if (UCC_OK != status) {
+        ucc_tune_file_free(tune);
+    }
+    return status;
+}
+
+void ucc_tune_file_free(ucc_tune_file_t *tune)
+{
+    int i, j;
+
+    for (i = 0; i < tune->n_entries; i++) {
+        for (j = 0; j < tune->entries[i].n_params; j++) {
+            ucc_free(tune->entries[i].params[j].name);
+            ucc_free(tune->entries[i].params[j].value);
+        }
+        ucc_free(tune->entries[i].params);
+        ucc_free(tune->entries[i].score_str);
+    }
+    ucc_free(tune->entries);
+    tune->entries   = NULL;
+    tune->n_entries = 0;
+}
+
+const ucc_tune_file_entry_t *
+ucc_tune_file_lookup(const ucc_tune_file_t *tune, ucc_rank_t nnodes,
+                     ucc_rank_t ppn)
+{
+    const ucc_tune_file_entry_t *best = NULL;
+    int                          i;
+
+    for (i = 0; i < tune->n_entries; i++) {
+        if (tune->entries[i].ppn != ppn) {
+            continue;
+        }
+        if (!best || abs((int)tune->entries[i].nnodes - (int)nnodes) <
+                         abs((int)best->nnodes - (int)nnodes)) {
+            best = &tune->entries[i];
+        }
+    }
+    return best;
+}
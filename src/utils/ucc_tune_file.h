@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TUNE_FILE_H_
+#define UCC_TUNE_FILE_H_
+
+#include "ucc/api/ucc.h"
+
+typedef struct ucc_tune_file_param {
+    char *name;
+    char *value;
+} ucc_tune_file_param_t;
+
+typedef struct ucc_tune_file_entry {
+    ucc_rank_t             nnodes;
+    ucc_rank_t             ppn;
+    char                  *score_str; /*< TUNE string, NULL if not set */
+    ucc_tune_file_param_t *params;    /*< lib parameters of the component
+                                          that loads the file */
+    int                    n_params;
+} ucc_tune_file_entry_t;
+
+/* Tuning file produced by ucc_tune, loaded by TL/UCP. The file consists of
+   sections keyed by the team shape, each section holds a TUNE string and
+   lib parameters measured to be the best for that shape:
+
+   # comment
+   [nnodes=4 ppn=8]
+   TUNE=allreduce:0-8192:host:@knomial#allreduce:8192-inf:host:@sra_knomial
+   ALLREDUCE_SRA_KN_RADIX=4
+
+   Sections with the same key are merged, TUNE strings are concatenated. */
+typedef struct ucc_tune_file {
+    ucc_tune_file_entry_t *entries;
+    int                    n_entries;
+} ucc_tune_file_t;
+
+ucc_status_t ucc_tune_file_load(const char *filename, ucc_tune_file_t *tune);
+
+void ucc_tune_file_free(ucc_tune_file_t *tune);
+
+/* Returns the entry of the given shape. If there is no exact match, the
+   entry with the same ppn and the closest number of nodes is returned,
+   NULL if there is no entry with the same ppn. */
+const ucc_tune_file_entry_t *
+ucc_tune_file_lookup(const ucc_tune_file_t *tune, ucc_rank_t nnodes,
+                     ucc_rank_t ppn);
+
+#endif
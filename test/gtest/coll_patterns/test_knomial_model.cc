@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+extern "C" {
+#include <coll_patterns/knomial_model.h>
+}
+#include <common/test.h>
+#include <algorithm>
+
+class test_knomial_model : public ucc::test {
+  public:
+    ucc_kn_model_t model;
+    test_knomial_model()
+    {
+        model.latency  = 2e-6;
+        model.overhead = 1e-7;
+        model.bw       = 1e10;
+        model.nnodes   = 1;
+        model.ppn      = 1;
+    }
+};
+
+/* Step counts of full and non full trees, extra ranks exchange with their
+   proxy twice except in tree patterns */
+UCC_TEST_F(test_knomial_model, time)
+{
+    model.latency  = 1;
+    model.overhead = 0;
+
+    EXPECT_DOUBLE_EQ(3, ucc_kn_model_time(&model,
+                                          UCC_KN_PATTERN_EXCHANGE, 8,
+                                          2, 0));
+    EXPECT_DOUBLE_EQ(1, ucc_kn_model_time(&model,
+                                          UCC_KN_PATTERN_EXCHANGE, 8,
+                                          8, 0));
+    EXPECT_DOUBLE_EQ(4, ucc_kn_model_time(&model,
+                                          UCC_KN_PATTERN_EXCHANGE, 5,
+                                          2, 0));
+    EXPECT_DOUBLE_EQ(2, ucc_kn_model_time(&model,
+                                          UCC_KN_PATTERN_TREE, 5, 2,
+                                          0));
+    EXPECT_DOUBLE_EQ(8, ucc_kn_model_time(&model, UCC_KN_PATTERN_SRA,
+                                          5, 2, 0));
+
+    /* bandwidth term: radix - 1 messages of the full size every step */
+    model.latency = 0;
+    model.bw      = 1;
+    EXPECT_DOUBLE_EQ(3 * 3 * 100, ucc_kn_model_time(
+                                      &model, UCC_KN_PATTERN_EXCHANGE,
+                                      64, 4, 100));
+    /* scatter: the segment shrinks by radix every step */
+    EXPECT_DOUBLE_EQ(3 * 16 + 3 * 4 + 3 * 1,
+                     ucc_kn_model_time(&model, UCC_KN_PATTERN_SCATTER,
+                                       64, 4, 64));
+}
+
+/* Ranks of a node share the link only when the team spans several nodes */
+UCC_TEST_F(test_knomial_model, shape)
+{
+    double t_flat, t_shared;
+
+    model.latency  = 0;
+    model.overhead = 0;
+    model.bw       = 1;
+    model.nnodes   = 32;
+    model.ppn      = 1;
+    t_flat = ucc_kn_model_time(&model, UCC_KN_PATTERN_EXCHANGE, 32,
+                               2, 100);
+    model.nnodes = 4;
+    model.ppn    = 8;
+    t_shared     = ucc_kn_model_time(&model, UCC_KN_PATTERN_EXCHANGE,
+                                     32, 2, 100);
+    EXPECT_DOUBLE_EQ(8 * t_flat, t_shared);
+    model.nnodes = 1;
+    model.ppn    = 32;
+    EXPECT_DOUBLE_EQ(t_flat, ucc_kn_model_time(
+                                 &model, UCC_KN_PATTERN_EXCHANGE, 32, 2,
+                                 100));
+}
+
+UCC_TEST_F(test_knomial_model, radix)
+{
+    ucc_kn_radix_t radix;
+
+    EXPECT_EQ(1, ucc_kn_model_radix(
+                     &model, UCC_KN_PATTERN_EXCHANGE, 1, 8));
+    EXPECT_EQ(2, ucc_kn_model_radix(
+                     &model, UCC_KN_PATTERN_EXCHANGE, 2, 8));
+    /* latency bound: the smallest radix with the fewest steps */
+    EXPECT_EQ(8, ucc_kn_model_radix(
+                     &model, UCC_KN_PATTERN_EXCHANGE, 64, 8));
+    /* bandwidth bound: every extra peer resends the full message */
+    EXPECT_EQ(2, ucc_kn_model_radix(
+                     &model, UCC_KN_PATTERN_EXCHANGE, 64, 1 << 24));
+    for (ucc_rank_t size = 3; size < 300; size += 7) {
+        for (size_t msgsize = 1; msgsize <= (1 << 24); msgsize <<= 4) {
+            radix = ucc_kn_model_radix(
+                &model, UCC_KN_PATTERN_SRA, size, msgsize);
+            EXPECT_GE(radix, 2);
+            EXPECT_LE(radix, std::min(size, (ucc_rank_t)
+                                      UCC_KN_RADIX_AUTO_MAX));
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+extern "C" {
+#include <utils/ucc_math.h>
+#include <utils/ucc_malloc.h>
+#include <coll_patterns/sra_knomial.h>
+}
+#include <common/test.h>
+#include <vector>
+#include <algorithm>
+
+class test_knomial_table : public ucc::test {
+};
+
+/* Peers, step radices and SRA segments read from the table are the same
+   as the ones the pattern computes on the fly, for every rank that runs
+   the loop */
+UCC_TEST_F(test_knomial_table, peers)
+{
+    std::vector<ucc_rank_t> sizes = {2, 3, 5, 7, 8, 9, 16, 17, 31, 64, 100};
+    const size_t            count = 1000;
+    ucc_knomial_pattern_t   p, ref;
+    ucc_knomial_table_t    *tbl;
+    ucc_kn_radix_t          radix, k;
+    ucc_rank_t              rank;
+    ptrdiff_t               off, ref_off;
+    int                     len, ref_len;
+
+    for (auto size : sizes) {
+        for (radix = 2; radix <= std::min(size, (ucc_rank_t)32); radix++) {
+            for (rank = 0; rank < size; rank++) {
+                ucc_knomial_pattern_init(size, rank, radix, &p);
+                if (p.node_type == KN_NODE_EXTRA) {
+                    continue;
+                }
+                tbl = (ucc_knomial_table_t *)ucc_malloc(
+                    ucc_knomial_table_size(&p), "kn_table");
+                ASSERT_NE((void *)NULL, tbl);
+                ucc_sra_kn_table_init(tbl, size, rank, &p);
+
+                ucc_knomial_pattern_init(size, rank, radix, &p);
+                ucc_knomial_pattern_init(size, rank, radix, &ref);
+                ucc_knomial_pattern_set_table(&p, tbl);
+                while (!ucc_knomial_pattern_loop_done(&ref)) {
+                    EXPECT_EQ(ucc_sra_kn_compute_step_radix(rank, size, &ref),
+                              ucc_sra_kn_compute_step_radix(rank, size, &p));
+                    EXPECT_EQ(ucc_sra_kn_get_seg_index(&ref, rank, 0),
+                              ucc_sra_kn_get_seg_index(&p, rank, 0));
+                    EXPECT_EQ(ucc_sra_kn_compute_block_count(count, rank,
+                                                             &ref),
+                              ucc_sra_kn_compute_block_count(count, rank,
+                                                             &p));
+                    for (k = 1; k < radix; k++) {
+                        ucc_rank_t peer = ucc_knomial_pattern_get_loop_peer(
+                            &ref, rank, size, k);
+
+                        EXPECT_EQ(peer, ucc_knomial_pattern_get_loop_peer(
+                                            &p, rank, size, k))
+                            << "size " << size << " radix " << radix
+                            << " rank " << rank << " step " << k;
+                        if (peer != UCC_KN_PEER_NULL) {
+                            EXPECT_EQ(ucc_sra_kn_get_seg_index(&ref, peer, k),
+                                      ucc_sra_kn_get_seg_index(&p, peer, k));
+                        }
+                    }
+                    ucc_knomial_pattern_next_iteration(&ref);
+                    ucc_knomial_pattern_next_iteration(&p);
+                }
+                EXPECT_TRUE(ucc_knomial_pattern_loop_done(&p));
+
+                ucc_sra_kn_get_offset_and_seglen_tbl(count, 4, rank, size,
+                                                     radix, NULL, &ref_off,
+                                                     &ref_len);
+                ucc_sra_kn_get_offset_and_seglen_tbl(count, 4, rank, size,
+                                                     radix, tbl, &off, &len);
+                EXPECT_EQ(ref_off, off);
+                EXPECT_EQ(ref_len, len);
+                ucc_free(tbl);
+            }
+        }
+    }
+}
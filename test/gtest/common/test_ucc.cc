@@ -163,6 +163,10 @@ void UccTeam::init_team(bool use_team_ep_map)
     std::vector<allgather_coll_info_t *> cis;
     ucc_status_t                         status;
     for (int i = 0; i < n_procs; i++) {
+        std::vector<ucc_context_h> ctxs = {procs[i].p.get()->ctx_h};
+        if (lane_procs.size() > 0) {
+            ctxs.push_back(lane_procs[i]->ctx_h);
+        }
         cis.push_back(new allgather_coll_info);
         cis.back()->self     = this;
         cis.back()->my_rank  = i;
@@ -186,7 +190,7 @@ void UccTeam::init_team(bool use_team_ep_map)
             team_params.mask         |= UCC_TEAM_PARAM_FIELD_OOB;
         }
         EXPECT_EQ(UCC_OK,
-                  ucc_team_create_post(&(procs[i].p.get()->ctx_h), 1, &team_params,
+                  ucc_team_create_post(ctxs.data(), ctxs.size(), &team_params,
                                        &(procs[i].team)));
     }
 
@@ -195,6 +199,9 @@ void UccTeam::init_team(bool use_team_ep_map)
         all_done = 1;
         for (int i = 0; i < n_procs; i++) {
             ucc_context_progress(procs[i].p.get()->ctx_h);
+            if (lane_procs.size() > 0) {
+                ucc_context_progress(lane_procs[i]->ctx_h);
+            }
             status = ucc_team_create_test(procs[i].team);
             ASSERT_GE(status, 0);
             if (UCC_INPROGRESS == status) {
@@ -234,9 +241,14 @@ void UccTeam::progress()
     for (auto &p : procs) {
         ucc_context_progress(p.p->ctx_h);
     }
+    for (auto &p : lane_procs) {
+        ucc_context_progress(p->ctx_h);
+    }
 }
 
-UccTeam::UccTeam(std::vector<UccProcess_h> &_procs, bool use_team_ep_map)
+UccTeam::UccTeam(std::vector<UccProcess_h> &_procs, bool use_team_ep_map,
+                 std::vector<UccProcess_h> _lane_procs) :
+    lane_procs(_lane_procs)
 {
     n_procs = _procs.size();
     ag.resize(n_procs);
@@ -256,7 +268,8 @@ UccTeam::~UccTeam()
     destroy_team();
 }
 
-UccJob::UccJob(int _n_procs, ucc_job_ctx_mode_t _ctx_mode, ucc_job_env_t vars) :
+UccJob::UccJob(int _n_procs, ucc_job_ctx_mode_t _ctx_mode, ucc_job_env_t vars,
+               const ucc_lib_params_t &lib_params) :
     ta(_n_procs), n_procs(_n_procs), ctx_mode(_ctx_mode)
 
 {
@@ -280,7 +293,7 @@ UccJob::UccJob(int _n_procs, ucc_job_ctx_mode_t _ctx_mode, ucc_job_env_t vars) :
         setenv(v.first.c_str(), v.second.c_str(), 1);
     }
     for (int i = 0; i < n_procs; i++) {
-        procs.push_back(std::make_shared<UccProcess>(i));
+        procs.push_back(std::make_shared<UccProcess>(i, lib_params));
     }
 
     create_context();
@@ -478,6 +491,19 @@ UccTeam_h UccJob::create_team(std::vector<int> &ranks, bool use_team_ep_map)
     return std::make_shared<UccTeam>(team_procs, use_team_ep_map);
 }
 
+UccTeam_h UccJob::create_team(int _n_procs, UccJob &lanes)
+{
+    EXPECT_GE(n_procs, _n_procs);
+    EXPECT_GE(lanes.n_procs, _n_procs);
+    std::vector<UccProcess_h> team_procs;
+    std::vector<UccProcess_h> lane_procs;
+    for (int i=0; i<_n_procs; i++) {
+        team_procs.push_back(procs[i]);
+        lane_procs.push_back(lanes.procs[i]);
+    }
+    return std::make_shared<UccTeam>(team_procs, false, lane_procs);
+}
+
 
 UccReq::UccReq(UccTeam_h _team, ucc_coll_args_t *args) :
     team(_team)
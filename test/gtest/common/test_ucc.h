@@ -17,6 +17,7 @@ extern "C" {
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <algorithm>
 
 typedef struct {
     ucc_mc_buffer_header_t *dst_mc_header;
@@ -57,6 +58,19 @@ protected:
         }
         return err;
     }
+    /* first element of partition "p" of a partitioned collective, the
+       partition ends where the next one starts */
+    size_t partition_offset(size_t count, int n_parts, int p)
+    {
+        return p * (count / n_parts) + std::min((size_t)p, count % n_parts);
+    }
+    /* partitions marked ready in pairs swapped, 1 0 3 2 .., so that some
+       frags wait for their partition and some partitions are ready before
+       their frag is started */
+    int partition_order(int n_parts, int i)
+    {
+        return ((i ^ 1) < n_parts) ? (i ^ 1) : i;
+    }
 public:
     UccCollArgs() {
         // defaults
@@ -175,7 +189,11 @@ public:
     int n_procs;
     void progress();
     std::vector<proc> procs;
-    UccTeam(std::vector<UccProcess_h> &_procs, bool use_team_ep_map = false);
+    /* processes whose contexts are passed to the team create as additional
+       contexts, empty for the team over a single context */
+    std::vector<UccProcess_h> lane_procs;
+    UccTeam(std::vector<UccProcess_h> &_procs, bool use_team_ep_map = false,
+            std::vector<UccProcess_h> _lane_procs = {});
     ~UccTeam();
 };
 typedef std::shared_ptr<UccTeam> UccTeam_h;
@@ -200,11 +218,14 @@ public:
     static const std::vector<UccTeam_h> &getStaticTeams();
     int n_procs;
     UccJob(int _n_procs = 2, ucc_job_ctx_mode_t _ctx_mode = UCC_JOB_CTX_GLOBAL,
-           ucc_job_env_t vars = ucc_job_env_t());
+           ucc_job_env_t vars = ucc_job_env_t(),
+           const ucc_lib_params_t &lib_params = UccProcess::default_lib_params);
     ~UccJob();
     std::vector<UccProcess_h> procs;
     UccTeam_h create_team(int n_procs);
     UccTeam_h create_team(std::vector<int> &ranks, bool use_team_ep_map = false);
+    /* Team over the contexts of this job and of the "lanes" job */
+    UccTeam_h create_team(int n_procs, UccJob &lanes);
     void create_context();
     ucc_job_ctx_mode_t ctx_mode;
 };
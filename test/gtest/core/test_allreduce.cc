@@ -12,8 +12,13 @@
 #include "test_mc_reduce.h"
 #include "common/test_ucc.h"
 #include "utils/ucc_math.h"
+extern "C" {
+#include "core/ucc_team.h"
+}
 
 #include <array>
+#include <chrono>
+#include <thread>
 
 template<typename T>
 class test_allreduce : public UccCollArgs, public testing::Test {
@@ -285,3 +290,447 @@ TYPED_TEST(test_allreduce_alg, sra_knomial_pipelined) {
         }
     }
 }
+
+/* Team over two contexts next to a team over the second context only:
+   team ids must be unique on the shared context, otherwise the lane
+   traffic of the first team is matched by the second one */
+TYPED_TEST(test_allreduce_alg, multi_context) {
+    int           n_procs = 8;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_TUNE", "allreduce:@sra_knomial:inf"},
+                             {"UCC_TL_UCP_MULTI_CTX_STRIPE_THRESH", "1k"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccJob        lanes_job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     single = lanes_job.create_team(n_procs);
+    UccTeam_h     multi  = job.create_team(n_procs, lanes_job);
+    int           repeat = 3;
+    UccCollCtxVec ctxs_multi, ctxs_single;
+
+    for (auto i = 0; i < n_procs; i++) {
+        EXPECT_NE(multi->procs[i].team->id, single->procs[i].team->id);
+    }
+    this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+    for (auto count : {4, 65536}) {
+        this->data_init(n_procs, TypeParam::dt, count, ctxs_multi);
+        this->data_init(n_procs, TypeParam::dt, count, ctxs_single);
+        for (auto i = 0; i < repeat; i++) {
+            std::vector<UccReq> reqs;
+            reqs.push_back(UccReq(multi, ctxs_multi));
+            reqs.push_back(UccReq(single, ctxs_single));
+            UccReq::startall(reqs);
+            UccReq::waitall(reqs);
+            EXPECT_EQ(true, this->data_validate(ctxs_multi));
+            EXPECT_EQ(true, this->data_validate(ctxs_single));
+            this->reset(ctxs_multi);
+            this->reset(ctxs_single);
+        }
+        this->data_fini(ctxs_multi);
+        this->data_fini(ctxs_single);
+    }
+}
+
+/* lib params of the tests that use the contexts from several threads */
+static ucc_lib_params_t lib_params_mt()
+{
+    ucc_lib_params_t params = UccProcess::default_lib_params;
+
+    params.thread_mode = UCC_THREAD_MULTIPLE;
+    return params;
+}
+
+/* Every thread posts the collectives of its own team, collectives of the
+   teams are spread over the pool workers by tag */
+TYPED_TEST(test_allreduce_alg, worker_pool_threads) {
+    int           n_procs   = 4;
+    int           n_threads = 4;
+    int           repeat    = 8;
+    ucc_job_env_t env       = {{"UCC_PROGRESS_THREAD", "1"},
+                               {"UCC_TL_UCP_WORKER_POOL_SIZE", "3"},
+                               {"UCC_TL_UCP_WORKER_POOL_BIND", "coll"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env,
+                      lib_params_mt());
+    std::vector<UccTeam_h>     teams;
+    std::vector<UccCollCtxVec> ctxs(n_threads);
+    std::vector<std::thread>   threads;
+    std::vector<int>           valid(n_threads, 1);
+
+    this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+    for (auto t = 0; t < n_threads; t++) {
+        teams.push_back(job.create_team(n_procs));
+        this->data_init(n_procs, TypeParam::dt, 1024 * (t + 1), ctxs[t]);
+    }
+    for (auto t = 0; t < n_threads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            for (auto i = 0; i < repeat; i++) {
+                UccReq req(teams[t], ctxs[t]);
+                req.start();
+                req.wait();
+                if (!this->data_validate(ctxs[t])) {
+                    valid[t] = 0;
+                }
+                this->reset(ctxs[t]);
+            }
+        }));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    for (auto t = 0; t < n_threads; t++) {
+        EXPECT_EQ(1, valid[t]);
+        this->data_fini(ctxs[t]);
+    }
+}
+
+/* The application only tests the requests, the collective is completed
+   by the progress threads of the contexts */
+TYPED_TEST(test_allreduce_alg, progress_thread) {
+    int           n_procs = 4;
+    ucc_job_env_t env     = {{"UCC_PROGRESS_THREAD", "1"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env,
+                      lib_params_mt());
+    UccTeam_h     team    = job.create_team(n_procs);
+    auto          timeout = std::chrono::seconds(30);
+    UccCollCtxVec ctxs;
+    ucc_status_t  status;
+
+    for (auto &proc : job.procs) {
+        if (!((ucc_context_t *)proc->ctx_h)->progress_thread) {
+            /* memory components were initialized in thread single mode
+               by another lib of the test process */
+            UCC_TEST_SKIP_R("progress thread is disabled");
+        }
+    }
+    for (auto count : {8, 65536}) {
+        this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+        this->set_inplace(TEST_NO_INPLACE);
+        this->data_init(n_procs, TypeParam::dt, count, ctxs);
+        UccReq req(team, ctxs);
+        auto   start = std::chrono::steady_clock::now();
+
+        req.start();
+        while (UCC_INPROGRESS == (status = req.test()) &&
+               std::chrono::steady_clock::now() - start < timeout) {
+            std::this_thread::yield();
+        }
+        EXPECT_EQ(UCC_OK, status);
+        if (UCC_OK == status) {
+            EXPECT_EQ(true, this->data_validate(ctxs));
+        } else {
+            /* do not leave the request in flight on the freed buffers */
+            req.wait();
+        }
+        this->data_fini(ctxs);
+    }
+}
+
+/* Every rank is driven by its own thread through ucc_context_wait only.
+   Spinning is disabled, so each wait either blocks on the context fd that
+   the posted work must signal or falls back to polling for the work that
+   can not signal it. */
+TYPED_TEST(test_allreduce_alg, blocking_progress) {
+    int           n_procs   = 4;
+    ucc_job_env_t env       = {{"UCC_BLOCKING_PROGRESS", "1"},
+                               {"UCC_BLOCKING_SPIN_MIN", "0"},
+                               {"UCC_BLOCKING_SPIN_MAX", "0"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team      = job.create_team(n_procs);
+    const int     max_waits = 30000; /* 1ms each */
+    UccCollCtxVec ctxs;
+
+    for (auto count : {8, 65536}) {
+        std::vector<std::thread>  threads;
+        std::vector<ucc_status_t> status(n_procs, UCC_INPROGRESS);
+
+        this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+        this->set_inplace(TEST_NO_INPLACE);
+        this->data_init(n_procs, TypeParam::dt, count, ctxs);
+        UccReq req(team, ctxs);
+
+        req.start();
+        for (auto r = 0; r < n_procs; r++) {
+            threads.push_back(std::thread([&, r]() {
+                ucc_context_h ctx = team->procs[r].p->ctx_h;
+                ucc_status_t  st;
+
+                for (auto i = 0; i < max_waits; i++) {
+                    status[r] = ucc_collective_test(req.reqs[r]);
+                    if (UCC_INPROGRESS != status[r]) {
+                        break;
+                    }
+                    st = ucc_context_wait(ctx, 1);
+                    if (UCC_OK != st && UCC_INPROGRESS != st) {
+                        status[r] = st;
+                        break;
+                    }
+                }
+            }));
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+        for (auto r = 0; r < n_procs; r++) {
+            EXPECT_EQ(UCC_OK, status[r]);
+        }
+        req.wait();
+        EXPECT_EQ(true, this->data_validate(ctxs));
+        this->data_fini(ctxs);
+    }
+}
+
+/* Candidates are explored, agreed on and locked in within the repeats,
+   results must be correct in every phase */
+TYPED_TEST(test_allreduce_alg, adaptive) {
+    int           n_procs = 8;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_ADAPTIVE_SAMPLES", "2"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    int           repeat = 32;
+    UccCollCtxVec ctxs;
+
+    for (auto count : {8, 65536}) {
+        for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+            this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+            this->set_inplace(inplace);
+            this->data_init(n_procs, TypeParam::dt, count, ctxs);
+            for (auto i = 0; i < repeat; i++) {
+                UccReq req(team, ctxs);
+
+                req.start();
+                req.wait();
+                EXPECT_EQ(true, this->data_validate(ctxs));
+                this->reset(ctxs);
+            }
+            this->data_fini(ctxs);
+        }
+    }
+}
+
+/* Every rank produces its partitions after the start, right before marking
+   them ready and out of order. The pipeline is shallower than the number of
+   partitions, so frags are relaunched for the later partitions. */
+TYPED_TEST(test_allreduce_alg, partitioned) {
+    int           n_procs = 8;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_PARTITION_PIPELINE_DEPTH", "2"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    const size_t  count  = 4099;
+    const size_t  dt_sz  = ucc_dt_size(TypeParam::dt);
+    int           repeat = 2;
+    UccCollCtxVec ctxs;
+
+    for (auto n_parts : {1, 5, 16}) {
+        for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+            this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+            this->set_inplace(inplace);
+            this->data_init(n_procs, TypeParam::dt, count, ctxs);
+            for (auto r = 0; r < n_procs; r++) {
+                ctxs[r]->args->mask        |= UCC_COLL_ARGS_FIELD_PARTITIONS;
+                ctxs[r]->args->n_partitions = n_parts;
+            }
+            UccReq req(team, ctxs);
+            if (req.reqs.size() == 0) {
+                this->data_fini(ctxs);
+                UCC_TEST_SKIP_R("partitioned allreduce is not supported");
+            }
+            for (auto i = 0; i < repeat; i++) {
+                std::vector<uint8_t *> bufs(n_procs);
+
+                for (auto r = 0; r < n_procs; r++) {
+                    bufs[r] = (uint8_t *)(inplace == TEST_INPLACE ?
+                                          ctxs[r]->args->dst.info.buffer :
+                                          ctxs[r]->args->src.info.buffer);
+                    memset(bufs[r], 0, count * dt_sz);
+                }
+                req.start();
+                for (auto j = 0; j < n_parts; j++) {
+                    int    p    = this->partition_order(n_parts, j);
+                    size_t offs = this->partition_offset(count, n_parts, p);
+                    size_t len  =
+                        this->partition_offset(count, n_parts, p + 1) - offs;
+
+                    for (auto r = 0; r < n_procs; r++) {
+                        memcpy(bufs[r] + offs * dt_sz,
+                               (uint8_t *)ctxs[r]->init_buf + offs * dt_sz,
+                               len * dt_sz);
+                        EXPECT_EQ(UCC_OK,
+                                  ucc_collective_pready(req.reqs[r], p));
+                    }
+                    team->progress();
+                }
+                req.wait();
+                EXPECT_EQ(true, this->data_validate(ctxs));
+            }
+            this->data_fini(ctxs);
+        }
+    }
+}
+
+template<typename T>
+class test_allreduce_compress : public test_allreduce<T>
+{};
+
+using test_allreduce_compress_type =
+    ::testing::Types<ReductionTest<UCC_DT_FLOAT32, sum>>;
+TYPED_TEST_CASE(test_allreduce_compress, test_allreduce_compress_type);
+
+/* Inputs and partial sums are small integers that fp16 and bf16 represent
+   exactly, so the compressed allreduce must match the fp32 result */
+TYPED_TEST(test_allreduce_compress, sra_knomial) {
+    int n_procs = 8;
+    int repeat  = 3;
+
+    for (auto compress : {"fp16", "bf16"}) {
+        for (auto feedback : {"n", "y"}) {
+            ucc_job_env_t env = {
+                {"UCC_CL_BASIC_TUNE", "inf"},
+                {"UCC_TL_UCP_TUNE", "allreduce:@sra_knomial:inf"},
+                {"UCC_TL_UCP_ALLREDUCE_SRA_KN_COMPRESS", compress},
+                {"UCC_TL_UCP_ALLREDUCE_SRA_KN_ERROR_FEEDBACK", feedback}};
+            UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+            UccTeam_h     team = job.create_team(n_procs);
+            UccCollCtxVec ctxs;
+
+            for (auto count : {7, 65536, 123567}) {
+                for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                    this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+                    this->set_inplace(inplace);
+                    this->data_init(n_procs, TypeParam::dt, count, ctxs);
+                    UccReq req(team, ctxs);
+
+                    for (auto i = 0; i < repeat; i++) {
+                        req.start();
+                        req.wait();
+                        EXPECT_EQ(true, this->data_validate(ctxs));
+                        this->reset(ctxs);
+                    }
+                    this->data_fini(ctxs);
+                }
+            }
+        }
+    }
+}
+
+/* Values repeat across the ranks, so that on equal values the pair with
+   the smaller index must win */
+TYPED_TEST(test_allreduce_alg, maxloc_minloc) {
+    struct float_int {
+        float   v;
+        int32_t i;
+    };
+
+    ASSERT_EQ(sizeof(float_int), ucc_dt_size(UCC_DT_FLOAT32_INT32));
+    for (auto op : {UCC_OP_MAXLOC, UCC_OP_MINLOC}) {
+        for (int tid = 0; tid < UccJob::nStaticTeams; tid++) {
+            for (int count : {4, 256, 65536}) {
+                UccTeam_h     team = UccJob::getStaticTeams()[tid];
+                int           size = team->procs.size();
+                UccCollCtxVec ctxs(size);
+                std::vector<std::vector<float_int>> src(size), dst(size);
+
+                for (int r = 0; r < size; r++) {
+                    ucc_coll_args_t *coll = (ucc_coll_args_t *)
+                        calloc(1, sizeof(ucc_coll_args_t));
+
+                    src[r].resize(count);
+                    dst[r].resize(count);
+                    for (int i = 0; i < count; i++) {
+                        src[r][i] = {(float)((i + r) % 5), size - r};
+                    }
+                    ctxs[r] = (gtest_ucc_coll_ctx_t *)
+                        calloc(1, sizeof(gtest_ucc_coll_ctx_t));
+                    ctxs[r]->args              = coll;
+                    coll->mask                 =
+                        UCC_COLL_ARGS_FIELD_PREDEFINED_REDUCTIONS;
+                    coll->coll_type            = UCC_COLL_TYPE_ALLREDUCE;
+                    coll->reduce.predefined_op = op;
+                    coll->src.info.buffer      = src[r].data();
+                    coll->src.info.count       = count;
+                    coll->src.info.datatype    = UCC_DT_FLOAT32_INT32;
+                    coll->src.info.mem_type    = UCC_MEMORY_TYPE_HOST;
+                    coll->dst.info.buffer      = dst[r].data();
+                    coll->dst.info.count       = count;
+                    coll->dst.info.datatype    = UCC_DT_FLOAT32_INT32;
+                    coll->dst.info.mem_type    = UCC_MEMORY_TYPE_HOST;
+                }
+                UccReq req(team, ctxs);
+                req.start();
+                req.wait();
+                for (int i = 0; i < count; i++) {
+                    float_int exp = src[0][i];
+
+                    for (int r = 1; r < size; r++) {
+                        float_int v   = src[r][i];
+                        bool      sel = (op == UCC_OP_MAXLOC) ? v.v > exp.v
+                                                              : v.v < exp.v;
+                        if (sel || (v.v == exp.v && v.i < exp.i)) {
+                            exp = v;
+                        }
+                    }
+                    for (int r = 0; r < size; r++) {
+                        ASSERT_EQ(exp.v, dst[r][i].v);
+                        ASSERT_EQ(exp.i, dst[r][i].i);
+                    }
+                }
+                for (auto ctx : ctxs) {
+                    free(ctx->args);
+                    free(ctx);
+                }
+            }
+        }
+    }
+}
+
+/* int32 sum implemented as user defined reduction */
+static ucc_status_t user_sum_int32(const void *src1, const void *src2,
+                                   void *dst, size_t n_vectors, size_t count,
+                                   size_t stride, ucc_datatype_t dt,
+                                   void *cb_ctx)
+{
+    const int32_t *s1 = (const int32_t *)src1;
+    int32_t       *d  = (int32_t *)dst;
+    size_t        *max_count = (size_t *)cb_ctx;
+
+    if (dt != UCC_DT_INT32 || count > *max_count) {
+        return UCC_ERR_INVALID_PARAM;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int32_t res = s1[i];
+        for (size_t j = 0; j < n_vectors; j++) {
+            res += ((const int32_t *)PTR_OFFSET(src2, j * stride))[i];
+        }
+        d[i] = res;
+    }
+    return UCC_OK;
+}
+
+TYPED_TEST(test_allreduce_alg, userdefined_op) {
+    size_t                  max_count = 1000;
+    ucc_reduction_op_desc_t op        = {user_sum_int32, &max_count,
+                                         max_count};
+
+    for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+        for (int tid = 0; tid < UccJob::nStaticTeams; tid++) {
+            for (int count : {4, 256, 65536}) {
+                UccTeam_h     team = UccJob::getStaticTeams()[tid];
+                int           size = team->procs.size();
+                UccCollCtxVec ctxs;
+
+                this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+                this->set_inplace(inplace);
+                this->data_init(size, TypeParam::dt, count, ctxs);
+                for (auto ctx : ctxs) {
+                    ctx->args->mask = (ctx->args->mask &
+                                       ~UCC_COLL_ARGS_FIELD_PREDEFINED_REDUCTIONS) |
+                                      UCC_COLL_ARGS_FIELD_USERDEFINED_REDUCTIONS;
+                    ctx->args->reduce.custom_op = &op;
+                }
+                UccReq req(team, ctxs);
+                req.start();
+                req.wait();
+                EXPECT_EQ(true, this->data_validate(ctxs));
+                this->data_fini(ctxs);
+            }
+        }
+    }
+}
@@ -5,6 +5,9 @@
 
 #include "common/test_ucc.h"
 #include "utils/ucc_math.h"
+extern "C" {
+#include "core/ucc_context.h"
+}
 
 using Param_0 = std::tuple<int, int, ucc_memory_type_t, gtest_ucc_inplace_t, int>;
 using Param_1 = std::tuple<int, ucc_memory_type_t, gtest_ucc_inplace_t, int>;
@@ -246,3 +249,130 @@ INSTANTIATE_TEST_CASE_P(
 #endif
         ::testing::Values(/*TEST_INPLACE,*/ TEST_NO_INPLACE), // inplace
         ::testing::Values(1,3,8192))); // count
+
+/* Every element is the first 4 bytes of a 12 byte extent on the source
+   and the last 4 bytes of an 8 byte extent on the destination */
+static const ucc_dt_block_t       src_blocks[] = {{0, 4}};
+static const ucc_dt_block_t       dst_blocks[] = {{4, 4}};
+static const ucc_dt_userdefined_t src_layout   = {1, src_blocks, 12};
+static const ucc_dt_userdefined_t dst_layout   = {1, dst_blocks, 8};
+
+class test_alltoall_2 : public test_alltoall,
+        public ::testing::WithParamInterface<int> {};
+
+UCC_TEST_P(test_alltoall_2, userdefined)
+{
+    const int            count = GetParam();
+    const size_t         elem  = 4;
+    UccTeam_h            team  = UccJob::getStaticTeams()[1];
+    int                  size  = team->procs.size();
+    size_t               total = (size_t)count * size;
+    UccCollCtxVec        ctxs(size);
+    std::vector<uint8_t> contig(total * elem);
+
+    for (int i = 0; i < size; i++) {
+        ucc_coll_args_t *coll = (ucc_coll_args_t*)
+                calloc(1, sizeof(ucc_coll_args_t));
+        uint8_t         *src;
+
+        ctxs[i] = (gtest_ucc_coll_ctx_t*)calloc(1, sizeof(gtest_ucc_coll_ctx_t));
+        ctxs[i]->args = coll;
+        coll->mask          = UCC_COLL_ARGS_FIELD_USERDEFINED_DATATYPES;
+        coll->coll_type     = UCC_COLL_TYPE_ALLTOALL;
+        coll->dt.src        = &src_layout;
+        coll->dt.dst        = &dst_layout;
+        coll->src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        coll->src.info.count    = total;
+        coll->src.info.datatype = UCC_DT_USERDEFINED;
+        coll->dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        coll->dst.info.count    = total;
+        coll->dst.info.datatype = UCC_DT_USERDEFINED;
+        UCC_CHECK(ucc_mc_alloc(&ctxs[i]->src_mc_header,
+                               total * src_layout.extent,
+                               UCC_MEMORY_TYPE_HOST));
+        UCC_CHECK(ucc_mc_alloc(&ctxs[i]->dst_mc_header,
+                               total * dst_layout.extent,
+                               UCC_MEMORY_TYPE_HOST));
+        coll->src.info.buffer = ctxs[i]->src_mc_header->addr;
+        coll->dst.info.buffer = ctxs[i]->dst_mc_header->addr;
+        src = (uint8_t *)coll->src.info.buffer;
+        for (int r = 0; r < size; r++) {
+            alltoallx_init_buf(r, i, contig.data() + r * count * elem,
+                               count * elem);
+        }
+        for (size_t e = 0; e < total; e++) {
+            memcpy(src + e * src_layout.extent, contig.data() + e * elem,
+                   elem);
+        }
+    }
+    UccReq req(team, ctxs);
+    req.start();
+    req.wait();
+    for (int r = 0; r < size; r++) {
+        uint8_t *dst = (uint8_t *)ctxs[r]->args->dst.info.buffer;
+
+        for (size_t e = 0; e < total; e++) {
+            memcpy(contig.data() + e * elem,
+                   dst + e * dst_layout.extent + dst_blocks[0].offset, elem);
+        }
+        for (int i = 0; i < size; i++) {
+            EXPECT_EQ(0, alltoallx_validate_buf(i, r, contig.data() +
+                                                i * count * elem,
+                                                count * elem));
+        }
+    }
+    for (gtest_ucc_coll_ctx_t *ctx : ctxs) {
+        UCC_CHECK(ucc_mc_free(ctx->src_mc_header));
+        UCC_CHECK(ucc_mc_free(ctx->dst_mc_header));
+        free(ctx->args);
+        free(ctx);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    , test_alltoall_2,
+    ::testing::Values(1, 3, 100)); // count: iov and generic datatype
+
+class test_alltoall_node_agg : public test_alltoall,
+        public ::testing::WithParamInterface<int> {};
+
+/* All the ranks of a gtest job run on one host, the node layout is faked
+   through the context topology before the team is created: nodes of ppn
+   consecutive ranks, the last node may be smaller */
+UCC_TEST_P(test_alltoall_node_agg, fake_nodes)
+{
+    const int     n_procs = 8;
+    const int     ppn     = GetParam();
+    ucc_job_env_t env     = {{"UCC_TL_UCP_ALLTOALL_NODE_AGG_THRESH", "inf"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccCollCtxVec ctxs;
+
+    for (auto &p : job.procs) {
+        ucc_topo_t *topo = ((ucc_context_t *)p->ctx_h)->topo;
+
+        ASSERT_NE(nullptr, topo);
+        for (ucc_rank_t i = 0; i < topo->n_procs; i++) {
+            topo->procs[i].host_id = i / ppn;
+        }
+        topo->nnodes  = (topo->n_procs + ppn - 1) / ppn;
+        topo->max_ppn = ppn;
+        topo->min_ppn = topo->n_procs - (topo->nnodes - 1) * ppn;
+    }
+    UccTeam_h team = job.create_team(n_procs);
+
+    this->set_inplace(TEST_NO_INPLACE);
+    this->set_mem_type(UCC_MEMORY_TYPE_HOST);
+    for (int count : {1, 7}) {
+        data_init(n_procs, UCC_DT_INT32, count, ctxs);
+        UccReq req(team, ctxs);
+        req.start();
+        req.wait();
+        EXPECT_EQ(true, data_validate(ctxs));
+        data_fini(ctxs);
+        ctxs.clear();
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    , test_alltoall_node_agg,
+    ::testing::Values(2, 3, 4)); // ppn
@@ -15,8 +15,17 @@ class test_alltoallv : public UccCollArgs, public ucc::test
 public:
     uint64_t coll_mask;
     uint64_t coll_flags;
-
-    test_alltoallv() : coll_mask(0), coll_flags(0) {}
+    bool     sparse;
+
+    test_alltoallv() : coll_mask(0), coll_flags(0), sparse(false) {}
+    /* count of the block sent from src to dst; in sparse mode only a third
+       of the pairs exchange data and the blocks are uneven */
+    size_t block_count(int nprocs, int src, int dst, size_t count) {
+        if (sparse) {
+            return ((src + 2 * dst) % 3 == 0) ? (src % 2 + 1) * count : 0;
+        }
+        return (nprocs + src - dst) * count;
+    }
     void data_init(int nprocs, ucc_datatype_t dtype, size_t count,
                    UccCollCtxVec &ctxs) {
         int buf_count;
@@ -45,7 +54,7 @@ public:
 
             buf_count = 0;
             for (int i = 0; i < nprocs; i++) {
-                int rank_count = (nprocs + r - i) * count;
+                int rank_count = block_count(nprocs, r, i, count);
                 ((T*)coll->src.info_v.counts)[i] = rank_count;
                 ((T*)coll->src.info_v.displacements)[i] = buf_count;
                 buf_count += rank_count;
@@ -70,7 +79,7 @@ public:
 
             buf_count = 0;
             for (int i = 0; i < nprocs; i++) {
-                int rank_count = (nprocs - r + i) * count;
+                int rank_count = block_count(nprocs, i, r, count);
                 ((T*)coll->dst.info_v.counts)[i] = rank_count;
                 ((T*)coll->dst.info_v.displacements)[i] = buf_count;
                 buf_count += rank_count;
@@ -204,6 +213,33 @@ UCC_TEST_P(test_alltoallv_0, single_persistent)
     data_fini(ctxs);
 }
 
+UCC_TEST_P(test_alltoallv_0, sparse)
+{
+    const int            team_id  = std::get<0>(GetParam());
+    ucc_memory_type_t    mem_type = std::get<1>(GetParam());
+    gtest_ucc_inplace_t  inplace  = std::get<2>(GetParam());
+    const ucc_datatype_t dtype    = (ucc_datatype_t)std::get<3>(GetParam());
+    UccTeam_h            team     = UccJob::getStaticTeams()[team_id];
+    int                  size     = team->procs.size();
+    UccCollCtxVec        ctxs;
+
+    coll_mask  = UCC_COLL_ARGS_FIELD_FLAGS;
+    coll_flags =
+        UCC_COLL_ARGS_FLAG_COUNT_64BIT | UCC_COLL_ARGS_FLAG_DISPLACEMENTS_64BIT;
+    sparse     = true;
+    set_inplace(inplace);
+    set_mem_type(mem_type);
+
+    /* large blocks exceed the in-flight window of pairwise algorithm */
+    data_init(size, (ucc_datatype_t)dtype, 1 << 16, ctxs);
+    UccReq req(team, ctxs);
+    req.start();
+    req.wait();
+
+    EXPECT_EQ(true, data_validate(ctxs));
+    data_fini(ctxs);
+}
+
 class test_alltoallv_1 : public test_alltoallv <uint32_t>,
         public ::testing::WithParamInterface<Param_0> {};
 
@@ -344,3 +380,114 @@ INSTANTIATE_TEST_CASE_P(
 #endif
             ::testing::Values(/*TEST_INPLACE,*/ TEST_NO_INPLACE), // inplace
             ::testing::Range((int)UCC_DT_INT8, (int)UCC_DT_FLOAT64 + 1))); // dtype
+
+/* Every element is split in two 2 byte blocks of a 12 byte extent on the
+   source and is the last 4 bytes of an 8 byte extent on the destination */
+static const ucc_dt_block_t       ud_src_blocks[] = {{0, 2}, {6, 2}};
+static const ucc_dt_block_t       ud_dst_blocks[] = {{4, 4}};
+static const ucc_dt_userdefined_t ud_src_layout   = {2, ud_src_blocks, 12};
+static const ucc_dt_userdefined_t ud_dst_layout   = {1, ud_dst_blocks, 8};
+
+class test_alltoallv_4 : public test_alltoallv<uint64_t>,
+        public ::testing::WithParamInterface<int> {};
+
+UCC_TEST_P(test_alltoallv_4, userdefined)
+{
+    const int            count = GetParam();
+    const size_t         elem  = 4;
+    UccTeam_h            team  = UccJob::getStaticTeams()[1];
+    int                  size  = team->procs.size();
+    UccCollCtxVec        ctxs(size);
+    std::vector<uint8_t> contig;
+
+    for (int r = 0; r < size; r++) {
+        ucc_coll_args_t *coll = (ucc_coll_args_t*)
+                calloc(1, sizeof(ucc_coll_args_t));
+        uint64_t        *counts[2], *displs[2];
+        uint64_t         total[2] = {0, 0};
+        uint8_t         *src;
+
+        ctxs[r] = (gtest_ucc_coll_ctx_t*)calloc(1, sizeof(gtest_ucc_coll_ctx_t));
+        ctxs[r]->args = coll;
+        coll->mask      = UCC_COLL_ARGS_FIELD_FLAGS |
+                          UCC_COLL_ARGS_FIELD_USERDEFINED_DATATYPES;
+        coll->flags     = UCC_COLL_ARGS_FLAG_COUNT_64BIT |
+                          UCC_COLL_ARGS_FLAG_DISPLACEMENTS_64BIT;
+        coll->coll_type = UCC_COLL_TYPE_ALLTOALLV;
+        coll->dt.src    = &ud_src_layout;
+        coll->dt.dst    = &ud_dst_layout;
+        for (int k = 0; k < 2; k++) {
+            counts[k] = (uint64_t*)malloc(sizeof(uint64_t) * size);
+            displs[k] = (uint64_t*)malloc(sizeof(uint64_t) * size);
+            /* uneven blocks, displacements are in elements */
+            for (int i = 0; i < size; i++) {
+                counts[k][i] = k == 0 ? block_count(size, r, i, count)
+                                      : block_count(size, i, r, count);
+                displs[k][i] = total[k];
+                total[k]    += counts[k][i];
+            }
+        }
+        coll->src.info_v.mem_type      = UCC_MEMORY_TYPE_HOST;
+        coll->src.info_v.counts        = (ucc_count_t*)counts[0];
+        coll->src.info_v.displacements = (ucc_aint_t*)displs[0];
+        coll->src.info_v.datatype      = UCC_DT_USERDEFINED;
+        coll->dst.info_v.mem_type      = UCC_MEMORY_TYPE_HOST;
+        coll->dst.info_v.counts        = (ucc_count_t*)counts[1];
+        coll->dst.info_v.displacements = (ucc_aint_t*)displs[1];
+        coll->dst.info_v.datatype      = UCC_DT_USERDEFINED;
+        UCC_CHECK(ucc_mc_alloc(&ctxs[r]->src_mc_header,
+                               total[0] * ud_src_layout.extent,
+                               UCC_MEMORY_TYPE_HOST));
+        UCC_CHECK(ucc_mc_alloc(&ctxs[r]->dst_mc_header,
+                               total[1] * ud_dst_layout.extent,
+                               UCC_MEMORY_TYPE_HOST));
+        coll->src.info_v.buffer = ctxs[r]->src_mc_header->addr;
+        coll->dst.info_v.buffer = ctxs[r]->dst_mc_header->addr;
+        src = (uint8_t *)coll->src.info_v.buffer;
+        contig.resize(total[0] * elem);
+        for (int i = 0; i < size; i++) {
+            alltoallx_init_buf(r, i, contig.data() + displs[0][i] * elem,
+                               counts[0][i] * elem);
+        }
+        for (uint64_t e = 0; e < total[0]; e++) {
+            for (int b = 0; b < 2; b++) {
+                memcpy(src + e * ud_src_layout.extent + ud_src_blocks[b].offset,
+                       contig.data() + e * elem + b * 2, 2);
+            }
+        }
+    }
+    UccReq req(team, ctxs);
+    req.start();
+    req.wait();
+    for (int r = 0; r < size; r++) {
+        ucc_coll_args_t *coll   = ctxs[r]->args;
+        uint64_t        *counts = (uint64_t*)coll->dst.info_v.counts;
+        uint64_t        *displs = (uint64_t*)coll->dst.info_v.displacements;
+        uint8_t         *dst    = (uint8_t *)coll->dst.info_v.buffer;
+
+        for (int i = 0; i < size; i++) {
+            contig.resize(counts[i] * elem);
+            for (uint64_t e = 0; e < counts[i]; e++) {
+                memcpy(contig.data() + e * elem,
+                       dst + (displs[i] + e) * ud_dst_layout.extent +
+                       ud_dst_blocks[0].offset, elem);
+            }
+            EXPECT_EQ(0, alltoallx_validate_buf(i, r, contig.data(),
+                                                counts[i] * elem));
+        }
+    }
+    for (gtest_ucc_coll_ctx_t *ctx : ctxs) {
+        UCC_CHECK(ucc_mc_free(ctx->src_mc_header));
+        UCC_CHECK(ucc_mc_free(ctx->dst_mc_header));
+        free(ctx->args->src.info_v.counts);
+        free(ctx->args->src.info_v.displacements);
+        free(ctx->args->dst.info_v.counts);
+        free(ctx->args->dst.info_v.displacements);
+        free(ctx->args);
+        free(ctx);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    , test_alltoallv_4,
+    ::testing::Values(1, 3, 40)); // count: iov and generic datatype
@@ -8,6 +8,7 @@
 
 using Param_0 = std::tuple<int, int, ucc_memory_type_t, int, int>;
 using Param_1 = std::tuple<int, ucc_memory_type_t, int, int>;
+using Param_2 = std::tuple<int, int, int>;
 
 class test_bcast : public UccCollArgs, public ucc::test
 {
@@ -223,3 +224,64 @@ INSTANTIATE_TEST_CASE_P(
 #endif
         ::testing::Values(1,3,65536), // count
         ::testing::Values(0,1))); // root
+
+class test_bcast_2 : public test_bcast,
+        public ::testing::WithParamInterface<Param_2> {};
+
+UCC_TEST_P(test_bcast_2, partitioned)
+{
+    const int     team_id = std::get<0>(GetParam());
+    const int     n_parts = std::get<1>(GetParam());
+    const int     root    = std::get<2>(GetParam());
+    UccTeam_h     team    = UccJob::getStaticTeams()[team_id];
+    int           size    = team->procs.size();
+    const int     count   = 65536;
+    UccCollCtxVec ctxs;
+    uint8_t      *sbuf;
+
+    set_mem_type(UCC_MEMORY_TYPE_HOST);
+    set_root(root);
+
+    data_init(size, UCC_DT_INT8, count, ctxs);
+    for (auto r = 0; r < size; r++) {
+        ctxs[r]->args->mask        |= UCC_COLL_ARGS_FIELD_PARTITIONS;
+        ctxs[r]->args->n_partitions = n_parts;
+    }
+    UccReq req(team, ctxs);
+    if (req.reqs.size() == 0) {
+        data_fini(ctxs);
+        UCC_TEST_SKIP_R("partitioned bcast is not supported");
+    }
+    /* the root produces every partition after the start, right before
+       marking it ready */
+    sbuf = (uint8_t *)ctxs[root]->args->src.info.buffer;
+    memset(sbuf, 0, count);
+    req.start();
+    for (auto i = 0; i < n_parts; i++) {
+        int    p    = partition_order(n_parts, i);
+        size_t offs = partition_offset(count, n_parts, p);
+
+        memcpy(sbuf + offs, (uint8_t *)ctxs[root]->init_buf + offs,
+               partition_offset(count, n_parts, p + 1) - offs);
+        for (auto r = 0; r < size; r++) {
+            EXPECT_EQ(UCC_OK, ucc_collective_pready(req.reqs[r], p));
+        }
+        team->progress();
+    }
+    EXPECT_EQ(UCC_ERR_INVALID_PARAM,
+              ucc_collective_pready(req.reqs[root], n_parts));
+    req.wait();
+    EXPECT_EQ(true, data_validate(ctxs));
+    for (auto r = 0; r < size; r++) {
+        EXPECT_EQ(0, memcmp(ctxs[r]->args->src.info.buffer,
+                            ctxs[root]->init_buf, count));
+    }
+    data_fini(ctxs);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    , test_bcast_2,
+    ::testing::Combine(
+        ::testing::Range(1, UccJob::nStaticTeams), // team_ids
+        ::testing::Values(1,5,16), // n_partitions
+        ::testing::Values(0,1))); // root
@@ -0,0 +1,119 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#include "common/test_ucc.h"
+
+typedef std::vector<std::vector<int32_t>> bufs_t;
+
+class test_coll_group : public ucc::test {
+};
+
+/* Many small allreduces of two datatype/op pairs are fused, the large
+   allreduce and the one with a different op run unfused, the group is
+   posted twice to check that it can be reused */
+UCC_TEST_F(test_coll_group, small_allreduces)
+{
+    const int    n_small     = 37;
+    const size_t large_count = 64 * 1024;
+
+    for (auto &team : UccJob::getStaticTeams()) {
+        int                                       size    = team->procs.size();
+        int                                       n_colls = n_small + 2;
+        std::vector<std::vector<ucc_coll_args_t>> args(size);
+        std::vector<bufs_t>                       src(size), dst(size);
+        std::vector<ucc_coll_req_h>               reqs(size);
+        std::vector<size_t>                       counts(n_colls);
+        std::vector<ucc_reduction_op_t>           ops(n_colls);
+        int                                       n_done;
+
+        for (int i = 0; i < n_colls; i++) {
+            counts[i] = 1 + (i * 13) % 100;
+            ops[i]    = (i % 3) ? UCC_OP_SUM : UCC_OP_MAX;
+        }
+        counts[n_small]  = large_count;
+        ops[n_small + 1] = UCC_OP_MIN;
+
+        for (int r = 0; r < size; r++) {
+            args[r].resize(n_colls);
+            src[r].resize(n_colls);
+            dst[r].resize(n_colls);
+            for (int i = 0; i < n_colls; i++) {
+                ucc_coll_args_t &a = args[r][i];
+
+                src[r][i].resize(counts[i]);
+                dst[r][i].resize(counts[i]);
+                memset(&a, 0, sizeof(a));
+                a.coll_type            = UCC_COLL_TYPE_ALLREDUCE;
+                a.reduce.predefined_op = ops[i];
+                a.src.info.buffer      = src[r][i].data();
+                a.src.info.count       = counts[i];
+                a.src.info.datatype    = UCC_DT_INT32;
+                a.src.info.mem_type    = UCC_MEMORY_TYPE_HOST;
+                a.dst.info.buffer      = dst[r][i].data();
+                a.dst.info.count       = counts[i];
+                a.dst.info.datatype    = UCC_DT_INT32;
+                a.dst.info.mem_type    = UCC_MEMORY_TYPE_HOST;
+                if (i % 5 == 1) {
+                    a.mask  = UCC_COLL_ARGS_FIELD_FLAGS;
+                    a.flags = UCC_COLL_ARGS_FLAG_IN_PLACE;
+                }
+            }
+            ASSERT_EQ(UCC_OK,
+                      ucc_collective_init_group(args[r].data(), n_colls,
+                                                &reqs[r],
+                                                team->procs[r].team));
+        }
+
+        for (int iter = 0; iter < 2; iter++) {
+            for (int r = 0; r < size; r++) {
+                for (int i = 0; i < n_colls; i++) {
+                    for (size_t k = 0; k < counts[i]; k++) {
+                        int32_t v = r * (iter + 1) + i + k;
+
+                        src[r][i][k] = v;
+                        dst[r][i][k] = (i % 5 == 1) ? v : -1;
+                    }
+                }
+            }
+            for (int r = 0; r < size; r++) {
+                ASSERT_EQ(UCC_OK, ucc_collective_post(reqs[r]));
+            }
+            do {
+                team->progress();
+                n_done = 0;
+                for (int r = 0; r < size; r++) {
+                    ucc_status_t st = ucc_collective_test(reqs[r]);
+
+                    ASSERT_GE(st, 0);
+                    n_done += (st == UCC_OK);
+                }
+            } while (n_done < size);
+
+            for (int r = 0; r < size; r++) {
+                for (int i = 0; i < n_colls; i++) {
+                    for (size_t k = 0; k < counts[i]; k++) {
+                        int32_t base = i + k, expected;
+
+                        switch (ops[i]) {
+                        case UCC_OP_MAX:
+                            expected = base + (size - 1) * (iter + 1);
+                            break;
+                        case UCC_OP_MIN:
+                            expected = base;
+                            break;
+                        default:
+                            expected = base * size +
+                                       (iter + 1) * size * (size - 1) / 2;
+                        }
+                        EXPECT_EQ(expected, dst[r][i][k]);
+                    }
+                }
+            }
+        }
+        for (int r = 0; r < size; r++) {
+            EXPECT_EQ(UCC_OK, ucc_collective_finalize(reqs[r]));
+        }
+    }
+}
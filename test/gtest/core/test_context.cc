@@ -4,6 +4,9 @@
  */
 #include "test_context.h"
 #include "../common/test_ucc.h"
+extern "C" {
+#include "core/ucc_context.h"
+}
 #include <vector>
 #include <algorithm>
 #include <random>
@@ -90,3 +93,54 @@ UCC_TEST_F(test_context, global)
     job16.cleanup();
 
 }
+
+UCC_TEST_F(test_context, get_fd_not_enabled)
+{
+    ucc_context_params_t ctx_params;
+    ucc_context_h        ctx_h;
+    int                  fd;
+    ctx_params.mask = UCC_CONTEXT_PARAM_FIELD_TYPE;
+    ctx_params.type = UCC_CONTEXT_EXCLUSIVE;
+    EXPECT_EQ(UCC_OK, ucc_context_create(lib_h, &ctx_params, ctx_config, &ctx_h));
+    EXPECT_EQ(UCC_ERR_NOT_SUPPORTED, ucc_context_get_fd(ctx_h, &fd));
+    EXPECT_EQ(UCC_ERR_NOT_SUPPORTED, ucc_context_arm(ctx_h));
+    EXPECT_EQ(UCC_OK, ucc_context_destroy(ctx_h));
+}
+
+UCC_TEST_F(test_context, blocking_progress)
+{
+    ucc_context_params_t ctx_params;
+    ucc_context_h        ctx_h;
+    ucc_status_t         status;
+    int                  fd;
+    ctx_params.mask = UCC_CONTEXT_PARAM_FIELD_TYPE;
+    ctx_params.type = UCC_CONTEXT_EXCLUSIVE;
+    EXPECT_EQ(UCC_OK, ucc_context_config_modify(ctx_config, NULL,
+                                                "BLOCKING_PROGRESS", "1"));
+    EXPECT_EQ(UCC_OK, ucc_context_create(lib_h, &ctx_params, ctx_config, &ctx_h));
+    EXPECT_EQ(UCC_OK, ucc_context_get_fd(ctx_h, &fd));
+    EXPECT_LE(0, fd);
+    do {
+        EXPECT_EQ(UCC_OK, ucc_context_progress(ctx_h));
+        status = ucc_context_arm(ctx_h);
+    } while (UCC_INPROGRESS == status);
+    EXPECT_EQ(UCC_OK, status);
+    /* nothing is posted on the context - wait must time out */
+    EXPECT_EQ(UCC_INPROGRESS, ucc_context_wait(ctx_h, 10));
+    EXPECT_EQ(UCC_OK, ucc_context_destroy(ctx_h));
+}
+
+/* the progress thread shares the memory components with the application
+   threads, it is refused for a lib in thread single mode */
+UCC_TEST_F(test_context, progress_thread_single_lib)
+{
+    ucc_context_params_t ctx_params;
+    ucc_context_h        ctx_h;
+    ctx_params.mask = UCC_CONTEXT_PARAM_FIELD_TYPE;
+    ctx_params.type = UCC_CONTEXT_EXCLUSIVE;
+    EXPECT_EQ(UCC_OK, ucc_context_config_modify(ctx_config, NULL,
+                                                "PROGRESS_THREAD", "1"));
+    EXPECT_EQ(UCC_OK, ucc_context_create(lib_h, &ctx_params, ctx_config, &ctx_h));
+    EXPECT_EQ(nullptr, ((ucc_context_t *)ctx_h)->progress_thread);
+    EXPECT_EQ(UCC_OK, ucc_context_destroy(ctx_h));
+}
@@ -0,0 +1,109 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#include "common/test_ucc.h"
+
+class test_ee : public ucc::test {
+};
+
+/* Allreduce is triggered by the compute completion event set on a host
+   execution engine, completion is published back as an ee event */
+UCC_TEST_F(test_ee, cpu_thread_triggered_allreduce)
+{
+    const size_t    count     = 1024;
+    ucc_ee_params_t ee_params = {
+        .ee_type         = UCC_EE_CPU_THREAD,
+        .ee_context      = NULL,
+        .ee_context_size = 0,
+    };
+
+    for (auto &team : UccJob::getStaticTeams()) {
+        int                                 size = team->procs.size();
+        std::vector<std::vector<int32_t>>   src(size), dst(size);
+        std::vector<ucc_coll_args_t>        args(size);
+        std::vector<gtest_ucc_coll_ctx_t>   ctx(size);
+        std::vector<ucc_ee_h>               ees(size);
+        std::vector<int>                    n_events(size, 0);
+        UccCollCtxVec                       ctxs(size);
+        ucc_ev_t                            ev, *out_ev;
+        int                                 n_done;
+
+        for (int r = 0; r < size; r++) {
+            src[r].resize(count, 0);
+            dst[r].resize(count, 0);
+            memset(&args[r], 0, sizeof(args[r]));
+            args[r].coll_type             = UCC_COLL_TYPE_ALLREDUCE;
+            args[r].reduce.predefined_op  = UCC_OP_SUM;
+            args[r].src.info.buffer       = src[r].data();
+            args[r].src.info.count        = count;
+            args[r].src.info.datatype     = UCC_DT_INT32;
+            args[r].src.info.mem_type     = UCC_MEMORY_TYPE_HOST;
+            args[r].dst.info.buffer       = dst[r].data();
+            args[r].dst.info.count        = count;
+            args[r].dst.info.datatype     = UCC_DT_INT32;
+            args[r].dst.info.mem_type     = UCC_MEMORY_TYPE_HOST;
+            ctx[r].args                   = &args[r];
+            ctxs[r]                       = &ctx[r];
+        }
+        UccReq req(team, ctxs);
+        ASSERT_EQ(size, req.reqs.size());
+
+        for (int r = 0; r < size; r++) {
+            ASSERT_EQ(UCC_OK, ucc_ee_create(team->procs[r].team, &ee_params,
+                                            &ees[r]));
+            memset(&ev, 0, sizeof(ev));
+            ev.ev_type = UCC_EVENT_COMPUTE_COMPLETE;
+            ev.req     = req.reqs[r];
+            ASSERT_EQ(UCC_OK, ucc_collective_triggered_post(ees[r], &ev));
+        }
+
+        /* nothing is launched until compute is complete */
+        for (int i = 0; i < 16; i++) {
+            team->progress();
+        }
+        for (int r = 0; r < size; r++) {
+            EXPECT_NE(UCC_OK, ucc_collective_test(req.reqs[r]));
+            EXPECT_EQ(UCC_ERR_NOT_FOUND, ucc_ee_get_event(ees[r], &out_ev));
+        }
+
+        for (int r = 0; r < size; r++) {
+            for (size_t i = 0; i < count; i++) {
+                src[r][i] = r + i;
+            }
+            memset(&ev, 0, sizeof(ev));
+            ev.ev_type = UCC_EVENT_COMPUTE_COMPLETE;
+            ASSERT_EQ(UCC_OK, ucc_ee_set_event(ees[r], &ev));
+        }
+
+        /* collective post and collective complete events, in order */
+        n_done = 0;
+        while (n_done < size) {
+            team->progress();
+            for (int r = 0; r < size; r++) {
+                if (UCC_OK != ucc_ee_get_event(ees[r], &out_ev)) {
+                    continue;
+                }
+                EXPECT_EQ(req.reqs[r], out_ev->req);
+                if (n_events[r] == 0) {
+                    EXPECT_EQ(UCC_EVENT_COLLECTIVE_POST, out_ev->ev_type);
+                } else {
+                    EXPECT_EQ(UCC_EVENT_COLLECTIVE_COMPLETE, out_ev->ev_type);
+                    EXPECT_EQ(UCC_OK, ucc_collective_test(req.reqs[r]));
+                    n_done++;
+                }
+                n_events[r]++;
+                EXPECT_EQ(UCC_OK, ucc_ee_ack_event(ees[r], out_ev));
+            }
+        }
+
+        for (int r = 0; r < size; r++) {
+            for (size_t i = 0; i < count; i++) {
+                EXPECT_EQ((int32_t)(i * size + size * (size - 1) / 2),
+                          dst[r][i]);
+            }
+            EXPECT_EQ(UCC_OK, ucc_ee_destroy(ees[r]));
+        }
+    }
+}
@@ -9,6 +9,9 @@ extern "C" {
 }
 #include <common/test.h>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 void *mt_ucc_mc_cpu_allocs(void *args)
 {
@@ -82,6 +85,165 @@ UCC_TEST_F(test_mc, can_alloc_and_free_host_mem)
     ucc_mc_finalize();
 }
 
+UCC_TEST_F(test_mc, host_mem_pool_reuse)
+{
+    // buffers of the same size class are reused by the mpool
+    std::vector<size_t>     sizes = {1, 4096, 5000, 1 << 20};
+    ucc_mc_buffer_header_t *h;
+    void                   *ptr;
+    ucc_mc_attr_t           attr;
+    uint64_t                hits;
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_SINGLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    attr.field_mask = UCC_MC_ATTR_FIELD_MPOOL_STATS;
+    for (auto size : sizes) {
+        ASSERT_EQ(UCC_OK, ucc_mc_alloc(&h, size, UCC_MEMORY_TYPE_HOST));
+        ptr = h->addr;
+        memset(ptr, 0, size);
+        EXPECT_EQ(UCC_OK, ucc_mc_free(h));
+        ASSERT_EQ(UCC_OK, ucc_mc_get_attr(UCC_MEMORY_TYPE_HOST, &attr));
+        hits = attr.mpool_hits;
+        ASSERT_EQ(UCC_OK, ucc_mc_alloc(&h, size, UCC_MEMORY_TYPE_HOST));
+        EXPECT_EQ(ptr, h->addr);
+        EXPECT_EQ(UCC_OK, ucc_mc_free(h));
+        ASSERT_EQ(UCC_OK, ucc_mc_get_attr(UCC_MEMORY_TYPE_HOST, &attr));
+        EXPECT_EQ(hits + 1, attr.mpool_hits);
+    }
+    ucc_mc_finalize();
+}
+
+UCC_TEST_F(test_mc, host_memcpy)
+{
+    // copies above MC_CPU_MEMCPY_NT_THRESH (4MB by default) use streaming
+    // stores, unaligned offsets check the head/tail handling
+    std::vector<size_t> sizes   = {1, 4095, 1 << 20, (8 << 20) + 3};
+    std::vector<size_t> offsets = {0, 1, 17};
+    std::vector<char>   src, dst;
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_SINGLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    for (auto size : sizes) {
+        src.resize(size + offsets.back());
+        dst.resize(size + offsets.back());
+        for (size_t i = 0; i < src.size(); i++) {
+            src[i] = (char)(i * 7 + 1);
+        }
+        for (auto offset : offsets) {
+            std::fill(dst.begin(), dst.end(), 0);
+            EXPECT_EQ(UCC_OK, ucc_mc_memcpy(dst.data() + offset, src.data(),
+                                            size, UCC_MEMORY_TYPE_HOST,
+                                            UCC_MEMORY_TYPE_HOST));
+            EXPECT_EQ(0, memcmp(dst.data() + offset, src.data(), size));
+        }
+    }
+    ucc_mc_finalize();
+}
+
+UCC_TEST_F(test_mc, host_memcpy_mt)
+{
+    // copies above MC_CPU_MEMCPY_MT_THRESH are split between the helper
+    // threads started at mc init, concurrent copies fall back to the
+    // calling thread while the helpers are busy
+    const size_t             size      = (4 << 20) + 3;
+    const int                n_threads = 4;
+    std::vector<std::thread> threads;
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    setenv("UCC_MC_CPU_MEMCPY_MT_THREADS", "4", 1);
+    setenv("UCC_MC_CPU_MEMCPY_MT_THRESH", "1Mb", 1);
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_MULTIPLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    unsetenv("UCC_MC_CPU_MEMCPY_MT_THREADS");
+    unsetenv("UCC_MC_CPU_MEMCPY_MT_THRESH");
+    for (int t = 0; t < n_threads; t++) {
+        threads.push_back(std::thread([t, size]() {
+            std::vector<char> src(size), dst(size + 1);
+
+            for (size_t i = 0; i < size; i++) {
+                src[i] = (char)(i * 7 + t);
+            }
+            for (int it = 0; it < 8; it++) {
+                std::fill(dst.begin(), dst.end(), 0);
+                EXPECT_EQ(UCC_OK, ucc_mc_memcpy(dst.data() + it % 2,
+                                                src.data(), size,
+                                                UCC_MEMORY_TYPE_HOST,
+                                                UCC_MEMORY_TYPE_HOST));
+                EXPECT_EQ(0, memcmp(dst.data() + it % 2, src.data(), size));
+            }
+        }));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    ucc_mc_finalize();
+}
+
+UCC_TEST_F(test_mc, host_compress)
+{
+    // odd count checks the scalar tail of vectorized conversions
+    const size_t                count     = 1027;
+    const size_t                n_vectors = 3;
+    const int                   n_iters   = 64;
+    std::vector<ucc_datatype_t> dts       = {UCC_DT_FLOAT16, UCC_DT_BFLOAT16};
+    std::vector<float>          src(count), dst(count), err(count), sum(count);
+    std::vector<uint16_t>       wire(count * n_vectors);
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_SINGLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    for (size_t i = 0; i < count; i++) {
+        src[i] = (float)i / 7 - 50;
+    }
+    for (auto dt : dts) {
+        // relative precision of 10 and 7 bit mantissa
+        float eps = (dt == UCC_DT_FLOAT16) ? 1.0f / 1024 : 1.0f / 128;
+
+        for (size_t j = 0; j < n_vectors; j++) {
+            EXPECT_EQ(UCC_OK, ucc_mc_compress(&wire[j * count], src.data(),
+                                              NULL, count, dt,
+                                              UCC_MEMORY_TYPE_HOST));
+        }
+        std::fill(dst.begin(), dst.end(), 1.0f);
+        EXPECT_EQ(UCC_OK, ucc_mc_reduce_multi_decompress(
+                              dst.data(), wire.data(), dst.data(), n_vectors,
+                              count, count * sizeof(uint16_t), dt,
+                              UCC_MEMORY_TYPE_HOST));
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_NEAR(1 + n_vectors * src[i], dst[i],
+                        n_vectors * std::abs(src[i]) * eps);
+        }
+
+        // with error feedback the sum of decompressed values converges to
+        // the sum of the inputs
+        std::fill(err.begin(), err.end(), 0.0f);
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (int it = 0; it < n_iters; it++) {
+            EXPECT_EQ(UCC_OK, ucc_mc_compress(wire.data(), src.data(),
+                                              err.data(), count, dt,
+                                              UCC_MEMORY_TYPE_HOST));
+            EXPECT_EQ(UCC_OK, ucc_mc_reduce_multi_decompress(
+                                  sum.data(), wire.data(), sum.data(), 1,
+                                  count, 0, dt, UCC_MEMORY_TYPE_HOST));
+        }
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_NEAR(n_iters * src[i], sum[i] + err[i],
+                        n_iters * std::abs(src[i]) * 1e-5);
+        }
+    }
+    ucc_mc_finalize();
+}
+
 // Disabled because can't reinit mc with different thread mode
 UCC_TEST_F(test_mc, DISABLED_can_alloc_and_free_host_mem_mt)
 {
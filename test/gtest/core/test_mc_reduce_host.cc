@@ -4,6 +4,7 @@
  */
 
 #include "test_mc_reduce.h"
+#include <vector>
 
 TYPED_TEST(test_mc_reduce, ucc_reduce_single_host) {
     this->alloc_bufs(UCC_MEMORY_TYPE_HOST, 1);
@@ -31,3 +32,61 @@ TYPED_TEST(test_mc_reduce, ucc_reduce_multi_host) {
         TypeParam::assert_equal(res, this->res_h[i]);
     }
 }
+
+class test_mc_reduce_loc : public ucc::test {
+  protected:
+    struct float_int {
+        float   v;
+        int32_t i;
+    };
+};
+
+UCC_TEST_F(test_mc_reduce_loc, maxloc_minloc_host)
+{
+    const int              count   = 1023;
+    const int              num_vec = 3;
+    std::vector<float_int> src1(count), src2(count * num_vec), dst(count);
+    float_int              exp_max, exp_min;
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_SINGLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    ASSERT_EQ(sizeof(float_int), ucc_dt_size(UCC_DT_FLOAT32_INT32));
+    for (int i = 0; i < count; i++) {
+        src1[i] = {(float)(i % 5), 0};
+        for (int j = 0; j < num_vec; j++) {
+            /* values repeat across vectors to check index tie break */
+            src2[i + j * count] = {(float)((i + j) % 5), j + 1};
+        }
+    }
+    for (auto op : {UCC_OP_MAXLOC, UCC_OP_MINLOC}) {
+        EXPECT_EQ(UCC_OK, ucc_mc_reduce_multi(src1.data(), src2.data(),
+                                              dst.data(), num_vec, count,
+                                              count * sizeof(float_int),
+                                              UCC_DT_FLOAT32_INT32, op,
+                                              UCC_MEMORY_TYPE_HOST));
+        for (int i = 0; i < count; i++) {
+            exp_max = exp_min = src1[i];
+            for (int j = 0; j < num_vec; j++) {
+                float_int v = src2[i + j * count];
+                if (v.v > exp_max.v || (v.v == exp_max.v && v.i < exp_max.i)) {
+                    exp_max = v;
+                }
+                if (v.v < exp_min.v || (v.v == exp_min.v && v.i < exp_min.i)) {
+                    exp_min = v;
+                }
+            }
+            float_int exp = (op == UCC_OP_MAXLOC) ? exp_max : exp_min;
+            EXPECT_EQ(exp.v, dst[i].v);
+            EXPECT_EQ(exp.i, dst[i].i);
+        }
+    }
+    /* value-index pairs support only MAXLOC/MINLOC */
+    EXPECT_EQ(UCC_ERR_NOT_SUPPORTED,
+              ucc_mc_reduce(src1.data(), src2.data(), dst.data(), count,
+                            UCC_DT_FLOAT32_INT32, UCC_OP_SUM,
+                            UCC_MEMORY_TYPE_HOST));
+    ucc_mc_finalize();
+}
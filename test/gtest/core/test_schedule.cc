@@ -6,6 +6,7 @@
 #include <common/test.h>
 extern "C" {
 #include "schedule/ucc_schedule.h"
+#include "schedule/ucc_schedule_pipelined.h"
 }
 typedef std::tuple<ucc_coll_task_t*, int> rst_t;
 class test_schedule : public ucc_coll_task_t, public ucc::test
@@ -77,3 +78,84 @@ UCC_TEST_F(test_schedule, different_handlers)
     EXPECT_EQ(true, (std::get<0>(rst[1]) == &tasks[1]) &&
               (std::get<1>(rst[1]) == 2));
 }
+
+/* Number of listeners is not limited by the inline storage of event
+   manager, all of them are notified in the subscription order */
+UCC_TEST_F(test_schedule, many_listeners)
+{
+    const int       n_listeners = 64;
+    ucc_coll_task_t task;
+
+    EXPECT_EQ(UCC_OK, ucc_coll_task_init((ucc_coll_task_t *)this, NULL, NULL));
+    EXPECT_EQ(UCC_OK, ucc_coll_task_init(&task, NULL, NULL));
+    for (int i = 0; i < n_listeners; i++) {
+        EXPECT_EQ(UCC_OK, ucc_event_manager_subscribe(
+                              &task.em, UCC_EVENT_COMPLETED,
+                              (ucc_coll_task_t *)this,
+                              (i % 2) ? test_schedule::handler_2
+                                      : test_schedule::handler_1));
+    }
+    EXPECT_EQ(UCC_OK, ucc_event_manager_notify(&task, UCC_EVENT_COMPLETED));
+    EXPECT_EQ(n_listeners, rst.size());
+    for (int i = 0; i < n_listeners; i++) {
+        EXPECT_EQ(true, (std::get<0>(rst[i]) == &task) &&
+                  (std::get<1>(rst[i]) == 1 + (i % 2)));
+    }
+    ucc_event_manager_cleanup(&task.em);
+    EXPECT_EQ(0, task.em.n_listeners);
+}
+
+UCC_TEST_F(test_schedule, pipelined_select)
+{
+    ucc_pipeline_model_t model = {.frag_latency = 5e-6, .bw = 1e10};
+    int                  n_frags, depth, prev_n_frags = 1;
+
+    /* single stage: nothing to overlap */
+    ucc_schedule_pipelined_select(&model, 1 << 30, 1, 1 << 28, &n_frags,
+                                  &depth);
+    EXPECT_EQ(1, n_frags);
+    EXPECT_EQ(1, depth);
+
+    /* small message is latency bound */
+    ucc_schedule_pipelined_select(&model, 1024, 8, 256, &n_frags, &depth);
+    EXPECT_EQ(1, n_frags);
+
+    for (size_t msgsize = 1 << 20; msgsize <= (1ul << 32); msgsize *= 4) {
+        ucc_schedule_pipelined_select(&model, msgsize, 8, msgsize / 4,
+                                      &n_frags, &depth);
+        EXPECT_LT(1, n_frags);
+        EXPECT_LE(prev_n_frags, n_frags);
+        EXPECT_LE(depth, n_frags);
+        EXPECT_LE(depth, 8);
+        EXPECT_LE(depth, UCC_SCHEDULE_PIPELINED_MAX_FRAGS);
+        prev_n_frags = n_frags;
+    }
+
+    /* number of fragments is limited by the caller */
+    ucc_schedule_pipelined_select(&model, 1ul << 32, 8, 3, &n_frags, &depth);
+    EXPECT_EQ(3, n_frags);
+    EXPECT_EQ(3, depth);
+}
+
+UCC_TEST_F(test_schedule, pipeline_stats)
+{
+    ucc_pipeline_stats_t stats;
+    ucc_pipeline_model_t model;
+    size_t               size;
+
+    ucc_pipeline_stats_init(&stats);
+    EXPECT_EQ(UCC_ERR_NOT_FOUND, ucc_pipeline_stats_estimate(&stats, &model));
+    /* a single fragment size doesn't allow to separate latency and bw */
+    for (int i = 0; i < 16; i++) {
+        ucc_pipeline_stats_update(&stats, 4096, 1e-5);
+    }
+    EXPECT_EQ(UCC_ERR_NOT_FOUND, ucc_pipeline_stats_estimate(&stats, &model));
+
+    for (int i = 0; i < 1000; i++) {
+        size = (i % 4 + 1) * 65536;
+        ucc_pipeline_stats_update(&stats, size, 3e-6 + size / 5e9);
+    }
+    ASSERT_EQ(UCC_OK, ucc_pipeline_stats_estimate(&stats, &model));
+    EXPECT_NEAR(3e-6, model.frag_latency, 1e-6);
+    EXPECT_NEAR(5e9, model.bw, 5e8);
+}
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#include "common/test_ucc.h"
+
+#include <array>
+
+class test_sparse_allreduce : public ucc::test {
+  public:
+    struct rank_data {
+        std::vector<uint64_t> src_idx;
+        std::vector<double>   src_val;
+        std::vector<uint64_t> dst_idx;
+        std::vector<double>   dst_val;
+        uint64_t              dst_nnz;
+        ucc_coll_args_t       args;
+        gtest_ucc_coll_ctx_t  ctx;
+    };
+
+    /* every rank contributes density_pct percent of the dense vector,
+       values are small integers so that the sum is exact */
+    void data_init(int nprocs, size_t dense_count, int density_pct,
+                   bool dense_out, std::vector<rank_data> &data,
+                   UccCollCtxVec &ctxs)
+    {
+        data.resize(nprocs);
+        ctxs.resize(nprocs);
+        for (int r = 0; r < nprocs; r++) {
+            rank_data       &d    = data[r];
+            ucc_coll_args_t *args = &d.args;
+
+            for (size_t i = 0; i < dense_count; i++) {
+                if ((i * 7 + r * 13) % 100 < density_pct) {
+                    d.src_idx.push_back(i);
+                    d.src_val.push_back((double)((i + r) % 5 + 1));
+                }
+            }
+            d.dst_val.resize(dense_count);
+            if (!dense_out) {
+                d.dst_idx.resize(dense_count);
+            }
+            memset(args, 0, sizeof(*args));
+            args->mask = UCC_COLL_ARGS_FIELD_PREDEFINED_REDUCTIONS |
+                         UCC_COLL_ARGS_FIELD_SPARSE;
+            args->coll_type            = UCC_COLL_TYPE_SPARSE_ALLREDUCE;
+            args->reduce.predefined_op = UCC_OP_SUM;
+            args->src.info.buffer      = d.src_val.data();
+            args->src.info.count       = d.src_val.size();
+            args->src.info.datatype    = UCC_DT_FLOAT64;
+            args->src.info.mem_type    = UCC_MEMORY_TYPE_HOST;
+            args->dst.info.buffer      = d.dst_val.data();
+            args->dst.info.count       = d.dst_val.size();
+            args->dst.info.datatype    = UCC_DT_FLOAT64;
+            args->dst.info.mem_type    = UCC_MEMORY_TYPE_HOST;
+            args->sparse.src_indices   = d.src_idx.data();
+            args->sparse.dst_indices   = dense_out ? NULL : d.dst_idx.data();
+            args->sparse.dst_nnz       = &d.dst_nnz;
+            args->sparse.dense_count   = dense_count;
+            d.ctx.args = args;
+            ctxs[r]    = &d.ctx;
+        }
+    }
+
+    void data_validate(size_t dense_count, bool dense_out,
+                       std::vector<rank_data> &data)
+    {
+        std::vector<double> ref(dense_count, 0), res(dense_count);
+
+        for (auto &d : data) {
+            for (size_t i = 0; i < d.src_idx.size(); i++) {
+                ref[d.src_idx[i]] += d.src_val[i];
+            }
+        }
+        for (auto &d : data) {
+            if (dense_out) {
+                EXPECT_EQ(dense_count, d.dst_nnz);
+                EXPECT_EQ(ref, d.dst_val);
+                continue;
+            }
+            std::fill(res.begin(), res.end(), 0);
+            for (uint64_t i = 0; i < d.dst_nnz; i++) {
+                if (i > 0) {
+                    EXPECT_LT(d.dst_idx[i - 1], d.dst_idx[i]);
+                }
+                res[d.dst_idx[i]] = d.dst_val[i];
+            }
+            EXPECT_EQ(ref, res);
+        }
+    }
+};
+
+#define TEST_DECLARE(_dense_out, _repeat)                                      \
+    {                                                                          \
+        std::array<int, 3> densities{1, 10, 60};                               \
+        size_t             dense_count = 4099;                                 \
+        for (int tid = 0; tid < UccJob::nStaticTeams; tid++) {                 \
+            for (int density : densities) {                                    \
+                UccTeam_h              team = UccJob::getStaticTeams()[tid];   \
+                int                    size = team->procs.size();              \
+                std::vector<rank_data> data;                                   \
+                UccCollCtxVec          ctxs;                                   \
+                this->data_init(size, dense_count, density, _dense_out, data,  \
+                                ctxs);                                         \
+                UccReq req(team, ctxs);                                        \
+                for (auto i = 0; i < _repeat; i++) {                           \
+                    req.start();                                               \
+                    req.wait();                                                \
+                    this->data_validate(dense_count, _dense_out, data);        \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }
+
+UCC_TEST_F(test_sparse_allreduce, sparse_out)
+{
+    TEST_DECLARE(false, 1);
+}
+
+UCC_TEST_F(test_sparse_allreduce, dense_out)
+{
+    TEST_DECLARE(true, 1);
+}
+
+UCC_TEST_F(test_sparse_allreduce, sparse_out_persistent)
+{
+    TEST_DECLARE(false, 3);
+}
@@ -78,3 +78,26 @@ UCC_TEST_F(test_team, team_create_multiple_preconnect_ctx_global)
     /* shuffle vector so that teams are destroyed in different order */
     std::shuffle(teams.begin(), teams.end(), std::default_random_engine());
 }
+
+/* Create and destroy several coexisting teams over the TL/UCP worker pool,
+   teams are bound to different pool workers */
+UCC_TEST_F(test_team, team_create_multiple_worker_pool)
+{
+    int              job_size   = 8;
+    ucc_lib_params_t lib_params = UccProcess::default_lib_params;
+
+    /* the progress thread requires a thread multiple lib */
+    lib_params.thread_mode = UCC_THREAD_MULTIPLE;
+    UccJob job(job_size, UccJob::UCC_JOB_CTX_GLOBAL,
+               {ucc_env_var_t("UCC_PROGRESS_THREAD", "1"),
+                ucc_env_var_t("UCC_TL_UCP_WORKER_POOL_SIZE", "4"),
+                ucc_env_var_t("UCC_TL_UCP_PRECONNECT", "inf")},
+               lib_params);
+    int n_teams  = 4; /* how many teams to create */
+    std::vector<UccTeam_h> teams;
+    for (int i = 0; i < n_teams; i++) {
+        int team_size = 2 + (rand() % (job_size - 2 + 1));
+        teams.push_back(job.create_team(team_size));
+    }
+    std::shuffle(teams.begin(), teams.end(), std::default_random_engine());
+}
@@ -46,6 +46,8 @@ class test_topo : public ucc::test {
     _s.h[_i].ctx_id.pi.socket_id = _sock;                                      \
     _s.h[_i].ctx_id.pi.pid       = _pid;
 
+#define SET_NUMA(_s, _i, _numa) _s.h[_i].ctx_id.pi.numa_id = _numa;
+
 UCC_TEST_F(test_topo, single_node)
 {
     const ucc_rank_t ctx_size = 4;
@@ -187,6 +189,59 @@ UCC_TEST_F(test_topo, 1node_2sockets)
     EXPECT_EQ(sbgp->map.strided.stride, 1);
 }
 
+UCC_TEST_F(test_topo, 1node_4numas)
+{
+    const ucc_rank_t ctx_size  = 8;
+    const ucc_rank_t team_size = 8;
+    addr_storage     s(ctx_size);
+    ucc_sbgp_t *     sbgp;
+    int              i;
+
+    /* simulates world proc array: single socket, 4 numa nodes */
+    for (i = 0; i < ctx_size; i++) {
+        SET_PI(s, i, 0xabcd, 0, i);
+        SET_NUMA(s, i, i % 4);
+    }
+
+    /* team from the world */
+    team.size         = team_size;
+    team.rank         = 5;
+    team.ctx_map.type = UCC_EP_MAP_FULL;
+
+    EXPECT_EQ(UCC_OK, ucc_topo_init(&s.storage, &topo));
+    EXPECT_EQ(UCC_OK, ucc_team_topo_init(&team, topo, &team.topo));
+
+    /* SOCKET subgroup - ALL on the same socket */
+    sbgp = ucc_team_topo_get_sbgp(team.topo, UCC_SBGP_SOCKET);
+    EXPECT_EQ(UCC_SBGP_ENABLED, sbgp->status);
+    EXPECT_EQ(team_size, sbgp->group_size);
+
+    /* NUMA subgroup - must contain ranks 1, 5 */
+    sbgp = ucc_team_topo_get_sbgp(team.topo, UCC_SBGP_NUMA);
+    EXPECT_EQ(UCC_SBGP_ENABLED, sbgp->status);
+    EXPECT_EQ(2, sbgp->group_size);
+    EXPECT_EQ(1, sbgp->group_rank);
+    EXPECT_EQ(sbgp->map.type, UCC_EP_MAP_STRIDED);
+    EXPECT_EQ(sbgp->map.strided.start, 1);
+    EXPECT_EQ(sbgp->map.strided.stride, 4);
+
+    /* NUMA_LEADERS subgroup - ranks 0, 1, 2, 3. Rank 5 does not
+       participate */
+    sbgp = ucc_team_topo_get_sbgp(team.topo, UCC_SBGP_NUMA_LEADERS);
+    EXPECT_EQ(UCC_SBGP_DISABLED, sbgp->status);
+
+    ucc_team_topo_cleanup(team.topo);
+    team.rank = 2;
+    EXPECT_EQ(UCC_OK, ucc_team_topo_init(&team, topo, &team.topo));
+    sbgp = ucc_team_topo_get_sbgp(team.topo, UCC_SBGP_NUMA_LEADERS);
+    EXPECT_EQ(UCC_SBGP_ENABLED, sbgp->status);
+    EXPECT_EQ(4, sbgp->group_size);
+    EXPECT_EQ(2, sbgp->group_rank);
+    EXPECT_EQ(sbgp->map.type, UCC_EP_MAP_STRIDED);
+    EXPECT_EQ(sbgp->map.strided.start, 0);
+    EXPECT_EQ(sbgp->map.strided.stride, 1);
+}
+
 UCC_TEST_F(test_topo, 2nodes)
 {
     const ucc_rank_t ctx_size  = 8;
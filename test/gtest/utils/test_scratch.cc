@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+extern "C" {
+#include <core/ucc_mc.h>
+#include <utils/ucc_scratch.h>
+}
+#include <common/test.h>
+#include <vector>
+#include <algorithm>
+
+class test_scratch : public ucc::test {
+  public:
+    ucc_scratch_arena_t arena;
+    void                       init_arena(size_t max_cached)
+    {
+        ucc_mc_params_t mc_params = {
+            .thread_mode = UCC_THREAD_SINGLE,
+        };
+        ASSERT_EQ(UCC_OK, ucc_constructor());
+        ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+        ucc_scratch_arena_init(&arena, max_cached);
+    }
+    void cleanup_arena()
+    {
+        ucc_scratch_arena_cleanup(&arena);
+        EXPECT_EQ(UCC_OK, ucc_mc_finalize());
+    }
+};
+
+/* Buffers are page multiples and waste less than a quarter of the size */
+UCC_TEST_F(test_scratch, size_rounding)
+{
+    std::vector<size_t>   sizes = {1,       4096,    4097,     8193,
+                                   12289,   65537,   100000,   1000000,
+                                   3145728, 3145729, 33554431};
+    ucc_scratch_t *s;
+
+    init_arena(0);
+    for (auto size : sizes) {
+        ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, size,
+                                          UCC_MEMORY_TYPE_HOST, &s));
+        EXPECT_GE(s->size, size);
+        EXPECT_EQ(0, s->size % UCC_SCRATCH_ALIGN);
+        EXPECT_LT(s->size - size,
+                  std::max(size / 4, (size_t)UCC_SCRATCH_ALIGN));
+        EXPECT_GE(s->size_class, 0);
+        EXPECT_LT(s->size_class, UCC_SCRATCH_N_CLASSES);
+        ucc_scratch_put(&arena, s);
+    }
+    cleanup_arena();
+}
+
+/* A released buffer is reused by the next request of its size class and
+   not by a request of another class or memory type */
+UCC_TEST_F(test_scratch, reuse)
+{
+    ucc_scratch_t *s1, *s2, *s3;
+    void                 *addr;
+
+    init_arena(1 << 20);
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, 100000,
+                                      UCC_MEMORY_TYPE_HOST, &s1));
+    addr = s1->addr;
+    ucc_scratch_put(&arena, s1);
+    EXPECT_EQ(s1->size, arena.cached);
+
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, 70000,
+                                      UCC_MEMORY_TYPE_HOST, &s2));
+    EXPECT_NE(s1, s2);
+    EXPECT_EQ(s1->size, arena.cached);
+
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, 110000,
+                                      UCC_MEMORY_TYPE_HOST, &s3));
+    EXPECT_EQ(s1, s3);
+    EXPECT_EQ(addr, s3->addr);
+    EXPECT_EQ(0, arena.cached);
+
+    ucc_scratch_put(&arena, s2);
+    ucc_scratch_put(&arena, s3);
+    EXPECT_EQ(s2->size + s3->size, arena.cached);
+    cleanup_arena();
+}
+
+/* Buffers released above max_cached are freed and not reused */
+UCC_TEST_F(test_scratch, max_cached)
+{
+    const size_t          max_cached = 256 * 1024;
+    ucc_scratch_t *s1, *s2, *s3;
+
+    init_arena(max_cached);
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, 2 * max_cached,
+                                      UCC_MEMORY_TYPE_HOST, &s1));
+    ucc_scratch_put(&arena, s1);
+    EXPECT_EQ(0, arena.cached);
+
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, max_cached / 2,
+                                      UCC_MEMORY_TYPE_HOST, &s1));
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, max_cached / 2,
+                                      UCC_MEMORY_TYPE_HOST, &s2));
+    ASSERT_EQ(UCC_OK, ucc_scratch_get(&arena, max_cached / 2,
+                                      UCC_MEMORY_TYPE_HOST, &s3));
+    ucc_scratch_put(&arena, s1);
+    ucc_scratch_put(&arena, s2);
+    EXPECT_EQ(max_cached, arena.cached);
+    ucc_scratch_put(&arena, s3);
+    EXPECT_EQ(max_cached, arena.cached);
+    cleanup_arena();
+}
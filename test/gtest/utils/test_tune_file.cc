@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+extern "C" {
+#include <utils/ucc_tune_file.h>
+}
+#include <common/test.h>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+
+class test_tune_file : public ucc::test {
+  public:
+    ucc_tune_file_t tune;
+    std::string       filename;
+    test_tune_file()
+    {
+        tune.entries   = NULL;
+        tune.n_entries = 0;
+    }
+    ~test_tune_file()
+    {
+        ucc_tune_file_free(&tune);
+        if (!filename.empty()) {
+            unlink(filename.c_str());
+        }
+    }
+    ucc_status_t load(const std::string &content)
+    {
+        char  name[] = "/tmp/ucc_tune_file_XXXXXX";
+        int   fd     = mkstemp(name);
+        FILE *f;
+
+        EXPECT_GE(fd, 0);
+        filename = name;
+        f        = fdopen(fd, "w");
+        fputs(content.c_str(), f);
+        fclose(f);
+        return ucc_tune_file_load(filename.c_str(), &tune);
+    }
+    const char *param(const ucc_tune_file_entry_t *e, const char *name)
+    {
+        for (int i = 0; i < e->n_params; i++) {
+            if (std::string(e->params[i].name) == name) {
+                return e->params[i].value;
+            }
+        }
+        return NULL;
+    }
+};
+
+/* Sections with the same key are merged, TUNE strings are concatenated and
+   the last value of a parameter wins */
+UCC_TEST_F(test_tune_file, parse)
+{
+    const ucc_tune_file_entry_t *e;
+
+    ASSERT_EQ(UCC_OK, load("# comment\n"
+                           "\n"
+                           "[nnodes=4 ppn=8]\n"
+                           "  TUNE = allreduce:0-8192:host:@knomial  \n"
+                           "ALLREDUCE_SRA_KN_RADIX=4\n"
+                           "[nnodes=2 ppn=8]\n"
+                           "BCAST_KN_RADIX=2\n"
+                           "[nnodes=4 ppn=8]\n"
+                           "TUNE=allreduce:8192-inf:host:@sra_knomial\n"
+                           "ALLREDUCE_SRA_KN_RADIX=8\n"));
+    EXPECT_EQ(2, tune.n_entries);
+    e = ucc_tune_file_lookup(&tune, 4, 8);
+    ASSERT_NE((void *)NULL, e);
+    EXPECT_EQ(4, e->nnodes);
+    EXPECT_STREQ("allreduce:0-8192:host:@knomial#"
+                 "allreduce:8192-inf:host:@sra_knomial",
+                 e->score_str);
+    EXPECT_EQ(1, e->n_params);
+    EXPECT_STREQ("8", param(e, "ALLREDUCE_SRA_KN_RADIX"));
+    e = ucc_tune_file_lookup(&tune, 2, 8);
+    ASSERT_NE((void *)NULL, e);
+    EXPECT_EQ((void *)NULL, e->score_str);
+    EXPECT_STREQ("2", param(e, "BCAST_KN_RADIX"));
+}
+
+UCC_TEST_F(test_tune_file, invalid)
+{
+    EXPECT_EQ(UCC_ERR_INVALID_PARAM, load("BCAST_KN_RADIX=2\n"));
+    EXPECT_EQ(0, tune.n_entries);
+    unlink(filename.c_str());
+    EXPECT_EQ(UCC_ERR_INVALID_PARAM, load("[nnodes=0 ppn=8]\n"));
+    unlink(filename.c_str());
+    EXPECT_EQ(UCC_ERR_INVALID_PARAM, load("[nnodes=2 ppn=8]\n"
+                                          "BCAST_KN_RADIX\n"));
+    EXPECT_EQ(0, tune.n_entries);
+    EXPECT_EQ(UCC_ERR_NOT_FOUND,
+              ucc_tune_file_load("/nonexistent/ucc_tune", &tune));
+}
+
+/* Lookup falls back to the closest number of nodes with the same ppn */
+UCC_TEST_F(test_tune_file, lookup)
+{
+    ASSERT_EQ(UCC_OK, load("[nnodes=2 ppn=4]\nA=1\n"
+                           "[nnodes=8 ppn=4]\nA=2\n"
+                           "[nnodes=4 ppn=16]\nA=3\n"));
+    EXPECT_EQ(2, ucc_tune_file_lookup(&tune, 1, 4)->nnodes);
+    EXPECT_EQ(2, ucc_tune_file_lookup(&tune, 3, 4)->nnodes);
+    EXPECT_EQ(8, ucc_tune_file_lookup(&tune, 6, 4)->nnodes);
+    EXPECT_EQ(8, ucc_tune_file_lookup(&tune, 64, 4)->nnodes);
+    EXPECT_EQ(16, ucc_tune_file_lookup(&tune, 2, 16)->ppn);
+    EXPECT_EQ((void *)NULL, ucc_tune_file_lookup(&tune, 2, 8));
+}
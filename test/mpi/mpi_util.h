@@ -32,6 +32,7 @@ static inline MPI_Datatype ucc_dt_to_mpi(ucc_datatype_t dt) {
     case UCC_DT_FLOAT64:
         return MPI_DOUBLE;
     case UCC_DT_FLOAT16:
+    case UCC_DT_BFLOAT16:
     case UCC_DT_INT128:
     case UCC_DT_UINT128:
     default:
@@ -71,6 +71,33 @@ exit_err:
     return st;
 }
 
+/* Average time of the collective with the given count, the max over
+   the ranks is returned on all the ranks */
+ucc_status_t ucc_pt_benchmark::measure(size_t count, float &time_us) noexcept
+{
+    size_t                   coll_size = count * ucc_dt_size(config.dt);
+    int                      iter      = config.n_iter_small;
+    int                      warmup    = config.n_warmup_small;
+    ucc_status_t             st;
+    ucc_coll_args_t          args;
+    std::chrono::nanoseconds time;
+    float                    t;
+
+    if (coll_size >= config.large_thresh) {
+        iter   = config.n_iter_large;
+        warmup = config.n_warmup_large;
+    }
+    UCCCHECK_GOTO(coll->init_coll_args(count, args), exit_err, st);
+    UCCCHECK_GOTO(run_single_test(args, warmup, iter, time), free_coll, st);
+    coll->free_coll_args(args);
+    t = time.count() / 1000.0;
+    return comm->allreduce(&t, &time_us, 1, UCC_OP_MAX);
+free_coll:
+    coll->free_coll_args(args);
+exit_err:
+    return st;
+}
+
 ucc_status_t ucc_pt_benchmark::run_single_test(ucc_coll_args_t args,
                                                int nwarmup, int niter,
                                                std::chrono::nanoseconds &time)
@@ -28,6 +28,7 @@ public:
     ucc_status_t run_single_test(ucc_coll_args_t args,
                                  int nwarmup, int niter,
                                  std::chrono::nanoseconds &time) noexcept;
+    ucc_status_t measure(size_t count, float &time_us) noexcept;
     ~ucc_pt_benchmark();
 };
 
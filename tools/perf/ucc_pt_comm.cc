@@ -41,6 +41,16 @@ int ucc_pt_comm::get_size()
     return bootstrap->get_size();
 }
 
+int ucc_pt_comm::get_ppn()
+{
+    return bootstrap->get_ppn();
+}
+
+int ucc_pt_comm::get_local_rank()
+{
+    return bootstrap->get_local_rank();
+}
+
 ucc_team_h ucc_pt_comm::get_team()
 {
     return team;
@@ -23,6 +23,8 @@ public:
     ucc_pt_comm(ucc_pt_comm_config config);
     int get_rank();
     int get_size();
+    int get_ppn();
+    int get_local_rank();
     ucc_team_h get_team();
     ucc_context_h get_context();
     ~ucc_pt_comm();
@@ -43,6 +43,11 @@ struct ucc_pt_benchmark_config {
     bool               full_print;
 };
 
+extern const std::map<std::string, ucc_reduction_op_t> ucc_pt_op_map;
+extern const std::map<std::string, ucc_coll_type_t>    ucc_pt_coll_map;
+extern const std::map<std::string, ucc_memory_type_t>  ucc_pt_memtype_map;
+extern const std::map<std::string, ucc_datatype_t>     ucc_pt_datatype_map;
+
 struct ucc_pt_config {
     ucc_pt_bootstrap_config bootstrap;
     ucc_pt_comm_config      comm;
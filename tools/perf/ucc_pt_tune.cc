@@ -0,0 +1,413 @@
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include "ucc_pt_tune.h"
+#include "ucc_pt_benchmark.h"
+#include "ucc_perftest.h"
+#include "core/ucc_mc.h"
+#include "utils/ucc_coll_utils.h"
+
+static const std::string ucc_pt_tune_env_prefix = "UCC_TL_UCP_";
+
+static std::vector<std::string> ucc_pt_tune_split(const std::string &str)
+{
+    std::vector<std::string> tokens;
+    std::stringstream        ss(str);
+    std::string              token;
+
+    while (std::getline(ss, token, ',')) {
+        if (!token.empty()) {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+ucc_pt_tune_config::ucc_pt_tune_config()
+{
+    ucc_pt_config pt_config;
+
+    comm            = pt_config.comm;
+    bench           = pt_config.bench;
+    bench.min_count = 1;
+    bench.max_count = 1 << 22;
+    comm.mt         = bench.mt;
+    radices         = ucc_pt_tune_split("2,4,8,16");
+    frag_sizes      = ucc_pt_tune_split("inf,auto,256k,1m");
+}
+
+ucc_status_t ucc_pt_tune_config::process_args(int argc, char *argv[])
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "c:b:e:d:m:n:w:o:r:s:f:h")) != -1) {
+        switch (c) {
+            case 'c':
+                if (ucc_pt_coll_map.count(optarg) == 0) {
+                    std::cerr << "invalid collective" << std::endl;
+                    return UCC_ERR_INVALID_PARAM;
+                }
+                bench.coll_type = ucc_pt_coll_map.at(optarg);
+                break;
+            case 'o':
+                if (ucc_pt_op_map.count(optarg) == 0) {
+                    std::cerr << "invalid operation" << std::endl;
+                    return UCC_ERR_INVALID_PARAM;
+                }
+                bench.op = ucc_pt_op_map.at(optarg);
+                break;
+            case 'm':
+                if (ucc_pt_memtype_map.count(optarg) == 0) {
+                    std::cerr << "invalid memory type" << std::endl;
+                    return UCC_ERR_INVALID_PARAM;
+                }
+                bench.mt = ucc_pt_memtype_map.at(optarg);
+                comm.mt  = bench.mt;
+                break;
+            case 'd':
+                if (ucc_pt_datatype_map.count(optarg) == 0) {
+                    std::cerr << "invalid datatype" << std::endl;
+                    return UCC_ERR_INVALID_PARAM;
+                }
+                bench.dt = ucc_pt_datatype_map.at(optarg);
+                break;
+            case 'b':
+                std::stringstream(optarg) >> bench.min_count;
+                break;
+            case 'e':
+                std::stringstream(optarg) >> bench.max_count;
+                break;
+            case 'n':
+                std::stringstream(optarg) >> bench.n_iter_small;
+                bench.n_iter_large = bench.n_iter_small;
+                break;
+            case 'w':
+                std::stringstream(optarg) >> bench.n_warmup_small;
+                bench.n_warmup_large = bench.n_warmup_small;
+                break;
+            case 'r':
+                radices = ucc_pt_tune_split(optarg);
+                break;
+            case 's':
+                frag_sizes = ucc_pt_tune_split(optarg);
+                break;
+            case 'f':
+                output = optarg;
+                break;
+            case 'h':
+            default:
+                print_help();
+                std::exit(0);
+        }
+    }
+    if (radices.empty() || frag_sizes.empty() ||
+        bench.min_count == 0 || bench.min_count > bench.max_count) {
+        std::cerr << "invalid tuning range" << std::endl;
+        return UCC_ERR_INVALID_PARAM;
+    }
+    return UCC_OK;
+}
+
+void ucc_pt_tune_config::print_help()
+{
+    std::cout << "Usage: ucc_tune [options]"<<std::endl;
+    std::cout << "  -c <collective name>: Collective type"<<std::endl;
+    std::cout << "  -b <count>: Min number of elements"<<std::endl;
+    std::cout << "  -e <count>: Max number of elements"<<std::endl;
+    std::cout << "  -d <dt name>: datatype"<<std::endl;
+    std::cout << "  -o <op name>: reduction operation type"<<std::endl;
+    std::cout << "  -m <mtype name>: memory type"<<std::endl;
+    std::cout << "  -n <number>: number of iterations"<<std::endl;
+    std::cout << "  -w <number>: number of warmup iterations"<<std::endl;
+    std::cout << "  -r <list>: ',' separated knomial radices, number of "
+                 "posts for alltoall(v)"<<std::endl;
+    std::cout << "  -s <list>: ',' separated allreduce fragment sizes, "
+                 "inf and auto are allowed"<<std::endl;
+    std::cout << "  -f <file>: append the result to the tuning file"
+              <<std::endl;
+    std::cout << "  -h: show this help message"<<std::endl;
+    std::cout << std::endl;
+}
+
+ucc_pt_tune::ucc_pt_tune(ucc_pt_tune_config cfg, ucc_pt_comm *communicator):
+    config(cfg),
+    comm(communicator),
+    nnodes(0),
+    ppn(0)
+{
+    add_candidates();
+    if (candidates.empty()) {
+        throw std::runtime_error("collective has nothing to tune");
+    }
+    if (config.bench.coll_type == UCC_COLL_TYPE_BARRIER) {
+        counts.push_back(1);
+        return;
+    }
+    for (size_t cnt = config.bench.min_count; cnt <= config.bench.max_count;
+         cnt *= 2) {
+        counts.push_back(cnt);
+    }
+}
+
+void ucc_pt_tune::add_candidates()
+{
+    const char  *param = nullptr;
+    std::string  thresh;
+
+    switch (config.bench.coll_type) {
+    case UCC_COLL_TYPE_ALLREDUCE:
+        for (auto &r : config.radices) {
+            candidates.push_back({"knomial", {{"ALLREDUCE_KN_RADIX", r}}, {}});
+        }
+        for (auto &r : config.radices) {
+            for (auto &f : config.frag_sizes) {
+                /* auto fragmentation decides itself when to fragment */
+                thresh = (f == "auto") ? "0" : f;
+                candidates.push_back(
+                    {"sra_knomial",
+                     {{"ALLREDUCE_SRA_KN_RADIX", r},
+                      {"ALLREDUCE_SRA_KN_FRAG_THRESH", thresh},
+                      {"ALLREDUCE_SRA_KN_FRAG_SIZE", f}},
+                     {}});
+            }
+        }
+        return;
+    case UCC_COLL_TYPE_ALLGATHER:
+        param = "ALLGATHER_KN_RADIX";
+        break;
+    case UCC_COLL_TYPE_ALLTOALL:
+        param = "ALLTOALL_PAIRWISE_NUM_POSTS";
+        break;
+    case UCC_COLL_TYPE_ALLTOALLV:
+        param = "ALLTOALLV_PAIRWISE_NUM_POSTS";
+        break;
+    case UCC_COLL_TYPE_BARRIER:
+        param = "BARRIER_KN_RADIX";
+        break;
+    case UCC_COLL_TYPE_BCAST:
+        param = "BCAST_KN_RADIX";
+        break;
+    case UCC_COLL_TYPE_REDUCE:
+        param = "REDUCE_KN_RADIX";
+        break;
+    default:
+        return;
+    }
+    for (auto &r : config.radices) {
+        candidates.push_back({"", {{param, r}}, {}});
+    }
+}
+
+ucc_status_t ucc_pt_tune::run_candidate(ucc_pt_tune_candidate &c)
+{
+    const char       *coll_name = ucc_coll_type_str(config.bench.coll_type);
+    ucc_pt_benchmark *bench;
+    ucc_status_t      st;
+    std::string       tune;
+    float             time;
+
+    /* force the algorithm, tuning file of a previous run must not be
+       applied */
+    if (!c.alg.empty()) {
+        tune = std::string(coll_name) + ":@" + c.alg + ":inf";
+    }
+    setenv((ucc_pt_tune_env_prefix + "TUNE").c_str(), tune.c_str(), 1);
+    unsetenv((ucc_pt_tune_env_prefix + "TUNE_FILE").c_str());
+    for (auto &p : c.params) {
+        setenv((ucc_pt_tune_env_prefix + p.first).c_str(), p.second.c_str(),
+               1);
+    }
+    st = comm->init();
+    if (st != UCC_OK) {
+        return st;
+    }
+    if (nnodes == 0) {
+        float local_leader = (comm->get_local_rank() == 0) ? 1 : 0;
+        float local_ppn    = comm->get_ppn();
+        float n;
+
+        UCCCHECK_GOTO(comm->allreduce(&local_leader, &n, 1, UCC_OP_SUM),
+                      exit_comm, st);
+        nnodes = (int)n;
+        UCCCHECK_GOTO(comm->allreduce(&local_ppn, &n, 1, UCC_OP_MAX),
+                      exit_comm, st);
+        ppn = (int)n;
+    }
+    try {
+        bench = new ucc_pt_benchmark(config.bench, comm);
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        st = UCC_ERR_NOT_SUPPORTED;
+        goto exit_comm;
+    }
+    c.times.clear();
+    for (auto cnt : counts) {
+        UCCCHECK_GOTO(bench->measure(cnt, time), exit_bench, st);
+        c.times.push_back(time);
+    }
+exit_bench:
+    delete bench;
+exit_comm:
+    comm->finalize();
+    return st;
+}
+
+/* Parameters of every algorithm are chosen over the message sizes where
+   the algorithm wins, then the algorithms are compared with the chosen
+   parameters. The parameters apply to the whole message range, so the
+   relative slowdown is minimized rather than the absolute time, which
+   would be dominated by the large messages. */
+void ucc_pt_tune::select(std::vector<int> &best_alg,
+                         std::vector<int> &best_cand)
+{
+    std::vector<std::string> algs;
+    std::vector<float>       best_time(counts.size(),
+                                       std::numeric_limits<float>::max());
+    std::vector<int>         owner(counts.size(), 0);
+    std::vector<int>         alg_of(candidates.size());
+    float                    score, best_score;
+    size_t                   a, c, s;
+
+    for (c = 0; c < candidates.size(); c++) {
+        for (a = 0; a < algs.size(); a++) {
+            if (algs[a] == candidates[c].alg) {
+                break;
+            }
+        }
+        if (a == algs.size()) {
+            algs.push_back(candidates[c].alg);
+        }
+        alg_of[c] = a;
+        for (s = 0; s < counts.size(); s++) {
+            if (candidates[c].times[s] < best_time[s]) {
+                best_time[s] = candidates[c].times[s];
+                owner[s]     = a;
+            }
+        }
+    }
+    best_cand.assign(algs.size(), -1);
+    for (a = 0; a < algs.size(); a++) {
+        bool owns = false;
+
+        for (s = 0; s < counts.size(); s++) {
+            owns = owns || (owner[s] == (int)a);
+        }
+        best_score = std::numeric_limits<float>::max();
+        for (c = 0; c < candidates.size(); c++) {
+            if (alg_of[c] != (int)a) {
+                continue;
+            }
+            score = 0;
+            for (s = 0; s < counts.size(); s++) {
+                if (!owns || owner[s] == (int)a) {
+                    score += candidates[c].times[s] / best_time[s];
+                }
+            }
+            if (score < best_score) {
+                best_score   = score;
+                best_cand[a] = c;
+            }
+        }
+    }
+    best_alg.assign(counts.size(), 0);
+    for (s = 0; s < counts.size(); s++) {
+        for (a = 1; a < algs.size(); a++) {
+            if (candidates[best_cand[a]].times[s] <
+                candidates[best_cand[best_alg[s]]].times[s]) {
+                best_alg[s] = a;
+            }
+        }
+    }
+}
+
+std::string ucc_pt_tune::size_str(size_t idx)
+{
+    if (idx == 0) {
+        return "0";
+    }
+    if (idx == counts.size()) {
+        return "inf";
+    }
+    return std::to_string(counts[idx] * ucc_dt_size(config.bench.dt));
+}
+
+void ucc_pt_tune::write(const std::vector<int> &best_alg,
+                        const std::vector<int> &best_cand)
+{
+    const char      *coll_name = ucc_coll_type_str(config.bench.coll_type);
+    std::ofstream    file;
+    std::ostream    *out       = &std::cout;
+    std::vector<int> used(best_cand.size(), 0);
+    std::string      tune;
+    size_t           s, start;
+
+    if (!config.output.empty()) {
+        file.open(config.output, std::ios::app);
+        if (!file) {
+            std::cerr << "failed to open " << config.output << std::endl;
+        } else {
+            out = &file;
+        }
+    }
+    for (start = 0, s = 1; s <= counts.size(); s++) {
+        if (s < counts.size() && best_alg[s] == best_alg[start]) {
+            continue;
+        }
+        used[best_alg[start]] = 1;
+        if (!candidates[best_cand[best_alg[start]]].alg.empty()) {
+            tune += (tune.empty() ? "" : "#") + std::string(coll_name) + ":" +
+                    size_str(start) + "-" + size_str(s) + ":" +
+                    ucc_memory_type_names[config.bench.mt] + ":@" +
+                    candidates[best_cand[best_alg[start]]].alg;
+        }
+        start = s;
+    }
+    *out << "# ucc_tune: " << coll_name << " "
+         << ucc_datatype_str(config.bench.dt) << " "
+         << ucc_memory_type_names[config.bench.mt] << std::endl;
+    *out << "[nnodes=" << nnodes << " ppn=" << ppn << "]" << std::endl;
+    if (!tune.empty()) {
+        *out << "TUNE=" << tune << std::endl;
+    }
+    for (s = 0; s < best_cand.size(); s++) {
+        if (!used[s]) {
+            continue;
+        }
+        for (auto &p : candidates[best_cand[s]].params) {
+            *out << p.first << "=" << p.second << std::endl;
+        }
+    }
+    *out << std::endl;
+}
+
+ucc_status_t ucc_pt_tune::run()
+{
+    std::vector<int> best_alg, best_cand;
+    ucc_status_t     st;
+
+    for (auto &c : candidates) {
+        st = run_candidate(c);
+        if (st != UCC_OK) {
+            return st;
+        }
+        if (comm->get_rank() == 0) {
+            std::cout << std::setw(12) << (c.alg.empty() ? "-" : c.alg);
+            for (auto &p : c.params) {
+                std::cout << " " << p.first << "=" << p.second;
+            }
+            std::cout << std::endl;
+            for (size_t s = 0; s < counts.size(); s++) {
+                std::cout << std::setw(12) << counts[s]
+                          << std::setw(12) << std::fixed
+                          << std::setprecision(2) << c.times[s] << std::endl;
+            }
+        }
+    }
+    if (comm->get_rank() == 0) {
+        select(best_alg, best_cand);
+        write(best_alg, best_cand);
+    }
+    return UCC_OK;
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_PT_TUNE_H
+#define UCC_PT_TUNE_H
+
+#include "ucc_pt_config.h"
+#include "ucc_pt_comm.h"
+#include <ucc/api/ucc.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+struct ucc_pt_tune_config {
+    ucc_pt_comm_config       comm;
+    ucc_pt_benchmark_config  bench;
+    std::vector<std::string> radices;
+    std::vector<std::string> frag_sizes;
+    std::string              output;
+
+    ucc_pt_tune_config();
+    ucc_status_t process_args(int argc, char *argv[]);
+    void print_help();
+};
+
+/* Algorithm of TL/UCP together with the values of its lib parameters */
+struct ucc_pt_tune_candidate {
+    std::string                                      alg;
+    std::vector<std::pair<std::string, std::string>> params;
+    std::vector<float>                               times;
+};
+
+/* Measures every candidate of the collective over the message size range
+   and writes the tuning file section for the shape of the job: the best
+   algorithm per message range as a TUNE string and the best parameters of
+   every selected algorithm. Each candidate runs on its own UCC context
+   since TL/UCP parameters are read from the environment at init. */
+class ucc_pt_tune {
+    ucc_pt_tune_config                 config;
+    ucc_pt_comm                       *comm;
+    std::vector<size_t>                counts;
+    std::vector<ucc_pt_tune_candidate> candidates;
+    int                                nnodes;
+    int                                ppn;
+
+    void add_candidates();
+    ucc_status_t run_candidate(ucc_pt_tune_candidate &c);
+    void select(std::vector<int> &best_alg, std::vector<int> &best_cand);
+    std::string size_str(size_t idx);
+    void write(const std::vector<int> &best_alg,
+               const std::vector<int> &best_cand);
+public:
+    ucc_pt_tune(ucc_pt_tune_config cfg, ucc_pt_comm *communicator);
+    ucc_status_t run();
+};
+
+#endif
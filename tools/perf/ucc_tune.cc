@@ -0,0 +1,32 @@
+#include <ucc/api/ucc.h>
+#include "ucc_pt_comm.h"
+#include "ucc_pt_tune.h"
+
+int main(int argc, char *argv[])
+{
+    ucc_pt_tune_config tune_config;
+    ucc_pt_comm *comm;
+    ucc_pt_tune *tune;
+    ucc_status_t st;
+
+    if (tune_config.process_args(argc, argv) != UCC_OK) {
+        std::exit(1);
+    }
+    try {
+        comm = new ucc_pt_comm(tune_config.comm);
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        std::exit(1);
+    }
+    try {
+        tune = new ucc_pt_tune(tune_config, comm);
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        delete comm;
+        std::exit(1);
+    }
+    st = tune->run();
+    delete tune;
+    delete comm;
+    return (st == UCC_OK) ? 0 : 1;
+}